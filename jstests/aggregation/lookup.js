@@ -0,0 +1,87 @@
+// Test the $lookUp stage under each of its join strategies.
+
+var local = db.agg_lookup_local;
+var foreign = db.agg_lookup_foreign;
+local.drop();
+foreign.drop();
+
+assert.writeOK(local.insert({_id: 0, a: 1}));
+assert.writeOK(local.insert({_id: 1, a: null}));
+assert.writeOK(local.insert({_id: 2}));
+assert.writeOK(local.insert({_id: 3, a: 2}));
+assert.writeOK(local.insert({_id: 4, a: 3}));
+
+assert.writeOK(foreign.insert({_id: 0, b: 1}));
+assert.writeOK(foreign.insert({_id: 1, b: null}));
+assert.writeOK(foreign.insert({_id: 2}));
+assert.writeOK(foreign.insert({_id: 3, b: [2, 3]}));
+assert.writeOK(foreign.insert({_id: 4, b: 1}));
+
+var pipeline = [
+    {$sort: {_id: -1}},
+    {$lookUp: {from: "agg_lookup_foreign", localField: "a", foreignField: "b", as: "joined"}}
+];
+
+var expected = [
+    {_id: 4, a: 3, joined: [3]},
+    {_id: 3, a: 2, joined: [3]},
+    {_id: 2, joined: [1, 2]},
+    {_id: 1, a: null, joined: [1, 2]},
+    {_id: 0, a: 1, joined: [0, 4]}
+];
+
+function strategy() {
+    var res = local.runCommand("aggregate", {pipeline: pipeline, explain: true});
+    assert.commandWorked(res);
+    return res.stages[1].$lookUp.strategy;
+}
+
+function checkResults(options) {
+    var results = local.aggregate(pipeline, options).toArray();
+    assert.eq(expected.length, results.length, tojson(results));
+    for (var i = 0; i < results.length; i++) {
+        var joinedIds = results[i].joined.map(function(doc) { return doc._id; }).sort();
+        assert.eq(expected[i]._id, results[i]._id, tojson(results));
+        assert.eq(expected[i].joined, joinedIds, tojson(results));
+    }
+}
+
+function setMaxMemoryBytes(bytes) {
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalDocumentSourceLookUpMaxMemoryBytes: bytes}));
+}
+
+var originalMaxMemoryBytes =
+    db.adminCommand({getParameter: 1, internalDocumentSourceLookUpMaxMemoryBytes: 1})
+        .internalDocumentSourceLookUpMaxMemoryBytes;
+
+try {
+    // The foreign collection fits in memory.
+    assert.eq("hashTable", strategy());
+    checkResults();
+
+    // Too large for a hash table and no usable index: sort both sides and merge.
+    setMaxMemoryBytes(1);
+    assert.eq("sortMerge", strategy());
+    checkResults({allowDiskUse: true});
+
+    // A sparse index can't find documents missing the field, so it isn't used.
+    assert.commandWorked(foreign.ensureIndex({b: 1}, {sparse: true}));
+    assert.eq("sortMerge", strategy());
+    assert.commandWorked(foreign.dropIndex({b: 1}));
+
+    // Too large for a hash table but indexed: query the foreign collection per document.
+    assert.commandWorked(foreign.ensureIndex({b: 1}));
+    assert.eq("indexedLoop", strategy());
+    checkResults();
+} finally {
+    setMaxMemoryBytes(originalMaxMemoryBytes);
+}
+
+// Invalid specifications.
+assert.commandFailedWithCode(
+    local.runCommand("aggregate", {pipeline: [{$lookUp: "agg_lookup_foreign"}]}), 28784);
+assert.commandFailedWithCode(
+    local.runCommand("aggregate",
+                     {pipeline: [{$lookUp: {from: "agg_lookup_foreign", as: "joined"}}]}),
+    28787);
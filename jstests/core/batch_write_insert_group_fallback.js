@@ -0,0 +1,55 @@
+// Inserts from one batch are written in groups. When a group fails, its documents are retried one
+// at a time, so errors must still be reported against the right document and ordered batches must
+// still stop at the first error.
+
+(function() {
+    "use strict";
+
+    var coll = db.batch_write_insert_group_fallback;
+
+    function makeBatch(size, dupIndexes) {
+        var docs = [];
+        for (var i = 0; i < size; i++) {
+            docs.push({_id: dupIndexes.indexOf(i) >= 0 ? 0 : i + 1, x: i});
+        }
+        return docs;
+    }
+
+    // Unordered: every document but the duplicates is inserted.
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 0}));
+    var res = db.runCommand(
+        {insert: coll.getName(), documents: makeBatch(200, [10, 150]), ordered: false});
+    assert.commandWorked(res);
+    assert.eq(198, res.n, tojson(res));
+    assert.eq(2, res.writeErrors.length, tojson(res));
+    assert.eq(10, res.writeErrors[0].index, tojson(res));
+    assert.eq(150, res.writeErrors[1].index, tojson(res));
+    assert.eq(ErrorCodes.DuplicateKey, res.writeErrors[0].code, tojson(res));
+    assert.eq(199, coll.count());
+
+    // Ordered: everything before the first duplicate is inserted, nothing after it.
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 0}));
+    res = db.runCommand(
+        {insert: coll.getName(), documents: makeBatch(200, [70, 150]), ordered: true});
+    assert.commandWorked(res);
+    assert.eq(70, res.n, tojson(res));
+    assert.eq(1, res.writeErrors.length, tojson(res));
+    assert.eq(70, res.writeErrors[0].index, tojson(res));
+    assert.eq(71, coll.count());
+    assert.eq(0, coll.find({x: {$gte: 70}}).itcount());
+
+    // A document that fails validation before the write is not part of any group.
+    coll.drop();
+    res = db.runCommand({
+        insert: coll.getName(),
+        documents: [{_id: 1}, {_id: 2}, {_id: 3, $bad: 1}, {_id: 4}, {_id: 5}],
+        ordered: false
+    });
+    assert.commandWorked(res);
+    assert.eq(4, res.n, tojson(res));
+    assert.eq(1, res.writeErrors.length, tojson(res));
+    assert.eq(2, res.writeErrors[0].index, tojson(res));
+    assert.eq(4, coll.count());
+}());
@@ -0,0 +1,76 @@
+// Each index receives the keys of a whole insert group at once, sorted into index order. The
+// index entries must be the same as when documents are inserted one at a time.
+
+(function() {
+    "use strict";
+
+    var coll = db.batch_write_insert_group_index_keys;
+    coll.drop();
+
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: -1, a: 1}));
+    assert.commandWorked(coll.ensureIndex({tags: 1}));
+    assert.commandWorked(coll.ensureIndex({a: 1, c: 1}, {partialFilterExpression: {c: {$gt: 0}}}));
+
+    // Keys arrive out of index order, with repeats and some multikey documents.
+    var docs = [];
+    for (var i = 0; i < 200; i++) {
+        var a = (i * 37) % 101;
+        var doc = {_id: i, a: a, b: i % 7, c: i % 3};
+        if (i % 5 === 0) {
+            doc.tags = [a, a + 1000];
+        }
+        docs.push(doc);
+    }
+    var res = db.runCommand({insert: coll.getName(), documents: docs, ordered: true});
+    assert.commandWorked(res);
+    assert.eq(200, res.n, tojson(res));
+
+    function indexedIds(hint, query) {
+        return coll.find(query || {}, {_id: 1}).hint(hint).toArray().map(function(doc) {
+            return doc._id;
+        });
+    }
+
+    // The _ids of the documents matching "query", in the order of an index on "keyPattern".
+    function expectedIds(keyPattern, query) {
+        var fields = Object.keys(keyPattern);
+        var docs = coll.find(query || {}).hint({$natural: 1}).toArray();
+        docs.sort(function(l, r) {
+            for (var i = 0; i < fields.length; i++) {
+                var diff = keyPattern[fields[i]] * (l[fields[i]] - r[fields[i]]);
+                if (diff !== 0) {
+                    return diff;
+                }
+            }
+            return l._id - r._id;
+        });
+        return docs.map(function(doc) {
+            return doc._id;
+        });
+    }
+
+    assert.eq(expectedIds({a: 1}), indexedIds({a: 1}));
+    assert.eq(expectedIds({b: -1, a: 1}), indexedIds({b: -1, a: 1}));
+    assert.eq(expectedIds({a: 1, c: 1}, {c: {$gt: 0}}), indexedIds({a: 1, c: 1}, {c: {$gt: 0}}));
+
+    // Every element of the multikey documents is indexed.
+    assert.eq(40, coll.find({tags: {$lt: 1000}}).hint({tags: 1}).itcount());
+    assert.eq(40, coll.find({tags: {$gte: 1000}}).hint({tags: 1}).itcount());
+    var explain = coll.find({tags: 5}).hint({tags: 1}).explain();
+    assert(explain.queryPlanner.winningPlan.inputStage.isMultiKey, tojson(explain));
+
+    // A duplicate on a unique secondary index is still reported against the right document.
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({u: 1}, {unique: true}));
+    docs = [];
+    for (var i = 0; i < 50; i++) {
+        docs.push({_id: i, u: i === 30 ? 90 : 100 - i});
+    }
+    res = db.runCommand({insert: coll.getName(), documents: docs, ordered: false});
+    assert.commandWorked(res);
+    assert.eq(49, res.n, tojson(res));
+    assert.eq(1, res.writeErrors.length, tojson(res));
+    assert.eq(30, res.writeErrors[0].index, tojson(res));
+    assert.eq(49, coll.find().hint({u: 1}).itcount());
+}());
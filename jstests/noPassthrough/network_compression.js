@@ -0,0 +1,49 @@
+// Connections negotiate a message compressor in isMaster. Check that the server picks the first
+// compressor the client offers which it has enabled, and that replies come back intact.
+
+(function() {
+    "use strict";
+
+    var conn = MongoRunner.runMongod({setParameter: "networkMessageCompressors=zlib"});
+    var db = conn.getDB("test");
+
+    // Offering a compressor the server hasn't enabled first still picks one it has.
+    var res = assert.commandWorked(db.runCommand({isMaster: 1, compression: ["snappy", "zlib"]}));
+    assert.eq(["zlib"], res.compression, tojson(res));
+
+    res = assert.commandWorked(db.runCommand({isMaster: 1, compression: ["snappy"]}));
+    assert(!res.hasOwnProperty("compression"), tojson(res));
+    res = assert.commandWorked(db.runCommand({isMaster: 1}));
+    assert(!res.hasOwnProperty("compression"), tojson(res));
+
+    // Send compressible documents over a connection using zlib, and read them back.
+    res = assert.commandWorked(db.runCommand({isMaster: 1, compression: ["zlib"]}));
+    assert.eq(["zlib"], res.compression, tojson(res));
+
+    var padding = new Array(10 * 1024).join("compressible");
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(db.network_compression.insert({_id: i, padding: padding}));
+    }
+    db.network_compression.find().forEach(function(doc) {
+        assert.eq(padding, doc.padding);
+    });
+
+    var stats = db.serverStatus().network.compression;
+    assert(stats.hasOwnProperty("zlib"), tojson(stats));
+    assert(!stats.hasOwnProperty("snappy"), tojson(stats));
+    assert.gt(stats.zlib.compressor.bytesIn, 10 * padding.length, tojson(stats));
+    assert.lt(stats.zlib.compressor.bytesOut, stats.zlib.compressor.bytesIn / 10, tojson(stats));
+    assert.gt(stats.zlib.decompressor.bytesOut, 0, tojson(stats));
+
+    MongoRunner.stopMongod(conn);
+
+    // Compression can be turned off, and unknown compressors are refused at startup.
+    conn = MongoRunner.runMongod({setParameter: "networkMessageCompressors=disabled"});
+    res = assert.commandWorked(
+        conn.getDB("admin").runCommand({isMaster: 1, compression: ["snappy", "zlib"]}));
+    assert(!res.hasOwnProperty("compression"), tojson(res));
+    assert.eq({}, conn.getDB("admin").serverStatus().network.compression);
+    MongoRunner.stopMongod(conn);
+
+    assert.eq(null, MongoRunner.runMongod({setParameter: "networkMessageCompressors=lz4"}));
+}());
@@ -0,0 +1,55 @@
+// Tests that the epoll service executor keeps serving replication traffic while more clients than
+// it has worker threads wait for w:majority. The waiting writes occupy every worker, so the pool
+// has to grow for the secondary's oplog reads and position updates to get through.
+(function() {
+"use strict";
+
+var kWorkers = 2;
+var kWriters = 3 * kWorkers;
+var kDocsPerWriter = 10;
+
+var replTest = new ReplSetTest({
+    name: "service_executor_epoll_majority",
+    nodes: 2,
+    nodeOptions: {serviceExecutor: "epoll", serviceExecutorThreads: kWorkers}
+});
+replTest.startSet();
+replTest.initiate();
+
+var primary = replTest.getPrimary();
+var secondary = replTest.getSecondaries()[0];
+var testDB = primary.getDB("test");
+assert.eq("epoll", testDB.serverStatus().serviceExecutor.mode);
+
+// Hold back replication so that every write waits for write concern until it resumes.
+assert.commandWorked(
+    secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "alwaysOn"}));
+
+// The parallel shells connect to the "test" database on the primary.
+var writers = [];
+for (var i = 0; i < kWriters; i++) {
+    writers.push(startParallelShell(
+        "for (var j = 0; j < " + kDocsPerWriter + "; j++) {" +
+            "    assert.writeOK(db.majority.insert(" +
+            "        {writer: " + i + ", j: j}," +
+            "        {writeConcern: {w: 'majority', wtimeout: 5 * 60 * 1000}}));" +
+            "}",
+        primary.port));
+}
+
+// Every writer is now parked on a worker, more of them than the pool started with.
+assert.soon(function() {
+    var stats = testDB.serverStatus().serviceExecutor;
+    return stats.threads > kWorkers && testDB.majority.count() === kWriters;
+}, "writers never all waited for write concern");
+
+assert.commandWorked(
+    secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "off"}));
+
+writers.forEach(function(join) {
+    join();
+});
+assert.eq(kWriters * kDocsPerWriter, testDB.majority.count());
+
+replTest.stopSet();
+})();
@@ -0,0 +1,63 @@
+// Foreground index builds generate keys on several threads once a collection is large enough.
+// Check that they build the same indexes as a single thread does.
+
+(function() {
+    "use strict";
+
+    var coll = db.index_build_parallel;
+    coll.drop();
+
+    var numDocs = 20000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, a: i % 1000, b: [i % 7, i % 11], c: (i * 7919) % numDocs,
+                     s: "str" + (i % 13)});
+    }
+    assert.writeOK(bulk.execute());
+
+    var original = db.adminCommand({getParameter: 1, maxIndexBuildWorkerThreads: 1});
+    assert.commandWorked(original);
+
+    function buildAndRead(workers) {
+        assert.commandWorked(db.adminCommand({setParameter: 1,
+                                              maxIndexBuildWorkerThreads: workers}));
+        coll.dropIndexes();
+
+        assert.commandWorked(coll.ensureIndex({a: 1, s: -1}));
+        assert.commandWorked(coll.ensureIndex({b: 1}));
+        assert.commandWorked(coll.ensureIndex({c: 1}, {unique: true}));
+        assert.commandWorked(coll.ensureIndex({s: 1}, {partialFilterExpression: {a: {$lt: 10}}}));
+
+        // A unique index over duplicate values fails to build.
+        var res = coll.ensureIndex({a: 1}, {unique: true});
+        assert.commandFailed(res);
+        assert.eq(11000, res.code, tojson(res));
+
+        var valid = coll.validate(true);
+        assert(valid.valid, tojson(valid));
+
+        return {
+            a: coll.find({}, {_id: 1}).hint({a: 1, s: -1}).toArray(),
+            b: coll.find({}, {_id: 1}).hint({b: 1}).toArray(),
+            c: coll.find({}, {_id: 1}).hint({c: 1}).toArray(),
+            s: coll.find({s: {$gt: ""}, a: {$lt: 10}}, {_id: 1}).hint({s: 1}).toArray(),
+        };
+    }
+
+    var serial = buildAndRead(1);
+    assert.eq(numDocs, serial.a.length);
+    assert.eq(numDocs, serial.b.length);
+    assert.eq(numDocs, serial.c.length);
+    assert.eq(200, serial.s.length);
+
+    var parallel = buildAndRead(4);
+    assert.eq(serial.a, parallel.a);
+    assert.eq(serial.b, parallel.b);
+    assert.eq(serial.c, parallel.c);
+    assert.eq(serial.s, parallel.s);
+
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          maxIndexBuildWorkerThreads:
+                                              original.maxIndexBuildWorkerThreads}));
+    coll.drop();
+}());
@@ -0,0 +1,62 @@
+// Background builds of non-unique indexes bulk load a scan of the collection, and apply the
+// writes made during the scan afterwards. Check that the index ends up matching the collection
+// when documents are inserted, updated and removed while it is being built.
+
+(function() {
+    "use strict";
+
+    Random.setRandomSeed();
+
+    var coll = db.indexbg_side_writes;
+    coll.drop();
+
+    var numDocs = 100000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, a: i % 100});
+    }
+    assert.writeOK(bulk.execute());
+
+    var awaitBuild = startParallelShell(
+        "assert.commandWorked(db.indexbg_side_writes.ensureIndex({a: 1}, {background: true}));");
+
+    function buildInProgress() {
+        return db.currentOp().inprog.some(function(op) {
+            return op.msg && op.msg.indexOf("Index Build (background)") === 0;
+        });
+    }
+
+    // Write until the build is done. Each round touches documents both behind and ahead of the
+    // collection scan.
+    assert.soon(function() {
+        return coll.getIndexes().length === 2;
+    });
+    var round = 0;
+    do {
+        var id = Random.randInt(numDocs);
+        assert.writeOK(coll.update({_id: id}, {$set: {a: -round}}));
+        assert.writeOK(coll.update({_id: id + 1}, {$inc: {a: 1000}}));
+        assert.writeOK(coll.remove({_id: id + 2}));
+        assert.writeOK(coll.insert({_id: numDocs + round, a: round % 100}));
+        round++;
+    } while (buildInProgress());
+    awaitBuild();
+    print("made " + round + " rounds of writes during the index build");
+
+    var valid = coll.validate(true);
+    assert(valid.valid, tojson(valid));
+
+    // The keys in the index are exactly those of the documents in the collection. The index
+    // isn't multikey, so the query is covered and reads the keys themselves.
+    function sorted(cursor) {
+        return cursor.toArray().map(function(doc) {
+            return doc.a;
+        }).sort(function(x, y) {
+            return x - y;
+        });
+    }
+    var expected = sorted(coll.find({}, {_id: 0, a: 1}).hint({$natural: 1}));
+    var indexed = sorted(coll.find({a: {$gte: MinKey}}, {_id: 0, a: 1}).hint({a: 1}));
+    assert.eq(expected.length, indexed.length);
+    assert.eq(expected, indexed);
+}());
@@ -0,0 +1,126 @@
+// Tests that a sharded $group gives the same results when its merge is split across the shards by
+// a hash of the group key.
+
+(function() {
+    "use strict";
+
+    var st = new ShardingTest({shards: 3, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB("admin");
+    var db = mongos.getDB("test");
+    var coll = db.partitioned_group;
+
+    assert.commandWorked(admin.runCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+
+    // Spread the documents over all three shards.
+    assert.commandWorked(admin.runCommand({split: coll.getFullName(), middle: {_id: 300}}));
+    assert.commandWorked(admin.runCommand({split: coll.getFullName(), middle: {_id: 600}}));
+    assert.commandWorked(
+        admin.runCommand({moveChunk: coll.getFullName(), find: {_id: 300}, to: "shard0001"}));
+    assert.commandWorked(
+        admin.runCommand({moveChunk: coll.getFullName(), find: {_id: 600}, to: "shard0002"}));
+
+    // Every shard has every group, and the keys are numbers of different types so that equal
+    // keys only end up in the same partition if they hash the same.
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 900; i++) {
+        var key = i % 50;
+        var types = [key, NumberInt(key), NumberLong(key)];
+        bulk.insert({_id: i, key: types[Math.floor(i / 300)], sub: i % 3, value: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Which of the equal keys a group reports depends on the order the shards' results arrive in,
+    // so compare them as plain numbers.
+    function normalize(value) {
+        if (value instanceof NumberInt || value instanceof NumberLong) {
+            return value.toNumber();
+        }
+        if (Array.isArray(value)) {
+            return value.map(normalize);
+        }
+        if (typeof value === "object" && value !== null) {
+            var normalized = {};
+            Object.keys(value).forEach(function(field) {
+                normalized[field] = normalize(value[field]);
+            });
+            return normalized;
+        }
+        return value;
+    }
+
+    function runAggregations() {
+        var sorted = function(results) {
+            return normalize(results).sort(function(a, b) {
+                return bsonWoCompare({_id: a._id}, {_id: b._id});
+            });
+        };
+
+        return {
+            simple: sorted(coll.aggregate([
+                {$group: {_id: "$key", count: {$sum: 1}, total: {$sum: "$value"}}}
+            ]).toArray()),
+            compound: sorted(coll.aggregate([
+                {$group: {_id: {key: "$key", sub: "$sub"}, max: {$max: "$value"}}}
+            ]).toArray()),
+            followedByMatch: sorted(coll.aggregate([
+                {$group: {_id: "$key", count: {$sum: 1}}},
+                {$match: {_id: {$lt: 10}}},
+                {$project: {doubled: {$multiply: ["$count", 2]}}}
+            ]).toArray()),
+            followedBySort: normalize(coll.aggregate([
+                {$group: {_id: "$key", total: {$sum: "$value"}}},
+                {$sort: {total: -1}},
+                {$limit: 5}
+            ]).toArray()),
+        };
+    }
+
+    var expected = runAggregations();
+    assert.eq(50, expected.simple.length, tojson(expected.simple));
+    assert.eq(150, expected.compound.length, tojson(expected.compound));
+    expected.simple.forEach(function(group) {
+        assert.eq(18, group.count, tojson(group));
+    });
+
+    assert.commandWorked(
+        admin.runCommand({setParameter: 1, clusterAggregationPartitionedMerge: true}));
+
+    var partitioned = runAggregations();
+    assert.eq(expected.simple, partitioned.simple);
+    assert.eq(expected.compound, partitioned.compound);
+    assert.eq(expected.followedByMatch, partitioned.followedByMatch);
+    assert.eq(expected.followedBySort, partitioned.followedBySort);
+
+    // A batch size smaller than the result still returns everything through getMore.
+    var cursor = coll.aggregate([{$group: {_id: "$key"}}], {cursor: {batchSize: 3}});
+    assert.eq(50, cursor.itcount());
+
+    // With allowDiskUse the merge runs on a single shard, which may spill to disk.
+    cursor = coll.aggregate([{$group: {_id: "$key", count: {$sum: 1}}}], {allowDiskUse: true});
+    assert.eq(50, cursor.itcount());
+
+    // A shard that cannot buffer its partitioned results makes mongos fall back to merging on a
+    // single shard.
+    [st.shard0, st.shard1, st.shard2].forEach(function(shard) {
+        assert.commandWorked(shard.adminCommand(
+            {setParameter: 1, internalAggregationPartitionedOutputMaxBytes: 100}));
+    });
+    var overLimit = runAggregations();
+    assert.eq(expected.simple, overLimit.simple);
+    assert.eq(expected.compound, overLimit.compound);
+    assert.eq(expected.followedByMatch, overLimit.followedByMatch);
+    assert.eq(expected.followedBySort, overLimit.followedBySort);
+
+    // Only mongos can ask a shard to partition its results.
+    assert.commandFailedWithCode(
+        st.shard0.getDB("test").runCommand(
+            {aggregate: coll.getName(), pipeline: [], partitionOutput: 2, cursor: {}}),
+        28796);
+
+    st.stop();
+}());
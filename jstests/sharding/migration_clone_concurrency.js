@@ -0,0 +1,44 @@
+//
+// Tests that the initial clone of a migration copies every document when the recipient fetches
+// several batches from the donor at once, and that _recvChunkStatus reports its throughput.
+//
+
+var st = new ShardingTest({ shards : 2, mongos : 1 });
+st.stopBalancer();
+
+var mongos = st.s0;
+var shards = mongos.getDB( "config" ).shards.find().toArray();
+var admin = mongos.getDB( "admin" );
+var coll = mongos.getCollection( "foo.bar" );
+
+assert( admin.runCommand({ enableSharding : coll.getDB() + "" }).ok );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert( admin.runCommand({ shardCollection : coll + "", key : { _id : 1 } }).ok );
+
+assert.commandWorked( st.shard1.adminCommand({ setParameter : 1, migrateCloneConcurrency : 4 }) );
+
+// Enough data for several batches of at most 16MB each.
+var padding = new Array( 1024 * 1024 ).join( "x" );
+var bulk = coll.initializeUnorderedBulkOp();
+for ( var i = 0; i < 60; i++ ) {
+    bulk.insert({ _id : i, padding : padding });
+}
+assert.writeOK( bulk.execute() );
+
+jsTest.log( "Moving the chunk to the other shard..." );
+
+assert( admin.runCommand({ moveChunk : coll + "", find : { _id : 0 }, to : shards[1]._id,
+                           _waitForDelete : true }).ok );
+
+assert.eq( 0, st.shard0.getCollection( coll + "" ).count() );
+assert.eq( 60, st.shard1.getCollection( coll + "" ).count() );
+assert.eq( 60, coll.find().itcount() );
+
+var status = st.shard1.adminCommand({ _recvChunkStatus : 1 });
+printjson( status );
+assert.commandWorked( status );
+assert.eq( 60, status.counts.cloned );
+assert.gt( status.clone.bytesPerSec, 0 );
+assert.eq( 0, status.clone.queueDepth );
+
+st.stop();
@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include <climits>
 #include <cmath>
 
 #include "mongo/platform/decimal128.h"
@@ -538,4 +538,21 @@ TEST(Looping, Cpp11Auto) {
     ASSERT_EQUALS(count, 1 + 2 + 3);
 }
 
+TEST(BSONObj, ShareOwnershipWith) {
+    BSONObj obj;
+    {
+        BSONObj parent = BSON("a" << BSON("b" << 1));
+        ASSERT_TRUE(parent.isOwned());
+
+        obj = parent["a"].Obj();
+        ASSERT_FALSE(obj.isOwned());
+        obj.shareOwnershipWith(parent);
+        ASSERT_TRUE(obj.isOwned());
+        ASSERT_EQUALS(parent["a"].Obj().objdata(), obj.objdata());
+    }
+
+    // The subobject is still valid after the parent went away.
+    ASSERT_EQUALS(BSON("b" << 1), obj);
+}
+
 }  // unnamed namespace
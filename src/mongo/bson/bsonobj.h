@@ -184,6 +184,16 @@ public:
     /** @return a new full (and owned) copy of the object. */
     BSONObj copy() const;
 
+    /**
+     * Makes this object share ownership of the buffer backing 'other', which must contain this
+     * object's data (for example, a subobject of 'other'). This keeps the data alive as long as
+     * this object without copying it. If 'other' is not owned, this object is not owned either.
+     */
+    BSONObj& shareOwnershipWith(const BSONObj& other) {
+        _ownedBuffer = other._ownedBuffer;
+        return *this;
+    }
+
     /** Readable representation of a BSON object in an extended JSON-style notation.
         This is an abbreviated representation which might be used for logging.
     */
@@ -62,6 +62,7 @@
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/message_compressor_manager.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/password_digest.h"
@@ -851,22 +852,34 @@ private:
 };
 
 /**
-* Initializes the wire version of conn, and returns the isMaster reply.
+* Initializes the wire version of conn, and returns the isMaster reply. Negotiates message
+* compression through compressorManager if it is given.
 */
-StatusWith<executor::RemoteCommandResponse> initWireVersion(DBClientBase* conn) {
+StatusWith<executor::RemoteCommandResponse> initWireVersion(
+    DBClientBase* conn, MessageCompressorManager* compressorManager) {
     try {
         // We need to force the usage of OP_QUERY on this command, even if we have previously
         // detected support for OP_COMMAND on a connection. This is necessary to handle the case
         // where we reconnect to an older version of MongoDB running at the same host/port.
         ScopedForceOpQuery forceOpQuery{conn};
 
+        BSONObjBuilder isMasterCmd;
+        isMasterCmd.append("isMaster", 1);
+        if (compressorManager) {
+            compressorManager->clientBegin(&isMasterCmd);
+        }
+
         Date_t start{Date_t::now()};
         auto result = conn->runCommandWithMetadata(
-            "admin", "isMaster", rpc::makeEmptyMetadata(), BSON("isMaster" << 1));
+            "admin", "isMaster", rpc::makeEmptyMetadata(), isMasterCmd.done());
         Date_t finish{Date_t::now()};
 
         BSONObj isMasterObj = result->getCommandReply().getOwned();
 
+        if (compressorManager) {
+            compressorManager->clientFinish(isMasterObj);
+        }
+
         if (isMasterObj.hasField("minWireVersion") && isMasterObj.hasField("maxWireVersion")) {
             int minWireVersion = isMasterObj["minWireVersion"].numberInt();
             int maxWireVersion = isMasterObj["maxWireVersion"].numberInt();
@@ -899,7 +912,7 @@ Status DBClientConnection::connect(const HostAndPort& serverAddress,
         return connectStatus;
     }
 
-    auto swIsMasterReply = initWireVersion(this);
+    auto swIsMasterReply = initWireVersion(this, &port().compressorManager());
     if (!swIsMasterReply.isOK()) {
         _failed = true;
         return swIsMasterReply.getStatus();
@@ -130,7 +130,14 @@ Status parseCursorResponse(const BSONObj& obj,
                                         << "'" << kCursorFieldName << "." << batchFieldName
                                         << "' field: " << obj);
         }
-        batchData->documents.push_back(itemElement.Obj().getOwned());
+        // The documents keep the reply alive instead of copying themselves out of it.
+        BSONObj document = itemElement.Obj();
+        if (obj.isOwned()) {
+            document.shareOwnershipWith(obj);
+        } else {
+            document = document.getOwned();
+        }
+        batchData->documents.push_back(std::move(document));
     }
 
     return Status::OK();
@@ -198,6 +205,14 @@ Status Fetcher::schedule() {
     return _schedule_inlock(_cmdObj, kFirstBatchFieldName);
 }
 
+Status Fetcher::scheduleGetMore(const BSONObj& getMoreCmdObj) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_active) {
+        return Status(ErrorCodes::IllegalOperation, "fetcher already scheduled");
+    }
+    return _schedule_inlock(getMoreCmdObj.getOwned(), kNextBatchFieldName);
+}
+
 void Fetcher::cancel() {
     executor::TaskExecutor::CallbackHandle remoteCommandCallbackHandle;
     {
@@ -285,6 +300,12 @@ void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batch
     BSONObjBuilder bob;
     _work(StatusWith<QueryResponse>(batchData), &nextAction, &bob);
 
+    // Callback function _work may take over the cursor and read the rest of the results later.
+    if (nextAction == NextAction::kExitAndKeepCursorAlive) {
+        _finishCallback();
+        return;
+    }
+
     // Callback function _work may modify nextAction to request the fetcher
     // not to schedule a getMore command.
     if (nextAction != NextAction::kGetMore) {
@@ -74,8 +74,17 @@ public:
 
     /**
      * Represents next steps of fetcher.
+     *
+     * kExitAndKeepCursorAlive stops the fetcher without killing the remote cursor. The client
+     * becomes responsible for the cursor and may continue reading from it later with
+     * scheduleGetMore().
      */
-    enum class NextAction : int { kInvalid = 0, kNoAction = 1, kGetMore = 2 };
+    enum class NextAction : int {
+        kInvalid = 0,
+        kNoAction = 1,
+        kGetMore = 2,
+        kExitAndKeepCursorAlive = 3
+    };
 
     /**
      * Type of a fetcher callback function.
@@ -140,6 +149,17 @@ public:
      */
     Status schedule();
 
+    /**
+     * Schedules 'getMoreCmdObj' to be run on the remote server to continue reading from a cursor
+     * that a previous callback left alive with NextAction::kExitAndKeepCursorAlive.
+     * Results are delivered to the callback function in the same way as for schedule().
+     *
+     * Returns IllegalOperation while the fetcher is active. The fetcher stays active until the
+     * callback that left the cursor alive has returned, so callers on other threads should wait()
+     * first.
+     */
+    Status scheduleGetMore(const BSONObj& getMoreCmdObj);
+
     /**
      * Cancels remote command request.
      * Returns immediately if fetcher is not active.
@@ -640,6 +640,60 @@ TEST_F(FetcherTest, UpdateNextActionAfterSecondBatch) {
     ASSERT_FALSE(fetcher->isActive());
 }
 
+void setNextActionToExitAndKeepCursorAlive(const StatusWith<Fetcher::QueryResponse>& fetchResult,
+                                           Fetcher::NextAction* nextAction,
+                                           BSONObjBuilder* getMoreBob) {
+    *nextAction = Fetcher::NextAction::kExitAndKeepCursorAlive;
+}
+
+TEST_F(FetcherTest, ExitAndKeepCursorAliveThenScheduleGetMore) {
+    callbackHook = setNextActionToExitAndKeepCursorAlive;
+
+    ASSERT_OK(fetcher->schedule());
+    const BSONObj doc = BSON("_id" << 1);
+    scheduleNetworkResponse(
+        BSON("cursor" << BSON("id" << 1LL << "ns"
+                                   << "db.coll"
+                                   << "firstBatch" << BSON_ARRAY(doc)) << "ok" << 1));
+    getNet()->runReadyNetworkOperations();
+    ASSERT_OK(status);
+    ASSERT_EQUALS(1LL, cursorId);
+    ASSERT_EQUALS(1U, documents.size());
+    ASSERT_EQUALS(doc, documents.front());
+    ASSERT_TRUE(Fetcher::NextAction::kExitAndKeepCursorAlive == nextAction);
+
+    // The cursor is left to the client: neither killCursors nor getMore is sent.
+    ASSERT_FALSE(fetcher->isActive());
+    ASSERT_FALSE(getNet()->hasReadyRequests());
+
+    callbackHook = Fetcher::CallbackFn();
+    const BSONObj getMoreCmdObj = BSON("getMore" << 1LL << "collection"
+                                                 << "coll");
+    ASSERT_OK(fetcher->scheduleGetMore(getMoreCmdObj));
+    ASSERT_TRUE(fetcher->isActive());
+    ASSERT_NOT_OK(fetcher->scheduleGetMore(getMoreCmdObj));
+
+    NetworkInterfaceMock* net = getNet();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto noi = net->getNextReadyRequest();
+    ASSERT_EQUALS(getMoreCmdObj, noi->getRequest().cmdObj);
+    const BSONObj doc2 = BSON("_id" << 2);
+    executor::RemoteCommandResponse response(
+        BSON("cursor" << BSON("id" << 0LL << "ns"
+                                   << "db.coll"
+                                   << "nextBatch" << BSON_ARRAY(doc2)) << "ok" << 1),
+        BSONObj(),
+        Milliseconds(0));
+    net->scheduleResponse(noi, net->now(), TaskExecutor::ResponseStatus(response));
+    finishProcessingNetworkResponse();
+    ASSERT_OK(status);
+    ASSERT_EQUALS(0, cursorId);
+    ASSERT_EQUALS(1U, documents.size());
+    ASSERT_EQUALS(doc2, documents.front());
+    ASSERT_FALSE(first);
+    ASSERT_TRUE(Fetcher::NextAction::kNoAction == nextAction);
+}
+
 /**
  * This will be invoked twice before the fetcher returns control to the replication executor.
  */
@@ -211,6 +211,14 @@ vector<std::unique_ptr<RecordCursor>> Collection::getManyCursors(OperationContex
     return _recordStore->getManyCursors(txn);
 }
 
+std::unique_ptr<RecordCursor> Collection::getCursorForFields(
+    OperationContext* txn, const std::vector<std::string>& fields) const {
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IS));
+    invariant(ok());
+
+    return _recordStore->getCursorForFields(txn, fields);
+}
+
 Snapshotted<BSONObj> Collection::docFor(OperationContext* txn, const RecordId& loc) const {
     return Snapshotted<BSONObj>(txn->recoveryUnit()->getSnapshotId(),
                                 _recordStore->dataFor(txn, loc).releaseToBson());
@@ -305,6 +313,66 @@ StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
     return StatusWith<RecordId>(loc);
 }
 
+Status Collection::insertDocumentsForOplog(OperationContext* txn, std::vector<Record>* records) {
+    invariant(!_validator || documentValidationDisabled(txn));
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+    invariant(!_indexCatalog.haveAnyIndexes());
+
+    if (_mustTakeCappedLockOnInsert)
+        synchronizeOnCappedInFlightResource(txn->lockState());
+
+    Status status = _recordStore->insertRecords(txn, records, false);
+    if (!status.isOK())
+        return status;
+
+    if (_cappedNotifier && !_cappedNotifier.unique()) {
+        _cappedNotifier->notifyOfInsert();
+    }
+
+    return Status::OK();
+}
+
+Status Collection::insertDocuments(OperationContext* txn,
+                                   std::vector<BSONObj>::const_iterator begin,
+                                   std::vector<BSONObj>::const_iterator end,
+                                   bool enforceQuota,
+                                   bool fromMigrate) {
+    const bool hasIdIndex = _indexCatalog.findIdIndex(txn);
+
+    for (auto it = begin; it != end; it++) {
+        if (hasIdIndex && (*it)["_id"].eoo()) {
+            return Status(ErrorCodes::InternalError,
+                          str::stream() << "Collection::insertDocuments got "
+                                           "document without _id for ns:" << _ns.ns());
+        }
+
+        auto status = checkValidation(txn, *it);
+        if (!status.isOK())
+            return status;
+    }
+
+    const SnapshotId sid = txn->recoveryUnit()->getSnapshotId();
+
+    if (_mustTakeCappedLockOnInsert)
+        synchronizeOnCappedInFlightResource(txn->lockState());
+
+    Status status = _insertDocuments(txn, begin, end, enforceQuota);
+    if (!status.isOK())
+        return status;
+    invariant(sid == txn->recoveryUnit()->getSnapshotId());
+
+    getGlobalServiceContext()->getOpObserver()->onInserts(txn, ns(), begin, end, fromMigrate);
+
+    // If there is a notifier object and another thread is waiting on it, then we notify waiters
+    // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
+    // waiters if this Collection's shared_ptr is not unique.
+    if (_cappedNotifier && !_cappedNotifier.unique()) {
+        _cappedNotifier->notifyOfInsert();
+    }
+
+    return Status::OK();
+}
+
 StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
                                                 const BSONObj& docToInsert,
                                                 bool enforceQuota,
@@ -406,6 +474,45 @@ StatusWith<RecordId> Collection::_insertDocument(OperationContext* txn,
     return loc;
 }
 
+Status Collection::_insertDocuments(OperationContext* txn,
+                                    std::vector<BSONObj>::const_iterator begin,
+                                    std::vector<BSONObj>::const_iterator end,
+                                    bool enforceQuota) {
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+
+    if (isCapped()) {
+        // A capped insert may delete earlier documents, including ones from this group, and
+        // those have to be indexed before they can be unindexed.
+        for (auto it = begin; it != end; it++) {
+            StatusWith<RecordId> loc = _insertDocument(txn, *it, enforceQuota);
+            if (!loc.isOK())
+                return loc.getStatus();
+        }
+        return Status::OK();
+    }
+
+    std::vector<Record> records;
+    records.reserve(std::distance(begin, end));
+    for (auto it = begin; it != end; it++) {
+        records.push_back(Record{RecordId(), RecordData(it->objdata(), it->objsize())});
+    }
+
+    Status status = _recordStore->insertRecords(txn, &records, _enforceQuota(enforceQuota));
+    if (!status.isOK())
+        return status;
+
+    std::vector<BsonRecord> bsonRecords;
+    bsonRecords.reserve(records.size());
+    auto it = begin;
+    for (const auto& record : records) {
+        invariant(RecordId::min() < record.id);
+        invariant(record.id < RecordId::max());
+        bsonRecords.push_back(BsonRecord{record.id, &(*it++)});
+    }
+
+    return _indexCatalog.indexRecords(txn, bsonRecords);
+}
+
 Status Collection::aboutToDeleteCapped(OperationContext* txn,
                                        const RecordId& loc,
                                        RecordData data) {
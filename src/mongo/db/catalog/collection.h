@@ -211,6 +211,14 @@ public:
      */
     std::vector<std::unique_ptr<RecordCursor>> getManyCursors(OperationContext* txn) const;
 
+    /**
+     * Returns a forward cursor which only returns the top-level 'fields' of each document, or
+     * {} if the record store can't scan fields separately. See
+     * RecordStore::getCursorForFields().
+     */
+    std::unique_ptr<RecordCursor> getCursorForFields(OperationContext* txn,
+                                                     const std::vector<std::string>& fields) const;
+
     void deleteDocument(OperationContext* txn,
                         const RecordId& loc,
                         bool cappedOK = false,
@@ -228,6 +236,21 @@ public:
                                         bool enforceQuota,
                                         bool fromMigrate = false);
 
+    /**
+     * Inserts the documents in [begin, end) as one group: the records are written together,
+     * each index receives all of its keys in turn and the OpObserver is told about the group at
+     * once, so a replicated collection writes the group's oplog entries in one batch.
+     *
+     * Nothing is undone on failure; callers run this inside a WriteUnitOfWork and abandon it
+     * if the group fails, retrying the documents individually if they need to know which one
+     * was at fault.
+     */
+    Status insertDocuments(OperationContext* txn,
+                           std::vector<BSONObj>::const_iterator begin,
+                           std::vector<BSONObj>::const_iterator end,
+                           bool enforceQuota,
+                           bool fromMigrate = false);
+
     /**
      * Callers must ensure no document validation is performed for this collection when calling
      * this method.
@@ -236,6 +259,13 @@ public:
                                         const DocWriter* doc,
                                         bool enforceQuota);
 
+    /**
+     * Writes a group of already built oplog entries. Like the DocWriter overload above, this
+     * neither validates nor notifies the OpObserver. The RecordIds assigned are stored back into
+     * 'records'.
+     */
+    Status insertDocumentsForOplog(OperationContext* txn, std::vector<Record>* records);
+
     StatusWith<RecordId> insertDocument(OperationContext* txn,
                                         const BSONObj& doc,
                                         MultiIndexBlock* indexBlock,
@@ -394,6 +424,11 @@ private:
                                          const BSONObj& doc,
                                          bool enforceQuota);
 
+    Status _insertDocuments(OperationContext* txn,
+                            std::vector<BSONObj>::const_iterator begin,
+                            std::vector<BSONObj>::const_iterator end,
+                            bool enforceQuota);
+
     bool _enforceQuota(bool userEnforeQuota) const;
 
     int _magic;
@@ -1138,6 +1138,28 @@ Status IndexCatalog::_indexRecord(OperationContext* txn,
     return index->accessMethod()->insert(txn, obj, loc, options, &inserted);
 }
 
+Status IndexCatalog::_indexRecords(OperationContext* txn,
+                                   IndexCatalogEntry* index,
+                                   const std::vector<BsonRecord>& bsonRecords) {
+    const MatchExpression* filter = index->getFilterExpression();
+
+    InsertDeleteOptions options;
+    options.logIfError = false;
+    options.dupsAllowed = isDupsAllowed(index->descriptor());
+
+    std::vector<std::pair<const BSONObj*, RecordId>> docs;
+    docs.reserve(bsonRecords.size());
+    for (const auto& bsonRecord : bsonRecords) {
+        if (filter && !filter->matchesBSON(*bsonRecord.docPtr)) {
+            continue;
+        }
+        docs.push_back(std::make_pair(bsonRecord.docPtr, bsonRecord.id));
+    }
+
+    int64_t inserted;
+    return index->accessMethod()->insertMany(txn, docs, options, &inserted);
+}
+
 Status IndexCatalog::_unindexRecord(OperationContext* txn,
                                     IndexCatalogEntry* index,
                                     const BSONObj& obj,
@@ -1175,6 +1197,18 @@ Status IndexCatalog::indexRecord(OperationContext* txn, const BSONObj& obj, cons
     return Status::OK();
 }
 
+Status IndexCatalog::indexRecords(OperationContext* txn,
+                                  const std::vector<BsonRecord>& bsonRecords) {
+    for (IndexCatalogEntryContainer::const_iterator i = _entries.begin(); i != _entries.end();
+         ++i) {
+        Status s = _indexRecords(txn, *i, bsonRecords);
+        if (!s.isOK())
+            return s;
+    }
+
+    return Status::OK();
+}
+
 void IndexCatalog::unindexRecord(OperationContext* txn,
                                  const BSONObj& obj,
                                  const RecordId& loc,
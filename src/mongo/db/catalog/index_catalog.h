@@ -46,6 +46,14 @@ class Collection;
 class IndexDescriptor;
 class IndexAccessMethod;
 
+/**
+ * A document that has already been written to the record store, along with its RecordId.
+ */
+struct BsonRecord {
+    RecordId id;
+    const BSONObj* docPtr;
+};
+
 /**
  * how many: 1 per Collection
  * lifecycle: attached to a Collection
@@ -265,6 +273,13 @@ public:
     // this throws for now
     Status indexRecord(OperationContext* txn, const BSONObj& obj, const RecordId& loc);
 
+    /**
+     * Indexes a group of records, one index at a time. Each index gets the keys of the whole
+     * group in one IndexAccessMethod::insertMany() call, which inserts them in key order. Stops
+     * at the first error.
+     */
+    Status indexRecords(OperationContext* txn, const std::vector<BsonRecord>& bsonRecords);
+
     void unindexRecord(OperationContext* txn, const BSONObj& obj, const RecordId& loc, bool noWarn);
 
     // ------- temp internal -------
@@ -299,6 +314,10 @@ private:
                         const BSONObj& obj,
                         const RecordId& loc);
 
+    Status _indexRecords(OperationContext* txn,
+                         IndexCatalogEntry* index,
+                         const std::vector<BsonRecord>& bsonRecords);
+
     Status _unindexRecord(OperationContext* txn,
                           IndexCatalogEntry* index,
                           const BSONObj& obj,
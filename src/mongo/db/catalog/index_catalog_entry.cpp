@@ -38,6 +38,7 @@
 #include "mongo/db/catalog/head_manager.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_parser.h"
@@ -91,6 +92,11 @@ IndexCatalogEntry::~IndexCatalogEntry() {
     delete _descriptor;
 }
 
+void IndexCatalogEntry::setIndexBuildInterceptor(
+    std::unique_ptr<IndexBuildInterceptor> interceptor) {
+    _indexBuildInterceptor = std::move(interceptor);
+}
+
 void IndexCatalogEntry::init(OperationContext* txn, IndexAccessMethod* accessMethod) {
     verify(_accessMethod == NULL);
     _accessMethod = accessMethod;
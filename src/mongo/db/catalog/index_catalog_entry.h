@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -43,6 +44,7 @@ class CollectionCatalogEntry;
 class CollectionInfoCache;
 class HeadManager;
 class IndexAccessMethod;
+class IndexBuildInterceptor;
 class IndexDescriptor;
 class MatchExpression;
 class OperationContext;
@@ -119,6 +121,16 @@ public:
         _minVisibleSnapshot = name;
     }
 
+    /**
+     * While a hybrid background build bulk loads this index, writes to it go to the interceptor
+     * instead. NULL otherwise. Only changed with an exclusive lock on the collection.
+     */
+    IndexBuildInterceptor* indexBuildInterceptor() const {
+        return _indexBuildInterceptor.get();
+    }
+
+    void setIndexBuildInterceptor(std::unique_ptr<IndexBuildInterceptor> interceptor);
+
 private:
     class SetMultikeyChange;
     class SetHeadChange;
@@ -152,6 +164,8 @@ private:
 
     // The earliest snapshot that is allowed to read this index.
     boost::optional<SnapshotName> _minVisibleSnapshot;
+
+    std::unique_ptr<IndexBuildInterceptor> _indexBuildInterceptor;
 };
 
 class IndexCatalogEntryContainer {
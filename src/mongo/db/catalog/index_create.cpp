@@ -34,6 +34,8 @@
 
 #include "mongo/db/catalog/index_create.h"
 
+#include <algorithm>
+#include <deque>
 
 #include "mongo/base/error_codes.h"
 #include "mongo/client/dbclientinterface.h"
@@ -44,10 +46,15 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
@@ -58,6 +65,21 @@ using std::unique_ptr;
 using std::string;
 using std::endl;
 
+namespace {
+
+// The most threads that generate and sort keys for a foreground index build. 1 builds on the
+// thread running the collection scan, as before.
+MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildWorkerThreads, int, 4);
+
+// Smaller collections aren't worth starting threads for.
+const long long kMinRecordsForParallelBuild = 10000;
+
+// Whether background builds of non-unique indexes bulk load them from the collection scan and
+// apply the writes made meanwhile afterwards, rather than inserting keys one at a time.
+MONGO_EXPORT_SERVER_PARAMETER(hybridBackgroundIndexBuilds, bool, true);
+
+}  // namespace
+
 /**
  * On rollback sets MultiIndexBlock::_needToCleanup to true.
  */
@@ -92,10 +114,178 @@ private:
     MultiIndexBlock* const _indexer;
 };
 
+/**
+ * Generates and sorts the keys of a foreground index build on a pool of worker threads, while
+ * the thread running the collection scan only reads documents. Documents are handed to the
+ * workers in batches, and each worker inserts their keys into its own BulkBuilder for every
+ * index. finish() merges the workers' builders into the MultiIndexBlock's, so that commitBulk
+ * does a k-way merge of their sorted runs.
+ *
+ * Bulk builders only generate and sort keys, without touching the storage engine, which is
+ * what makes it safe for the workers to run without an OperationContext.
+ */
+class MultiIndexBlock::ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    ParallelKeyGenerator(MultiIndexBlock* indexer, size_t numWorkers)
+        : _indexer(indexer), _builders(numWorkers) {
+        const size_t maxMemoryUsageBytes =
+            IndexAccessMethod::BulkBuilder::kMaxMemoryUsageBytes / numWorkers;
+        for (auto& builders : _builders) {
+            for (const IndexToBuild& index : _indexer->_indexes) {
+                builders.push_back(index.real->initiateBulk(maxMemoryUsageBytes));
+            }
+        }
+
+        for (size_t worker = 0; worker < numWorkers; worker++) {
+            _threads.emplace_back([this, worker] { _work(worker); });
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        _stop();
+    }
+
+    /**
+     * Queues 'doc' to have its keys generated. Returns the first error any worker has hit, in
+     * which case the index build should fail.
+     */
+    Status add(const BSONObj& doc, const RecordId& loc) {
+        _batch.emplace_back(doc.getOwned(), loc);
+        if (_batch.size() < kBatchSize) {
+            return Status::OK();
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _spaceAvailable.wait(
+            lk, [this] { return _queue.size() < _threads.size() * 2 || !_status.isOK(); });
+        if (!_status.isOK()) {
+            return _status;
+        }
+        _queue.push_back(std::move(_batch));
+        _batch.clear();
+        _workAvailable.notify_one();
+        return Status::OK();
+    }
+
+    /**
+     * Waits for the workers to finish with every document added, then hands their keys to the
+     * MultiIndexBlock's bulk builders.
+     */
+    Status finish() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_batch.empty()) {
+                _queue.push_back(std::move(_batch));
+                _batch.clear();
+            }
+        }
+        _stop();
+
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        for (auto& builders : _builders) {
+            for (size_t i = 0; i < builders.size(); i++) {
+                _indexer->_indexes[i].bulk->merge(std::move(builders[i]));
+            }
+        }
+        return Status::OK();
+    }
+
+private:
+    typedef std::vector<std::pair<BSONObj, RecordId>> Batch;
+
+    static const size_t kBatchSize = 256;
+
+    void _work(size_t worker) {
+        while (true) {
+            Batch batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _workAvailable.wait(lk, [this] { return !_queue.empty() || _done; });
+                if (_queue.empty()) {
+                    return;
+                }
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+                _spaceAvailable.notify_one();
+                if (!_status.isOK()) {
+                    continue;
+                }
+            }
+
+            Status status = _insertKeys(worker, batch);
+            if (!status.isOK()) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_status.isOK()) {
+                    _status = status;
+                }
+                _spaceAvailable.notify_all();
+            }
+        }
+    }
+
+    Status _insertKeys(size_t worker, const Batch& batch) {
+        try {
+            const std::vector<IndexToBuild>& indexes = _indexer->_indexes;
+            for (const auto& doc : batch) {
+                for (size_t i = 0; i < indexes.size(); i++) {
+                    if (indexes[i].filterExpression &&
+                        !indexes[i].filterExpression->matchesBSON(doc.first)) {
+                        continue;
+                    }
+
+                    Status status = _builders[worker][i]->insert(
+                        NULL, doc.first, doc.second, indexes[i].options, NULL);
+                    if (!status.isOK()) {
+                        return status;
+                    }
+                }
+            }
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+        return Status::OK();
+    }
+
+    void _stop() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _done = true;
+            _workAvailable.notify_all();
+        }
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+        _threads.clear();
+    }
+
+    MultiIndexBlock* const _indexer;
+
+    // The bulk builders for each index, per worker. Only used by their worker until finish().
+    std::vector<std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>>> _builders;
+    std::vector<stdx::thread> _threads;
+
+    // Documents read since the last batch was queued. Only used by the scanning thread.
+    Batch _batch;
+
+    // Protects the members below.
+    stdx::mutex _mutex;
+    stdx::condition_variable _workAvailable;
+    stdx::condition_variable _spaceAvailable;
+    std::deque<Batch> _queue;
+    bool _done = false;
+    Status _status = Status::OK();
+};
+
 MultiIndexBlock::MultiIndexBlock(OperationContext* txn, Collection* collection)
     : _collection(collection),
       _txn(txn),
       _buildInBackground(false),
+      _buildUsingSideWrites(false),
       _allowInterruption(false),
       _ignoreUnique(false),
       _needToCleanup(true) {}
@@ -164,6 +354,15 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
         _buildInBackground = (_buildInBackground && info["background"].trueValue());
     }
 
+    // Unique indexes can't be bulk loaded in the background, since a collection scan which
+    // yields may see the same key in two documents which never had it at the same time.
+    _buildUsingSideWrites = _buildInBackground && hybridBackgroundIndexBuilds;
+    for (size_t i = 0; i < indexSpecs.size(); i++) {
+        if (indexSpecs[i]["unique"].trueValue()) {
+            _buildUsingSideWrites = false;
+        }
+    }
+
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
         StatusWith<BSONObj> statusWithInfo =
@@ -188,6 +387,11 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
             // Bulk build process requires foreground building as it assumes nothing is changing
             // under it.
             index.bulk = index.real->initiateBulk();
+        } else if (_buildUsingSideWrites) {
+            // Or for concurrent writes to be kept out of the index until it is loaded.
+            index.bulk = index.real->initiateBulk();
+            index.block->getEntry()->setIndexBuildInterceptor(
+                stdx::make_unique<IndexBuildInterceptor>());
         }
 
         const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
@@ -197,7 +401,9 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
             repl::getGlobalReplicationCoordinator()->shouldIgnoreUniqueIndex(descriptor);
 
         log() << "build index on: " << ns << " properties: " << descriptor->toString();
-        if (index.bulk)
+        if (_buildUsingSideWrites)
+            log() << "\t building index using bulk method, recording concurrent writes";
+        else if (index.bulk)
             log() << "\t building index using bulk method";
 
         index.filterExpression = index.block->getEntry()->getFilterExpression();
@@ -239,6 +445,17 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
         exec->setYieldPolicy(PlanExecutor::WRITE_CONFLICT_RETRY_ONLY);
     }
 
+    // Bulk builds only need the collection scan on this thread, and can generate keys on
+    // others.
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    const size_t numWorkers = std::min(std::max(maxIndexBuildWorkerThreads, 1),
+                                       static_cast<int>(stdx::thread::hardware_concurrency()));
+    if ((!_buildInBackground || _buildUsingSideWrites) && numWorkers > 1 &&
+        numRecords >= kMinRecordsForParallelBuild) {
+        keyGenerator.reset(new ParallelKeyGenerator(this, numWorkers));
+        LOG(1) << "\t generating index keys on " << numWorkers << " threads";
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -260,17 +477,23 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
             // Done before insert so we can retry document if it WCEs.
             progress->setTotalWhileRunning(_collection->numRecords(_txn));
 
-            WriteUnitOfWork wunit(_txn);
-            Status ret = insert(objToIndex.value(), loc);
-            if (ret.isOK()) {
-                wunit.commit();
-            } else if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
-                // If dupsOut is non-null, we should only fail the specific insert that
-                // led to a DuplicateKey rather than the whole index build.
-                dupsOut->insert(loc);
+            if (keyGenerator) {
+                Status ret = keyGenerator->add(objToIndex.value(), loc);
+                if (!ret.isOK())
+                    return ret;
             } else {
-                // Fail the index build hard.
-                return ret;
+                WriteUnitOfWork wunit(_txn);
+                Status ret = insert(objToIndex.value(), loc);
+                if (ret.isOK()) {
+                    wunit.commit();
+                } else if (dupsOut && ret.code() == ErrorCodes::DuplicateKey) {
+                    // If dupsOut is non-null, we should only fail the specific insert that
+                    // led to a DuplicateKey rather than the whole index build.
+                    dupsOut->insert(loc);
+                } else {
+                    // Fail the index build hard.
+                    return ret;
+                }
             }
 
             // Go to the next document
@@ -300,12 +523,31 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
         uasserted(28550, "Unable to complete index build as the collection is no longer readable");
     }
 
+    if (keyGenerator) {
+        Status ret = keyGenerator->finish();
+        if (!ret.isOK())
+            return ret;
+    }
+
     progress->finished();
 
     Status ret = doneInserting(dupsOut);
     if (!ret.isOK())
         return ret;
 
+    if (_buildUsingSideWrites) {
+        // Catch up on the writes made during the scan now, so that few are left to apply under
+        // the exclusive lock in drainBackgroundWrites().
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            IndexBuildInterceptor* interceptor =
+                _indexes[i].block->getEntry()->indexBuildInterceptor();
+            ret = interceptor->drainWritesIntoIndex(
+                _txn, _indexes[i].real, _indexes[i].options, _allowInterruption);
+            if (!ret.isOK())
+                return ret;
+        }
+    }
+
     log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs"
           << endl;
 
@@ -351,6 +593,33 @@ Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
     return Status::OK();
 }
 
+Status MultiIndexBlock::drainBackgroundWrites() {
+    if (!_buildUsingSideWrites)
+        return Status::OK();
+
+    invariant(_txn->lockState()->isDbLockedForMode(_collection->ns().db(), MODE_X));
+
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        IndexCatalogEntry* entry = _indexes[i].block->getEntry();
+        IndexBuildInterceptor* interceptor = entry->indexBuildInterceptor();
+        if (!interceptor)
+            continue;  // Already drained.
+
+        Status status = interceptor->drainWritesIntoIndex(
+            _txn, _indexes[i].real, _indexes[i].options, /*mayInterrupt*/ false);
+        if (!status.isOK())
+            return status;
+
+        // Nothing else can write to the collection while we hold the exclusive lock.
+        invariant(interceptor->numPending() == 0);
+        LOG(1) << "\t applied " << interceptor->numApplied()
+               << " writes made during the build of index: " << entry->descriptor()->indexName();
+        entry->setIndexBuildInterceptor(nullptr);
+    }
+
+    return Status::OK();
+}
+
 void MultiIndexBlock::abortWithoutCleanup() {
     _indexes.clear();
     _needToCleanup = false;
@@ -358,6 +627,8 @@ void MultiIndexBlock::abortWithoutCleanup() {
 
 void MultiIndexBlock::commit() {
     for (size_t i = 0; i < _indexes.size(); i++) {
+        // drainBackgroundWrites() must have been called.
+        invariant(!_indexes[i].block->getEntry()->indexBuildInterceptor());
         _indexes[i].block->success();
     }
 
@@ -156,6 +156,17 @@ public:
      */
     Status doneInserting(std::set<RecordId>* dupsOut = NULL);
 
+    /**
+     * Applies the writes made to the collection while a hybrid background build was bulk
+     * loading the indexes, and has later writes go to the indexes directly again. Does nothing
+     * for other builds. Call this after insertAllDocumentsInCollection() and before commit().
+     *
+     * Should not be called inside of a WriteUnitOfWork.
+     *
+     * Requires holding an exclusive database lock.
+     */
+    Status drainBackgroundWrites();
+
     /**
      * Marks the index ready for use. Should only be called as the last method after
      * doneInserting() or insertAllDocumentsInCollection() return success.
@@ -187,9 +198,19 @@ public:
         return _buildInBackground;
     }
 
+    /**
+     * True if this background build bulk loads the indexes from a collection scan while
+     * recording concurrent writes to apply afterwards, rather than inserting each key into the
+     * live indexes as it scans. Only known after init().
+     */
+    bool getBuildUsingSideWrites() const {
+        return _buildUsingSideWrites;
+    }
+
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelKeyGenerator;
 
     struct IndexToBuild {
 #if defined(_MSC_VER) && _MSC_VER < 1900  // MVSC++ <= 2013 can't generate default move operations
@@ -229,6 +250,7 @@ private:
     OperationContext* _txn;
 
     bool _buildInBackground;
+    bool _buildUsingSideWrites;
     bool _allowInterruption;
     bool _ignoreUnique;
 
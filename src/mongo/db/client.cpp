@@ -89,6 +89,22 @@ void Client::initThread(const char* desc, ServiceContext* service, AbstractMessa
     *currentClient.get() = service->makeClient(fullDesc, mp);
 }
 
+ServiceContext::UniqueClient Client::releaseCurrent() {
+    invariant(haveClient());
+    return std::move(*currentClient.getMake());
+}
+
+void Client::setCurrent(ServiceContext::UniqueClient client) {
+    invariant(client);
+    invariant(!haveClient());
+    setThreadName(client->desc().c_str());
+    {
+        stdx::lock_guard<Client> lk(*client);
+        client->_threadId = stdx::this_thread::get_id();
+    }
+    *currentClient.getMake() = std::move(client);
+}
+
 namespace {
 int64_t generateSeed(const std::string& desc) {
     size_t seed = 0;
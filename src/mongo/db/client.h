@@ -75,6 +75,19 @@ public:
      */
     static void initThreadIfNotAlready();
 
+    /**
+     * Detaches the Client from the current thread and returns it, leaving the thread without a
+     * Client. Together with setCurrent(), this lets a connection's Client move between the
+     * worker threads of a service executor from one request to the next.
+     */
+    static ServiceContext::UniqueClient releaseCurrent();
+
+    /**
+     * Attaches "client" to the current thread, which must not already have a Client, and names
+     * the thread after it.
+     */
+    static void setCurrent(ServiceContext::UniqueClient client);
+
     std::string clientAddress(bool includePort = false) const;
     const std::string& desc() const {
         return _desc;
@@ -150,8 +163,9 @@ private:
     // Description for the client (e.g. conn8)
     const std::string _desc;
 
-    // OS id of the thread, which owns this client
-    const stdx::thread::id _threadId;
+    // OS id of the thread, which owns this client. Changes only when the client is moved to
+    // another thread with setCurrent().
+    stdx::thread::id _threadId;
 
     // > 0 for things "conn", 0 otherwise
     const ConnectionId _connectionId;
@@ -269,6 +269,8 @@ public:
             uassert(28552, "collection dropped during index build", db->getCollection(ns.ns()));
         }
 
+        uassertStatusOK(indexer.drainBackgroundWrites());
+
         MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
             WriteUnitOfWork wunit(txn);
 
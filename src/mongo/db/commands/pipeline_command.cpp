@@ -34,11 +34,15 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/pipeline_proxy.h"
+#include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
@@ -50,6 +54,7 @@
 #include "mongo/db/query/cursor_responses.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/stdx/memory.h"
 
@@ -145,6 +150,88 @@ static bool handleCursorCommand(OperationContext* txn,
 }
 
 
+// The most results a shard holds in memory to partition them, by default the same as the limit of
+// a $group without allowDiskUse. mongos merges on a single shard instead if a shard fails with
+// 28794.
+MONGO_EXPORT_SERVER_PARAMETER(internalAggregationPartitionedOutputMaxBytes,
+                              int,
+                              100 * 1024 * 1024);
+
+/**
+ * Runs the shards part of a sharded aggregation to completion and splits its results into
+ * 'numPartitions' cursors by a hash of their _id, so that each partition can be merged on a
+ * different shard. The hash only depends on the value of _id, so every shard sends the same group
+ * to the same partition.
+ *
+ * The results are held in memory, up to internalAggregationPartitionedOutputMaxBytes.
+ */
+static void handlePartitionedCursorCommand(OperationContext* txn,
+                                           const NamespaceString& nss,
+                                           PlanExecutor* exec,
+                                           int numPartitions,
+                                           BSONObjBuilder& result) {
+    std::vector<std::vector<BSONObj>> partitions(numPartitions);
+    long long bufferedBytes = 0;
+
+    BSONObj next;
+    while (exec->getNext(&next, NULL) == PlanExecutor::ADVANCED) {
+        bufferedBytes += next.objsize();
+        uassert(28794,
+                str::stream() << "Exceeded memory limit of "
+                              << internalAggregationPartitionedOutputMaxBytes
+                              << " bytes for partitioning aggregation results",
+                bufferedBytes <= internalAggregationPartitionedOutputMaxBytes);
+
+        const long long hash =
+            BSONElementHasher::hash64(next["_id"], BSONElementHasher::DEFAULT_HASH_SEED);
+        const int partition = static_cast<int>(static_cast<unsigned long long>(hash) %
+                                               static_cast<unsigned long long>(numPartitions));
+        partitions[partition].push_back(next.getOwned());
+    }
+
+    // The cursors only return what is buffered above, so they don't need the shard version which
+    // the original read was checked against.
+    Lock::DBLock dbLock(txn->lockState(), nss.db(), MODE_IS);
+    Lock::CollectionLock collLock(txn->lockState(), nss.ns(), MODE_IS);
+    Database* db = dbHolder().get(txn, nss.db());
+    Collection* collection = db ? db->getCollection(nss) : NULL;
+    uassert(28795,
+            str::stream() << "Can't create cursors for partitioned aggregation results since "
+                          << "collection " << nss.ns() << " doesn't exist",
+            collection);
+
+    BSONArrayBuilder cursors(result.subarrayStart("cursors"));
+    for (auto&& partition : partitions) {
+        auto ws = make_unique<WorkingSet>();
+        auto root = make_unique<QueuedDataStage>(txn, ws.get());
+
+        for (auto&& obj : partition) {
+            WorkingSetID id = ws->allocate();
+            WorkingSetMember* member = ws->get(id);
+            member->obj = Snapshotted<BSONObj>(SnapshotId(), obj);
+            member->transitionToOwnedObj();
+            root->pushBack(id);
+        }
+
+        auto statusWithPlanExecutor = PlanExecutor::make(
+            txn, std::move(ws), std::move(root), collection, PlanExecutor::YIELD_MANUAL);
+        invariant(statusWithPlanExecutor.isOK());
+        unique_ptr<PlanExecutor> partitionExec = std::move(statusWithPlanExecutor.getValue());
+
+        partitionExec->saveState();
+        partitionExec->detachFromOperationContext();
+        ClientCursor* cursor =
+            new ClientCursor(collection->getCursorManager(),
+                             partitionExec.release(),
+                             nss.ns(),
+                             txn->recoveryUnit()->isReadingFromMajorityCommittedSnapshot());
+
+        cursors.append(BSON("id" << cursor->cursorid() << "ns" << nss.ns() << "firstBatch"
+                                 << BSONArray()));
+    }
+    cursors.doneFast();
+}
+
 class PipelineCommand : public Command {
 public:
     PipelineCommand() : Command(Pipeline::commandName) {}  // command is called "aggregate"
@@ -277,10 +364,23 @@ public:
             bool keepCursor = false;
 
             const bool isCursorCommand = !cmdObj["cursor"].eoo();
+            const BSONElement partitionOutput = cmdObj[Pipeline::partitionOutputName];
 
             // If both explain and cursor are specified, explain wins.
             if (pPipeline->isExplain()) {
                 result << "stages" << Value(pPipeline->writeExplainOps());
+            } else if (!partitionOutput.eoo()) {
+                uassert(28796,
+                        str::stream() << Pipeline::partitionOutputName
+                                      << " must be a positive number and is only valid in "
+                                      << "commands from mongos",
+                        pCtx->inShard && partitionOutput.isNumber() &&
+                            partitionOutput.numberInt() > 0);
+                handlePartitionedCursorCommand(txn,
+                                               nss,
+                                               pin ? pin->c()->getExecutor() : exec.get(),
+                                               partitionOutput.numberInt(),
+                                               result);
             } else if (isCursorCommand) {
                 keepCursor = handleCursorCommand(txn,
                                                  nss.ns(),
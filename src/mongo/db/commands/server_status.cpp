@@ -47,6 +47,7 @@
 #include "mongo/platform/process_id.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
+#include "mongo/util/net/message_compressor_registry.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
@@ -275,6 +276,10 @@ public:
     BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const {
         BSONObjBuilder b;
         networkCounter.append(b);
+        {
+            BSONObjBuilder compression(b.subobjStart("compression"));
+            MessageCompressorRegistry::get().appendStats(&compression);
+        }
         return b.obj();
     }
 
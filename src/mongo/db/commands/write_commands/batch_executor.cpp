@@ -123,6 +123,10 @@ private:
 // TODO: Determine queueing behavior we want here
 MONGO_EXPORT_SERVER_PARAMETER(queueForMigrationCommit, bool, true);
 
+// Largest number of consecutive documents from an insert batch that are written together. A value
+// of 1 or less inserts every document on its own.
+MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize, int, 64);
+
 using mongoutils::str::stream;
 
 WriteBatchExecutor::WriteBatchExecutor(OperationContext* txn, OpCounters* opCounters, LastError* le)
@@ -797,8 +801,23 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
     // Yield frequency is based on the same constants used by PlanYieldPolicy.
     ElapsedTracker elapsedTracker(internalQueryExecYieldIterations, internalQueryExecYieldPeriodMS);
 
+    // Documents before this index have already been tried as part of a group that failed, and
+    // are inserted one at a time.
+    size_t ungroupedUntil = 0;
+
     for (state.currIndex = 0; state.currIndex < state.request->sizeWriteOps(); ++state.currIndex) {
-        if (state.currIndex + 1 == state.request->sizeWriteOps()) {
+        // A group is a run of consecutive documents that normalized without error.
+        size_t groupEnd = state.currIndex;
+        if (!request.isInsertIndexRequest() && state.currIndex >= ungroupedUntil) {
+            const size_t maxGroupSize = std::max(internalInsertMaxBatchSize, 1);
+            while (groupEnd < state.request->sizeWriteOps() &&
+                   groupEnd - state.currIndex < maxGroupSize &&
+                   state.normalizedInserts[groupEnd].isOK()) {
+                ++groupEnd;
+            }
+        }
+
+        if (std::max(groupEnd, state.currIndex + 1) == state.request->sizeWriteOps()) {
             setupSynchronousCommit(_txn);
         }
 
@@ -819,6 +838,13 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
             elapsedTracker.resetLastTime();
         }
 
+        if (groupEnd - state.currIndex > 1) {
+            if (execInsertGroup(&state, groupEnd)) {
+                continue;
+            }
+            ungroupedUntil = groupEnd;
+        }
+
         WriteErrorDetail* error = NULL;
         execOneInsert(&state, &error);
         if (error) {
@@ -1064,6 +1090,64 @@ void WriteBatchExecutor::execOneInsert(ExecInsertsState* state, WriteErrorDetail
     }
 }
 
+bool WriteBatchExecutor::execInsertGroup(ExecInsertsState* state, size_t groupEnd) {
+    invariant(!_txn->lockState()->inAWriteUnitOfWork());
+    const size_t groupBegin = state->currIndex;
+
+    std::vector<BSONObj> docs;
+    docs.reserve(groupEnd - groupBegin);
+    for (size_t i = groupBegin; i < groupEnd; ++i) {
+        const BSONObj& normalized = state->normalizedInserts[i].getValue();
+        docs.push_back(normalized.isEmpty()
+                           ? state->request->getInsertRequest()->getDocumentsAt(i)
+                           : normalized);
+    }
+
+    CurOp currentOp(_txn);
+    beginCurrentOp(_txn, BatchItemRef(state->request, groupBegin));
+
+    // Any failure, including a write conflict, sends the whole group down the single insert
+    // path, which retries conflicts and reports errors against the right document.
+    bool inserted = false;
+    WriteOpResult result;
+    try {
+        if (state->lockAndCheck(&result)) {
+            WriteUnitOfWork wunit(_txn);
+            Status status = state->getCollection()->insertDocuments(
+                _txn, docs.begin(), docs.end(), true);
+            if (status.isOK()) {
+                wunit.commit();
+                inserted = true;
+            }
+        }
+    } catch (const WriteConflictException&) {
+        currentOp.debug().writeConflicts++;
+    } catch (const StaleConfigException&) {
+    } catch (const DBException& ex) {
+        if (ErrorCodes::isInterruption(ex.toStatus().code()))
+            throw;
+    }
+
+    if (!inserted) {
+        _txn->recoveryUnit()->abandonSnapshot();
+        state->unlock();
+        return false;
+    }
+
+    for (size_t i = groupBegin; i < groupEnd; ++i) {
+        BatchItemRef insertItem(state->request, i);
+        incOpStats(insertItem);
+
+        WriteOpStats stats;
+        stats.n = 1;
+        incWriteStats(insertItem, stats, NULL, &currentOp);
+    }
+    finishCurrentOp(_txn, NULL);
+
+    state->currIndex = groupEnd - 1;
+    return true;
+}
+
 /**
  * Perform a single insert into a collection.  Requires the insert be preprocessed and the
  * collection already has been created.
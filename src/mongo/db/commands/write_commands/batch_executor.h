@@ -97,6 +97,14 @@ private:
      */
     void execOneInsert(ExecInsertsState* state, WriteErrorDetail** error);
 
+    /**
+     * Tries to insert the documents from the current insert up to, but not including,
+     * "groupEnd" in a single WriteUnitOfWork. Returns true and advances the state past the group
+     * if every document was inserted; otherwise nothing is written, the lock is released and
+     * the caller must insert the documents individually to find out which of them failed.
+     */
+    bool execInsertGroup(ExecInsertsState* state, size_t groupEnd);
+
     /**
      * Executes an update item (which may update many documents or upsert), and returns the
      * upserted _id on upsert or error on failure.
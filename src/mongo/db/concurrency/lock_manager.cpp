@@ -32,6 +32,10 @@
 
 #include <vector>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include "mongo/db/concurrency/lock_manager.h"
 
 #include "mongo/config.h"
@@ -124,6 +128,20 @@ static_assert((sizeof(LockRequestStatusNames) / sizeof(LockRequestStatusNames[0]
               "(sizeof(LockRequestStatusNames) / sizeof(LockRequestStatusNames[0])) == "
               "LockRequest::StatusCount");
 
+/**
+ * Returns the CPU the calling thread is running on, or 'fallback' where that isn't known. The
+ * thread may move to another CPU at any time, so this is only good for spreading out work.
+ */
+unsigned currentCpu(unsigned fallback) {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return cpu;
+    }
+#endif
+    return fallback;
+}
+
 }  // namespace
 
 
@@ -354,6 +372,7 @@ struct LockHead {
  */
 struct PartitionedLockHead {
     void initNew(ResourceId resId) {
+        resourceId = resId;
         grantedList.reset();
     }
 
@@ -376,6 +395,9 @@ struct PartitionedLockHead {
     // the end of the queue. The PartitionedLockHead never contains anything but granted
     // requests with intent modes.
     LockRequestList grantedList;
+
+    // Id of the resource which this lock protects; the key in its partition's table
+    ResourceId resourceId;
 };
 
 void LockHead::migratePartitionedLockHeads() {
@@ -388,9 +410,8 @@ void LockHead::migratePartitionedLockHeads() {
         LockManager::Partition* partition = partitions.back();
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
 
-        LockManager::Partition::Map::iterator it = partition->data.find(resourceId);
-        if (it != partition->data.end()) {
-            PartitionedLockHead* partitionedLock = it->second;
+        PartitionedLockHead* partitionedLock = partition->remove(resourceId);
+        if (partitionedLock) {
 
             while (!partitionedLock->grantedList.empty()) {
                 LockRequest* request = partitionedLock->grantedList._front;
@@ -400,7 +421,6 @@ void LockHead::migratePartitionedLockHeads() {
                 LockResult res = newRequest(request, request->mode);
                 invariant(res == LOCK_OK);  // Lock must still be granted
             }
-            partition->data.erase(it);
             delete partitionedLock;
         }
         // Don't pop-back to early as otherwise the lock will be considered not partioned in
@@ -416,9 +436,10 @@ void LockHead::migratePartitionedLockHeads() {
 // Have more buckets than CPUs to reduce contention on lock and caches
 const unsigned LockManager::_numLockBuckets(128);
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+// Balance scalability of intent locks against potential added cost of conflicting locks. Migration
+// only visits the partitions that were actually used for a resource, so this can cover one
+// partition per CPU on most machines. Larger machines share partitions between CPUs.
+const unsigned LockManager::_numPartitions = 128;
 
 LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
@@ -445,7 +466,7 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
-        Partition* partition = _getPartition(request);
+        Partition* partition = _choosePartition(request);
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
 
         // Fast path for intent locks
@@ -789,8 +810,13 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
     return &_lockBuckets[resId % _numLockBuckets];
 }
 
+LockManager::Partition* LockManager::_choosePartition(LockRequest* request) const {
+    request->partitionIndex = currentCpu(request->locker->getId()) % _numPartitions;
+    return _getPartition(request);
+}
+
 LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-    return &_partitions[request->locker->getId() % _numPartitions];
+    return &_partitions[request->partitionIndex];
 }
 
 void LockManager::dump() const {
@@ -843,25 +869,78 @@ void LockManager::_dumpBucket(const LockBucket* bucket) const {
     }
 }
 
-PartitionedLockHead* LockManager::Partition::find(ResourceId resId) {
-    Map::iterator it = data.find(resId);
-    return it == data.end() ? NULL : it->second;
+PartitionedLockHead* LockManager::Partition::find(ResourceId resId) const {
+    if (slots.empty())
+        return NULL;
+    return slots[_findSlot(resId)];
 }
 
 PartitionedLockHead* LockManager::Partition::findOrInsert(ResourceId resId) {
-    PartitionedLockHead* lock;
-    Map::iterator it = data.find(resId);
-    if (it == data.end()) {
-        lock = new PartitionedLockHead();
-        lock->initNew(resId);
+    if ((numLocks + 1) * 2 > slots.size()) {
+        _grow();
+    }
 
-        data.insert(Map::value_type(resId, lock));
-    } else {
-        lock = it->second;
+    PartitionedLockHead*& slot = slots[_findSlot(resId)];
+    if (!slot) {
+        slot = new PartitionedLockHead();
+        slot->initNew(resId);
+        numLocks++;
+    }
+    return slot;
+}
+
+PartitionedLockHead* LockManager::Partition::remove(ResourceId resId) {
+    if (slots.empty())
+        return NULL;
+
+    size_t hole = _findSlot(resId);
+    PartitionedLockHead* const lock = slots[hole];
+    if (!lock)
+        return NULL;
+
+    slots[hole] = NULL;
+    numLocks--;
+
+    // Shift back any following entries that can now be found closer to their home slot, so
+    // that probing never stops early at the new hole.
+    const size_t mask = slots.size() - 1;
+    for (size_t i = (hole + 1) & mask; slots[i] != NULL; i = (i + 1) & mask) {
+        const size_t home = _homeSlot(slots[i]->resourceId);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots[hole] = slots[i];
+            slots[i] = NULL;
+            hole = i;
+        }
     }
     return lock;
 }
 
+size_t LockManager::Partition::_homeSlot(ResourceId resId) const {
+    // Resources of different types may share the low bits of their ids, so mix the whole id.
+    const uint64_t hash = static_cast<uint64_t>(resId) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(hash ^ (hash >> 32)) & (slots.size() - 1);
+}
+
+size_t LockManager::Partition::_findSlot(ResourceId resId) const {
+    const size_t mask = slots.size() - 1;
+    size_t i = _homeSlot(resId);
+    while (slots[i] != NULL && slots[i]->resourceId != resId) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void LockManager::Partition::_grow() {
+    std::vector<PartitionedLockHead*> oldSlots(slots.empty() ? 8 : slots.size() * 2, NULL);
+    oldSlots.swap(slots);
+
+    for (size_t i = 0; i < oldSlots.size(); i++) {
+        if (oldSlots[i]) {
+            slots[_findSlot(oldSlots[i]->resourceId)] = oldSlots[i];
+        }
+    }
+}
+
 LockHead* LockManager::LockBucket::findOrInsert(ResourceId resId) {
     LockHead* lock;
     Map::iterator it = data.find(resId);
@@ -1075,6 +1154,8 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     recursiveCount = 0;
 
     lock = NULL;
+    partitionedLock = NULL;
+    partitionIndex = 0;
     prev = NULL;
     next = NULL;
     status = STATUS_NEW;
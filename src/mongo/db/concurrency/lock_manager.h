@@ -30,6 +30,7 @@
 
 #include <cstdint>
 #include <deque>
+#include <vector>
 
 #include "mongo/config.h"
 #include "mongo/db/concurrency/lock_manager_defs.h"
@@ -137,15 +138,34 @@ private:
         LockHead* findOrInsert(ResourceId resId);
     };
 
-    // Each locker maps to a partition that is used for resources acquired in intent modes
+    // Each CPU maps to a partition that is used for resources acquired in intent
     // modes and potentially other modes that don't conflict with themselves. This avoids
-    // contention on the regular LockHead in the lock manager.
-    struct Partition {
-        PartitionedLockHead* find(ResourceId resId);
+    // contention on the regular LockHead in the lock manager, and keeps the partition's mutex
+    // and table in the cache of the CPU that uses them. The alignment is a best effort to keep
+    // partitions on separate cache lines.
+    struct MONGO_COMPILER_ALIGN_TYPE(64) Partition {
+        PartitionedLockHead* find(ResourceId resId) const;
         PartitionedLockHead* findOrInsert(ResourceId resId);
-        typedef unordered_map<ResourceId, PartitionedLockHead*> Map;
+
+        /**
+         * Removes the PartitionedLockHead for resId, if any, and returns it. The caller takes
+         * ownership.
+         */
+        PartitionedLockHead* remove(ResourceId resId);
+
         SimpleMutex mutex;
-        Map data;
+
+        // Open addressing table of the PartitionedLockHeads in this partition, keyed by their
+        // resourceId and probed linearly. The size is zero or a power of two, and the table is
+        // kept at most half full. Typically only holds the global lock and a few databases and
+        // collections, so lookups touch a single cache line.
+        std::vector<PartitionedLockHead*> slots;
+        size_t numLocks = 0;
+
+    private:
+        size_t _homeSlot(ResourceId resId) const;
+        size_t _findSlot(ResourceId resId) const;
+        void _grow();
     };
 
     /**
@@ -156,7 +176,13 @@ private:
 
 
     /**
-     * Retrieves the Partition that a particular LockRequest should use for intent locking.
+     * Picks the Partition that a new LockRequest will use for intent locking, based on the CPU
+     * the caller is running on, and records it in the request.
+     */
+    Partition* _choosePartition(LockRequest* request) const;
+
+    /**
+     * Retrieves the Partition that a particular LockRequest uses for intent locking.
      */
     Partition* _getPartition(LockRequest* request) const;
 
@@ -381,6 +381,11 @@ struct LockRequest {
     // only transition from 'partitionedLock' to 'lock', never the other way around.
     PartitionedLockHead* partitionedLock;
 
+    // Index of the LockManager partition used by a partitioned request. Chosen when the request
+    // is first locked and kept until it is unlocked, even if the request has been migrated to
+    // 'lock' in the meantime.
+    unsigned partitionIndex;
+
     // The reason intrusive linked list is used instead of the std::list class is to allow
     // for entries to be removed from the middle of the list in O(1) time, if they are known
     // instead of having to search for them and we cannot persist iterators, because the list
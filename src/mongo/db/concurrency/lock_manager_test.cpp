@@ -26,6 +26,9 @@
  *    it in the license file.
  */
 
+#include <memory>
+#include <vector>
+
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/unittest/unittest.h"
 
@@ -816,4 +819,51 @@ TEST(LockManager, CompatibleFirstCancelWaiting) {
     ASSERT(lockMgr.unlock(&requestX));
 }
 
+TEST(LockManager, PartitionedIntentLocksMigrateOnConflict) {
+    LockManager lockMgr;
+
+    // Enough resources to grow the partitioned lock table several times.
+    const int kNumResources = 100;
+    MMAPV1LockerImpl locker;
+    std::vector<std::unique_ptr<LockRequestCombo>> requests;
+    for (int i = 0; i < kNumResources; i++) {
+        requests.emplace_back(new LockRequestCombo(&locker));
+        const ResourceId resId(RESOURCE_COLLECTION, i);
+        ASSERT(LOCK_OK == lockMgr.lock(resId, requests.back().get(), MODE_IX));
+
+        // A second intent lock on the same resource uses the existing partitioned lock head.
+        MMAPV1LockerImpl lockerIS;
+        LockRequestCombo requestIS(&lockerIS);
+        ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS, MODE_IS));
+        ASSERT(lockMgr.unlock(&requestIS));
+    }
+
+    // Conflicting requests move the partitioned requests back to their lock heads and wait.
+    std::vector<std::unique_ptr<MMAPV1LockerImpl>> lockersX;
+    std::vector<std::unique_ptr<LockRequestCombo>> requestsX;
+    for (int i = 0; i < kNumResources; i += 2) {
+        lockersX.emplace_back(new MMAPV1LockerImpl());
+        requestsX.emplace_back(new LockRequestCombo(lockersX.back().get()));
+        ASSERT(LOCK_WAITING ==
+               lockMgr.lock(ResourceId(RESOURCE_COLLECTION, i), requestsX.back().get(), MODE_X));
+    }
+
+    // Releasing the intent locks grants the conflicting requests.
+    for (int i = 0; i < kNumResources; i++) {
+        ASSERT(lockMgr.unlock(requests[i].get()));
+    }
+    for (size_t i = 0; i < requestsX.size(); i++) {
+        ASSERT_EQUALS(1, requestsX[i]->numNotifies);
+        ASSERT(LOCK_OK == requestsX[i]->lastResult);
+        ASSERT(lockMgr.unlock(requestsX[i].get()));
+    }
+
+    // Resources that were never migrated are still partitioned and usable.
+    for (int i = 1; i < kNumResources; i += 2) {
+        LockRequestCombo request(&locker);
+        ASSERT(LOCK_OK == lockMgr.lock(ResourceId(RESOURCE_COLLECTION, i), &request, MODE_IS));
+        ASSERT(lockMgr.unlock(&request));
+    }
+}
+
 }  // namespace mongo
@@ -146,12 +146,33 @@ ntservice::NtServiceDefaultStrings defaultServiceStrings = {
 
 Timer startupSrandTimer;
 
+/**
+ * The connection's Client, parked while a service executor worker is not servicing it.
+ */
+struct ClientSessionState : public MessageHandler::SessionState {
+    explicit ClientSessionState(ServiceContext::UniqueClient client) : client(std::move(client)) {}
+
+    ServiceContext::UniqueClient client;
+};
+
 class MyMessageHandler : public MessageHandler {
 public:
     virtual void connected(AbstractMessagingPort* p) {
         Client::initThread("conn", p);
     }
 
+    virtual std::unique_ptr<SessionState> suspend(AbstractMessagingPort* p) {
+        if (!haveClient()) {
+            return nullptr;
+        }
+        return stdx::make_unique<ClientSessionState>(Client::releaseCurrent());
+    }
+
+    virtual void resume(AbstractMessagingPort* p, std::unique_ptr<SessionState> state) {
+        invariant(state);
+        Client::setCurrent(std::move(static_cast<ClientSessionState*>(state.get())->client));
+    }
+
     virtual void process(Message& m, AbstractMessagingPort* port) {
         while (true) {
             if (inShutdown()) {
@@ -33,7 +33,10 @@
 #include "mongo/db/dbhelpers.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
 #include <fstream>
+#include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_create.h"
@@ -61,6 +64,8 @@
 #include "mongo/db/write_concern_options.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -297,16 +302,60 @@ static bool findShardKeyIndexPattern(OperationContext* txn,
     return true;
 }
 
+namespace {
+
+// Maximum number of documents removeRange() deletes in a single write unit of work, and so
+// while holding the collection lock without yielding.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 64);
+
+// Limits on the rate at which removeRange() deletes documents, 0 for no limit.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxDocsPerSec, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBytesPerSec, int, 0);
+
+// Totals of all removeRange() calls since startup.
+AtomicInt64 totalDeletedDocs;
+AtomicInt64 totalDeletedBytes;
+AtomicInt64 totalBatches;
+AtomicInt64 totalThrottledMillis;
+
+/**
+ * Returns how long to sleep so that 'docs' and 'bytes' deleted over 'elapsedMillis' stay within
+ * the configured rate limits.
+ */
+long long millisToThrottle(long long docs, long long bytes, long long elapsedMillis) {
+    long long targetMillis = 0;
+
+    const long long maxDocsPerSec = rangeDeleterMaxDocsPerSec;
+    if (maxDocsPerSec > 0) {
+        targetMillis = std::max(targetMillis, docs * 1000 / maxDocsPerSec);
+    }
+
+    const long long maxBytesPerSec = rangeDeleterMaxBytesPerSec;
+    if (maxBytesPerSec > 0) {
+        targetMillis = std::max(targetMillis, bytes * 1000 / maxBytesPerSec);
+    }
+
+    return std::max(0LL, targetMillis - elapsedMillis);
+}
+
+}  // namespace
+
 long long Helpers::removeRange(OperationContext* txn,
                                const KeyRange& range,
                                bool maxInclusive,
                                const WriteConcernOptions& writeConcern,
                                RemoveSaver* callback,
                                bool fromMigrate,
-                               bool onlyRemoveOrphanedDocs) {
+                               bool onlyRemoveOrphanedDocs,
+                               RemoveRangeStats* stats) {
     Timer rangeRemoveTimer;
     const string& ns = range.ns;
 
+    RemoveRangeStats localStats;
+    if (!stats) {
+        stats = &localStats;
+    }
+
     // The IndexChunk has a keyPattern that may apply to more than one index - we need to
     // select the index and get the full index keyPattern here.
     BSONObj indexKeyPatternDoc;
@@ -336,7 +385,10 @@ long long Helpers::removeRange(OperationContext* txn,
 
     Milliseconds millisWaitingForReplication{0};
 
-    while (1) {
+    bool done = false;
+    while (!done) {
+        long long batchDeleted = 0;
+
         // Scoping for write lock.
         {
             OldClientWriteContext ctx(txn, ns);
@@ -347,6 +399,9 @@ long long Helpers::removeRange(OperationContext* txn,
             IndexDescriptor* desc =
                 collection->getIndexCatalog()->findIndexByKeyPattern(txn, indexKeyPattern.toBSON());
 
+            // The scan starts from 'min' again for every batch, since the documents before it
+            // have all been deleted. It doesn't yield, so that the batch it returns is still there
+            // to be deleted below.
             unique_ptr<PlanExecutor> exec(
                 InternalPlanner::indexScan(txn,
                                            collection,
@@ -357,85 +412,113 @@ long long Helpers::removeRange(OperationContext* txn,
                                            PlanExecutor::YIELD_MANUAL,
                                            InternalPlanner::FORWARD,
                                            InternalPlanner::IXSCAN_FETCH));
-            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+            const int batchSize = std::max(1, static_cast<int>(rangeDeleterBatchSize));
+            std::vector<std::pair<RecordId, BSONObj>> batch;
+            batch.reserve(batchSize);
 
             RecordId rloc;
             BSONObj obj;
-            PlanExecutor::ExecState state;
-            // This may yield so we cannot touch nsd after this.
-            state = exec->getNext(&obj, &rloc);
-            exec.reset();
-            if (PlanExecutor::IS_EOF == state) {
-                break;
+            PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+            while (static_cast<int>(batch.size()) < batchSize &&
+                   PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &rloc))) {
+                batch.emplace_back(rloc, obj.getOwned());
             }
 
             if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
-                const std::unique_ptr<PlanStageStats> stats(exec->getStats());
+                const std::unique_ptr<PlanStageStats> execStats(exec->getStats());
                 warning(LogComponent::kSharding)
                     << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
                     << min << " to " << max << " in " << ns << ": "
                     << WorkingSetCommon::toStatusString(obj)
-                    << ", stats: " << Explain::statsToBSON(*stats) << endl;
+                    << ", stats: " << Explain::statsToBSON(*execStats) << endl;
                 break;
             }
+            exec.reset();
 
-            verify(PlanExecutor::ADVANCED == state);
+            if (batch.empty()) {
+                break;
+            }
 
-            WriteUnitOfWork wuow(txn);
+            // A short batch means the scan reached the end of the range.
+            done = static_cast<int>(batch.size()) < batchSize;
 
-            if (onlyRemoveOrphanedDocs) {
-                // Do a final check in the write lock to make absolutely sure that our
-                // collection hasn't been modified in a way that invalidates our migration
-                // cleanup.
+            NamespaceString nss(ns);
+            if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
+                warning() << "stepped down from primary while deleting chunk; "
+                          << "orphaning data in " << ns << " in range [" << min << ", " << max
+                          << ")";
+                return numDeleted;
+            }
 
+            // In write lock, so will be the most up-to-date version
+            std::shared_ptr<CollectionMetadata> metadataNow;
+            if (onlyRemoveOrphanedDocs) {
                 // We should never be able to turn off the sharding state once enabled, but
                 // in the future we might want to.
                 verify(ShardingState::get(getGlobalServiceContext())->enabled());
 
-                bool docIsOrphan;
-
-                // In write lock, so will be the most up-to-date version
-                std::shared_ptr<CollectionMetadata> metadataNow =
+                metadataNow =
                     ShardingState::get(getGlobalServiceContext())->getCollectionMetadata(ns);
-                if (metadataNow) {
-                    ShardKeyPattern kp(metadataNow->getKeyPattern());
-                    BSONObj key = kp.extractShardKeyFromDoc(obj);
-                    docIsOrphan =
-                        !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
-                } else {
-                    docIsOrphan = false;
-                }
+            }
 
-                if (!docIsOrphan) {
-                    warning(LogComponent::kSharding)
-                        << "aborting migration cleanup for chunk " << min << " to " << max
-                        << (metadataNow ? (string) " at document " + obj.toString() : "")
-                        << ", collection " << ns << " has changed " << endl;
-                    break;
+            long long batchBytes = 0;
+
+            WriteUnitOfWork wuow(txn);
+
+            for (const auto& doc : batch) {
+                if (onlyRemoveOrphanedDocs) {
+                    // Do a final check in the write lock to make absolutely sure that our
+                    // collection hasn't been modified in a way that invalidates our migration
+                    // cleanup.
+                    bool docIsOrphan;
+                    if (metadataNow) {
+                        ShardKeyPattern kp(metadataNow->getKeyPattern());
+                        BSONObj key = kp.extractShardKeyFromDoc(doc.second);
+                        docIsOrphan =
+                            !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
+                    } else {
+                        docIsOrphan = false;
+                    }
+
+                    if (!docIsOrphan) {
+                        warning(LogComponent::kSharding)
+                            << "aborting migration cleanup for chunk " << min << " to " << max
+                            << (metadataNow ? (string) " at document " + doc.second.toString()
+                                            : "")
+                            << ", collection " << ns << " has changed " << endl;
+                        done = true;
+                        break;
+                    }
                 }
-            }
 
-            NamespaceString nss(ns);
-            if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
-                warning() << "stepped down from primary while deleting chunk; "
-                          << "orphaning data in " << ns << " in range [" << min << ", " << max
-                          << ")";
-                return numDeleted;
-            }
+                if (callback)
+                    callback->goingToDelete(doc.second);
 
-            if (callback)
-                callback->goingToDelete(obj);
+                BSONObj deletedId;
+                collection->deleteDocument(txn, doc.first, false, false, &deletedId);
+                batchDeleted++;
+                batchBytes += doc.second.objsize();
+            }
 
-            BSONObj deletedId;
-            collection->deleteDocument(txn, rloc, false, false, &deletedId);
             wuow.commit();
-            numDeleted++;
+
+            if (batchDeleted > 0) {
+                numDeleted += batchDeleted;
+                stats->deletedDocs += batchDeleted;
+                stats->deletedBytes += batchBytes;
+                stats->batches++;
+
+                totalDeletedDocs.addAndFetch(batchDeleted);
+                totalDeletedBytes.addAndFetch(batchBytes);
+                totalBatches.addAndFetch(1);
+            }
         }
 
         // TODO remove once the yielding below that references this timer has been removed
         Timer secondaryThrottleTime;
 
-        if (writeConcern.shouldWaitForOtherNodes() && numDeleted > 0) {
+        if (writeConcern.shouldWaitForOtherNodes() && batchDeleted > 0) {
             repl::ReplicationCoordinator::StatusAndDuration replStatus =
                 repl::getGlobalReplicationCoordinator()->awaitReplication(
                     txn,
@@ -449,6 +532,20 @@ long long Helpers::removeRange(OperationContext* txn,
             }
             millisWaitingForReplication += replStatus.duration;
         }
+
+        if (!done) {
+            // Throttle against the rate since the start of the delete rather than sleeping for a
+            // fixed time after each batch, so that time spent deleting and waiting for
+            // replication counts towards the limit.
+            const long long throttleMillis = millisToThrottle(
+                stats->deletedDocs, stats->deletedBytes, rangeRemoveTimer.millis());
+            if (throttleMillis > 0) {
+                txn->checkForInterrupt();
+                sleepmillis(throttleMillis);
+                stats->throttledMillis += throttleMillis;
+                totalThrottledMillis.addAndFetch(throttleMillis);
+            }
+        }
     }
 
     if (writeConcern.shouldWaitForOtherNodes())
@@ -456,13 +553,21 @@ long long Helpers::removeRange(OperationContext* txn,
             << "Helpers::removeRangeUnlocked time spent waiting for replication: "
             << durationCount<Milliseconds>(millisWaitingForReplication) << "ms" << endl;
 
-    MONGO_LOG_COMPONENT(1, LogComponent::kSharding) << "end removal of " << min << " to " << max
-                                                    << " in " << ns << " (took "
-                                                    << rangeRemoveTimer.millis() << "ms)" << endl;
+    MONGO_LOG_COMPONENT(1, LogComponent::kSharding)
+        << "end removal of " << min << " to " << max << " in " << ns << " (took "
+        << rangeRemoveTimer.millis() << "ms, " << stats->batches << " batches, "
+        << stats->throttledMillis << "ms throttled)" << endl;
 
     return numDeleted;
 }
 
+void Helpers::appendRemoveRangeTotals(BSONObjBuilder* builder) {
+    builder->append("deletedDocs", totalDeletedDocs.load());
+    builder->append("deletedBytes", totalDeletedBytes.load());
+    builder->append("batches", totalBatches.load());
+    builder->append("throttledMillis", totalThrottledMillis.load());
+}
+
 const long long Helpers::kMaxDocsPerChunk(250000);
 
 // Used by migration clone step
@@ -151,6 +151,23 @@ struct Helpers {
      */
     static BSONObj inferKeyPattern(const BSONObj& o);
 
+    /**
+     * What a single removeRange() call did.
+     */
+    struct RemoveRangeStats {
+        RemoveRangeStats() : deletedDocs(0), deletedBytes(0), batches(0), throttledMillis(0) {}
+
+        long long deletedDocs;
+        long long deletedBytes;
+
+        // Number of write units of work committed.
+        long long batches;
+
+        // Time spent sleeping to stay under the rangeDeleterMaxDocsPerSec and
+        // rangeDeleterMaxBytesPerSec limits.
+        long long throttledMillis;
+    };
+
     /**
      * Takes a namespace range, specified by a min and max and qualified by an index pattern,
      * and removes all the documents in that range found by iterating
@@ -159,6 +176,10 @@ struct Helpers {
      * keyPattern={a:1,b:1} since it can be extended to {a:100,b:minKey}, but
      * min={b:100} is not compatible).
      *
+     * Documents are deleted in batches of up to rangeDeleterBatchSize per write unit of work, and
+     * the deletion sleeps between batches as needed to stay under rangeDeleterMaxDocsPerSec and
+     * rangeDeleterMaxBytesPerSec. If 'stats' is not NULL, it is filled in with what was done.
+     *
      * Caller must hold a write lock on 'ns'
      *
      * Returns -1 when no usable index exists
@@ -172,7 +193,14 @@ struct Helpers {
                                  const WriteConcernOptions& secondaryThrottle,
                                  RemoveSaver* callback = NULL,
                                  bool fromMigrate = false,
-                                 bool onlyRemoveOrphanedDocs = false);
+                                 bool onlyRemoveOrphanedDocs = false,
+                                 RemoveRangeStats* stats = NULL);
+
+    /**
+     * Appends the totals of all removeRange() calls since startup, which are updated as each
+     * batch commits and so show the progress of deletes which are still running.
+     */
+    static void appendRemoveRangeTotals(BSONObjBuilder* builder);
 
 
     // TODO: This will supersede Chunk::MaxObjectsPerChunk
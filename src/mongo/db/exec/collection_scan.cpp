@@ -38,6 +38,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -66,6 +67,10 @@ CollectionScan::CollectionScan(OperationContext* txn,
       _wsidForFetch(_workingSet->allocate()) {
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
+
+    if (_filter && internalQueryExecCompileFilters) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
 }
 
 PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
@@ -97,7 +102,13 @@ PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
     try {
         if (needToMakeCursor) {
             const bool forward = _params.direction == CollectionScanParams::FORWARD;
-            _cursor = _params.collection->getCursor(getOpCtx(), forward);
+            if (!_params.fields.empty() && forward && !_params.tailable &&
+                _params.start.isNull()) {
+                _cursor = _params.collection->getCursorForFields(getOpCtx(), _params.fields);
+            }
+            if (!_cursor) {
+                _cursor = _params.collection->getCursor(getOpCtx(), forward);
+            }
 
             if (!_lastSeenId.isNull()) {
                 invariant(_params.tailable);
@@ -175,7 +186,7 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         *out = memberID;
         ++_commonStats.advanced;
         return PlanStage::ADVANCED;
@@ -33,6 +33,7 @@
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -86,6 +87,9 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Compiled form of '_filter', or NULL if it has none.
+    std::unique_ptr<CompiledMatchExpression> _compiledFilter;
+
     std::unique_ptr<RecordCursor> _cursor;
 
     CollectionScanParams _params;
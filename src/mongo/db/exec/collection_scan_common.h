@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -58,6 +61,11 @@ struct CollectionScanParams {
 
     // If non-zero, how many documents will we look at?
     size_t maxScan;
+
+    // If non-empty, the only top-level fields the consumers of the scan look at. Record stores
+    // which support it return documents with just these fields for forward, non-tailable scans
+    // starting at the beginning of the collection.
+    std::vector<std::string> fields;
 };
 
 }  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -60,6 +61,9 @@ FetchStage::FetchStage(OperationContext* txn,
       _filter(filter),
       _idRetrying(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
+    if (_filter && internalQueryExecCompileFilters) {
+        _compiledFilter = CompiledMatchExpression::compile(_filter);
+    }
 }
 
 FetchStage::~FetchStage() {}
@@ -209,7 +213,7 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     // predicate.
     ++_specificStats.docsExamined;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         *out = memberID;
 
         ++_commonStats.advanced;
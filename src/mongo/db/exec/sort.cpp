@@ -31,6 +31,7 @@
 #include "mongo/db/exec/sort.h"
 
 #include <algorithm>
+#include <cstring>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/index_names.h"
@@ -41,6 +42,7 @@
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -58,6 +60,16 @@ SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p) : pattern(p) {}
 
 bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
                                                  const SortableDataItem& rhs) const {
+    if (!lhs.encodedKey.empty()) {
+        // The encodings include the RecordId, so they are never equal.
+        const size_t minSize = std::min(lhs.encodedKey.size(), rhs.encodedKey.size());
+        const int result = memcmp(lhs.encodedKey.data(), rhs.encodedKey.data(), minSize);
+        if (0 != result) {
+            return result < 0;
+        }
+        return lhs.encodedKey.size() < rhs.encodedKey.size();
+    }
+
     // False means ignore field names.
     int result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
     if (0 != result) {
@@ -100,12 +112,10 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
     if (NULL == _sortKeyGen) {
         // This is heavy and should be done as part of work().
         _sortKeyGen.reset(new SortKeyGenerator(_collection, _pattern, _query));
-        _sortKeyComparator.reset(new WorkingSetComparator(_sortKeyGen->getSortComparator()));
-        // If limit > 1, we need to initialize _dataSet here to maintain ordered
-        // set of data items while fetching from the child stage.
-        if (_limit > 1) {
-            const WorkingSetComparator& cmp = *_sortKeyComparator;
-            _dataSet.reset(new SortableDataItemSet(cmp));
+        const BSONObj& comparatorObj = _sortKeyGen->getSortComparator();
+        _sortKeyComparator.reset(new WorkingSetComparator(comparatorObj));
+        if (comparatorObj.nFields() <= 32) {
+            _sortKeyOrdering.reset(new Ordering(Ordering::make(comparatorObj)));
         }
         return PlanStage::NEED_TIME;
     }
@@ -146,7 +156,7 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
             // The data remains in the WorkingSet and we wrap the WSID with the sort key.
             SortableDataItem item;
             Status sortKeyStatus = _sortKeyGen->getSortKey(*member, &item.sortKey);
-            if (!_sortKeyGen->getSortKey(*member, &item.sortKey).isOK()) {
+            if (!sortKeyStatus.isOK()) {
                 *out = WorkingSetCommon::allocateStatusMember(_ws, sortKeyStatus);
                 return PlanStage::FAILURE;
             }
@@ -156,7 +166,15 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
                 item.loc = member->loc;
             }
 
-            addToBuffer(item);
+            // Encode the key once here, rather than comparing BSON on every comparison of the
+            // sort.
+            if (_sortKeyOrdering) {
+                KeyString encoded(item.sortKey, *_sortKeyOrdering, item.loc);
+                item.encodedKey.assign(encoded.getBuffer(), encoded.getSize());
+                item.sortKey = BSONObj();
+            }
+
+            addToBuffer(&item);
 
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
@@ -264,58 +282,53 @@ const SpecificStats* SortStage::getSpecificStats() const {
  *                     Updates memory usage if item was replaced.
  *     sortBuffer() - Does nothing.
  * limit > 1:
- *     addToBuffer() - Does not update vector. Adds item to set.
- *                     If size of set exceeds limit, remove item from set
- *                     with lowest key. Updates memory usage accordingly.
- *     sortBuffer() - Copies items from set to vectors.
+ *     addToBuffer() - Pushes item onto the heap in the vector.
+ *                     If size of heap exceeds limit, pops the item
+ *                     with the highest key. Updates memory usage accordingly.
+ *     sortBuffer() - Sorts the heap.
  */
-void SortStage::addToBuffer(const SortableDataItem& item) {
+void SortStage::addToBuffer(SortableDataItem* item) {
     // Holds ID of working set member to be freed at end of this function.
     WorkingSetID wsidToFree = WorkingSet::INVALID_ID;
+    const size_t itemMemUsage = _ws->get(item->wsid)->getMemUsage() + item->encodedKey.size();
+    const WorkingSetComparator& cmp = *_sortKeyComparator;
 
     if (_limit == 0) {
-        _data.push_back(item);
-        _memUsage += _ws->get(item.wsid)->getMemUsage();
+        _data.push_back(std::move(*item));
+        _memUsage += itemMemUsage;
     } else if (_limit == 1) {
         if (_data.empty()) {
-            _data.push_back(item);
-            _memUsage = _ws->get(item.wsid)->getMemUsage();
+            _data.push_back(std::move(*item));
+            _memUsage = itemMemUsage;
             return;
         }
-        wsidToFree = item.wsid;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
+        wsidToFree = item->wsid;
         // Compare new item with existing item in vector.
-        if (cmp(item, _data[0])) {
+        if (cmp(*item, _data[0])) {
             wsidToFree = _data[0].wsid;
-            _data[0] = item;
-            _memUsage = _ws->get(item.wsid)->getMemUsage();
+            _data[0] = std::move(*item);
+            _memUsage = itemMemUsage;
         }
     } else {
-        // Update data item set instead of vector
-        // Limit not reached - insert and return
-        vector<SortableDataItem>::size_type limit(_limit);
-        if (_dataSet->size() < limit) {
-            _dataSet->insert(item);
-            _memUsage += _ws->get(item.wsid)->getMemUsage();
+        // Limit not reached - push onto the heap and return.
+        if (_data.size() < _limit) {
+            _data.push_back(std::move(*item));
+            std::push_heap(_data.begin(), _data.end(), cmp);
+            _memUsage += itemMemUsage;
             return;
         }
-        // Limit will be exceeded - compare with item with lowest key
-        // If new item does not have a lower key value than last item,
-        // do nothing.
-        wsidToFree = item.wsid;
-        SortableDataItemSet::const_iterator lastItemIt = --(_dataSet->end());
-        const SortableDataItem& lastItem = *lastItemIt;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        if (cmp(item, lastItem)) {
-            _memUsage -= _ws->get(lastItem.wsid)->getMemUsage();
-            _memUsage += _ws->get(item.wsid)->getMemUsage();
+        // Limit will be exceeded - compare with the item with the highest key, which is at the
+        // top of the heap. If the new item does not have a lower key, do nothing.
+        wsidToFree = item->wsid;
+        if (cmp(*item, _data.front())) {
+            SortableDataItem& lastItem = _data.front();
+            _memUsage -= _ws->get(lastItem.wsid)->getMemUsage() + lastItem.encodedKey.size();
+            _memUsage += itemMemUsage;
             wsidToFree = lastItem.wsid;
-            // According to std::set iterator validity rules,
-            // it does not matter which of erase()/insert() happens first.
-            // Here, we choose to erase first to release potential resources
-            // used by the last item and to keep the scope of the iterator to a minimum.
-            _dataSet->erase(lastItemIt);
-            _dataSet->insert(item);
+
+            std::pop_heap(_data.begin(), _data.end(), cmp);
+            _data.back() = std::move(*item);
+            std::push_heap(_data.begin(), _data.end(), cmp);
         }
     }
 
@@ -331,19 +344,14 @@ void SortStage::addToBuffer(const SortableDataItem& item) {
 }
 
 void SortStage::sortBuffer() {
+    const WorkingSetComparator& cmp = *_sortKeyComparator;
     if (_limit == 0) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
         std::sort(_data.begin(), _data.end(), cmp);
     } else if (_limit == 1) {
         // Buffer contains either 0 or 1 item so it is already in a sorted state.
         return;
     } else {
-        // Set already contains items in sorted order, so we simply copy the items
-        // from the set to the vector.
-        // Release the memory for the set after the copy.
-        vector<SortableDataItem> newData(_dataSet->begin(), _dataSet->end());
-        _data.swap(newData);
-        _dataSet.reset();
+        std::sort_heap(_data.begin(), _data.end(), cmp);
     }
 }
 
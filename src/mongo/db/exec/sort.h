@@ -28,8 +28,8 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
-#include <set>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/sort_key_generator.h"
@@ -126,6 +126,12 @@ private:
     // Collection of working set members to sort with their respective sort key.
     struct SortableDataItem {
         WorkingSetID wsid;
+
+        // The sort key and RecordId encoded as a KeyString, so that items order by memcmp of
+        // their encodings. Empty if the sort pattern has too many fields to be encoded, in which
+        // case 'sortKey' and 'loc' are compared instead.
+        std::string encodedKey;
+
         BSONObj sortKey;
         // Since we must replicate the behavior of a covered sort as much as possible we use the
         // RecordId to break sortKey ties.
@@ -133,10 +139,11 @@ private:
         RecordId loc;
     };
 
-    // Comparison object for data buffers (vector and set).
+    // Comparison object for the data buffer.
     // Items are compared on (sortKey, loc). This is also how the items are
     // ordered in the indices.
-    // Keys are compared using BSONObj::woCompare() with RecordId as a tie-breaker.
+    // Encoded keys are compared with memcmp. Otherwise keys are compared using
+    // BSONObj::woCompare() with RecordId as a tie-breaker.
     struct WorkingSetComparator {
         explicit WorkingSetComparator(BSONObj p);
 
@@ -146,16 +153,14 @@ private:
     };
 
     /**
-     * Inserts one item into data buffer (vector or set).
-     * If limit is exceeded, remove item with lowest key.
+     * Inserts one item into the data buffer.
+     * If limit is exceeded, remove item with highest key.
      */
-    void addToBuffer(const SortableDataItem& item);
+    void addToBuffer(SortableDataItem* item);
 
     /**
      * Sorts data buffer.
      * Assumes no more items will be added to buffer.
-     * If data is stored in set, copy set
-     * contents to vector and clear set.
      */
     void sortBuffer();
 
@@ -163,16 +168,17 @@ private:
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
 
+    // Ordering used to encode sort keys, or empty if the sort pattern has more fields than an
+    // Ordering can describe.
+    std::unique_ptr<Ordering> _sortKeyOrdering;
+
     // The data we buffer and sort.
     // _data will contain sorted data when all data is gathered
     // and sorted.
     // When _limit is greater than 1 and not all data has been gathered from child stage,
-    // _dataSet is used instead to maintain an ordered set of the incomplete data set.
-    // When the data set is complete, we copy the items from _dataSet to _data which will
-    // be used to provide the results of this stage through _resultIterator.
+    // _data is kept as a max-heap of the best _limit items seen so far, so that the worst of
+    // them can be replaced in logarithmic time.
     std::vector<SortableDataItem> _data;
-    typedef std::set<SortableDataItem, WorkingSetComparator> SortableDataItemSet;
-    std::unique_ptr<SortableDataItemSet> _dataSet;
 
     // Iterates through _data post-sort returning it.
     std::vector<SortableDataItem>::iterator _resultIterator;
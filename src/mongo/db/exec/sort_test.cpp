@@ -243,4 +243,28 @@ TEST(SortStageTest, SortDescendingWithLimitOfOne) {
     testWork("{a: -1}", "{}", 1, "{input: [{a: 2}, {a: 1}, {a: 3}]}", "{output: [{a: 3}]}");
 }
 
+//
+// Sorting on keys of mixed types and directions
+// Keys must order as they would in an index on the sort pattern.
+//
+
+TEST(SortStageTest, SortCompoundMixedTypes) {
+    testWork("{a: 1, b: -1}",
+             "{}",
+             0,
+             "{input: [{a: 2, b: 1}, {a: 1.5, b: 2}, {a: 'x', b: 1}, {a: 1, b: 1}, {a: 1, b: 3},"
+             " {b: 4}]}",
+             "{output: [{b: 4}, {a: 1, b: 3}, {a: 1, b: 1}, {a: 1.5, b: 2}, {a: 2, b: 1},"
+             " {a: 'x', b: 1}]}");
+}
+
+TEST(SortStageTest, SortCompoundMixedTypesWithLimit) {
+    testWork("{a: 1, b: -1}",
+             "{}",
+             3,
+             "{input: [{a: 2, b: 1}, {a: 1.5, b: 2}, {a: 'x', b: 1}, {a: 1, b: 1}, {a: 1, b: 3},"
+             " {b: 4}]}",
+             "{output: [{b: 4}, {a: 1, b: 3}, {a: 1, b: 1}]}");
+}
+
 }  // namespace
@@ -32,6 +32,8 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "mongo/base/error_codes.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
@@ -102,15 +105,44 @@ Status IndexAccessMethod::insert(OperationContext* txn,
                                  const RecordId& loc,
                                  const InsertDeleteOptions& options,
                                  int64_t* numInserted) {
+    return insertMany(txn, {std::make_pair(&obj, loc)}, options, numInserted);
+}
+
+Status IndexAccessMethod::insertMany(OperationContext* txn,
+                                     const std::vector<std::pair<const BSONObj*, RecordId>>& docs,
+                                     const InsertDeleteOptions& options,
+                                     int64_t* numInserted) {
     *numInserted = 0;
 
-    BSONObjSet keys;
-    // Delegate to the subclass.
-    getKeys(obj, &keys);
+    std::vector<IndexKeyEntry> entries;
+    bool multikey = false;
+    for (const auto& doc : docs) {
+        BSONObjSet keys;
+        // Delegate to the subclass.
+        getKeys(*doc.first, &keys);
+        multikey = multikey || keys.size() > 1;
+        for (const BSONObj& key : keys) {
+            entries.push_back(IndexKeyEntry(key, doc.second));
+        }
+    }
 
-    Status ret = Status::OK();
-    for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-        Status status = _newInterface->insert(txn, *i, loc, options.dupsAllowed);
+    if (IndexBuildInterceptor* interceptor = _btreeState->indexBuildInterceptor()) {
+        for (const IndexKeyEntry& entry : entries) {
+            interceptor->sideWrite(txn, IndexBuildInterceptor::Op::kInsert, entry.key, entry.loc);
+        }
+        *numInserted = entries.size();
+        if (multikey) {
+            _btreeState->setMultikey(txn);
+        }
+        return Status::OK();
+    }
+
+    if (docs.size() > 1) {
+        std::sort(entries.begin(), entries.end(), IndexEntryComparison(_btreeState->ordering()));
+    }
+
+    for (auto i = entries.begin(); i != entries.end(); ++i) {
+        Status status = _newInterface->insert(txn, i->key, i->loc, options.dupsAllowed);
 
         // Everything's OK, carry on.
         if (status.isOK()) {
@@ -128,25 +160,25 @@ Status IndexAccessMethod::insert(OperationContext* txn,
             // A document might be indexed multiple times during a background index build
             // if it moves ahead of the collection scan cursor (e.g. via an update).
             if (!_btreeState->isReady(txn)) {
-                LOG(3) << "key " << *i << " already in index during background indexing (ok)";
+                LOG(3) << "key " << i->key << " already in index during background indexing (ok)";
                 continue;
             }
         }
 
         // Clean up after ourselves.
-        for (BSONObjSet::const_iterator j = keys.begin(); j != i; ++j) {
-            removeOneKey(txn, *j, loc, options.dupsAllowed);
-            *numInserted = 0;
+        for (auto j = entries.begin(); j != i; ++j) {
+            removeOneKey(txn, j->key, j->loc, options.dupsAllowed);
         }
+        *numInserted = 0;
 
         return status;
     }
 
-    if (*numInserted > 1) {
+    if (multikey) {
         _btreeState->setMultikey(txn);
     }
 
-    return ret;
+    return Status::OK();
 }
 
 void IndexAccessMethod::removeOneKey(OperationContext* txn,
@@ -178,14 +210,41 @@ Status IndexAccessMethod::remove(OperationContext* txn,
     getKeys(obj, &keys);
     *numDeleted = 0;
 
+    IndexBuildInterceptor* interceptor = _btreeState->indexBuildInterceptor();
     for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-        removeOneKey(txn, *i, loc, options.dupsAllowed);
+        if (interceptor) {
+            interceptor->sideWrite(txn, IndexBuildInterceptor::Op::kDelete, *i, loc);
+        } else {
+            removeOneKey(txn, *i, loc, options.dupsAllowed);
+        }
         ++*numDeleted;
     }
 
     return Status::OK();
 }
 
+Status IndexAccessMethod::insertKey(OperationContext* txn,
+                                    const BSONObj& key,
+                                    const RecordId& loc,
+                                    const InsertDeleteOptions& options) {
+    Status status = _newInterface->insert(txn, key, loc, options.dupsAllowed);
+    if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+        return Status::OK();
+    }
+    if (status.code() == ErrorCodes::DuplicateKeyValue && !_btreeState->isReady(txn)) {
+        // The collection scan of the index build already found this key.
+        return Status::OK();
+    }
+    return status;
+}
+
+void IndexAccessMethod::removeKey(OperationContext* txn,
+                                  const BSONObj& key,
+                                  const RecordId& loc,
+                                  const InsertDeleteOptions& options) {
+    removeOneKey(txn, key, loc, options.dupsAllowed);
+}
+
 // Return keys in l that are not in r.
 // Lifted basically verbatim from elsewhere.
 static void setDifference(const BSONObjSet& l, const BSONObjSet& r, vector<BSONObj*>* diff) {
@@ -296,6 +355,19 @@ Status IndexAccessMethod::update(OperationContext* txn,
         _btreeState->setMultikey(txn);
     }
 
+    if (IndexBuildInterceptor* interceptor = _btreeState->indexBuildInterceptor()) {
+        for (size_t i = 0; i < ticket.removed.size(); ++i) {
+            interceptor->sideWrite(
+                txn, IndexBuildInterceptor::Op::kDelete, *ticket.removed[i], ticket.loc);
+        }
+        for (size_t i = 0; i < ticket.added.size(); ++i) {
+            interceptor->sideWrite(
+                txn, IndexBuildInterceptor::Op::kInsert, *ticket.added[i], ticket.loc);
+        }
+        *numUpdated = ticket.added.size();
+        return Status::OK();
+    }
+
     for (size_t i = 0; i < ticket.removed.size(); ++i) {
         _newInterface->unindex(txn, *ticket.removed[i], ticket.loc, ticket.dupsAllowed);
     }
@@ -318,17 +390,21 @@ Status IndexAccessMethod::update(OperationContext* txn,
     return Status::OK();
 }
 
-std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk() {
-    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor));
+const size_t IndexAccessMethod::BulkBuilder::kMaxMemoryUsageBytes;
+
+std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk(
+    size_t maxMemoryUsageBytes) {
+    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor, maxMemoryUsageBytes));
 }
 
 IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
-                                            const IndexDescriptor* descriptor)
+                                            const IndexDescriptor* descriptor,
+                                            size_t maxMemoryUsageBytes)
     : _sorter(Sorter::make(
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(100 * 1024 * 1024),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -354,6 +430,17 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
     return Status::OK();
 }
 
+void IndexAccessMethod::BulkBuilder::merge(std::unique_ptr<BulkBuilder> other) {
+    invariant(other->_real == _real);
+    _keysInserted += other->_keysInserted;
+    _isMultiKey = _isMultiKey || other->_isMultiKey;
+    for (auto&& merged : other->_merged) {
+        _merged.push_back(std::move(merged));
+    }
+    other->_merged.clear();
+    _merged.push_back(std::move(other));
+}
+
 
 Status IndexAccessMethod::commitBulk(OperationContext* txn,
                                      std::unique_ptr<BulkBuilder> bulk,
@@ -363,6 +450,18 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
     Timer timer;
 
     std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    if (!bulk->_merged.empty()) {
+        // Each builder's keys are already sorted, so a k-way merge puts them all in order.
+        std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> iters;
+        iters.emplace_back(i.release());
+        for (auto&& merged : bulk->_merged) {
+            iters.emplace_back(merged->_sorter->done());
+        }
+        i.reset(BulkBuilder::Sorter::Iterator::merge(
+            iters,
+            SortOptions(),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*txn->getClient());
     ProgressMeterHolder pm(*txn->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -73,6 +74,10 @@ public:
      * there is more than one key for 'obj', either all keys will be inserted or none will.
      *
      * The behavior of the insertion can be specified through 'options'.
+     *
+     * While the index has an IndexBuildInterceptor, this and the other mutation methods below
+     * hand the keys to it instead of changing the index, and errors such as KeyTooLong are only
+     * found once they are applied.
      */
     Status insert(OperationContext* txn,
                   const BSONObj& obj,
@@ -80,6 +85,17 @@ public:
                   const InsertDeleteOptions& options,
                   int64_t* numInserted);
 
+    /**
+     * As insert(), for a group of documents and their locations. The keys of the whole group are
+     * generated first and inserted in index order, so that successive inserts land near each
+     * other in the index. 'numInserted' is set to the number of keys added for the group. On
+     * error, none of the group's keys remain in the index.
+     */
+    Status insertMany(OperationContext* txn,
+                      const std::vector<std::pair<const BSONObj*, RecordId>>& docs,
+                      const InsertDeleteOptions& options,
+                      int64_t* numInserted);
+
     /**
      * Analogous to above, but remove the records instead of inserting them.  If not NULL,
      * numDeleted will be set to the number of keys removed from the index for the document.
@@ -118,6 +134,19 @@ public:
      */
     Status update(OperationContext* txn, const UpdateTicket& ticket, int64_t* numUpdated);
 
+    /**
+     * Inserts or removes a single key for 'loc'. Used to apply the writes recorded by an
+     * IndexBuildInterceptor, and so never intercepted themselves.
+     */
+    Status insertKey(OperationContext* txn,
+                     const BSONObj& key,
+                     const RecordId& loc,
+                     const InsertDeleteOptions& options);
+    void removeKey(OperationContext* txn,
+                   const BSONObj& key,
+                   const RecordId& loc,
+                   const InsertDeleteOptions& options);
+
     /**
      * Returns an unpositioned cursor over 'this' index.
      */
@@ -184,6 +213,9 @@ public:
 
     class BulkBuilder {
     public:
+        // The default bound on the memory used to sort keys before spilling them to disk.
+        static const size_t kMaxMemoryUsageBytes = 100 * 1024 * 1024;
+
         /**
          * Insert into the BulkBuilder as-if inserting into an IndexAccessMethod.
          */
@@ -193,17 +225,29 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Takes the keys gathered by 'other', which must be building the same index, so that
+         * commitBulk merges them with the keys inserted here. This lets several threads
+         * gather keys for one index, each with its own BulkBuilder.
+         */
+        void merge(std::unique_ptr<BulkBuilder> other);
+
     private:
         friend class IndexAccessMethod;
 
         using Sorter = mongo::Sorter<BSONObj, RecordId>;
 
-        BulkBuilder(const IndexAccessMethod* index, const IndexDescriptor* descriptor);
+        BulkBuilder(const IndexAccessMethod* index,
+                    const IndexDescriptor* descriptor,
+                    size_t maxMemoryUsageBytes);
 
         std::unique_ptr<Sorter> _sorter;
         const IndexAccessMethod* _real;
         int64_t _keysInserted = 0;
         bool _isMultiKey = false;
+
+        // Builders passed to merge(). Their sorters are only read in commitBulk.
+        std::vector<std::unique_ptr<BulkBuilder>> _merged;
     };
 
     /**
@@ -212,8 +256,11 @@ public:
      * This can return NULL, meaning bulk mode is not available.
      *
      * It is only legal to initiate bulk when the index is new and empty.
+     *
+     * @param maxMemoryUsageBytes - memory for sorting keys, beyond which they spill to disk
      */
-    std::unique_ptr<BulkBuilder> initiateBulk();
+    std::unique_ptr<BulkBuilder> initiateBulk(
+        size_t maxMemoryUsageBytes = BulkBuilder::kMaxMemoryUsageBytes);
 
     /**
      * Call this when you are ready to finish your bulk work.
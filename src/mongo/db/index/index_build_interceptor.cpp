@@ -0,0 +1,145 @@
+/**
+*    Copyright (C) 2015 MongoDB Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kIndex
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_build_interceptor.h"
+
+#include <vector>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+/**
+ * Marks a side write as committed or rolled back along with the unit of work that made it.
+ */
+class IndexBuildInterceptor::SideWriteChange : public RecoveryUnit::Change {
+public:
+    SideWriteChange(IndexBuildInterceptor* interceptor, uint64_t seq)
+        : _interceptor(interceptor), _seq(seq) {}
+
+    virtual void commit() {
+        _interceptor->_finish(_seq, State::kCommitted);
+    }
+
+    virtual void rollback() {
+        _interceptor->_finish(_seq, State::kRolledBack);
+    }
+
+private:
+    IndexBuildInterceptor* const _interceptor;
+    const uint64_t _seq;
+};
+
+const size_t IndexBuildInterceptor::kDrainBatchSize;
+
+void IndexBuildInterceptor::sideWrite(OperationContext* txn,
+                                      Op op,
+                                      const BSONObj& key,
+                                      const RecordId& loc) {
+    uint64_t seq;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        seq = _firstSeq + _writes.size();
+        _writes.push_back(SideWrite{op, key.getOwned(), loc, State::kInProgress});
+    }
+    txn->recoveryUnit()->registerChange(new SideWriteChange(this, seq));
+}
+
+void IndexBuildInterceptor::_finish(uint64_t seq, State state) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    // Writes in progress are never removed, so this one is still here.
+    invariant(seq >= _firstSeq && seq - _firstSeq < _writes.size());
+    _writes[seq - _firstSeq].state = state;
+}
+
+Status IndexBuildInterceptor::drainWritesIntoIndex(OperationContext* txn,
+                                                   IndexAccessMethod* index,
+                                                   const InsertDeleteOptions& options,
+                                                   bool mayInterrupt) {
+    while (true) {
+        if (mayInterrupt) {
+            txn->checkForInterrupt();
+        }
+
+        std::vector<SideWrite> batch;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            while (batch.size() < kDrainBatchSize && !_writes.empty() &&
+                   _writes.front().state != State::kInProgress) {
+                if (_writes.front().state == State::kCommitted) {
+                    batch.push_back(std::move(_writes.front()));
+                }
+                _writes.pop_front();
+                _firstSeq++;
+            }
+        }
+
+        if (batch.empty()) {
+            return Status::OK();
+        }
+
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            WriteUnitOfWork wunit(txn);
+            for (const SideWrite& write : batch) {
+                if (write.op == Op::kInsert) {
+                    Status status = index->insertKey(txn, write.key, write.loc, options);
+                    if (!status.isOK()) {
+                        return status;
+                    }
+                } else {
+                    index->removeKey(txn, write.key, write.loc, options);
+                }
+            }
+            wunit.commit();
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "applying index build side writes", "");
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _applied += batch.size();
+    }
+}
+
+size_t IndexBuildInterceptor::numPending() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _writes.size();
+}
+
+long long IndexBuildInterceptor::numApplied() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _applied;
+}
+
+}  // namespace mongo
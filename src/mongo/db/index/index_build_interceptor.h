@@ -0,0 +1,109 @@
+/**
+*    Copyright (C) 2015 MongoDB Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <deque>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class IndexAccessMethod;
+class OperationContext;
+struct InsertDeleteOptions;
+
+/**
+ * Records the writes made to an index while a hybrid background build bulk loads it, so that
+ * they can be applied once loading is done. While an index has one, IndexAccessMethod passes
+ * the keys being inserted and removed to it rather than writing them to the index.
+ *
+ * Writes are kept in the order they were made, and only applied once the unit of work that made
+ * them commits. Writes rolled back are dropped.
+ */
+class IndexBuildInterceptor {
+    MONGO_DISALLOW_COPYING(IndexBuildInterceptor);
+
+public:
+    enum class Op { kInsert, kDelete };
+
+    IndexBuildInterceptor() = default;
+
+    /**
+     * Records that 'key' is being inserted into or removed from the index for 'loc', by the unit
+     * of work open on 'txn'.
+     */
+    void sideWrite(OperationContext* txn, Op op, const BSONObj& key, const RecordId& loc);
+
+    /**
+     * Applies the recorded writes to 'index' in the order they were made, and forgets them.
+     * Stops at the first write whose unit of work is still open. With an exclusive lock on the
+     * collection there are no such writes, so every recorded write is applied.
+     */
+    Status drainWritesIntoIndex(OperationContext* txn,
+                                IndexAccessMethod* index,
+                                const InsertDeleteOptions& options,
+                                bool mayInterrupt);
+
+    /**
+     * Returns the number of writes recorded but not yet applied or dropped.
+     */
+    size_t numPending() const;
+
+    long long numApplied() const;
+
+private:
+    class SideWriteChange;
+
+    enum class State { kInProgress, kCommitted, kRolledBack };
+
+    struct SideWrite {
+        Op op;
+        BSONObj key;
+        RecordId loc;
+        State state;
+    };
+
+    void _finish(uint64_t seq, State state);
+
+    // The most writes applied in one WriteUnitOfWork.
+    static const size_t kDrainBatchSize = 1000;
+
+    // Protects the members below.
+    mutable stdx::mutex _mutex;
+
+    std::deque<SideWrite> _writes;
+    uint64_t _firstSeq = 0;  // Of _writes.front(), counting every write ever recorded.
+    long long _applied = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,298 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_build_interceptor.h"
+
+#include <vector>
+
+#include "mongo/db/catalog/collection_catalog_entry.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
+#include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const char* const kNs = "test.interceptor";
+const char* const kIndexName = "a_1";
+
+/**
+ * Just enough of a catalog for an IndexCatalogEntry over an index that is still being built.
+ */
+class CollectionCatalogEntryMock : public CollectionCatalogEntry {
+public:
+    CollectionCatalogEntryMock() : CollectionCatalogEntry(kNs) {}
+
+    CollectionOptions getCollectionOptions(OperationContext* txn) const {
+        return CollectionOptions();
+    }
+    int getTotalIndexCount(OperationContext* txn) const {
+        return 1;
+    }
+    int getCompletedIndexCount(OperationContext* txn) const {
+        return 0;
+    }
+    int getMaxAllowedIndexes() const {
+        return 64;
+    }
+    void getAllIndexes(OperationContext* txn, std::vector<std::string>* names) const {
+        names->push_back(kIndexName);
+    }
+    BSONObj getIndexSpec(OperationContext* txn, StringData idxName) const {
+        invariant(false);
+    }
+    bool isIndexMultikey(OperationContext* txn, StringData indexName) const {
+        return false;
+    }
+    bool setIndexIsMultikey(OperationContext* txn, StringData indexName, bool multikey) {
+        return true;
+    }
+    RecordId getIndexHead(OperationContext* txn, StringData indexName) const {
+        return RecordId();
+    }
+    void setIndexHead(OperationContext* txn, StringData indexName, const RecordId& newHead) {}
+    bool isIndexReady(OperationContext* txn, StringData indexName) const {
+        return false;
+    }
+    Status removeIndex(OperationContext* txn, StringData indexName) {
+        invariant(false);
+    }
+    Status prepareForIndexBuild(OperationContext* txn, const IndexDescriptor* spec) {
+        invariant(false);
+    }
+    void indexBuildSuccess(OperationContext* txn, StringData indexName) {
+        invariant(false);
+    }
+    void updateTTLSetting(OperationContext* txn, StringData idxName, long long newExpireSeconds) {
+        invariant(false);
+    }
+    void updateFlags(OperationContext* txn, int newValue) {
+        invariant(false);
+    }
+    void updateValidator(OperationContext* txn,
+                         const BSONObj& validator,
+                         StringData validationLevel,
+                         StringData validationAction) {
+        invariant(false);
+    }
+};
+
+/**
+ * An unready index on {a: 1}, kept in an in-memory btree, with an interceptor to drain into it.
+ */
+class IndexBuildInterceptorTest : public unittest::Test {
+public:
+    IndexBuildInterceptorTest()
+        : _entry(kNs,
+                 &_collection,
+                 new IndexDescriptor(NULL,
+                                     "",
+                                     BSON("v" << 1 << "key" << BSON("a" << 1) << "name"
+                                              << kIndexName << "ns" << kNs)),
+                 NULL) {
+        _sorted = getInMemoryBtreeImpl(Ordering::make(BSON("a" << 1)), &_data);
+        OperationContextNoop txn(new InMemoryRecoveryUnit());
+        _entry.init(&txn, new BtreeAccessMethod(&_entry, _sorted));
+    }
+
+protected:
+    std::unique_ptr<OperationContext> newTxn() {
+        return stdx::make_unique<OperationContextNoop>(new InMemoryRecoveryUnit());
+    }
+
+    /**
+     * Loads an entry straight into the index, as the bulk load of the collection scan would.
+     */
+    void bulkLoaded(int a, const RecordId& loc) {
+        auto txn = newTxn();
+        WriteUnitOfWork wunit(txn.get());
+        ASSERT_OK(_sorted->insert(txn.get(), key(a), loc, true));
+        wunit.commit();
+    }
+
+    void sideWrite(OperationContext* txn,
+                   IndexBuildInterceptor::Op op,
+                   int a,
+                   const RecordId& loc) {
+        _interceptor.sideWrite(txn, op, key(a), loc);
+    }
+
+    /**
+     * Records one side write in a unit of work of its own, which commits.
+     */
+    void committedSideWrite(IndexBuildInterceptor::Op op, int a, const RecordId& loc) {
+        auto txn = newTxn();
+        WriteUnitOfWork wunit(txn.get());
+        sideWrite(txn.get(), op, a, loc);
+        wunit.commit();
+    }
+
+    Status drain() {
+        auto txn = newTxn();
+        InsertDeleteOptions options;
+        options.dupsAllowed = true;
+        return _interceptor.drainWritesIntoIndex(txn.get(), _entry.accessMethod(), options, false);
+    }
+
+    std::vector<IndexKeyEntry> indexEntries() {
+        auto txn = newTxn();
+        std::vector<IndexKeyEntry> entries;
+        auto cursor = _sorted->newCursor(txn.get());
+        for (auto entry = cursor->seek(BSON("" << MINKEY), true); entry; entry = cursor->next()) {
+            entries.push_back(*entry);
+        }
+        return entries;
+    }
+
+    static BSONObj key(int a) {
+        return BSON("" << a);
+    }
+
+    IndexBuildInterceptor _interceptor;
+
+private:
+    CollectionCatalogEntryMock _collection;
+    std::shared_ptr<void> _data;
+    SortedDataInterface* _sorted;  // Owned by the access method of _entry.
+    IndexCatalogEntry _entry;
+};
+
+TEST_F(IndexBuildInterceptorTest, InsertThenDeleteLeavesNoEntry) {
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 1, RecordId(1));
+    committedSideWrite(IndexBuildInterceptor::Op::kDelete, 1, RecordId(1));
+    ASSERT_EQUALS(2U, _interceptor.numPending());
+    ASSERT_TRUE(indexEntries().empty());
+
+    ASSERT_OK(drain());
+    ASSERT_EQUALS(0U, _interceptor.numPending());
+    ASSERT_EQUALS(2, _interceptor.numApplied());
+    ASSERT_TRUE(indexEntries().empty());
+}
+
+TEST_F(IndexBuildInterceptorTest, DeleteThenInsertLeavesEntry) {
+    // The collection scan already loaded the key that the writes remove and then put back.
+    bulkLoaded(1, RecordId(1));
+    committedSideWrite(IndexBuildInterceptor::Op::kDelete, 1, RecordId(1));
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 1, RecordId(1));
+
+    ASSERT_OK(drain());
+    std::vector<IndexKeyEntry> entries = indexEntries();
+    ASSERT_EQUALS(1U, entries.size());
+    ASSERT_EQUALS(key(1), entries[0].key);
+    ASSERT_EQUALS(RecordId(1), entries[0].loc);
+}
+
+TEST_F(IndexBuildInterceptorTest, LastWriteWinsPerKeyAndRecordId) {
+    bulkLoaded(1, RecordId(1));
+    bulkLoaded(1, RecordId(2));
+    committedSideWrite(IndexBuildInterceptor::Op::kDelete, 1, RecordId(1));
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 2, RecordId(2));
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 1, RecordId(3));
+    committedSideWrite(IndexBuildInterceptor::Op::kDelete, 2, RecordId(2));
+    committedSideWrite(IndexBuildInterceptor::Op::kDelete, 1, RecordId(3));
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 1, RecordId(3));
+
+    ASSERT_OK(drain());
+    std::vector<IndexKeyEntry> entries = indexEntries();
+    ASSERT_EQUALS(2U, entries.size());
+    ASSERT_EQUALS(key(1), entries[0].key);
+    ASSERT_EQUALS(RecordId(2), entries[0].loc);
+    ASSERT_EQUALS(key(1), entries[1].key);
+    ASSERT_EQUALS(RecordId(3), entries[1].loc);
+}
+
+TEST_F(IndexBuildInterceptorTest, RolledBackWritesAreDropped) {
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 1, RecordId(1));
+    {
+        auto txn = newTxn();
+        WriteUnitOfWork wunit(txn.get());
+        sideWrite(txn.get(), IndexBuildInterceptor::Op::kInsert, 2, RecordId(2));
+        sideWrite(txn.get(), IndexBuildInterceptor::Op::kDelete, 1, RecordId(1));
+    }
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 3, RecordId(3));
+    ASSERT_EQUALS(4U, _interceptor.numPending());
+
+    ASSERT_OK(drain());
+    ASSERT_EQUALS(0U, _interceptor.numPending());
+    ASSERT_EQUALS(2, _interceptor.numApplied());
+    std::vector<IndexKeyEntry> entries = indexEntries();
+    ASSERT_EQUALS(2U, entries.size());
+    ASSERT_EQUALS(key(1), entries[0].key);
+    ASSERT_EQUALS(key(3), entries[1].key);
+}
+
+TEST_F(IndexBuildInterceptorTest, DrainStopsAtWriteStillInProgress) {
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 1, RecordId(1));
+
+    auto txn = newTxn();
+    std::unique_ptr<WriteUnitOfWork> wunit(new WriteUnitOfWork(txn.get()));
+    sideWrite(txn.get(), IndexBuildInterceptor::Op::kInsert, 2, RecordId(2));
+    committedSideWrite(IndexBuildInterceptor::Op::kInsert, 3, RecordId(3));
+
+    // Only the write ahead of the open unit of work can be applied.
+    ASSERT_OK(drain());
+    ASSERT_EQUALS(2U, _interceptor.numPending());
+    ASSERT_EQUALS(1U, indexEntries().size());
+
+    wunit->commit();
+    wunit.reset();
+    ASSERT_OK(drain());
+    ASSERT_EQUALS(0U, _interceptor.numPending());
+    ASSERT_EQUALS(3U, indexEntries().size());
+}
+
+TEST_F(IndexBuildInterceptorTest, DrainsInBatches) {
+    // More than one batch, with the writes to each RecordId split across batch boundaries.
+    const int kRecords = 1500;
+    for (int i = 0; i < kRecords; i++) {
+        committedSideWrite(IndexBuildInterceptor::Op::kInsert, i, RecordId(i + 1));
+    }
+    for (int i = 0; i < kRecords; i += 2) {
+        committedSideWrite(IndexBuildInterceptor::Op::kDelete, i, RecordId(i + 1));
+    }
+
+    ASSERT_OK(drain());
+    ASSERT_EQUALS(0U, _interceptor.numPending());
+    ASSERT_EQUALS(kRecords + kRecords / 2, _interceptor.numApplied());
+    std::vector<IndexKeyEntry> entries = indexEntries();
+    ASSERT_EQUALS(static_cast<size_t>(kRecords / 2), entries.size());
+    for (int i = 0; i < kRecords / 2; i++) {
+        ASSERT_EQUALS(key(2 * i + 1), entries[i].key);
+        ASSERT_EQUALS(RecordId(2 * i + 2), entries[i].loc);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
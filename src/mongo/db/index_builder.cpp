@@ -188,6 +188,10 @@ Status IndexBuilder::_build(OperationContext* txn,
                     if (allowBackgroundBuilding) {
                         dbLock->relockWithMode(MODE_X);
                     }
+                    status = indexer.drainBackgroundWrites();
+                }
+
+                if (status.isOK()) {
                     WriteUnitOfWork wunit(txn);
                     indexer.commit();
                     wunit.commit();
@@ -0,0 +1,247 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_compiled.h"
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+std::unique_ptr<CompiledMatchExpression> CompiledMatchExpression::compile(
+    const MatchExpression* root) {
+    invariant(root);
+    std::unique_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression(root));
+    if (compiled->_numCompiledLeaves == 0) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+CompiledMatchExpression::CompiledMatchExpression(const MatchExpression* root)
+    : _root(root), _nodes(1) {
+    _compile(root);
+    _slots.resize(_numSlots);
+    _visited.resize(_nodes.size());
+}
+
+void CompiledMatchExpression::_compile(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+            _compileList(expr, OpCode::kJumpIfFalse, true);
+            return;
+        case MatchExpression::OR:
+            _compileList(expr, OpCode::kJumpIfTrue, false);
+            return;
+        case MatchExpression::NOR:
+            _compileList(expr, OpCode::kJumpIfTrue, false);
+            _program.push_back({OpCode::kNot, nullptr, 0});
+            return;
+        case MatchExpression::NOT:
+            _compile(expr->getChild(0));
+            _program.push_back({OpCode::kNot, nullptr, 0});
+            return;
+
+        // These leaves all match through LeafMatchExpression::matches(), which only calls
+        // matchesSingleElement() on the elements of their path.
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+            if (_compileLeaf(expr)) {
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    _program.push_back({OpCode::kTree, expr, 0});
+}
+
+void CompiledMatchExpression::_compileList(const MatchExpression* expr,
+                                           OpCode shortCircuit,
+                                           bool emptyResult) {
+    const size_t numChildren = expr->numChildren();
+    if (numChildren == 0) {
+        _program.push_back({OpCode::kConst, nullptr, emptyResult});
+        return;
+    }
+
+    // Every child but the last jumps past the list once its result decides the list's.
+    std::vector<size_t> jumps;
+    for (size_t i = 0; i < numChildren; ++i) {
+        _compile(expr->getChild(i));
+        if (i + 1 < numChildren) {
+            jumps.push_back(_program.size());
+            _program.push_back({shortCircuit, nullptr, 0});
+        }
+    }
+
+    for (size_t jump : jumps) {
+        _program[jump].arg = _program.size();
+    }
+}
+
+bool CompiledMatchExpression::_compileLeaf(const MatchExpression* expr) {
+    const StringData path = expr->path();
+    if (path.empty() || path[0] == '.' || path[path.size() - 1] == '.' ||
+        path.find("..") != std::string::npos) {
+        return false;
+    }
+
+    _program.push_back({OpCode::kLeaf, expr, _slotForPath(path)});
+    ++_numCompiledLeaves;
+    return true;
+}
+
+size_t CompiledMatchExpression::_slotForPath(StringData path) {
+    size_t nodeIndex = 0;
+    while (!path.empty()) {
+        const size_t dot = path.find('.');
+        const StringData part = path.substr(0, dot);
+        path = (dot == std::string::npos) ? StringData() : path.substr(dot + 1);
+
+        size_t childIndex = 0;
+        for (const auto& child : _nodes[nodeIndex].children) {
+            if (part == child.first) {
+                childIndex = child.second;
+                break;
+            }
+        }
+
+        if (childIndex == 0) {
+            childIndex = _nodes.size();
+            _nodes[nodeIndex].children.push_back(std::make_pair(part.toString(), childIndex));
+            _nodes.push_back(PathNode());
+        }
+        nodeIndex = childIndex;
+    }
+
+    PathNode& node = _nodes[nodeIndex];
+    if (node.slot < 0) {
+        node.slot = _numSlots++;
+    }
+    return node.slot;
+}
+
+bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) const {
+    std::fill(_slots.begin(), _slots.end(), BSONElement());
+    std::fill(_visited.begin(), _visited.end(), false);
+
+    if (!_resolve(doc, 0)) {
+        return _root->matchesBSON(doc, NULL);
+    }
+    return _run(doc);
+}
+
+bool CompiledMatchExpression::_resolve(const BSONObj& obj, size_t nodeIndex) const {
+    const auto& children = _nodes[nodeIndex].children;
+    size_t remaining = children.size();
+
+    BSONObjIterator it(obj);
+    while (remaining > 0 && it.more()) {
+        const BSONElement elt = it.next();
+        const StringData fieldName = elt.fieldNameStringData();
+
+        for (const auto& child : children) {
+            // Like BSONObj::getField(), only the first field with a given name counts.
+            if (fieldName != child.first || _visited[child.second]) {
+                continue;
+            }
+            _visited[child.second] = true;
+            --remaining;
+
+            if (elt.type() == Array) {
+                return false;
+            }
+
+            const PathNode& childNode = _nodes[child.second];
+            if (childNode.slot >= 0) {
+                _slots[childNode.slot] = elt;
+            }
+
+            // A path through a scalar resolves to EOO, which the slots already hold.
+            if (!childNode.children.empty() && elt.type() == Object &&
+                !_resolve(elt.Obj(), child.second)) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CompiledMatchExpression::_run(const BSONObj& doc) const {
+    bool result = true;
+    size_t pc = 0;
+    const size_t end = _program.size();
+    while (pc < end) {
+        const Instruction& instruction = _program[pc++];
+        switch (instruction.op) {
+            case OpCode::kLeaf:
+                result = instruction.expr->matchesSingleElement(_slots[instruction.arg]);
+                break;
+            case OpCode::kTree:
+                result = instruction.expr->matchesBSON(doc, NULL);
+                break;
+            case OpCode::kConst:
+                result = instruction.arg;
+                break;
+            case OpCode::kNot:
+                result = !result;
+                break;
+            case OpCode::kJumpIfFalse:
+                if (!result) {
+                    pc = instruction.arg;
+                }
+                break;
+            case OpCode::kJumpIfTrue:
+                if (result) {
+                    pc = instruction.arg;
+                }
+                break;
+        }
+    }
+    return result;
+}
+
+}  // namespace mongo
@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+class BSONObj;
+
+/**
+ * A MatchExpression flattened into a straight-line program.
+ *
+ * Every leaf path in the expression is put in a trie, so a document is walked once per match to
+ * find the elements of all of the paths, however many predicates share them. The program then
+ * evaluates each leaf's matchesSingleElement() against its resolved element, and $and, $or, $nor
+ * and $not become jumps and negations over a single boolean register instead of virtual calls
+ * down the tree.
+ *
+ * Paths are only resolved this way while they see no arrays. A document with an array anywhere
+ * along a compiled path is matched with the original tree, which keeps the array semantics of
+ * BSONElementIterator. Expressions without a compiled form ($where, $elemMatch, geo, ...) are
+ * evaluated with matchesBSON() from inside the program.
+ *
+ * The compiled form refers to the nodes of the MatchExpression it was built from, which must
+ * outlive it and must not be changed. Matching uses scratch space in the object, so an instance
+ * must not be used by more than one thread at a time.
+ */
+class CompiledMatchExpression {
+    MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+
+public:
+    /**
+     * Returns the compiled form of 'root', or nullptr if it has no leaves that could be compiled
+     * and would gain nothing from it.
+     */
+    static std::unique_ptr<CompiledMatchExpression> compile(const MatchExpression* root);
+
+    /**
+     * Returns the same result as _root->matchesBSON(doc, NULL).
+     */
+    bool matchesBSON(const BSONObj& doc) const;
+
+    /**
+     * Number of distinct leaf paths resolved by the document walk.
+     */
+    size_t numPaths() const {
+        return _numSlots;
+    }
+
+private:
+    enum class OpCode {
+        // result = expr->matchesSingleElement(slots[arg])
+        kLeaf,
+        // result = expr->matchesBSON(doc)
+        kTree,
+        // result = arg
+        kConst,
+        // result = !result
+        kNot,
+        // if (!result) jump to arg
+        kJumpIfFalse,
+        // if (result) jump to arg
+        kJumpIfTrue,
+    };
+
+    struct Instruction {
+        OpCode op;
+        const MatchExpression* expr;
+        size_t arg;
+    };
+
+    struct PathNode {
+        // Field name and index into _nodes of each child.
+        std::vector<std::pair<std::string, size_t>> children;
+
+        // Index into _slots of the element at this path, or -1 if no leaf uses this path.
+        int slot = -1;
+    };
+
+    explicit CompiledMatchExpression(const MatchExpression* root);
+
+    void _compile(const MatchExpression* expr);
+    void _compileList(const MatchExpression* expr, OpCode shortCircuit, bool emptyResult);
+    bool _compileLeaf(const MatchExpression* expr);
+    size_t _slotForPath(StringData path);
+
+    /**
+     * Stores into _slots the elements 'obj' holds for the paths below _nodes[nodeIndex]. Returns
+     * false if an array was found along one of them.
+     */
+    bool _resolve(const BSONObj& obj, size_t nodeIndex) const;
+
+    bool _run(const BSONObj& doc) const;
+
+    const MatchExpression* const _root;
+
+    std::vector<Instruction> _program;
+    size_t _numCompiledLeaves = 0;
+
+    // _nodes[0] is the root of the path trie.
+    std::vector<PathNode> _nodes;
+    size_t _numSlots = 0;
+
+    // Scratch space for matchesBSON().
+    mutable std::vector<BSONElement> _slots;
+    mutable std::vector<bool> _visited;
+};
+
+}  // namespace mongo
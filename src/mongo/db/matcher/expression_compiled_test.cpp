@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_compiled.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using std::unique_ptr;
+
+unique_ptr<MatchExpression> parse(const BSONObj& query) {
+    StatusWithMatchExpression status = MatchExpressionParser::parse(query);
+    ASSERT_OK(status.getStatus());
+    return std::move(status.getValue());
+}
+
+/**
+ * Asserts that the compiled form of 'query' agrees with the MatchExpression tree on every one
+ * of 'docs'.
+ */
+void assertMatchesLikeTree(const char* query, const std::vector<BSONObj>& docs) {
+    const BSONObj queryObj = fromjson(query);
+    unique_ptr<MatchExpression> expr = parse(queryObj);
+    unique_ptr<CompiledMatchExpression> compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled) << query;
+
+    for (const auto& doc : docs) {
+        ASSERT_EQUALS(expr->matchesBSON(doc, NULL), compiled->matchesBSON(doc))
+            << query << " on " << doc;
+    }
+}
+
+std::vector<BSONObj> testDocuments() {
+    const char* docs[] = {
+        "{}",
+        "{a: 1}",
+        "{a: 5, b: 'x'}",
+        "{a: null, b: 2}",
+        "{a: {b: 1, c: 2}}",
+        "{a: {b: 5}, d: 3}",
+        "{a: {b: {c: 1}}}",
+        "{a: 'string', b: {c: 4}}",
+        "{a: [1, 2, 3]}",
+        "{a: [{b: 1}, {b: 5}]}",
+        "{a: {b: [1, 7]}}",
+        "{a: 3, a: 10}",
+        "{a: {'0': 4}}",
+        "{b: 3, c: 4, d: 5, e: 6}",
+        "{a: 2, b: 3, c: 4, d: 5, e: 6, f: 'abc'}",
+    };
+
+    std::vector<BSONObj> result;
+    for (const char* doc : docs) {
+        result.push_back(fromjson(doc));
+    }
+    return result;
+}
+
+TEST(CompiledMatchExpressionTest, ComparisonLeaves) {
+    const std::vector<BSONObj> docs = testDocuments();
+    assertMatchesLikeTree("{a: 1}", docs);
+    assertMatchesLikeTree("{a: null}", docs);
+    assertMatchesLikeTree("{a: {$gt: 2}}", docs);
+    assertMatchesLikeTree("{a: {$gte: 2, $lt: 6}}", docs);
+    assertMatchesLikeTree("{a: {$lte: 'z'}}", docs);
+    assertMatchesLikeTree("{a: {$in: [1, 5, null]}}", docs);
+    assertMatchesLikeTree("{a: {$exists: true}}", docs);
+    assertMatchesLikeTree("{a: {$exists: false}}", docs);
+    assertMatchesLikeTree("{a: {$mod: [2, 1]}}", docs);
+    assertMatchesLikeTree("{f: /^ab/}", docs);
+    assertMatchesLikeTree("{a: {$bitsAllSet: 1}}", docs);
+}
+
+TEST(CompiledMatchExpressionTest, DottedPaths) {
+    const std::vector<BSONObj> docs = testDocuments();
+    assertMatchesLikeTree("{'a.b': 1}", docs);
+    assertMatchesLikeTree("{'a.b': null}", docs);
+    assertMatchesLikeTree("{'a.b': {$gt: 2}}", docs);
+    assertMatchesLikeTree("{'a.b.c': 1}", docs);
+    assertMatchesLikeTree("{'a.0': 4}", docs);
+    assertMatchesLikeTree("{a: {b: 1, c: 2}, 'a.b': 1, 'a.c': {$gte: 2}}", docs);
+    assertMatchesLikeTree("{'b.c': {$exists: true}, 'a.b': {$exists: false}}", docs);
+}
+
+TEST(CompiledMatchExpressionTest, LogicalOperators) {
+    const std::vector<BSONObj> docs = testDocuments();
+    assertMatchesLikeTree("{$and: [{a: {$gt: 1}}, {b: {$exists: true}}]}", docs);
+    assertMatchesLikeTree("{$or: [{a: 1}, {b: 2}, {'a.b': 5}]}", docs);
+    assertMatchesLikeTree("{$nor: [{a: 1}, {b: 2}]}", docs);
+    assertMatchesLikeTree("{a: {$not: {$gt: 2}}}", docs);
+    assertMatchesLikeTree("{a: {$nin: [1, 5]}}", docs);
+    assertMatchesLikeTree("{a: {$ne: null}, $or: [{c: 4}, {$nor: [{d: 3}, {'b.c': 4}]}]}", docs);
+    assertMatchesLikeTree(
+        "{a: {$gte: 0}, b: {$gte: 0}, c: {$gte: 0}, d: {$gte: 0}, e: {$gte: 0}, f: {$gte: ''},"
+        " 'a.b': {$exists: false}, $or: [{c: 4}, {d: 4}], $nor: [{e: 7}]}",
+        docs);
+}
+
+TEST(CompiledMatchExpressionTest, UncompiledSubexpressions) {
+    const std::vector<BSONObj> docs = testDocuments();
+    assertMatchesLikeTree("{a: {$type: 2}, b: {$exists: true}}", docs);
+    assertMatchesLikeTree("{a: {$elemMatch: {b: 5}}, d: {$ne: 1}}", docs);
+    assertMatchesLikeTree("{$or: [{a: {$size: 3}}, {b: 'x'}]}", docs);
+}
+
+TEST(CompiledMatchExpressionTest, SharedPathsResolvedOnce) {
+    const BSONObj query =
+        fromjson("{a: {$gt: 1, $lt: 10}, 'a.b': 1, 'a.c': 2, $or: [{a: 3}, {'a.b': 4}]}");
+    unique_ptr<MatchExpression> expr = parse(query);
+    unique_ptr<CompiledMatchExpression> compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQUALS(3U, compiled->numPaths());
+}
+
+TEST(CompiledMatchExpressionTest, NothingToCompile) {
+    const BSONObj query = fromjson("{a: {$size: 1}}");
+    unique_ptr<MatchExpression> expr = parse(query);
+    ASSERT(!CompiledMatchExpression::compile(expr.get()));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -59,4 +59,24 @@ Factory Accumulator::getFactory(StringData name) {
     return it->second;
 }
 
+bool NumericColumn::append(const Value& input) {
+    switch (input.getType()) {
+        case NumberInt:
+        case NumberLong: {
+            const long long value = input.getLong();
+            _types.push_back(input.getType());
+            _longs.push_back(value);
+            _doubles.push_back(value);
+            return true;
+        }
+        case NumberDouble:
+            _types.push_back(NumberDouble);
+            _longs.push_back(0);
+            _doubles.push_back(input.getDouble());
+            return true;
+        default:
+            return false;
+    }
+}
+
 }  // namespace mongo
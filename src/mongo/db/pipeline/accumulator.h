@@ -54,6 +54,67 @@ namespace mongo {
         return Status::OK();                                                   \
     }
 
+/**
+ * A view over a run of numeric inputs to a single accumulator, in input order. Every row is a
+ * NumberInt, NumberLong or NumberDouble; 'longs' holds the value of integral rows and 0 for
+ * doubles, while 'doubles' holds the value of every row converted to double.
+ */
+struct NumericBatch {
+    const BSONType* types;
+    const long long* longs;
+    const double* doubles;
+    size_t size;
+
+    /** Reconstructs the Value that row 'i' was built from. */
+    Value getValue(size_t i) const {
+        switch (types[i]) {
+            case NumberInt:
+                return Value(static_cast<int>(longs[i]));
+            case NumberLong:
+                return Value(longs[i]);
+            default:
+                return Value(doubles[i]);
+        }
+    }
+};
+
+/**
+ * Owns the arrays viewed by a NumericBatch. Only numeric() Values can be stored.
+ */
+class NumericColumn {
+public:
+    /** Appends 'input' and returns true if it is numeric(), otherwise returns false. */
+    bool append(const Value& input);
+
+    /** Appends row 'row' of 'other'. */
+    void append(const NumericColumn& other, size_t row) {
+        _types.push_back(other._types[row]);
+        _longs.push_back(other._longs[row]);
+        _doubles.push_back(other._doubles[row]);
+    }
+
+    /** Returns a view of rows [begin, end). */
+    NumericBatch slice(size_t begin, size_t end) const {
+        dassert(begin <= end && end <= size());
+        return {_types.data() + begin, _longs.data() + begin, _doubles.data() + begin, end - begin};
+    }
+
+    size_t size() const {
+        return _types.size();
+    }
+
+    void clear() {
+        _types.clear();
+        _longs.clear();
+        _doubles.clear();
+    }
+
+private:
+    std::vector<BSONType> _types;
+    std::vector<long long> _longs;
+    std::vector<double> _doubles;
+};
+
 class Accumulator : public RefCountable {
 public:
     using Factory = boost::intrusive_ptr<Accumulator>(*)();
@@ -103,6 +164,33 @@ public:
         return false;
     }
 
+    /**
+     * Returns true if non-merging input can be fed through processNumericBatch(). Callers that do
+     * so must skip inputs for which ignoresInput() is true, and must use process() for inputs
+     * that are neither numeric nor ignored.
+     */
+    virtual bool supportsNumericBatch() const {
+        return false;
+    }
+
+    /**
+     * Returns true if 'input' has no effect on the result, so batch callers may drop it. Only
+     * meaningful when supportsNumericBatch() is true.
+     */
+    virtual bool ignoresInput(const Value& input) const {
+        return false;
+    }
+
+    /**
+     * Equivalent to calling process(batch.getValue(i), false) for each row in order, but lets
+     * subclasses run a tight loop over the unboxed inputs.
+     */
+    virtual void processNumericBatch(const NumericBatch& batch) {
+        for (size_t i = 0; i < batch.size; i++) {
+            processInternal(batch.getValue(i), false);
+        }
+    }
+
 protected:
     /// Update subclass's internal state based on input
     virtual void processInternal(const Value& input, bool merging) = 0;
@@ -181,6 +269,14 @@ public:
         return true;
     }
 
+    bool supportsNumericBatch() const final {
+        return true;
+    }
+    bool ignoresInput(const Value& input) const final {
+        return !input.numeric();
+    }
+    void processNumericBatch(const NumericBatch& batch) final;
+
 private:
     BSONType totalType;
     long long longTotal;
@@ -206,6 +302,14 @@ public:
         return true;
     }
 
+    bool supportsNumericBatch() const final {
+        return true;
+    }
+    bool ignoresInput(const Value& input) const final {
+        return input.nullish();
+    }
+    void processNumericBatch(const NumericBatch& batch) final;
+
 private:
     Value _val;
     const Sense _sense;
@@ -251,6 +355,14 @@ public:
 
     static boost::intrusive_ptr<Accumulator> create();
 
+    bool supportsNumericBatch() const final {
+        return true;
+    }
+    bool ignoresInput(const Value& input) const final {
+        return !input.numeric();
+    }
+    void processNumericBatch(const NumericBatch& batch) final;
+
 private:
     double _total;
     long long _count;
@@ -67,6 +67,16 @@ void AccumulatorAvg::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorAvg::processNumericBatch(const NumericBatch& batch) {
+    // Summed in input order so that the result matches processInternal() exactly.
+    double total = _total;
+    for (size_t i = 0; i < batch.size; i++) {
+        total += batch.doubles[i];
+    }
+    _total = total;
+    _count += batch.size;
+}
+
 intrusive_ptr<Accumulator> AccumulatorAvg::create() {
     return new AccumulatorAvg();
 }
@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/base/compare_numbers.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/value.h"
@@ -59,6 +60,41 @@ void AccumulatorMinMax::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorMinMax::processNumericBatch(const NumericBatch& batch) {
+    // Find the first extreme integral row and the first extreme double row with plain loops,
+    // then let Value::compare() pick between them. Taking the earliest row on ties matches
+    // processInternal(), which only replaces _val with strictly better inputs; this matters
+    // because equal values of different types (1 vs 1.0) are distinguishable in the output.
+    const size_t none = batch.size;
+    size_t bestLong = none;
+    size_t bestDouble = none;
+    for (size_t i = 0; i < batch.size; i++) {
+        if (batch.types[i] == NumberDouble) {
+            if (bestDouble == none ||
+                compareDoubles(batch.doubles[bestDouble], batch.doubles[i]) * _sense > 0) {
+                bestDouble = i;
+            }
+        } else if (bestLong == none ||
+                   compareLongs(batch.longs[bestLong], batch.longs[i]) * _sense > 0) {
+            bestLong = i;
+        }
+    }
+
+    size_t best = bestLong;
+    if (bestDouble != none) {
+        if (best == none) {
+            best = bestDouble;
+        } else {
+            const int cmp = Value::compare(batch.getValue(bestLong), batch.getValue(bestDouble));
+            if (cmp * _sense > 0 || (cmp == 0 && bestDouble < bestLong))
+                best = bestDouble;
+        }
+    }
+
+    if (best != none)
+        processInternal(batch.getValue(best), false);
+}
+
 Value AccumulatorMinMax::getValue(bool toBeMerged) const {
     if (_val.missing()) {
         return Value(BSONNULL);
@@ -64,6 +64,38 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorSum::processNumericBatch(const NumericBatch& batch) {
+    // The double total is summed in input order so that the result is identical to calling
+    // processInternal() on each input. The integral total doesn't depend on order, and doubles
+    // contribute 0 to it, so that loop is free to vectorize.
+    double doubleSum = doubleTotal;
+    long long longSum = 0;
+    bool sawLong = false;
+    bool sawDouble = false;
+    for (size_t i = 0; i < batch.size; i++) {
+        doubleSum += batch.doubles[i];
+    }
+    for (size_t i = 0; i < batch.size; i++) {
+        longSum += batch.longs[i];
+    }
+    for (size_t i = 0; i < batch.size; i++) {
+        sawLong |= batch.types[i] == NumberLong;
+        sawDouble |= batch.types[i] == NumberDouble;
+    }
+
+    // The integral total is ignored once the total is a double, so it is fine to include
+    // integers that follow the first double.
+    if (totalType != NumberDouble)
+        longTotal += longSum;
+    doubleTotal = doubleSum;
+
+    if (sawDouble) {
+        totalType = NumberDouble;
+    } else if (sawLong) {
+        totalType = Value::getWidestNumeric(totalType, NumberLong);
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorSum::create() {
     return new AccumulatorSum();
 }
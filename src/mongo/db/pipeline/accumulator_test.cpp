@@ -86,6 +86,24 @@ static void assertExpectedResults(
                 ASSERT_EQUALS(op.second, result);
                 ASSERT_EQUALS(op.second.getType(), result.getType());
             }
+
+            // Asserts that result equals expected result when input is batched the way
+            // DocumentSourceGroup batches it.
+            if (factory()->supportsNumericBatch()) {
+                boost::intrusive_ptr<Accumulator> accum = factory();
+                NumericColumn column;
+                for (auto&& val : op.first) {
+                    if (column.append(val) || accum->ignoresInput(val))
+                        continue;
+                    accum->processNumericBatch(column.slice(0, column.size()));
+                    column.clear();
+                    accum->process(val, false);
+                }
+                accum->processNumericBatch(column.slice(0, column.size()));
+                Value result = accum->getValue(false);
+                ASSERT_EQUALS(op.second, result);
+                ASSERT_EQUALS(op.second.getType(), result.getType());
+            }
         } catch (...) {
             log() << "failed with arguments: " << Value(op.first);
             throw;
@@ -178,7 +196,19 @@ TEST(Accumulators, Min) {
          // The accumulator evaluates two documents and retains the minimum value.
          {{Value(5), Value(7)}, Value(5)},
          // The accumulator evaluates two documents and ignores the missing value.
-         {{Value(7), Value()}, Value(7)}});
+         {{Value(7), Value()}, Value(7)},
+
+         // Of equal values, the first one is retained.
+         {{Value(3), Value(3LL), Value(3.0)}, Value(3)},
+         {{Value(3.0), Value(3LL), Value(3)}, Value(3.0)},
+         {{Value(7), Value(3LL), Value(3.0), Value(3)}, Value(3LL)},
+         // NaN is less than all other numbers.
+         {{Value(1), Value(numeric_limits<double>::quiet_NaN()), Value(-1.5)},
+          Value(numeric_limits<double>::quiet_NaN())},
+         // A long that a double can't represent exactly.
+         {{Value(9007199254740992.0), Value(9007199254740993LL)}, Value(9007199254740992.0)},
+         // Numbers are less than strings.
+         {{Value(5), Value("a"), Value(7.5)}, Value(5)}});
 }
 
 TEST(Accumulators, Max) {
@@ -195,7 +225,18 @@ TEST(Accumulators, Max) {
          // The accumulator evaluates two documents and retains the maximum value.
          {{Value(5), Value(7)}, Value(7)},
          // The accumulator evaluates two documents and ignores the missing value.
-         {{Value(7), Value()}, Value(7)}});
+         {{Value(7), Value()}, Value(7)},
+
+         // Of equal values, the first one is retained.
+         {{Value(3LL), Value(3), Value(3.0)}, Value(3LL)},
+         {{Value(-1), Value(3.0), Value(3)}, Value(3.0)},
+         // NaN is less than all other numbers.
+         {{Value(numeric_limits<double>::quiet_NaN()), Value(-1.5)}, Value(-1.5)},
+         {{Value(numeric_limits<double>::quiet_NaN())}, Value(numeric_limits<double>::quiet_NaN())},
+         // A long that a double can't represent exactly.
+         {{Value(9007199254740993LL), Value(9007199254740992.0)}, Value(9007199254740993LL)},
+         // Strings are greater than numbers.
+         {{Value(5), Value("a"), Value(7.5)}, Value("a")}});
 }
 
 TEST(Accumulators, Sum) {
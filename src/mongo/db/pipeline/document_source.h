@@ -49,6 +49,7 @@
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/flat_value_map.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/sorter/sorter.h"
 #include "mongo/stdx/functional.h"
@@ -452,11 +453,37 @@ public:
 private:
     explicit DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
-    /// Spill groups map to disk and returns an iterator to the file.
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    /**
+     * Spilling to disk.
+     *
+     * Groups are hash partitioned by _id: each spill() appends every group in memory to the
+     * file of its partition, so all partial results for a given _id end up in the same file.
+     * Once the input is exhausted, the partitions are re-aggregated one at a time, which only
+     * needs memory for the groups of a single partition. A partition that still doesn't fit is
+     * split again on the next bits of the hash, up to kMaxSpillLevels deep.
+     */
+    static const int kSpillPartitionBits = 4;
+    static const size_t kNumSpillPartitions = 1 << kSpillPartitionBits;
+    static const int kMaxSpillLevels = 4;
+
+    typedef Sorter<Value, Value>::Iterator SpillIterator;
+
+    struct SpilledPartition {
+        std::shared_ptr<SpillIterator> iterator;
+        int level;  // How many bits of the hash, in units of kSpillPartitionBits, it shares.
+    };
 
-    // Only used by spill. Would be function-local if that were legal in C++03.
-    class SpillSTLComparator;
+    /// Appends the groups map to the level 'level' partition files and clears it.
+    void spill(int level = 0);
+
+    /// Closes the partition files and queues them to be aggregated.
+    void finishPartitions(int level);
+
+    /**
+     * Aggregates the next pending partition into the groups map. Returns false if there are no
+     * partitions left.
+     */
+    bool aggregateNextPartition();
 
     /*
       Before returning anything, this source must fetch everything from
@@ -485,7 +512,7 @@ private:
 
 
     typedef std::vector<boost::intrusive_ptr<Accumulator>> Accumulators;
-    typedef std::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
+    typedef FlatValueMap<Accumulators> GroupsMap;
     GroupsMap groups;
 
     /*
@@ -507,6 +534,38 @@ private:
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
+    /**
+     * Batch execution of accumulators that support Accumulator::processNumericBatch().
+     *
+     * Inputs to those accumulators are buffered column-wise for up to kBatchSize documents and
+     * then handed to each group as one contiguous run per accumulator, instead of through one
+     * virtual process() call per document. Accumulators without batch support, and inputs a
+     * batch can't represent, are processed immediately after the pending batch is applied, so
+     * each accumulator still sees its inputs in document order.
+     */
+    static const size_t kBatchSize = 1024;
+
+    /**
+     * Evaluates the accumulator inputs for the current document into _rowInputs and buffers
+     * those that can be batched. Returns false, buffering nothing, if any batched accumulator
+     * got an input that must go through process().
+     */
+    bool appendToBatch(Accumulators* group);
+
+    /**
+     * Applies and clears the pending batch. Returns the change in memory usage.
+     */
+    int applyBatch();
+
+    // Parallel to vpExpression: true for the accumulators that are fed through batches.
+    std::vector<bool> _batchable;
+    std::vector<Value> _rowInputs;
+    std::vector<Accumulators*> _batchGroups;  // The group of each buffered document.
+    // Row-major [document][accumulator] index into _batchColumns, or -1 if that input is skipped.
+    std::vector<int> _batchEntries;
+    std::vector<NumericColumn> _batchColumns;
+    NumericColumn _groupedColumn;  // Scratch space for applyBatch().
+
     bool _doingMerge;
     bool _spilled;
     const bool _extSortAllowed;
@@ -515,14 +574,11 @@ private:
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
-    // only used when !_spilled
     GroupsMap::iterator groupsIterator;
 
     // only used when _spilled
-    std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
-    std::pair<Value, Value> _firstPartOfNextGroup;
-    Value _currentId;
-    Accumulators _currentAccumulators;
+    std::vector<std::unique_ptr<SortedFileWriter<Value, Value>>> _partitionWriters;
+    std::vector<SpilledPartition> _pendingPartitions;  // Aggregated from the back.
 };
 
 
@@ -1146,4 +1202,122 @@ private:
     BSONObj cmdOutput;
     std::unique_ptr<BSONObjIterator> resultsIterator;  // iterator over cmdOutput["results"]
 };
+
+/**
+ * Joins each input document with the documents of an unsharded collection in the same database
+ * whose 'foreignField' equals the input's 'localField', placing the matches in an array field.
+ *
+ * The stage picks one of three strategies when it is first iterated:
+ *  - kHashTable: the foreign collection fits in memory and is loaded into a hash table once.
+ *  - kIndexedLoop: the foreign collection is too large but 'foreignField' is indexed, so each
+ *    input document issues an equality query against the foreign collection.
+ *  - kSortMerge: neither of the above, so both sides are sorted on the join key through the
+ *    Sorter (spilling to disk if allowDiskUse is set) and merged. The joined documents are
+ *    sorted back into input order before they are returned.
+ *
+ * Explain output includes the strategy that was, or would be, picked.
+ */
+class DocumentSourceLookUp final : public DocumentSource,
+                                   public SplittableDocumentSource,
+                                   public DocumentSourceNeedsMongod {
+public:
+    enum class Strategy { kHashTable, kIndexedLoop, kSortMerge };
+
+    // virtuals from DocumentSource
+    boost::optional<Document> getNext() final;
+    const char* getSourceName() const final;
+    void dispose() final;
+    Value serialize(bool explain = false) const final;
+    GetDepsReturn getDependencies(DepsTracker* deps) const final;
+    bool needsPrimaryShard() const final {
+        return true;
+    }
+    void addInvolvedCollections(std::vector<NamespaceString>* collections) const final {
+        collections->push_back(_fromNs);
+    }
+
+    // Virtuals for SplittableDocumentSource
+    boost::intrusive_ptr<DocumentSource> getShardSource() final {
+        return NULL;
+    }
+    boost::intrusive_ptr<DocumentSource> getMergeSource() final {
+        return this;
+    }
+
+    const NamespaceString& getFromNs() const {
+        return _fromNs;
+    }
+
+    static const char* strategyToString(Strategy strategy);
+
+    static boost::intrusive_ptr<DocumentSource> createFromBson(
+        BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+private:
+    DocumentSourceLookUp(NamespaceString fromNs,
+                         const std::string& as,
+                         const std::string& localField,
+                         const std::string& foreignField,
+                         const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+    typedef Sorter<Value, Document> JoinSorter;
+    typedef std::unordered_map<Value, std::vector<size_t>, Value::Hash> ForeignTable;
+
+    /**
+     * Picks a strategy from the foreign collection's size and indexes. 'allowHashTable' is false
+     * when a previous attempt to build the hash table ran out of memory.
+     */
+    Strategy chooseStrategy(bool allowHashTable) const;
+
+    /**
+     * Loads the foreign collection into _foreignDocs and _foreignTable. Returns false, leaving
+     * both empty, if that would take more than _maxMemoryUsageBytes.
+     */
+    bool buildHashTable();
+
+    /**
+     * Consumes the whole input and joins it against the foreign collection through the Sorter,
+     * leaving the results in input order in _sortMergeOutput.
+     */
+    void runSortMerge();
+
+    /**
+     * Returns the keys under which 'foreignDoc' can be matched: the value at 'foreignField',
+     * and each of its elements if it is an array. A missing value is keyed as null.
+     */
+    ValueSet extractForeignKeys(const BSONObj& foreignDoc) const;
+
+    /**
+     * Returns the value at 'localField' in 'input', normalizing missing and undefined to null.
+     */
+    Value extractLocalKey(const Document& input) const;
+
+    /**
+     * Returns the documents in the foreign collection that match 'key', using an index on
+     * 'foreignField' to find candidates.
+     */
+    std::vector<Value> queryForeign(const Value& key);
+
+    /**
+     * Returns 'input' with 'matches' stored at 'as'.
+     */
+    Document makeOutput(const Document& input, std::vector<Value> matches) const;
+
+    const NamespaceString _fromNs;
+    const FieldPath _as;
+    const FieldPath _localField;
+    const FieldPath _foreignField;
+    const std::string _foreignFieldName;  // _foreignField as a dotted string, for queries.
+    const bool _extSortAllowed;
+    const size_t _maxMemoryUsageBytes;
+
+    boost::optional<Strategy> _strategy;
+
+    // Only used by kHashTable.
+    std::vector<BSONObj> _foreignDocs;
+    ForeignTable _foreignTable;
+
+    // Only used by kSortMerge.
+    std::unique_ptr<JoinSorter::Iterator> _sortMergeOutput;
+};
 }
@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <limits>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -40,7 +41,6 @@
 namespace mongo {
 
 using boost::intrusive_ptr;
-using std::shared_ptr;
 using std::pair;
 using std::vector;
 
@@ -56,68 +56,25 @@ boost::optional<Document> DocumentSourceGroup::getNext() {
     if (!populated)
         populate();
 
-    if (_spilled) {
-        if (!_sorterIterator)
-            return boost::none;
-
-        const size_t numAccumulators = vpAccumulatorFactory.size();
-        for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators[i]->reset();  // prep accumulators for a new group
-        }
-
-        _currentId = _firstPartOfNextGroup.first;
-        while (_currentId == _firstPartOfNextGroup.first) {
-            // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
-            // At loop exit, it is the first value to be processed in the next group.
-
-            switch (numAccumulators) {  // mirrors switch in spill()
-                case 0:                 // no Accumulators so no Values
-                    break;
-
-                case 1:  // single accumulators serialize as a single Value
-                    _currentAccumulators[0]->process(_firstPartOfNextGroup.second,
-                                                     /*merging=*/true);
-                    break;
-
-                default: {  // multiple accumulators serialize as an array
-                    const vector<Value>& accumulatorStates =
-                        _firstPartOfNextGroup.second.getArray();
-                    for (size_t i = 0; i < numAccumulators; i++) {
-                        _currentAccumulators[i]->process(accumulatorStates[i],
-                                                         /*merging=*/true);
-                    }
-                    break;
-                }
-            }
-
-            if (!_sorterIterator->more()) {
-                dispose();
-                break;
-            }
-
-            _firstPartOfNextGroup = _sorterIterator->next();
-        }
-
-        return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
-
-    } else {
-        if (groups.empty())
+    while (groupsIterator == groups.end()) {
+        // Once spilled, the groups map holds one partition at a time.
+        if (!_spilled || !aggregateNextPartition())
             return boost::none;
+    }
 
-        Document out =
-            makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->inShard);
+    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->inShard);
 
-        if (++groupsIterator == groups.end())
-            dispose();
+    if (++groupsIterator == groups.end() && _pendingPartitions.empty())
+        dispose();
 
-        return out;
-    }
+    return out;
 }
 
 void DocumentSourceGroup::dispose() {
     // free our resources
     GroupsMap().swap(groups);
-    _sorterIterator.reset();
+    _partitionWriters.clear();
+    _pendingPartitions.clear();
 
     // make us look done
     groupsIterator = groups.end();
@@ -295,23 +252,24 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
     return pGroup;
 }
 
-namespace {
-class SorterComparator {
-public:
-    typedef pair<Value, Value> Data;
-    int operator()(const Data& lhs, const Data& rhs) const {
-        return Value::compare(lhs.first, rhs.first);
-    }
-};
-}
-
 void DocumentSourceGroup::populate() {
     const size_t numAccumulators = vpAccumulatorFactory.size();
     dassert(numAccumulators == vpExpression.size());
 
-    // pushed to on spill()
-    vector<shared_ptr<Sorter<Value, Value>::Iterator>> sortedFiles;
     int memoryUsageBytes = 0;
+    int numSpills = 0;
+
+    // Merging inputs are partial results rather than numbers, so they are never batched.
+    bool anyBatchable = false;
+    _batchable.assign(numAccumulators, false);
+    if (!_doingMerge) {
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _batchable[i] = vpAccumulatorFactory[i]()->supportsNumericBatch();
+            anyBatchable |= _batchable[i];
+        }
+    }
+    _rowInputs.resize(numAccumulators);
+    _batchColumns.resize(numAccumulators);
 
     // This loop consumes all input from pSource and buckets it based on pIdExpression.
     while (boost::optional<Document> input = pSource->getNext()) {
@@ -320,7 +278,8 @@ void DocumentSourceGroup::populate() {
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _extSortAllowed);
-            sortedFiles.push_back(spill());
+            spill();
+            numSpills++;
             memoryUsageBytes = 0;
         }
 
@@ -348,20 +307,31 @@ void DocumentSourceGroup::populate() {
             group.reserve(numAccumulators);
             for (size_t i = 0; i < numAccumulators; i++) {
                 group.push_back(vpAccumulatorFactory[i]());
-            }
-        } else {
-            for (size_t i = 0; i < numAccumulators; i++) {
-                // subtract old mem usage. New usage added back after processing.
-                memoryUsageBytes -= group[i]->memUsageForSorter();
+                memoryUsageBytes += group[i]->memUsageForSorter();
             }
         }
 
         /* tickle all the accumulators for the group we found */
         dassert(numAccumulators == group.size());
+        const bool batched = anyBatchable && appendToBatch(&group);
+        if (anyBatchable && !batched) {
+            // Apply the pending batch first so each accumulator sees its inputs in order.
+            memoryUsageBytes += applyBatch();
+        }
         for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
+            if (batched && _batchable[i])
+                continue;
+
+            // subtract old mem usage. New usage added back after processing.
+            memoryUsageBytes -= group[i]->memUsageForSorter();
+            group[i]->process(
+                anyBatchable ? _rowInputs[i] : vpExpression[i]->evaluate(_variables.get()),
+                _doingMerge);
             memoryUsageBytes += group[i]->memUsageForSorter();
         }
+        if (batched && _batchGroups.size() == kBatchSize) {
+            memoryUsageBytes += applyBatch();
+        }
 
         // We are done with the ROOT document so release it.
         _variables->clearRoot();
@@ -374,87 +344,223 @@ void DocumentSourceGroup::populate() {
                 &&
                 !_extSortAllowed  // don't change behavior when testing external sort
                 &&
-                sortedFiles.size() < 20  // don't open too many FDs
+                numSpills < 20  // don't write too many times
                 ) {
-                sortedFiles.push_back(spill());
+                spill();
+                numSpills++;
+                memoryUsageBytes = 0;
             }
         }
     }
 
-    // These blocks do any final steps necessary to prepare to output results.
-    if (!sortedFiles.empty()) {
+    applyBatch();
+
+    // If anything was spilled, the groups still in memory join their partitions and are then
+    // aggregated again with the rest of their partition's data.
+    if (!_partitionWriters.empty()) {
         _spilled = true;
-        if (!groups.empty()) {
-            sortedFiles.push_back(spill());
-        }
+        spill();
+        finishPartitions(0);
+    }
 
-        // We won't be using groups again so free its memory.
-        GroupsMap().swap(groups);
+    // start the group iterator
+    groupsIterator = groups.begin();
 
-        _sorterIterator.reset(
-            Sorter<Value, Value>::Iterator::merge(sortedFiles, SortOptions(), SorterComparator()));
+    populated = true;
+}
 
-        // prepare current to accumulate data
-        _currentAccumulators.reserve(numAccumulators);
-        for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators.push_back(vpAccumulatorFactory[i]());
-        }
+bool DocumentSourceGroup::appendToBatch(Accumulators* group) {
+    const size_t numAccumulators = vpExpression.size();
+    for (size_t i = 0; i < numAccumulators; i++) {
+        _rowInputs[i] = vpExpression[i]->evaluate(_variables.get());
+    }
 
-        verify(_sorterIterator->more());  // we put data in, we should get something out.
-        _firstPartOfNextGroup = _sorterIterator->next();
-    } else {
-        // start the group iterator
-        groupsIterator = groups.begin();
+    for (size_t i = 0; i < numAccumulators; i++) {
+        if (_batchable[i] && !_rowInputs[i].numeric() && !(*group)[i]->ignoresInput(_rowInputs[i]))
+            return false;
     }
 
-    populated = true;
+    for (size_t i = 0; i < numAccumulators; i++) {
+        int entry = -1;
+        if (_batchable[i] && _batchColumns[i].append(_rowInputs[i])) {
+            entry = _batchColumns[i].size() - 1;
+        }
+        _batchEntries.push_back(entry);
+    }
+    _batchGroups.push_back(group);
+    return true;
 }
 
-class DocumentSourceGroup::SpillSTLComparator {
-public:
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return Value::compare(lhs->first, rhs->first) < 0;
+int DocumentSourceGroup::applyBatch() {
+    const size_t numRows = _batchGroups.size();
+    if (numRows == 0)
+        return 0;
+    const size_t numAccumulators = vpExpression.size();
+
+    // Number the distinct groups in order of first appearance, then counting sort the rows by
+    // that number. The sort is stable, so each group's rows stay in document order.
+    std::unordered_map<Accumulators*, size_t> slotOfGroup;
+    vector<Accumulators*> slotGroups;
+    vector<size_t> slotEnds;
+    vector<size_t> rowSlots(numRows);
+    for (size_t row = 0; row < numRows; row++) {
+        auto it = slotOfGroup.emplace(_batchGroups[row], slotGroups.size()).first;
+        if (it->second == slotGroups.size()) {
+            slotGroups.push_back(_batchGroups[row]);
+            slotEnds.push_back(0);
+        }
+        rowSlots[row] = it->second;
+        slotEnds[it->second]++;
+    }
+    for (size_t slot = 1; slot < slotEnds.size(); slot++) {
+        slotEnds[slot] += slotEnds[slot - 1];
+    }
+    vector<size_t> orderedRows(numRows);
+    for (size_t row = numRows; row-- > 0;) {
+        orderedRows[--slotEnds[rowSlots[row]]] = row;
     }
-};
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(groups.size());
-    for (GroupsMap::const_iterator it = groups.begin(), end = groups.end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+    int memoryUsageDelta = 0;
+    for (size_t i = 0; i < numAccumulators; i++) {
+        if (!_batchable[i])
+            continue;
+
+        _groupedColumn.clear();
+        size_t pos = 0;
+        while (pos < numRows) {
+            const size_t slot = rowSlots[orderedRows[pos]];
+            const size_t begin = _groupedColumn.size();
+            for (; pos < numRows && rowSlots[orderedRows[pos]] == slot; pos++) {
+                const int entry = _batchEntries[orderedRows[pos] * numAccumulators + i];
+                if (entry >= 0)
+                    _groupedColumn.append(_batchColumns[i], entry);
+            }
+
+            if (_groupedColumn.size() == begin)
+                continue;  // Every input for this group was skipped.
+
+            Accumulator* accumulator = (*slotGroups[slot])[i].get();
+            memoryUsageDelta -= accumulator->memUsageForSorter();
+            accumulator->processNumericBatch(_groupedColumn.slice(begin, _groupedColumn.size()));
+            memoryUsageDelta += accumulator->memUsageForSorter();
+        }
+        _batchColumns[i].clear();
     }
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator());
+    _batchGroups.clear();
+    _batchEntries.clear();
+    return memoryUsageDelta;
+}
 
-    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (vpAccumulatorFactory.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                             // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+void DocumentSourceGroup::spill(int level) {
+    // Pending batched inputs belong to groups that are about to be written out.
+    applyBatch();
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
-            }
-            break;
+    // The partition is taken from the high bits of the hash, so that the next kSpillPartitionBits
+    // below them can split it again later.
+    const int shift = std::numeric_limits<size_t>::digits - kSpillPartitionBits * (level + 1);
+    _partitionWriters.resize(kNumSpillPartitions);
+
+    // The files are only read back in the order they were written, so "sorted" is meaningless.
+    for (GroupsMap::const_iterator it = groups.begin(), end = groups.end(); it != end; ++it) {
+        const size_t partition =
+            (GroupsMap::hash(it->first) >> shift) & (kNumSpillPartitions - 1);
+        std::unique_ptr<SortedFileWriter<Value, Value>>& writer = _partitionWriters[partition];
+        if (!writer) {
+            writer.reset(
+                new SortedFileWriter<Value, Value>(SortOptions().TempDir(pExpCtx->tempDir)));
+        }
+
+        switch (vpAccumulatorFactory.size()) {  // same as it->second.size()
+            case 0:                             // no values, essentially a distinct
+                writer->addAlreadySorted(it->first, Value());
+                break;
+
+            case 1:  // just one value, use optimized serialization as single Value
+                writer->addAlreadySorted(it->first,
+                                         it->second[0]->getValue(/*toBeMerged=*/true));
+                break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
+            default: {  // multiple values, serialize as array-typed Value
                 vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+                for (size_t j = 0; j < it->second.size(); j++) {
+                    accums.push_back(it->second[j]->getValue(/*toBeMerged=*/true));
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                writer->addAlreadySorted(it->first, Value(std::move(accums)));
+                break;
             }
-            break;
+        }
+    }
+
+    groups.clear();
+}
+
+void DocumentSourceGroup::finishPartitions(int level) {
+    for (size_t i = 0; i < _partitionWriters.size(); i++) {
+        if (!_partitionWriters[i])
+            continue;  // Nothing hashed to this partition.
+
+        SpilledPartition partition;
+        partition.iterator.reset(_partitionWriters[i]->done());
+        partition.level = level;
+        _pendingPartitions.push_back(std::move(partition));
     }
+    _partitionWriters.clear();
+}
+
+bool DocumentSourceGroup::aggregateNextPartition() {
+    if (_pendingPartitions.empty())
+        return false;
+
+    SpilledPartition partition = std::move(_pendingPartitions.back());
+    _pendingPartitions.pop_back();
 
+    const size_t numAccumulators = vpAccumulatorFactory.size();
+    const bool canSplit = partition.level + 1 < kMaxSpillLevels;
+    bool split = false;
+    int memoryUsageBytes = 0;
     groups.clear();
+    while (partition.iterator->more()) {
+        // A partition that is still too large is split on the next bits of the hash. That is
+        // pointless once it holds a single group, which, as before partitioning, may then use
+        // more than _maxMemoryUsageBytes.
+        if (memoryUsageBytes > _maxMemoryUsageBytes && canSplit && groups.size() > 1) {
+            spill(partition.level + 1);
+            split = true;
+            memoryUsageBytes = 0;
+        }
+
+        const pair<Value, Value> spilledGroup = partition.iterator->next();
+
+        const size_t oldSize = groups.size();
+        Accumulators& group = groups[spilledGroup.first];
+        if (groups.size() != oldSize) {
+            memoryUsageBytes += spilledGroup.first.getApproximateSize();
+            group.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group.push_back(vpAccumulatorFactory[i]());
+                memoryUsageBytes += group[i]->memUsageForSorter();
+            }
+        }
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            // mirrors switch in spill()
+            const Value& state = numAccumulators == 1 ? spilledGroup.second
+                                                      : spilledGroup.second.getArray()[i];
+            memoryUsageBytes -= group[i]->memUsageForSorter();
+            group[i]->process(state, /*merging=*/true);
+            memoryUsageBytes += group[i]->memUsageForSorter();
+        }
+    }
+
+    if (split) {
+        // Leaves the groups map empty; the sub-partitions are aggregated next.
+        spill(partition.level + 1);
+        finishPartitions(partition.level + 1);
+    }
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    groupsIterator = groups.begin();
+    return true;
 }
 
 void DocumentSourceGroup::parseIdExpression(BSONElement groupField,
@@ -0,0 +1,390 @@
+/**
+ * Copyright (c) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source.h"
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+// The memory budget for a $lookUp. A foreign collection larger than this is not loaded into a
+// hash table, and each of the sorters used by kSortMerge gets a third of it.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookUpMaxMemoryBytes, int, 100 * 1024 * 1024);
+
+class JoinKeyComparator {
+public:
+    typedef std::pair<Value, Document> Data;
+    int operator()(const Data& lhs, const Data& rhs) const {
+        return Value::compare(lhs.first, rhs.first);
+    }
+};
+}  // namespace
+
+REGISTER_DOCUMENT_SOURCE(lookUp, DocumentSourceLookUp::createFromBson);
+
+DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
+                                           const string& as,
+                                           const string& localField,
+                                           const string& foreignField,
+                                           const intrusive_ptr<ExpressionContext>& pExpCtx)
+    : DocumentSource(pExpCtx),
+      _fromNs(std::move(fromNs)),
+      _as(as),
+      _localField(localField),
+      _foreignField(foreignField),
+      _foreignFieldName(_foreignField.getPath(false)),
+      _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter),
+      _maxMemoryUsageBytes(internalDocumentSourceLookUpMaxMemoryBytes) {}
+
+const char* DocumentSourceLookUp::getSourceName() const {
+    return "$lookUp";
+}
+
+const char* DocumentSourceLookUp::strategyToString(Strategy strategy) {
+    switch (strategy) {
+        case Strategy::kHashTable:
+            return "hashTable";
+        case Strategy::kIndexedLoop:
+            return "indexedLoop";
+        case Strategy::kSortMerge:
+            return "sortMerge";
+    }
+    MONGO_UNREACHABLE;
+}
+
+boost::optional<Document> DocumentSourceLookUp::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_strategy) {
+        verify(_mongod);
+        uassert(28789,
+                str::stream() << "namespace '" << _fromNs.ns()
+                              << "' is sharded so it can't be used for $lookUp",
+                !_mongod->isSharded(_fromNs));
+
+        _strategy = chooseStrategy(true);
+        if (*_strategy == Strategy::kHashTable && !buildHashTable()) {
+            // The collection grew past what its stats claimed.
+            _strategy = chooseStrategy(false);
+        }
+        if (*_strategy == Strategy::kSortMerge) {
+            runSortMerge();
+        }
+    }
+
+    if (*_strategy == Strategy::kSortMerge) {
+        if (!_sortMergeOutput || !_sortMergeOutput->more())
+            return boost::none;
+        return _sortMergeOutput->next().second;
+    }
+
+    boost::optional<Document> input = pSource->getNext();
+    if (!input)
+        return boost::none;
+
+    const Value key = extractLocalKey(*input);
+    if (*_strategy == Strategy::kIndexedLoop)
+        return makeOutput(*input, queryForeign(key));
+
+    vector<Value> matches;
+    ForeignTable::const_iterator it = _foreignTable.find(key);
+    if (it != _foreignTable.end()) {
+        matches.reserve(it->second.size());
+        for (size_t index : it->second) {
+            matches.push_back(Value(_foreignDocs[index]));
+        }
+    }
+    return makeOutput(*input, std::move(matches));
+}
+
+void DocumentSourceLookUp::dispose() {
+    vector<BSONObj>().swap(_foreignDocs);
+    ForeignTable().swap(_foreignTable);
+    _sortMergeOutput.reset();
+    pSource->dispose();
+}
+
+DocumentSourceLookUp::Strategy DocumentSourceLookUp::chooseStrategy(bool allowHashTable) const {
+    DBClientBase* conn = _mongod->directClient();
+
+    if (allowHashTable) {
+        // collStats fails if the collection doesn't exist, in which case it is trivially small.
+        BSONObj stats;
+        if (!conn->runCommand(_fromNs.db().toString(), BSON("collStats" << _fromNs.coll()), stats) ||
+            static_cast<size_t>(stats["size"].safeNumberLong()) <= _maxMemoryUsageBytes) {
+            return Strategy::kHashTable;
+        }
+    }
+
+    // Only indexes that are guaranteed to contain every document can answer the equality
+    // queries issued by kIndexedLoop, since a local key of null must also match missing fields.
+    const std::list<BSONObj> indexes = conn->getIndexSpecs(_fromNs.ns());
+    for (const BSONObj& index : indexes) {
+        const BSONElement firstKey = index.getObjectField("key").firstElement();
+        if (firstKey.fieldNameStringData() != _foreignFieldName)
+            continue;
+        if (!firstKey.isNumber() && firstKey.str() != "hashed")
+            continue;
+        if (index["sparse"].trueValue() || index.hasField("partialFilterExpression"))
+            continue;
+        return Strategy::kIndexedLoop;
+    }
+
+    return Strategy::kSortMerge;
+}
+
+bool DocumentSourceLookUp::buildHashTable() {
+    unique_ptr<DBClientCursor> cursor = _mongod->directClient()->query(_fromNs.ns(), Query());
+    uassert(28790, str::stream() << "failed to query '" << _fromNs.ns() << "' for $lookUp", cursor);
+
+    size_t memoryUsageBytes = 0;
+    while (cursor->more()) {
+        pExpCtx->checkForInterrupt();
+
+        BSONObj foreignDoc = cursor->nextSafe().getOwned();
+        memoryUsageBytes += foreignDoc.objsize();
+        for (const Value& key : extractForeignKeys(foreignDoc)) {
+            memoryUsageBytes += key.getApproximateSize() + sizeof(size_t);
+            _foreignTable[key].push_back(_foreignDocs.size());
+        }
+        _foreignDocs.push_back(std::move(foreignDoc));
+
+        if (memoryUsageBytes > _maxMemoryUsageBytes) {
+            vector<BSONObj>().swap(_foreignDocs);
+            ForeignTable().swap(_foreignTable);
+            return false;
+        }
+    }
+    return true;
+}
+
+void DocumentSourceLookUp::runSortMerge() {
+    SortOptions opts;
+    opts.maxMemoryUsageBytes = _maxMemoryUsageBytes / 3;
+    if (_extSortAllowed) {
+        opts.extSortAllowed = true;
+        opts.tempDir = pExpCtx->tempDir;
+    }
+
+    // Input documents are keyed by [local key, position in the input] so that the joined
+    // documents can be sorted back into input order once the merge is done.
+    unique_ptr<JoinSorter> localSorter(JoinSorter::make(opts, JoinKeyComparator()));
+    long long position = 0;
+    while (boost::optional<Document> input = pSource->getNext()) {
+        localSorter->add(Value(vector<Value>{extractLocalKey(*input), Value(position++)}),
+                         *input);
+    }
+
+    // A foreign document is added once for each key it can be matched by.
+    unique_ptr<JoinSorter> foreignSorter(JoinSorter::make(opts, JoinKeyComparator()));
+    unique_ptr<DBClientCursor> cursor = _mongod->directClient()->query(_fromNs.ns(), Query());
+    uassert(28791, str::stream() << "failed to query '" << _fromNs.ns() << "' for $lookUp", cursor);
+    while (cursor->more()) {
+        pExpCtx->checkForInterrupt();
+
+        const BSONObj foreignDoc = cursor->nextSafe();
+        const Document foreignDocument(foreignDoc);
+        for (const Value& key : extractForeignKeys(foreignDoc)) {
+            foreignSorter->add(key, foreignDocument);
+        }
+    }
+
+    unique_ptr<JoinSorter::Iterator> localIt(localSorter->done());
+    unique_ptr<JoinSorter::Iterator> foreignIt(foreignSorter->done());
+    localSorter.reset();
+    foreignSorter.reset();
+
+    boost::optional<JoinSorter::Iterator::Data> nextForeign;
+    auto advanceForeign = [&] {
+        if (foreignIt->more()) {
+            nextForeign = foreignIt->next();
+        } else {
+            nextForeign = boost::none;
+        }
+    };
+    advanceForeign();
+
+    unique_ptr<JoinSorter> outputSorter(JoinSorter::make(opts, JoinKeyComparator()));
+    boost::optional<Value> currentKey;
+    vector<Value> currentMatches;
+    while (localIt->more()) {
+        pExpCtx->checkForInterrupt();
+
+        const JoinSorter::Iterator::Data next = localIt->next();
+        const vector<Value>& keyAndPosition = next.first.getArray();
+        const Value& key = keyAndPosition[0];
+
+        if (!currentKey || Value::compare(*currentKey, key) != 0) {
+            currentKey = key;
+            currentMatches.clear();
+            while (nextForeign && Value::compare(nextForeign->first, key) < 0) {
+                advanceForeign();
+            }
+            while (nextForeign && Value::compare(nextForeign->first, key) == 0) {
+                currentMatches.push_back(Value(nextForeign->second));
+                advanceForeign();
+            }
+        }
+
+        outputSorter->add(keyAndPosition[1], makeOutput(next.second, currentMatches));
+    }
+
+    _sortMergeOutput.reset(outputSorter->done());
+}
+
+ValueSet DocumentSourceLookUp::extractForeignKeys(const BSONObj& foreignDoc) const {
+    // Both passes are needed so that an array can be matched as a whole or by its elements.
+    BSONElementSet elements;
+    foreignDoc.getFieldsDotted(_foreignFieldName, elements, false);
+    foreignDoc.getFieldsDotted(_foreignFieldName, elements, true);
+
+    ValueSet keys;
+    for (const BSONElement& element : elements) {
+        keys.insert(element.type() == Undefined ? Value(BSONNULL) : Value(element));
+    }
+    if (keys.empty()) {
+        keys.insert(Value(BSONNULL));
+    }
+    return keys;
+}
+
+Value DocumentSourceLookUp::extractLocalKey(const Document& input) const {
+    Value key = input.getNestedField(_localField);
+    if (key.missing() || key.getType() == Undefined)
+        return Value(BSONNULL);
+    return key;
+}
+
+vector<Value> DocumentSourceLookUp::queryForeign(const Value& key) {
+    // $eq does not accept regular expressions, so those are found by type instead. Either way
+    // the candidates are filtered with extractForeignKeys() to keep the matching rules identical
+    // to the other strategies.
+    BSONObjBuilder query;
+    if (key.getType() == RegEx) {
+        query << _foreignFieldName << BSON("$type" << static_cast<int>(RegEx));
+    } else {
+        BSONObjBuilder eq(query.subobjStart(_foreignFieldName));
+        key.addToBsonObj(&eq, "$eq");
+        eq.doneFast();
+    }
+
+    unique_ptr<DBClientCursor> cursor =
+        _mongod->directClient()->query(_fromNs.ns(), Query(query.obj()));
+    uassert(28792, str::stream() << "failed to query '" << _fromNs.ns() << "' for $lookUp", cursor);
+
+    vector<Value> matches;
+    while (cursor->more()) {
+        const BSONObj foreignDoc = cursor->nextSafe();
+        if (extractForeignKeys(foreignDoc).count(key)) {
+            matches.push_back(Value(foreignDoc));
+        }
+    }
+    return matches;
+}
+
+Document DocumentSourceLookUp::makeOutput(const Document& input, vector<Value> matches) const {
+    MutableDocument output(input);
+    output.setNestedField(_as, Value(std::move(matches)));
+    return output.freeze();
+}
+
+Value DocumentSourceLookUp::serialize(bool explain) const {
+    MutableDocument spec;
+    spec["from"] = Value(_fromNs.coll());
+    spec["as"] = Value(_as.getPath(false));
+    spec["localField"] = Value(_localField.getPath(false));
+    spec["foreignField"] = Value(_foreignFieldName);
+    if (explain && (_strategy || _mongod)) {
+        spec["strategy"] = Value(strategyToString(_strategy ? *_strategy : chooseStrategy(true)));
+    }
+    return Value(DOC(getSourceName() << spec.freeze()));
+}
+
+DocumentSource::GetDepsReturn DocumentSourceLookUp::getDependencies(DepsTracker* deps) const {
+    deps->fields.insert(_localField.getPath(false));
+    return SEE_NEXT;
+}
+
+intrusive_ptr<DocumentSource> DocumentSourceLookUp::createFromBson(
+    BSONElement elem, const intrusive_ptr<ExpressionContext>& pExpCtx) {
+    uassert(28784, "the $lookUp specification must be an Object", elem.type() == Object);
+
+    string from;
+    string as;
+    string localField;
+    string foreignField;
+    for (auto&& argument : elem.Obj()) {
+        uassert(28785,
+                str::stream() << "arguments to $lookUp must be strings, " << argument << " is type "
+                              << typeName(argument.type()),
+                argument.type() == String);
+
+        const StringData argName = argument.fieldNameStringData();
+        if (argName == "from") {
+            from = argument.String();
+        } else if (argName == "as") {
+            as = argument.String();
+        } else if (argName == "localField") {
+            localField = argument.String();
+        } else if (argName == "foreignField") {
+            foreignField = argument.String();
+        } else {
+            uasserted(28786,
+                      str::stream() << "unknown argument to $lookUp: " << argument.fieldName());
+        }
+    }
+
+    uassert(28787,
+            "need to specify fields from, as, localField, and foreignField for a $lookUp",
+            !from.empty() && !as.empty() && !localField.empty() && !foreignField.empty());
+
+    NamespaceString fromNs(pExpCtx->ns.db(), from);
+    uassert(28788,
+            str::stream() << "invalid $lookUp namespace: " << fromNs.ns(),
+            fromNs.isValid());
+
+    return new DocumentSourceLookUp(std::move(fromNs), as, localField, foreignField, pExpCtx);
+}
+}
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
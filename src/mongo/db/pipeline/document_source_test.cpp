@@ -877,6 +877,30 @@ public:
     }
 };
 
+/** Batched accumulators see inputs from several blocks, with a non-numeric input in between. */
+class BatchedAccumulatorsSpanBlocks : public CheckResultsBase {
+    std::deque<Document> inputData() {
+        std::deque<Document> docs;
+        for (int i = 0; i < 2500; ++i) {
+            if (i == 1500) {
+                docs.push_back(DOC("id" << 0 << "a"
+                                        << "x"));
+            } else {
+                docs.push_back(DOC("id" << i % 2 << "a" << i));
+            }
+        }
+        return docs;
+    }
+    virtual BSONObj groupSpec() {
+        return fromjson(
+            "{_id:'$id',sum:{$sum:'$a'},min:{$min:'$a'},max:{$max:'$a'},count:{$sum:1}}");
+    }
+    virtual string expectedResultSetString() {
+        return "[{_id:0,sum:1559750,min:0,max:'x',count:1250},"
+               "{_id:1,sum:1562500,min:1,max:2499,count:1250}]";
+    }
+};
+
 }  // namespace DocumentSourceGroup
 
 namespace DocumentSourceProject {
@@ -1891,6 +1915,101 @@ public:
 };
 }  // namespace DocumentSourceGeoNear
 
+namespace DocumentSourceLookUp {
+using mongo::DocumentSourceLookUp;
+
+/**
+ * Fixture to test parsing and serialization of the $lookUp stage.
+ */
+class LookUpSpec : public Mock::Base, public unittest::Test {
+public:
+    intrusive_ptr<DocumentSource> createLookUp(BSONObj lookUpSpec) {
+        return DocumentSourceLookUp::createFromBson(lookUpSpec.firstElement(), ctx());
+    }
+
+    BSONObj createSpec(BSONObj spec) {
+        return BSON("$lookUp" << spec);
+    }
+
+    BSONObj validSpec() {
+        return BSON("from"
+                    << "foreign"
+                    << "as"
+                    << "joined"
+                    << "localField"
+                    << "a.b"
+                    << "foreignField"
+                    << "c");
+    }
+};
+
+TEST_F(LookUpSpec, NonObject) {
+    ASSERT_THROWS_CODE(createLookUp(BSON("$lookUp" << 1)), UserException, 28784);
+}
+
+TEST_F(LookUpSpec, NonStringArgument) {
+    ASSERT_THROWS_CODE(createLookUp(createSpec(BSON("from" << 1 << "as"
+                                                           << "joined"
+                                                           << "localField"
+                                                           << "a"
+                                                           << "foreignField"
+                                                           << "b"))),
+                       UserException,
+                       28785);
+}
+
+TEST_F(LookUpSpec, UnknownArgument) {
+    BSONObjBuilder spec;
+    spec.appendElements(validSpec());
+    spec.append("extra", "x");
+    ASSERT_THROWS_CODE(createLookUp(createSpec(spec.obj())), UserException, 28786);
+}
+
+TEST_F(LookUpSpec, MissingArgument) {
+    ASSERT_THROWS_CODE(createLookUp(createSpec(BSON("from"
+                                                    << "foreign"
+                                                    << "as"
+                                                    << "joined"
+                                                    << "localField"
+                                                    << "a"))),
+                       UserException,
+                       28787);
+}
+
+TEST_F(LookUpSpec, SerializeRoundTrips) {
+    auto lookUp = createLookUp(createSpec(validSpec()));
+    ASSERT_EQUALS(toBson(lookUp), createSpec(validSpec()));
+}
+
+TEST_F(LookUpSpec, ExplainWithoutMongodOmitsStrategy) {
+    auto lookUp = createLookUp(createSpec(validSpec()));
+    vector<Value> arr;
+    lookUp->serializeToArray(arr, true);
+    ASSERT_EQUALS(arr.size(), 1UL);
+    ASSERT_EQUALS(arr[0].getDocument().toBson(), createSpec(validSpec()));
+}
+
+TEST_F(LookUpSpec, DependsOnLocalField) {
+    auto lookUp = createLookUp(createSpec(validSpec()));
+    DepsTracker dependencies;
+    ASSERT_EQUALS(DocumentSource::SEE_NEXT, lookUp->getDependencies(&dependencies));
+    ASSERT_EQUALS(1U, dependencies.fields.size());
+    ASSERT_EQUALS(1U, dependencies.fields.count("a.b"));
+    ASSERT_EQUALS(false, dependencies.needWholeDocument);
+    ASSERT_EQUALS(false, dependencies.needTextScore);
+}
+
+TEST_F(LookUpSpec, InvolvesForeignCollection) {
+    auto lookUp = createLookUp(createSpec(validSpec()));
+    vector<NamespaceString> collections;
+    lookUp->addInvolvedCollections(&collections);
+    ASSERT_EQUALS(1U, collections.size());
+    ASSERT_EQUALS("unittests.foreign", collections[0].ns());
+    ASSERT(lookUp->needsPrimaryShard());
+}
+
+}  // namespace DocumentSourceLookUp
+
 namespace DocumentSourceMatch {
 using mongo::DocumentSourceMatch;
 
@@ -2106,6 +2225,7 @@ public:
         add<DocumentSourceGroup::Dependencies>();
         add<DocumentSourceGroup::StringConstantIdAndAccumulatorExpressions>();
         add<DocumentSourceGroup::ArrayConstantAccumulatorExpression>();
+        add<DocumentSourceGroup::BatchedAccumulatorsSpanBlocks>();
 
         add<DocumentSourceProject::Inclusion>();
         add<DocumentSourceProject::Optimize>();
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+/**
+ * A hash map keyed by Value, using open addressing with linear probing.
+ *
+ * Entries are stored contiguously in chunks, in insertion order, and are never moved once
+ * inserted, so references and pointers to them remain valid until clear(). The probe table
+ * only holds each entry's hash and position, which keeps lookups to a short scan of a flat
+ * array rather than a walk through per-node bucket chains.
+ *
+ * Keys are matched with Value's operator==, so, as with Value::Hash, numerically equal values
+ * of different types are the same key. Entries can't be erased individually.
+ */
+template <typename T>
+class FlatValueMap {
+public:
+    typedef std::pair<const Value, T> value_type;
+    typedef typename std::deque<value_type>::iterator iterator;
+    typedef typename std::deque<value_type>::const_iterator const_iterator;
+
+    /**
+     * Returns the mapped value for 'key', inserting a default constructed one if needed.
+     */
+    T& operator[](const Value& key) {
+        const size_t keyHash = hash(key);
+        if ((_entries.size() + 1) * 2 > _slots.size())
+            grow();
+
+        Slot& slot = _slots[findSlot(key, keyHash)];
+        if (slot.index == kEmptySlot) {
+            slot.hash = keyHash;
+            slot.index = _entries.size();
+            _entries.emplace_back(
+                std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+        }
+        return _entries[slot.index].second;
+    }
+
+    iterator find(const Value& key) {
+        if (_entries.empty())
+            return end();
+
+        const Slot& slot = _slots[findSlot(key, hash(key))];
+        return slot.index == kEmptySlot ? end() : _entries.begin() + slot.index;
+    }
+
+    /**
+     * Iteration is in insertion order.
+     */
+    iterator begin() {
+        return _entries.begin();
+    }
+    iterator end() {
+        return _entries.end();
+    }
+    const_iterator begin() const {
+        return _entries.begin();
+    }
+    const_iterator end() const {
+        return _entries.end();
+    }
+
+    size_t size() const {
+        return _entries.size();
+    }
+    bool empty() const {
+        return _entries.empty();
+    }
+
+    /**
+     * Removes all entries and releases the memory held by the map.
+     */
+    void clear() {
+        std::deque<value_type>().swap(_entries);
+        std::vector<Slot>().swap(_slots);
+    }
+
+    void swap(FlatValueMap& other) {
+        _entries.swap(other._entries);
+        _slots.swap(other._slots);
+    }
+
+    /**
+     * The hash used to place 'key'. Value::Hash is built on boost::hash_combine, whose low bits
+     * are poorly distributed for small integers, so its result is passed through a finalizer
+     * that spreads every input bit across the whole word. Callers partitioning keys may use any
+     * subset of the bits.
+     */
+    static size_t hash(const Value& key) {
+        // The 64-bit finalizer from MurmurHash3.
+        uint64_t h = Value::Hash()(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+private:
+    static const size_t kEmptySlot = std::numeric_limits<size_t>::max();
+    static const size_t kMinSlots = 16;
+
+    struct Slot {
+        size_t hash;
+        size_t index;  // Position in _entries, or kEmptySlot.
+    };
+
+    /**
+     * Returns the position of the slot holding 'key', or of the empty slot where it belongs.
+     * There is always an empty slot since the table is kept at most half full.
+     */
+    size_t findSlot(const Value& key, size_t keyHash) const {
+        const size_t mask = _slots.size() - 1;
+        for (size_t pos = keyHash & mask;; pos = (pos + 1) & mask) {
+            const Slot& slot = _slots[pos];
+            if (slot.index == kEmptySlot)
+                return pos;
+            if (slot.hash == keyHash && _entries[slot.index].first == key)
+                return pos;
+        }
+    }
+
+    void grow() {
+        const size_t newSize = _slots.empty() ? kMinSlots : _slots.size() * 2;
+        std::vector<Slot> oldSlots(newSize, Slot{0, kEmptySlot});
+        oldSlots.swap(_slots);
+
+        const size_t mask = newSize - 1;
+        for (const Slot& slot : oldSlots) {
+            if (slot.index == kEmptySlot)
+                continue;
+
+            size_t pos = slot.hash & mask;
+            while (_slots[pos].index != kEmptySlot) {
+                pos = (pos + 1) & mask;
+            }
+            _slots[pos] = slot;
+        }
+    }
+
+    std::deque<value_type> _entries;
+    std::vector<Slot> _slots;  // Size is zero or a power of two.
+};
+
+}  // namespace mongo
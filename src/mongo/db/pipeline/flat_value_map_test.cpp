@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/flat_value_map.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+typedef FlatValueMap<int> IntMap;
+
+TEST(FlatValueMapTest, EmptyMap) {
+    IntMap map;
+    ASSERT(map.empty());
+    ASSERT_EQUALS(0U, map.size());
+    ASSERT(map.find(Value(1)) == map.end());
+    ASSERT(map.begin() == map.end());
+}
+
+TEST(FlatValueMapTest, InsertAndFind) {
+    IntMap map;
+    map[Value(1)] = 10;
+    map[Value("a")] = 20;
+    map[Value(DOC("x" << 1))] = 30;
+    ASSERT_EQUALS(3U, map.size());
+
+    ASSERT_EQUALS(10, map.find(Value(1))->second);
+    ASSERT_EQUALS(20, map.find(Value("a"))->second);
+    ASSERT_EQUALS(30, map.find(Value(DOC("x" << 1)))->second);
+    ASSERT(map.find(Value(2)) == map.end());
+    ASSERT(map.find(Value("b")) == map.end());
+
+    // Looking up an existing key doesn't insert.
+    map[Value("a")] += 1;
+    ASSERT_EQUALS(3U, map.size());
+    ASSERT_EQUALS(21, map.find(Value("a"))->second);
+}
+
+TEST(FlatValueMapTest, NewEntriesAreDefaultConstructed) {
+    IntMap map;
+    ASSERT_EQUALS(0, map[Value(5)]);
+    ASSERT_EQUALS(1U, map.size());
+}
+
+TEST(FlatValueMapTest, NumericallyEqualKeysMatch) {
+    IntMap map;
+    map[Value(1)] = 1;
+    map[Value(1LL)] += 1;
+    map[Value(1.0)] += 1;
+    ASSERT_EQUALS(1U, map.size());
+    ASSERT_EQUALS(3, map.find(Value(1.0))->second);
+    ASSERT_EQUALS(Value(1), map.begin()->first);
+}
+
+TEST(FlatValueMapTest, IteratesInInsertionOrder) {
+    IntMap map;
+    for (int i = 99; i >= 0; i--) {
+        map[Value(i)] = i;
+    }
+
+    int expected = 99;
+    for (IntMap::const_iterator it = map.begin(); it != map.end(); ++it) {
+        ASSERT_EQUALS(Value(expected), it->first);
+        ASSERT_EQUALS(expected, it->second);
+        expected--;
+    }
+    ASSERT_EQUALS(-1, expected);
+}
+
+TEST(FlatValueMapTest, ReferencesSurviveGrowth) {
+    IntMap map;
+    std::vector<int*> refs;
+    for (int i = 0; i < 10000; i++) {
+        refs.push_back(&map[Value(i)]);
+        *refs.back() = i;
+    }
+    ASSERT_EQUALS(10000U, map.size());
+
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQUALS(refs[i], &map[Value(i)]);
+        ASSERT_EQUALS(i, *refs[i]);
+    }
+    ASSERT_EQUALS(10000U, map.size());
+}
+
+TEST(FlatValueMapTest, CollidingKeys) {
+    // Keys sharing a long common prefix still land on distinct entries.
+    IntMap map;
+    const std::string prefix(100, 'x');
+    for (int i = 0; i < 1000; i++) {
+        map[Value(prefix + std::to_string(i))] = i;
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQUALS(i, map.find(Value(prefix + std::to_string(i)))->second);
+    }
+}
+
+TEST(FlatValueMapTest, ClearAndSwap) {
+    IntMap map;
+    map[Value(1)] = 1;
+    map[Value(2)] = 2;
+
+    IntMap other;
+    other.swap(map);
+    ASSERT(map.empty());
+    ASSERT_EQUALS(2U, other.size());
+    ASSERT_EQUALS(2, other.find(Value(2))->second);
+
+    other.clear();
+    ASSERT(other.empty());
+    ASSERT(other.find(Value(1)) == other.end());
+
+    // The map is usable after clear().
+    other[Value(3)] = 3;
+    ASSERT_EQUALS(1U, other.size());
+    ASSERT_EQUALS(3, other.find(Value(3))->second);
+}
+
+TEST(FlatValueMapTest, HashMatchesForEqualKeys) {
+    ASSERT_EQUALS(IntMap::hash(Value(7)), IntMap::hash(Value(7.0)));
+    ASSERT_EQUALS(IntMap::hash(Value(7)), IntMap::hash(Value(7LL)));
+    ASSERT_EQUALS(IntMap::hash(Value("abc")), IntMap::hash(Value(std::string("abc"))));
+}
+
+}  // namespace
+}  // namespace mongo
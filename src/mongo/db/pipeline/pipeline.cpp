@@ -57,6 +57,7 @@ const char Pipeline::commandName[] = "aggregate";
 const char Pipeline::pipelineName[] = "pipeline";
 const char Pipeline::explainName[] = "explain";
 const char Pipeline::fromRouterName[] = "fromRouter";
+const char Pipeline::partitionOutputName[] = "partitionOutput";
 const char Pipeline::serverPipelineName[] = "serverPipeline";
 const char Pipeline::mongosPipelineName[] = "mongosPipeline";
 
@@ -85,7 +86,7 @@ intrusive_ptr<Pipeline> Pipeline::parseCommand(string& errmsg,
         }
 
         // ignore cursor options since they are handled externally.
-        if (str::equals(pFieldName, "cursor")) {
+        if (str::equals(pFieldName, "cursor") || str::equals(pFieldName, partitionOutputName)) {
             continue;
         }
 
@@ -455,6 +456,23 @@ bool Pipeline::needsPrimaryShardMerger() const {
     return false;
 }
 
+bool Pipeline::canMergeInPartitions() const {
+    if (sources.empty() || !dynamic_cast<DocumentSourceGroup*>(sources.front().get())) {
+        return false;
+    }
+
+    for (auto it = sources.begin() + 1; it != sources.end(); ++it) {
+        DocumentSource* source = it->get();
+        if (!dynamic_cast<DocumentSourceMatch*>(source) &&
+            !dynamic_cast<DocumentSourceProject*>(source) &&
+            !dynamic_cast<DocumentSourceRedact*>(source) &&
+            !dynamic_cast<DocumentSourceUnwind*>(source)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::vector<NamespaceString> Pipeline::getInvolvedCollections() const {
     std::vector<NamespaceString> collections;
     for (auto&& source : sources) {
@@ -94,6 +94,13 @@ public:
      */
     bool needsPrimaryShardMerger() const;
 
+    /**
+     * Returns true if this merger pipeline starts with a $group, and every later stage handles
+     * each document on its own. Such a merge gives the same results when the shards' output is
+     * partitioned by _id and each partition is merged separately.
+     */
+    bool canMergeInPartitions() const;
+
     /**
      * Returns any other collections involved in the pipeline in addition to the collection the
      * aggregation is run on.
@@ -157,6 +164,12 @@ public:
      */
     static const char commandName[];
 
+    /**
+     * Option on the command sent to the shards asking them to split their results into this many
+     * cursors, by a hash of each result's _id.
+     */
+    static const char partitionOutputName[];
+
     /*
       PipelineD is a "sister" class that has additional functionality
       for the Pipeline.  It exists because of linkage requirements.
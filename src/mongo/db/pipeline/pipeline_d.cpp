@@ -139,8 +139,12 @@ shared_ptr<PlanExecutor> PipelineD::prepareCursorSource(
 
     // Passing query an empty projection since it is faster to use ParsedDeps::extractFields().
     // This will need to change to support covering indexes (SERVER-12015). There is an
-    // exception for textScore since that can only be retrieved by a query projection.
-    const BSONObj projectionForQuery = deps.needTextScore ? deps.toProjection() : BSONObj();
+    // exception for textScore since that can only be retrieved by a query projection, and for
+    // record stores which can scan just the fields the pipeline depends on.
+    const bool canScanFields = collection && !deps.needWholeDocument &&
+        collection->getRecordStore()->supportsCursorForFields();
+    const BSONObj projectionForQuery =
+        (deps.needTextScore || canScanFields) ? deps.toProjection() : BSONObj();
 
     /*
       Look for an initial sort; we'll try to add this to the
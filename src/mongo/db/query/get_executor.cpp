@@ -305,10 +305,26 @@ Status prepareExecution(OperationContext* opCtx,
     CachedSolution* rawCS;
     if (PlanCache::shouldCacheQuery(*canonicalQuery) &&
         collection->infoCache()->getPlanCache()->get(*canonicalQuery, &rawCS).isOK()) {
-        // We have a CachedSolution.  Have the planner turn it into a QuerySolution.
+        // We have a CachedSolution.  If it carries a parameterized plan, bind our constants
+        // into it.  Otherwise have the planner turn it into a QuerySolution and attach the
+        // parameterized form of that solution to the cache entry for next time.  This also
+        // replaces a parameterized plan that failed to bind, for example because its index
+        // has since become multikey, so that later lookups don't keep paying for the failure.
         unique_ptr<CachedSolution> cs(rawCS);
-        QuerySolution* qs;
-        Status status = QueryPlanner::planFromCache(*canonicalQuery, plannerParams, *cs, &qs);
+        QuerySolution* qs = NULL;
+        Status status = Status::OK();
+        if (cs->parameterizedPlan) {
+            qs = cs->parameterizedPlan->bind(*canonicalQuery, plannerParams);
+        }
+        if (!qs) {
+            unique_ptr<ParameterizedPlan> parameterized;
+            status = QueryPlanner::planFromCache(
+                *canonicalQuery, plannerParams, *cs, &qs, &parameterized);
+            if (status.isOK() && (parameterized || cs->parameterizedPlan)) {
+                collection->infoCache()->getPlanCache()->setParameterizedPlan(
+                    *canonicalQuery, cs->parameterizedPlan.get(), std::move(parameterized));
+            }
+        }
 
         if (status.isOK()) {
             verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
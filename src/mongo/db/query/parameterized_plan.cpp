@@ -0,0 +1,269 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/parameterized_plan.h"
+
+#include "mongo/db/index_names.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/planner_analysis.h"
+#include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+typedef vector<const EqualityMatchExpression*> Equalities;
+
+/**
+ * Fills 'out' with the equalities making up 'root'. Returns false if 'root' is anything other
+ * than an equality or a conjunction of equalities.
+ */
+bool getEqualities(const MatchExpression* root, Equalities* out) {
+    if (MatchExpression::EQ == root->matchType()) {
+        out->push_back(static_cast<const EqualityMatchExpression*>(root));
+        return true;
+    }
+
+    if (MatchExpression::AND != root->matchType() || 0 == root->numChildren()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < root->numChildren(); ++i) {
+        const MatchExpression* child = root->getChild(i);
+        if (MatchExpression::EQ != child->matchType()) {
+            return false;
+        }
+        out->push_back(static_cast<const EqualityMatchExpression*>(child));
+    }
+    return true;
+}
+
+/**
+ * Returns the only equality on 'path', or NULL if there is none or more than one.
+ */
+const EqualityMatchExpression* findEquality(const Equalities& equalities, StringData path) {
+    const EqualityMatchExpression* found = NULL;
+    for (size_t i = 0; i < equalities.size(); ++i) {
+        if (equalities[i]->path() == path) {
+            if (found) {
+                return NULL;
+            }
+            found = equalities[i];
+        }
+    }
+    return found;
+}
+
+/**
+ * Returns true if an equality to 'data' is answered exactly by a single point interval.
+ */
+bool isPointEquality(const BSONElement& data) {
+    switch (data.type()) {
+        case Array:
+        case jstNULL:
+        case Undefined:
+        case MinKey:
+        case MaxKey:
+            return false;
+        default:
+            return true;
+    }
+}
+
+Interval makePoint(const BSONElement& data) {
+    return IndexBoundsBuilder::makePointInterval(IndexBoundsBuilder::objFromElement(data));
+}
+
+bool isExtreme(const BSONElement& elt) {
+    return MinKey == elt.type() || MaxKey == elt.type();
+}
+
+/**
+ * Returns true if 'oil' is [MinKey, MaxKey], in either direction.
+ */
+bool isAllValues(const OrderedIntervalList& oil) {
+    if (1 != oil.intervals.size()) {
+        return false;
+    }
+    const Interval& ival = oil.intervals[0];
+    return ival.startInclusive && ival.endInclusive && isExtreme(ival.start) &&
+        isExtreme(ival.end) && ival.start.type() != ival.end.type();
+}
+
+/**
+ * Returns the entry for the btree index with key pattern 'keyPattern', or NULL if there is no
+ * such index or it is a partial index.
+ */
+const IndexEntry* findIndex(const QueryPlannerParams& params, const BSONObj& keyPattern) {
+    for (size_t i = 0; i < params.indices.size(); ++i) {
+        const IndexEntry& entry = params.indices[i];
+        if (0 == entry.keyPattern.woCompare(keyPattern)) {
+            if (entry.filterExpr || IndexNames::BTREE != IndexNames::findPluginName(keyPattern)) {
+                return NULL;
+            }
+            return &entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Returns the index scan of a plan which is an index scan, possibly under a fetch, with no
+ * filters anywhere. Returns NULL for any other plan.
+ */
+const QuerySolutionNode* getUnfilteredScan(const QuerySolutionNode* root) {
+    if (STAGE_FETCH == root->getType()) {
+        if (root->filter || 1 != root->children.size()) {
+            return NULL;
+        }
+        root = root->children[0];
+    }
+
+    if (STAGE_IXSCAN != root->getType() || root->filter) {
+        return NULL;
+    }
+    return root;
+}
+
+IndexScanNode* getScan(QuerySolutionNode* root) {
+    return static_cast<IndexScanNode*>(
+        const_cast<QuerySolutionNode*>(getUnfilteredScan(root)));
+}
+
+}  // namespace
+
+ParameterizedPlan::ParameterizedPlan(unique_ptr<QuerySolutionNode> root,
+                                     IndexScanNode* scan,
+                                     vector<size_t> parameters)
+    : _root(std::move(root)), _scan(scan), _parameters(std::move(parameters)) {}
+
+ParameterizedPlan::~ParameterizedPlan() {}
+
+// static
+unique_ptr<ParameterizedPlan> ParameterizedPlan::make(const CanonicalQuery& query,
+                                                      const QueryPlannerParams& params,
+                                                      const QuerySolutionNode& dataAccessRoot) {
+    const QuerySolutionNode* scanNode = getUnfilteredScan(&dataAccessRoot);
+    if (!scanNode) {
+        return unique_ptr<ParameterizedPlan>();
+    }
+
+    const IndexScanNode* scan = static_cast<const IndexScanNode*>(scanNode);
+    if (scan->bounds.isSimpleRange || !findIndex(params, scan->indexKeyPattern)) {
+        return unique_ptr<ParameterizedPlan>();
+    }
+
+    Equalities equalities;
+    if (!getEqualities(query.root(), &equalities)) {
+        return unique_ptr<ParameterizedPlan>();
+    }
+
+    // Every equality must be the single point on its own field, and every other field must be
+    // unconstrained. Otherwise the bounds depend on the constants in ways we don't reproduce.
+    vector<size_t> parameters;
+    for (size_t i = 0; i < scan->bounds.fields.size(); ++i) {
+        const OrderedIntervalList& oil = scan->bounds.fields[i];
+        const EqualityMatchExpression* eq = findEquality(equalities, oil.name);
+        if (!eq) {
+            if (!isAllValues(oil)) {
+                return unique_ptr<ParameterizedPlan>();
+            }
+            continue;
+        }
+
+        if (!isPointEquality(eq->getData()) || 1 != oil.intervals.size() ||
+            !oil.intervals[0].equals(makePoint(eq->getData()))) {
+            return unique_ptr<ParameterizedPlan>();
+        }
+        parameters.push_back(i);
+    }
+
+    if (parameters.size() != equalities.size()) {
+        return unique_ptr<ParameterizedPlan>();
+    }
+
+    unique_ptr<QuerySolutionNode> root(dataAccessRoot.clone());
+    IndexScanNode* rootScan = getScan(root.get());
+    return unique_ptr<ParameterizedPlan>(
+        new ParameterizedPlan(std::move(root), rootScan, std::move(parameters)));
+}
+
+QuerySolution* ParameterizedPlan::bind(const CanonicalQuery& query,
+                                       const QueryPlannerParams& params) const {
+    Equalities equalities;
+    if (!getEqualities(query.root(), &equalities) || equalities.size() != _parameters.size()) {
+        return NULL;
+    }
+
+    // The index may have been rebuilt or become multikey since the plan was made.
+    const IndexEntry* index = findIndex(params, _scan->indexKeyPattern);
+    if (!index || index->multikey != _scan->indexIsMultiKey) {
+        return NULL;
+    }
+
+    unique_ptr<QuerySolutionNode> root(_root->clone());
+    IndexScanNode* scan = getScan(root.get());
+    scan->maxScan = query.getParsed().getMaxScan();
+    scan->addKeyMetadata = query.getParsed().returnKey();
+
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        OrderedIntervalList* oil = &scan->bounds.fields[_parameters[i]];
+        const EqualityMatchExpression* eq = findEquality(equalities, oil->name);
+        if (!eq || !isPointEquality(eq->getData())) {
+            return NULL;
+        }
+        oil->intervals.clear();
+        oil->intervals.push_back(makePoint(eq->getData()));
+    }
+
+    // Takes ownership of 'root'.
+    return QueryPlannerAnalysis::analyzeDataAccess(query, params, root.release());
+}
+
+string ParameterizedPlan::toString() const {
+    mongoutils::str::stream ss;
+    ss << "parameterized fields:";
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        ss << " " << _scan->bounds.fields[_parameters[i]].name;
+    }
+    ss << "\n";
+    _root->appendToString(&ss, 0);
+    return ss;
+}
+
+}  // namespace mongo
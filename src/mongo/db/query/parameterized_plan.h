@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+struct IndexScanNode;
+struct QueryPlannerParams;
+struct QuerySolution;
+struct QuerySolutionNode;
+
+/**
+ * A pre-built data access plan whose index bounds are the only thing that depends on the
+ * constants in the query. Queries of the same shape can be answered by cloning the plan and
+ * substituting their own constants into the bounds, without tagging the match expression or
+ * running the IndexBoundsBuilder.
+ *
+ * Only plans that are an index scan, optionally under a fetch, with neither node carrying a
+ * filter are parameterized, and only for queries which are a single equality or a conjunction
+ * of equalities. Each equality must be answered exactly by a point interval on its own field of
+ * the index, and every other field of the index must be unbounded. Under these conditions the
+ * bounds for any other constants are again a single point per field, which is what bind()
+ * produces.
+ *
+ * Instances are immutable once made and may be shared between threads.
+ */
+class ParameterizedPlan {
+    MONGO_DISALLOW_COPYING(ParameterizedPlan);
+
+public:
+    ~ParameterizedPlan();
+
+    /**
+     * Returns a parameterized copy of the data access plan 'dataAccessRoot', which was built
+     * by the planner for 'query', or NULL if the plan can't be parameterized.
+     */
+    static std::unique_ptr<ParameterizedPlan> make(const CanonicalQuery& query,
+                                                   const QueryPlannerParams& params,
+                                                   const QuerySolutionNode& dataAccessRoot);
+
+    /**
+     * Builds the solution for 'query', which must have the same shape as the query this plan
+     * was made from, by substituting its constants into a copy of the plan.
+     *
+     * Returns NULL if the constants can't be expressed as point bounds, or if the index used
+     * by the plan is no longer in 'params' in the same form. The caller should then plan the
+     * query the regular way. On success, the caller owns the returned solution.
+     */
+    QuerySolution* bind(const CanonicalQuery& query, const QueryPlannerParams& params) const;
+
+    // For debugging.
+    std::string toString() const;
+
+private:
+    ParameterizedPlan(std::unique_ptr<QuerySolutionNode> root,
+                      IndexScanNode* scan,
+                      std::vector<size_t> parameters);
+
+    // The data access plan, with the constants of the query it was made from in its bounds.
+    std::unique_ptr<QuerySolutionNode> _root;
+
+    // The index scan in '_root'. Not owned.
+    IndexScanNode* _scan;
+
+    // Positions in the index bounds of the fields that are bound to a constant of the query.
+    std::vector<size_t> _parameters;
+};
+
+}  // namespace mongo
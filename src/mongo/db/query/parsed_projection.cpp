@@ -28,6 +28,8 @@
 
 #include "mongo/db/query/parsed_projection.h"
 
+#include <algorithm>
+
 #include "mongo/db/query/lite_parsed_query.h"
 
 namespace mongo {
@@ -268,6 +270,28 @@ Status ParsedProjection::make(const BSONObj& spec,
         }
     }
 
+    // An inclusion projection only reads the top-level fields its paths start with, which
+    // lets a collection scan skip the rest of each document.
+    if (!include && !hasNonSimple && ARRAY_OP_NORMAL == arrayOpType && !hasIndexKeyProjection) {
+        if (includeID) {
+            pp->_requiredTopLevelFields.push_back("_id");
+        }
+
+        BSONObjIterator srcIt(spec);
+        while (srcIt.more()) {
+            BSONElement elt = srcIt.next();
+            if (!elt.trueValue()) {
+                continue;
+            }
+            const std::string field = mongoutils::str::before(elt.fieldName(), '.');
+            if (std::find(pp->_requiredTopLevelFields.begin(),
+                          pp->_requiredTopLevelFields.end(),
+                          field) == pp->_requiredTopLevelFields.end()) {
+                pp->_requiredTopLevelFields.push_back(field);
+            }
+        }
+    }
+
     // returnKey clobbers everything.
     if (hasIndexKeyProjection) {
         pp->_requiresDocument = false;
@@ -74,6 +74,15 @@ public:
         return _requiredFields;
     }
 
+    /**
+     * If the projection is a plain inclusion, possibly of dotted fields, returns the top-level
+     * fields it reads from the document, including _id unless it's excluded. Returns an empty
+     * vector for any other projection, which may need the whole document.
+     */
+    const std::vector<std::string>& getRequiredTopLevelFields() const {
+        return _requiredTopLevelFields;
+    }
+
     /**
      * Get the raw BSONObj proj spec obj
      */
@@ -127,6 +136,8 @@ private:
     // TODO: stringdata?
     std::vector<std::string> _requiredFields;
 
+    std::vector<std::string> _requiredTopLevelFields;
+
     bool _requiresMatchDetails;
 
     bool _requiresDocument;
@@ -211,4 +211,31 @@ TEST(ParsedProjectionTest, DBRefProjections) {
     // so these fields cannot be arrays.
     createParsedProjection("{'a.$id': {$elemMatch: {x: 1}}}", "{'a.$id.$': 1}");
 }
+
+//
+// Top-level fields read by the projection
+//
+
+void assertTopLevelFields(const char* projStr, const vector<std::string>& expected) {
+    unique_ptr<ParsedProjection> parsedProj(createParsedProjection("{}", projStr));
+    ASSERT(expected == parsedProj->getRequiredTopLevelFields());
+}
+
+TEST(ParsedProjectionTest, RequiredTopLevelFieldsForInclusion) {
+    assertTopLevelFields("{a: 1}", {"_id", "a"});
+    assertTopLevelFields("{a: 1, _id: 0}", {"a"});
+    assertTopLevelFields("{_id: 1}", {"_id"});
+    assertTopLevelFields("{'a.b': 1, 'a.c': 1, d: true}", {"_id", "a", "d"});
+    assertTopLevelFields("{'_id.x': 1}", {"_id"});
+}
+
+TEST(ParsedProjectionTest, NoRequiredTopLevelFieldsUnlessInclusion) {
+    assertTopLevelFields("{}", {});
+    assertTopLevelFields("{a: 0}", {});
+    assertTopLevelFields("{_id: 0}", {});
+    assertTopLevelFields("{a: 1, b: {$slice: 1}}", {});
+    assertTopLevelFields("{a: 1, b: {$elemMatch: {c: 1}}}", {});
+    assertTopLevelFields("{a: 1, b: {$meta: 'textScore'}}", {});
+    assertTopLevelFields("{a: {$meta: 'indexKey'}}", {});
+}
 }  // unnamed namespace
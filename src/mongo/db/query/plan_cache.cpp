@@ -312,7 +312,8 @@ CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& en
       query(entry.query.getOwned()),
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
-      decisionWorks(entry.decision->stats[0]->common.works) {
+      decisionWorks(entry.decision->stats[0]->common.works),
+      parameterizedPlan(entry.parameterizedPlan) {
     // CachedSolution should not having any references into
     // cache entry. All relevant data should be cloned/copied.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
@@ -372,6 +373,7 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
     entry->query = query.getOwned();
     entry->sort = sort.getOwned();
     entry->projection = projection.getOwned();
+    entry->parameterizedPlan = parameterizedPlan;
 
     // Copy performance stats.
     for (size_t i = 0; i < feedback.size(); ++i) {
@@ -688,6 +690,26 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     return Status::OK();
 }
 
+Status PlanCache::setParameterizedPlan(const CanonicalQuery& cq,
+                                       const ParameterizedPlan* expected,
+                                       std::unique_ptr<ParameterizedPlan> plan) {
+    PlanCacheKey ck = computeKey(cq);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry;
+    Status cacheStatus = _cache.get(ck, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    invariant(entry);
+
+    if (entry->parameterizedPlan.get() == expected) {
+        entry->parameterizedPlan = std::move(plan);
+    }
+
+    return Status::OK();
+}
+
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     return _cache.remove(computeKey(canonicalQuery));
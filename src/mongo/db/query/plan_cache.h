@@ -35,6 +35,7 @@
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/parameterized_plan.h"
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
@@ -200,6 +201,10 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     size_t decisionWorks;
+
+    // The winning plan with its constants parameterized, if the entry has one. Shared with the
+    // cache entry since it is never modified.
+    std::shared_ptr<const ParameterizedPlan> parameterizedPlan;
 };
 
 /**
@@ -237,6 +242,11 @@ public:
     // it from the cache a deep copy is made and returned inside CachedSolution.
     std::vector<SolutionCacheData*> plannerData;
 
+    // Built from the winning plan the first time it is recovered from the cache, if the plan
+    // only depends on the query's constants through its index bounds. Lets later queries of
+    // this shape skip planFromCache(...) by rebinding the bounds.
+    std::shared_ptr<const ParameterizedPlan> parameterizedPlan;
+
     // TODO: Do we really want to just hold a copy of the CanonicalQuery?  For now we just
     // extract the data we need.
     //
@@ -327,6 +337,21 @@ public:
      */
     Status feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* feedback);
 
+    /**
+     * Attaches 'plan' to the entry for 'cq' so that later lookups of this shape can bind their
+     * constants into it instead of rebuilding the plan from the cached index tags. 'plan' may be
+     * NULL, which removes the entry's parameterized plan.
+     *
+     * 'expected' is the parameterized plan the caller saw in the entry, or NULL if it had none.
+     * The entry is only changed if it still holds 'expected', so that a plan which failed to
+     * bind is replaced but one installed by a concurrent lookup is kept.
+     *
+     * Returns an error Status if the entry corresponding to 'cq' isn't in the cache anymore.
+     */
+    Status setParameterizedPlan(const CanonicalQuery& cq,
+                                const ParameterizedPlan* expected,
+                                std::unique_ptr<ParameterizedPlan> plan);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -608,6 +608,59 @@ protected:
         return out;
     }
 
+    /**
+     * Recovers 'soln' from a mock cache entry for 'cachedQuery' with projection 'proj', asking
+     * the planner for a parameterized copy of the plan, and then binds the constants of 'query'
+     * into it.
+     *
+     * Returns NULL if the plan was not parameterized or could not be bound. Otherwise the
+     * caller owns the result.
+     */
+    QuerySolution* bindParameterizedPlan(const BSONObj& cachedQuery,
+                                         const BSONObj& query,
+                                         const QuerySolution& soln,
+                                         const BSONObj& proj = BSONObj()) const {
+        auto statusWithCachedCQ = CanonicalQuery::canonicalize(nss, cachedQuery, BSONObj(), proj);
+        ASSERT_OK(statusWithCachedCQ.getStatus());
+        unique_ptr<CanonicalQuery> cachedCq = std::move(statusWithCachedCQ.getValue());
+
+        QuerySolution qs;
+        qs.cacheData.reset(soln.cacheData->clone());
+        std::vector<QuerySolution*> solutions;
+        solutions.push_back(&qs);
+        PlanCacheEntry entry(solutions, createDecision(1U));
+        CachedSolution cachedSoln(ck, entry);
+
+        QuerySolution* out;
+        unique_ptr<ParameterizedPlan> parameterized;
+        ASSERT_OK(
+            QueryPlanner::planFromCache(*cachedCq, params, cachedSoln, &out, &parameterized));
+        delete out;
+        if (!parameterized) {
+            return NULL;
+        }
+
+        auto statusWithCQ = CanonicalQuery::canonicalize(nss, query, BSONObj(), proj);
+        ASSERT_OK(statusWithCQ.getStatus());
+        return parameterized->bind(*statusWithCQ.getValue(), params);
+    }
+
+    /**
+     * Asserts that the plan matching 'solnJson' for the previously run 'cachedQuery' is
+     * parameterized, and that binding 'query' into it gives a solution matching 'boundJson'.
+     */
+    void assertParameterizedPlanBinds(const BSONObj& cachedQuery,
+                                      const string& solnJson,
+                                      const BSONObj& query,
+                                      const string& boundJson,
+                                      const BSONObj& proj = BSONObj()) {
+        QuerySolution* bestSoln = firstMatchingSolution(solnJson);
+        unique_ptr<QuerySolution> bound(
+            bindParameterizedPlan(cachedQuery, query, *bestSoln, proj));
+        ASSERT(bound.get());
+        assertSolutionMatches(bound.get(), boundJson);
+    }
+
     /**
      * @param solnJson -- a json representation of a query solution.
      *
@@ -717,6 +770,240 @@ TEST_F(CachePlanSelectionTest, EqualityIndexScanWithTrailingFields) {
         BSON("x" << 5), "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1, y: 1}}}}}");
 }
 
+//
+// Parameterized plans
+//
+
+TEST_F(CachePlanSelectionTest, ParameterizedEqualityRebindsBounds) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5));
+
+    assertParameterizedPlanBinds(
+        BSON("x" << 5),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}",
+        BSON("x" << 7),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}, bounds: {x: [[7, 7, true, "
+        "true]]}}}}}");
+}
+
+TEST_F(CachePlanSelectionTest, ParameterizedEqualityAcceptsOtherTypes) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5));
+
+    assertParameterizedPlanBinds(
+        BSON("x" << 5),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}",
+        BSON("x"
+             << "foo"),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}, bounds: {x: [['foo', 'foo', "
+        "true, true]]}}}}}");
+}
+
+TEST_F(CachePlanSelectionTest, ParameterizedEqualityWithTrailingFields) {
+    addIndex(BSON("x" << 1 << "y" << -1));
+    runQuery(BSON("x" << 5));
+
+    // The unbounded trailing field is left as it is.
+    assertParameterizedPlanBinds(
+        BSON("x" << 5),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1, y: -1}}}}}",
+        BSON("x" << 6),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1, y: -1}, bounds: {x: [[6, 6, "
+        "true, true]]}}}}}");
+}
+
+TEST_F(CachePlanSelectionTest, ParameterizedConjunction) {
+    addIndex(BSON("x" << 1 << "y" << 1));
+    runQuery(BSON("x" << 5 << "y" << 6));
+
+    assertParameterizedPlanBinds(
+        BSON("x" << 5 << "y" << 6),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1, y: 1}}}}}",
+        BSON("x" << 1 << "y" << 2),
+        "{fetch: {filter: null, node: {ixscan: {pattern: {x: 1, y: 1}, bounds: {x: [[1, 1, "
+        "true, true]], y: [[2, 2, true, true]]}}}}}");
+}
+
+TEST_F(CachePlanSelectionTest, ParameterizedCoveredProjection) {
+    addIndex(BSON("x" << 1));
+    runQuerySortProj(BSON("x" << 5), BSONObj(), fromjson("{_id: 0, x: 1}"));
+
+    assertParameterizedPlanBinds(
+        BSON("x" << 5),
+        "{proj: {spec: {_id: 0, x: 1}, node: {ixscan: {filter: null, pattern: {x: 1}}}}}",
+        BSON("x" << 8),
+        "{proj: {spec: {_id: 0, x: 1}, node: {ixscan: {filter: null, pattern: {x: 1}, bounds: "
+        "{x: [[8, 8, true, true]]}}}}}",
+        fromjson("{_id: 0, x: 1}"));
+}
+
+TEST_F(CachePlanSelectionTest, ResidualFilterIsNotParameterized) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5 << "z" << 3));
+
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: {z: 3}, node: {ixscan: {pattern: {x: 1}}}}}");
+    ASSERT(NULL == bindParameterizedPlan(
+                       BSON("x" << 5 << "z" << 3), BSON("x" << 6 << "z" << 4), *bestSoln));
+}
+
+TEST_F(CachePlanSelectionTest, RangeIsNotParameterized) {
+    addIndex(BSON("x" << 1));
+    runQuery(fromjson("{x: {$gt: 5}}"));
+
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+    ASSERT(NULL ==
+           bindParameterizedPlan(fromjson("{x: {$gt: 5}}"), fromjson("{x: {$gt: 6}}"), *bestSoln));
+}
+
+TEST_F(CachePlanSelectionTest, NullEqualityIsNotParameterized) {
+    addIndex(BSON("x" << 1));
+    runQuery(fromjson("{x: null}"));
+
+    QuerySolution* bestSoln = firstMatchingSolution("{fetch: {node: {ixscan: {pattern: {x: 1}}}}}");
+    ASSERT(NULL == bindParameterizedPlan(fromjson("{x: null}"), fromjson("{x: 3}"), *bestSoln));
+}
+
+TEST_F(CachePlanSelectionTest, ParameterizedPlanRejectsArrayConstant) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5));
+
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+    ASSERT(NULL == bindParameterizedPlan(BSON("x" << 5), fromjson("{x: [1, 2]}"), *bestSoln));
+}
+
+TEST_F(CachePlanSelectionTest, ParameterizedPlanRejectsChangedIndex) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5));
+
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+    auto statusWithCQ = CanonicalQuery::canonicalize(nss, BSON("x" << 5));
+    ASSERT_OK(statusWithCQ.getStatus());
+    unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    QuerySolution qs;
+    qs.cacheData.reset(bestSoln->cacheData->clone());
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(&qs);
+    PlanCacheEntry entry(solutions, createDecision(1U));
+    CachedSolution cachedSoln(ck, entry);
+
+    QuerySolution* out;
+    unique_ptr<ParameterizedPlan> parameterized;
+    ASSERT_OK(QueryPlanner::planFromCache(*cq, params, cachedSoln, &out, &parameterized));
+    delete out;
+    ASSERT(parameterized.get());
+
+    // The index becoming multikey invalidates the plan.
+    params.indices.back().multikey = true;
+    ASSERT(NULL == parameterized->bind(*cq, params));
+
+    // As does the index going away.
+    params.indices.pop_back();
+    ASSERT(NULL == parameterized->bind(*cq, params));
+}
+
+// Mirrors the cache hit path of getExecutor(): once the cached parameterized plan stops binding,
+// it is replaced by the one made from the replanned solution.
+TEST_F(CachePlanSelectionTest, ParameterizedPlanIsReplacedWhenBindFails) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5));
+
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+    auto statusWithCQ = CanonicalQuery::canonicalize(nss, BSON("x" << 5));
+    ASSERT_OK(statusWithCQ.getStatus());
+    unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(bestSoln->cacheData->clone());
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(&qs);
+    ASSERT_OK(planCache.add(*cq, solutions, createDecision(1U)));
+
+    // Plans from the cache, and if the cached parameterized plan doesn't bind, replaces it.
+    // Returns whether the cached parameterized plan was used.
+    auto planFromCache = [&]() -> bool {
+        CachedSolution* rawCS;
+        ASSERT_OK(planCache.get(*cq, &rawCS));
+        unique_ptr<CachedSolution> cs(rawCS);
+        if (cs->parameterizedPlan) {
+            unique_ptr<QuerySolution> bound(cs->parameterizedPlan->bind(*cq, params));
+            if (bound) {
+                return true;
+            }
+        }
+
+        QuerySolution* out;
+        unique_ptr<ParameterizedPlan> parameterized;
+        ASSERT_OK(QueryPlanner::planFromCache(*cq, params, *cs, &out, &parameterized));
+        delete out;
+        ASSERT_OK(planCache.setParameterizedPlan(
+            *cq, cs->parameterizedPlan.get(), std::move(parameterized)));
+        return false;
+    };
+
+    ASSERT_FALSE(planFromCache());
+    ASSERT_TRUE(planFromCache());
+
+    // The index becoming multikey makes the cached plan fail to bind once, after which the
+    // plan made for the multikey index is used.
+    params.indices.back().multikey = true;
+    ASSERT_FALSE(planFromCache());
+    ASSERT_TRUE(planFromCache());
+}
+
+TEST_F(CachePlanSelectionTest, SetParameterizedPlanKeepsPlanInstalledConcurrently) {
+    addIndex(BSON("x" << 1));
+    runQuery(BSON("x" << 5));
+
+    QuerySolution* bestSoln =
+        firstMatchingSolution("{fetch: {filter: null, node: {ixscan: {pattern: {x: 1}}}}}");
+    auto statusWithCQ = CanonicalQuery::canonicalize(nss, BSON("x" << 5));
+    ASSERT_OK(statusWithCQ.getStatus());
+    unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(bestSoln->cacheData->clone());
+    std::vector<QuerySolution*> solutions;
+    solutions.push_back(&qs);
+    ASSERT_OK(planCache.add(*cq, solutions, createDecision(1U)));
+
+    CachedSolution* rawCS;
+    ASSERT_OK(planCache.get(*cq, &rawCS));
+    unique_ptr<CachedSolution> cs(rawCS);
+    auto makeParameterized = [&]() {
+        QuerySolution* out;
+        unique_ptr<ParameterizedPlan> parameterized;
+        ASSERT_OK(QueryPlanner::planFromCache(*cq, params, *cs, &out, &parameterized));
+        delete out;
+        ASSERT(parameterized.get());
+        return parameterized;
+    };
+
+    unique_ptr<ParameterizedPlan> first = makeParameterized();
+    const ParameterizedPlan* firstPtr = first.get();
+    ASSERT_OK(planCache.setParameterizedPlan(*cq, NULL, std::move(first)));
+
+    // A lookup which saw no plan doesn't overwrite the one installed since.
+    ASSERT_OK(planCache.setParameterizedPlan(*cq, NULL, makeParameterized()));
+    CachedSolution* rawUpdated;
+    ASSERT_OK(planCache.get(*cq, &rawUpdated));
+    unique_ptr<CachedSolution> updated(rawUpdated);
+    ASSERT_EQUALS(firstPtr, updated->parameterizedPlan.get());
+
+    // Passing the current plan replaces it, here by clearing it.
+    ASSERT_OK(planCache.setParameterizedPlan(*cq, firstPtr, unique_ptr<ParameterizedPlan>()));
+    ASSERT_OK(planCache.get(*cq, &rawUpdated));
+    updated.reset(rawUpdated);
+    ASSERT(NULL == updated->parameterizedPlan.get());
+}
+
 //
 // Geo
 //
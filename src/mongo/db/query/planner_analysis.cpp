@@ -30,6 +30,7 @@
 
 #include "mongo/db/query/planner_analysis.h"
 
+#include <algorithm>
 #include <set>
 #include <vector>
 
@@ -281,6 +282,53 @@ void geoSkipValidationOn(const std::set<StringData>& twoDSphereFields,
     }
 }
 
+/**
+ * Adds the top-level fields of the paths 'expr' reads to 'fields'. Returns false if 'expr' may
+ * read fields which can't be determined from its paths, such as a $where.
+ */
+bool addTopLevelFields(const MatchExpression* expr, vector<string>* fields) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                if (!addTopLevelFields(expr->getChild(i), fields)) {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            break;
+    }
+
+    if (expr->path().empty()) {
+        return false;
+    }
+
+    const string field = expr->path().toString().substr(0, expr->path().find('.'));
+    if (std::find(fields->begin(), fields->end(), field) == fields->end()) {
+        fields->push_back(field);
+    }
+    return true;
+}
+
+/**
+ * If only some top-level fields of each document are read by the projection above 'csn' and by
+ * the filter of 'csn', tells the scan so that it may skip the others.
+ */
+void setCollectionScanFields(const ParsedProjection& proj, CollectionScanNode* csn) {
+    if (csn->tailable || proj.getRequiredTopLevelFields().empty()) {
+        return;
+    }
+
+    vector<string> fields = proj.getRequiredTopLevelFields();
+    if (csn->filter && !addTopLevelFields(csn->filter.get(), &fields)) {
+        return;
+    }
+    csn->fields.swap(fields);
+}
+
 }  // namespace
 
 // static
@@ -756,6 +804,10 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(const CanonicalQuery& que
             }
         }
 
+        if (STAGE_COLLSCAN == solnRoot->getType()) {
+            setCollectionScanFields(*query.getProj(), static_cast<CollectionScanNode*>(solnRoot));
+        }
+
         // We now know we have whatever data is required for the projection.
         ProjectionNode* projNode = new ProjectionNode();
         projNode->children.push_back(solnRoot);
@@ -101,4 +101,7 @@ extern int internalQueryExecYieldIterations;
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern int internalQueryExecYieldPeriodMS;
 
+// Do collection scans and fetches evaluate their filters with a CompiledMatchExpression?
+extern bool internalQueryExecCompileFilters;
+
 }  // namespace mongo
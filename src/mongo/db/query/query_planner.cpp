@@ -39,6 +39,7 @@
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/matcher/expression_text.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/parameterized_plan.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -333,7 +334,8 @@ Status QueryPlanner::tagAccordingToCache(MatchExpression* filter,
 Status QueryPlanner::planFromCache(const CanonicalQuery& query,
                                    const QueryPlannerParams& params,
                                    const CachedSolution& cachedSoln,
-                                   QuerySolution** out) {
+                                   QuerySolution** out,
+                                   std::unique_ptr<ParameterizedPlan>* parameterizedOut) {
     invariant(!cachedSoln.plannerData.empty());
     invariant(out);
 
@@ -409,6 +411,11 @@ Status QueryPlanner::planFromCache(const CanonicalQuery& query,
                                     << query.toStringShort());
     }
 
+    // Analysis may modify the data access plan, so the parameterized copy is taken first.
+    if (parameterizedOut) {
+        *parameterizedOut = ParameterizedPlan::make(query, params, *solnRoot);
+    }
+
     // Takes ownership of 'solnRoot'.
     QuerySolution* soln = QueryPlannerAnalysis::analyzeDataAccess(query, params, solnRoot);
     if (!soln) {
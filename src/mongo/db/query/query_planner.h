@@ -36,6 +36,7 @@ namespace mongo {
 
 class CachedSolution;
 class Collection;
+class ParameterizedPlan;
 
 /**
  * QueryPlanner's job is to provide an entry point to the query planning and optimization
@@ -65,13 +66,17 @@ public:
      * @param cachedSoln -- the CachedSolution retrieved from the plan cache.
      * @param out -- an out-parameter which will be filled in with the solution
      *   generated from the cache data
+     * @param parameterizedOut -- if not NULL, and the solution only depends on the
+     *   query's constants through its index bounds, filled in with a parameterized
+     *   copy of the solution's data access plan. See ParameterizedPlan.
      *
      * On success, the caller is responsible for deleting *out.
      */
     static Status planFromCache(const CanonicalQuery& query,
                                 const QueryPlannerParams& params,
                                 const CachedSolution& cachedSoln,
-                                QuerySolution** out);
+                                QuerySolution** out,
+                                std::unique_ptr<ParameterizedPlan>* parameterizedOut = NULL);
 
     /**
      * Used to generated the index tag tree that will be inserted
@@ -1317,6 +1317,30 @@ TEST_F(QueryPlannerTest, ProjNonCovering) {
         "{ixscan: {filter: null, pattern: {x: 1}}}}}}}");
 }
 
+TEST_F(QueryPlannerTest, ProjCollscanFields) {
+    runQuerySortProj(fromjson("{b: 1, 'c.d': {$gt: 1}}"), BSONObj(), fromjson("{'a.x': 1}"));
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertSolutionExists(
+        "{proj: {spec: {'a.x': 1}, node: {cscan: "
+        "{dir: 1, fields: ['_id', 'a', 'b', 'c']}}}}");
+}
+
+TEST_F(QueryPlannerTest, ProjCollscanFieldsNotSetForExclusion) {
+    runQuerySortProj(fromjson("{b: 1}"), BSONObj(), fromjson("{a: 0}"));
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertSolutionExists("{proj: {spec: {a: 0}, node: {cscan: {dir: 1, fields: []}}}}");
+}
+
+TEST_F(QueryPlannerTest, ProjCollscanFieldsNotSetForSlice) {
+    runQuerySortProj(fromjson("{b: 1}"), BSONObj(), fromjson("{a: 1, c: {$slice: 1}}"));
+
+    ASSERT_EQUALS(getNumSolutions(), 1U);
+    assertSolutionExists(
+        "{proj: {spec: {a: 1, c: {$slice: 1}}, node: {cscan: {dir: 1, fields: []}}}}");
+}
+
 //
 // Basic sort
 //
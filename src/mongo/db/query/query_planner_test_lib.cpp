@@ -220,6 +220,21 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             return false;
         }
 
+        BSONElement fields = csObj["fields"];
+        if (!fields.eoo()) {
+            if (Array != fields.type()) {
+                return false;
+            }
+            std::vector<std::string> expected;
+            BSONObjIterator it(fields.Obj());
+            while (it.more()) {
+                expected.push_back(it.next().String());
+            }
+            if (expected != csn->fields) {
+                return false;
+            }
+        }
+
         BSONElement filter = csObj["filter"];
         if (filter.eoo()) {
             return true;
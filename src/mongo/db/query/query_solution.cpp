@@ -115,6 +115,14 @@ void CollectionScanNode::appendToString(mongoutils::str::stream* ss, int indent)
     *ss << "COLLSCAN\n";
     addIndent(ss, indent + 1);
     *ss << "ns = " << name << '\n';
+    if (!fields.empty()) {
+        addIndent(ss, indent + 1);
+        *ss << "fields =";
+        for (size_t i = 0; i < fields.size(); ++i) {
+            *ss << " " << fields[i];
+        }
+        *ss << '\n';
+    }
     if (NULL != filter) {
         addIndent(ss, indent + 1);
         *ss << "filter = " << filter->toString();
@@ -131,6 +139,7 @@ QuerySolutionNode* CollectionScanNode::clone() const {
     copy->tailable = this->tailable;
     copy->direction = this->direction;
     copy->maxScan = this->maxScan;
+    copy->fields = this->fields;
 
     return copy;
 }
@@ -295,6 +295,10 @@ struct CollectionScanNode : public QuerySolutionNode {
 
     // maxScan option to .find() limits how many docs we look at.
     int maxScan;
+
+    // If non-empty, the top-level fields read by the filter and the projection above the scan.
+    // The scan only needs to produce these fields. See CollectionScanParams.
+    std::vector<std::string> fields;
 };
 
 struct AndHashNode : public QuerySolutionNode {
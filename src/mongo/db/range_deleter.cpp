@@ -366,7 +366,7 @@ bool RangeDeleter::deleteNow(OperationContext* txn,
     taskDetails.stats.queueEndTS = jsTime();
 
     taskDetails.stats.deleteStartTS = jsTime();
-    bool result = _env->deleteRange(txn, taskDetails, &taskDetails.stats.deletedDocCount, errMsg);
+    bool result = _env->deleteRange(txn, taskDetails, &taskDetails.stats, errMsg);
 
     taskDetails.stats.deleteEndTS = jsTime();
 
@@ -494,8 +494,7 @@ void RangeDeleter::doWork() {
         {
             auto txn = client->makeOperationContext();
             nextTask->stats.deleteStartTS = jsTime();
-            bool delResult =
-                _env->deleteRange(txn.get(), *nextTask, &nextTask->stats.deletedDocCount, &errMsg);
+            bool delResult = _env->deleteRange(txn.get(), *nextTask, &nextTask->stats, &errMsg);
             nextTask->stats.deleteEndTS = jsTime();
 
             if (delResult) {
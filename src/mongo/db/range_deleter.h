@@ -256,8 +256,15 @@ struct DeleteJobStats {
     Date_t waitForReplEndTS;
 
     long long int deletedDocCount;
+    long long int deletedBytes;
 
-    DeleteJobStats() : deletedDocCount(0) {}
+    // Number of write units of work the documents were deleted in.
+    long long int batchCount;
+
+    // Time the delete spent sleeping to stay under its rate limit.
+    long long int throttledMillis;
+
+    DeleteJobStats() : deletedDocCount(0), deletedBytes(0), batchCount(0), throttledMillis(0) {}
 };
 
 struct RangeDeleterOptions {
@@ -310,10 +317,12 @@ struct RangeDeleterEnv {
      *
      * Must be a synchronous call. Docs should be deleted after call ends.
      * Must not throw Exceptions.
+     *
+     * Fills in the counts of what was deleted in 'stats', but not its timestamps.
      */
     virtual bool deleteRange(OperationContext* txn,
                              const RangeDeleteEntry& taskDetails,
-                             long long int* deletedDocs,
+                             DeleteJobStats* stats,
                              std::string* errMsg) = 0;
 
     /**
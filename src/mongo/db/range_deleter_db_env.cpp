@@ -61,7 +61,7 @@ using std::string;
  */
 bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
                                     const RangeDeleteEntry& taskDetails,
-                                    long long int* deletedDocs,
+                                    DeleteJobStats* stats,
                                     std::string* errMsg) {
     const string ns(taskDetails.options.range.ns);
     const BSONObj inclusiveLower(taskDetails.options.range.minKey);
@@ -73,7 +73,7 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
 
     Client::initThreadIfNotAlready("RangeDeleter");
 
-    *deletedDocs = 0;
+    stats->deletedDocCount = 0;
     ShardForceVersionOkModeBlock forceVersion(txn->getClient());
     {
         Helpers::RemoveSaver removeSaver("moveChunk", ns, taskDetails.options.removeSaverReason);
@@ -88,24 +88,30 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
               << exclusiveUpper << ", with opId: " << opId << endl;
 
         try {
-            *deletedDocs =
+            Helpers::RemoveRangeStats removeStats;
+            stats->deletedDocCount =
                 Helpers::removeRange(txn,
                                      KeyRange(ns, inclusiveLower, exclusiveUpper, keyPattern),
                                      false, /*maxInclusive*/
                                      writeConcern,
                                      removeSaverPtr,
                                      fromMigrate,
-                                     onlyRemoveOrphans);
+                                     onlyRemoveOrphans,
+                                     &removeStats);
+            stats->deletedBytes = removeStats.deletedBytes;
+            stats->batchCount = removeStats.batches;
+            stats->throttledMillis = removeStats.throttledMillis;
 
-            if (*deletedDocs < 0) {
+            if (stats->deletedDocCount < 0) {
                 *errMsg = "collection or index dropped before data could be cleaned";
                 warning() << *errMsg << endl;
 
                 return false;
             }
 
-            log() << "rangeDeleter deleted " << *deletedDocs << " documents for " << ns << " from "
-                  << inclusiveLower << " -> " << exclusiveUpper << endl;
+            log() << "rangeDeleter deleted " << stats->deletedDocCount << " documents ("
+                  << stats->deletedBytes << " bytes in " << stats->batchCount << " batches) for "
+                  << ns << " from " << inclusiveLower << " -> " << exclusiveUpper << endl;
         } catch (const DBException& ex) {
             *errMsg = str::stream() << "Error encountered while deleting range: "
                                     << "ns" << ns << " from " << inclusiveLower << " -> "
@@ -46,13 +46,13 @@ struct RangeDeleterDBEnv : public RangeDeleterEnv {
      * Note that secondaryThrottle will be ignored if current process is not part
      * of a replica set.
      *
-     * docsDeleted would contain the number of docs deleted if the deletion was successful.
+     * stats would contain the number of docs and bytes deleted if the deletion was successful.
      *
      * Does not throw Exceptions.
      */
     virtual bool deleteRange(OperationContext* txn,
                              const RangeDeleteEntry& taskDetails,
-                             long long int* deletedDocs,
+                             DeleteJobStats* stats,
                              std::string* errMsg);
 
     /**
@@ -103,7 +103,7 @@ DeletedRange RangeDeleterMockEnv::getLastDelete() const {
 
 bool RangeDeleterMockEnv::deleteRange(OperationContext* txn,
                                       const RangeDeleteEntry& taskDetails,
-                                      long long int* deletedDocs,
+                                      DeleteJobStats* stats,
                                       string* errMsg) {
     {
         stdx::unique_lock<stdx::mutex> sl(_pauseDeleteMutex);
@@ -126,7 +126,7 @@ public:
      */
     bool deleteRange(OperationContext* txn,
                      const RangeDeleteEntry& taskDetails,
-                     long long int* deletedDocs,
+                     DeleteJobStats* stats,
                      std::string* errMsg);
 
     /**
@@ -145,8 +145,12 @@ size_t getSize(const BSONObj& o) {
 }
 }  // namespace
 
+size_t BackgroundSync::_getBatchSize(const OplogBatch& batch) {
+    return batch.bytes;
+}
+
 BackgroundSync::BackgroundSync()
-    : _buffer(bufferMaxSizeGauge, &getSize),
+    : _buffer(bufferMaxSizeGauge, &_getBatchSize),
       _lastOpTimeFetched(Timestamp(std::numeric_limits<int>::max(), 0),
                          std::numeric_limits<long long>::max()),
       _lastFetchedHash(0),
@@ -170,6 +174,11 @@ void BackgroundSync::shutdown() {
     // Clear the buffer in case the producerThread is waiting in push() due to a full queue.
     invariant(inShutdown());
     _buffer.clear();
+    {
+        stdx::lock_guard<stdx::mutex> consumerLock(_consumerMutex);
+        _consumerBatch = OplogBatch();
+        _consumerBatchPos = 0;
+    }
     _pause = true;
 
     // Wake up producerThread so it notices that we're in shutdown
@@ -181,7 +190,7 @@ void BackgroundSync::notify(OperationContext* txn) {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
 
     // If all ops in the buffer have been applied, unblock waitForRepl (if it's waiting)
-    if (_buffer.empty()) {
+    if (_isBufferEmpty()) {
         _appliedBuffer = true;
         _appliedBufferCondition.notify_all();
     }
@@ -422,24 +431,28 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
     }
 
     // process documents
-    int currentBatchMessageSize = 0;
-    for (auto documentIter = documentBegin; documentIter != documentEnd; ++documentIter) {
+    // The documents share the fetcher's reply buffer, so the batch holds on to the reply rather
+    // than copying each op out of it.
+    OplogBatch batch;
+    batch.ops.assign(documentBegin, documentEnd);
+    for (const auto& op : batch.ops) {
+        batch.bytes += getSize(op);
+    }
+    const int currentBatchMessageSize = batch.bytes;
+
+    if (!batch.ops.empty()) {
         if (inShutdown()) {
             return;
         }
 
         // If we are transitioning to primary state, we need to leave
-        // this loop in order to go into bgsync-pause mode.
+        // in order to go into bgsync-pause mode.
         if (_replCoord->isWaitingForApplierToDrain() || _replCoord->getMemberState().primary()) {
             LOG(1) << "waiting for draining or we are primary, not adding more ops to buffer";
             return;
         }
 
-        // At this point, we are guaranteed to have at least one thing to read out
-        // of the fetcher.
-        const BSONObj& o = *documentIter;
-        currentBatchMessageSize += o.objsize();
-        opsReadStats.increment();
+        opsReadStats.increment(batch.ops.size());
 
         if (MONGO_FAIL_POINT(stepDownWhileDrainingFailPoint)) {
             sleepsecs(20);
@@ -454,14 +467,18 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
             LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes";
         }
 
-        bufferCountGauge.increment();
-        bufferSizeGauge.increment(getSize(o));
-        _buffer.push(o);
+        const BSONObj& lastOp = batch.ops.back();
+        const long long lastHash = lastOp["h"].numberLong();
+        const OpTime lastOpTime = fassertStatusOK(28770, OpTime::parseFromBSON(lastOp));
+
+        bufferCountGauge.increment(batch.ops.size());
+        bufferSizeGauge.increment(batch.bytes);
+        _buffer.push(std::move(batch));
 
         {
             stdx::unique_lock<stdx::mutex> lock(_mutex);
-            _lastFetchedHash = o["h"].numberLong();
-            _lastOpTimeFetched = fassertStatusOK(28770, OpTime::parseFromBSON(o));
+            _lastFetchedHash = lastHash;
+            _lastOpTimeFetched = lastOpTime;
             LOG(3) << "lastOpTimeFetched: " << _lastOpTimeFetched;
         }
     }
@@ -521,23 +538,62 @@ bool BackgroundSync::_shouldChangeSyncSource(const HostAndPort& syncSource) {
 }
 
 
+bool BackgroundSync::_loadConsumerBatch_inlock() {
+    if (_consumerBatchPos < _consumerBatch.ops.size()) {
+        return true;
+    }
+
+    OplogBatch nextBatch;
+    if (!_buffer.tryPop(nextBatch)) {
+        return false;
+    }
+    _consumerBatch = std::move(nextBatch);
+    _consumerBatchPos = 0;
+    return !_consumerBatch.ops.empty();
+}
+
+bool BackgroundSync::_isBufferEmpty() const {
+    stdx::lock_guard<stdx::mutex> lock(_consumerMutex);
+    return _consumerBatchPos >= _consumerBatch.ops.size() && _buffer.empty();
+}
+
 bool BackgroundSync::peek(BSONObj* op) {
-    return _buffer.peek(*op);
+    stdx::lock_guard<stdx::mutex> lock(_consumerMutex);
+    if (!_loadConsumerBatch_inlock()) {
+        return false;
+    }
+    *op = _consumerBatch.ops[_consumerBatchPos];
+    return true;
 }
 
 void BackgroundSync::waitForMore() {
-    BSONObj op;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_consumerMutex);
+        if (_consumerBatchPos < _consumerBatch.ops.size()) {
+            return;
+        }
+    }
+
     // Block for one second before timing out.
-    // Ignore the value of the op we peeked at.
-    _buffer.blockingPeek(op, 1);
+    _buffer.waitForNonEmpty(1);
 }
 
 void BackgroundSync::consume() {
     // this is just to get the op off the queue, it's been peeked at
     // and queued for application already
-    BSONObj op = _buffer.blockingPop();
-    bufferCountGauge.decrement(1);
-    bufferSizeGauge.decrement(getSize(op));
+    stdx::lock_guard<stdx::mutex> lock(_consumerMutex);
+    if (!_loadConsumerBatch_inlock()) {
+        // The buffer was cleared after the op was peeked at.
+        return;
+    }
+
+    if (++_consumerBatchPos == _consumerBatch.ops.size()) {
+        bufferCountGauge.decrement(_consumerBatch.ops.size());
+        bufferSizeGauge.decrement(_consumerBatch.bytes);
+        // Release the fetcher reply backing the batch.
+        _consumerBatch = OplogBatch();
+        _consumerBatchPos = 0;
+    }
 }
 
 void BackgroundSync::_rollback(OperationContext* txn,
@@ -581,7 +637,7 @@ void BackgroundSync::stop() {
 }
 
 void BackgroundSync::start(OperationContext* txn) {
-    massert(16235, "going to start syncing, but buffer is not empty", _buffer.empty());
+    massert(16235, "going to start syncing, but buffer is not empty", _isBufferEmpty());
 
     long long lastFetchedHash = _readLastAppliedHash(txn);
     stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -607,7 +663,10 @@ void BackgroundSync::waitUntilPaused() {
 }
 
 void BackgroundSync::clearBuffer() {
+    stdx::lock_guard<stdx::mutex> lock(_consumerMutex);
     _buffer.clear();
+    _consumerBatch = OplogBatch();
+    _consumerBatchPos = 0;
 }
 
 long long BackgroundSync::_readLastAppliedHash(OperationContext* txn) {
@@ -654,7 +713,12 @@ void BackgroundSync::setInitialSyncRequestedFlag(bool value) {
 
 void BackgroundSync::pushTestOpToBuffer(const BSONObj& op) {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
-    _buffer.push(op);
+    OplogBatch batch;
+    batch.ops.push_back(op);
+    batch.bytes = getSize(op);
+    bufferCountGauge.increment();
+    bufferSizeGauge.increment(batch.bytes);
+    _buffer.push(std::move(batch));
 }
 
 
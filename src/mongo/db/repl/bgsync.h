@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/status_with.h"
 #include "mongo/client/fetcher.h"
 #include "mongo/db/jsobj.h"
@@ -79,6 +81,7 @@ public:
  * 1. rslock
  * 2. rwlock
  * 3. BackgroundSync::_mutex
+ * 4. BackgroundSync::_consumerMutex
  */
 class BackgroundSync : public BackgroundSyncInterface {
 public:
@@ -137,14 +140,33 @@ public:
     void pushTestOpToBuffer(const BSONObj& op);
 
 private:
+    /**
+     * The ops from one fetcher response. The producer hands these to the applier as a whole so
+     * that the buffer is locked and accounted for once per batch rather than once per op.
+     */
+    struct OplogBatch {
+        std::vector<BSONObj> ops;
+        // Sum of the sizes of 'ops'.
+        size_t bytes = 0;
+    };
+
+    static size_t _getBatchSize(const OplogBatch& batch);
+
     static BackgroundSync* s_instance;
     // protects creation of s_instance
     static stdx::mutex s_mutex;
 
     // Production thread
-    BlockingQueue<BSONObj> _buffer;
+    BlockingQueue<OplogBatch> _buffer;
+
+    // _consumerMutex protects the batch the applier is currently reading ops from. It is only
+    // contended when the buffer is cleared.
+    mutable stdx::mutex _consumerMutex;
+    OplogBatch _consumerBatch;
+    size_t _consumerBatchPos = 0;
 
-    // _mutex protects all of the class variables except _syncSourceReader and _buffer
+    // _mutex protects all of the class variables except _syncSourceReader, _buffer and the
+    // consumer batch.
     mutable stdx::mutex _mutex;
 
     OpTime _lastOpTimeFetched;
@@ -165,6 +187,13 @@ private:
     BackgroundSync(const BackgroundSync& s);
     BackgroundSync operator=(const BackgroundSync& s);
 
+    // Loads the next batch from _buffer if the current one has been consumed. Returns false if
+    // there is no op left to read. Must be called with _consumerMutex held.
+    bool _loadConsumerBatch_inlock();
+
+    // Returns true if there are no fetched ops left to apply, including in the consumer batch.
+    bool _isBufferEmpty() const;
+
     // Production thread
     void _producerThread(executor::TaskExecutor* taskExecutor);
     void _produce(OperationContext* txn, executor::TaskExecutor* taskExecutor);
@@ -32,6 +32,8 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -39,6 +41,23 @@
 namespace mongo {
 namespace repl {
 
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncClonerBufferSizeBytes, int, 256 * 1024 * 1024);
+
+namespace {
+
+// Bytes of documents queued for insertion by all collection cloners in this process.
+AtomicInt64 totalBufferedBytes;
+
+long long batchSizeBytes(const std::vector<BSONObj>& documents) {
+    long long bytes = 0;
+    for (auto&& doc : documents) {
+        bytes += doc.objsize();
+    }
+    return bytes;
+}
+
+}  // namespace
+
 CollectionCloner::CollectionCloner(ReplicationExecutor* executor,
                                    const HostAndPort& source,
                                    const NamespaceString& sourceNss,
@@ -53,6 +72,12 @@ CollectionCloner::CollectionCloner(ReplicationExecutor* executor,
       _onCompletion(onCompletion),
       _storageInterface(storageInterface),
       _active(false),
+      _batches(),
+      _batchesBytes(0),
+      _dbWorkerActive(false),
+      _lastBatchReceived(false),
+      _pendingGetMore(),
+      _status(Status::OK()),
       _listIndexesFetcher(_executor,
                           _source,
                           _sourceNss.db().toString(),
@@ -72,7 +97,6 @@ CollectionCloner::CollectionCloner(ReplicationExecutor* executor,
                               stdx::placeholders::_2,
                               stdx::placeholders::_3)),
       _indexSpecs(),
-      _documents(),
       _dbWorkCallbackHandle(),
       _scheduleDbWorkFn([this](const ReplicationExecutor::CallbackFn& work) {
           return _executor->scheduleDBWork(work);
@@ -87,7 +111,8 @@ CollectionCloner::CollectionCloner(ReplicationExecutor* executor,
 }
 
 CollectionCloner::~CollectionCloner() {
-    DESTRUCTOR_GUARD(cancel(); wait(););
+    // The find fetcher may still be delivering a batch after a failed insert finished the cloner.
+    DESTRUCTOR_GUARD(cancel(); wait(); _findFetcher.cancel(); _findFetcher.wait(););
 }
 
 const NamespaceString& CollectionCloner::getSourceNamespace() const {
@@ -106,6 +131,9 @@ std::string CollectionCloner::getDiagnosticString() const {
     output << " active: " << _active;
     output << " listIndexes fetcher: " << _listIndexesFetcher.getDiagnosticString();
     output << " find fetcher: " << _findFetcher.getDiagnosticString();
+    output << " queued batches: " << _batches.size();
+    output << " queued bytes: " << _batchesBytes;
+    output << " fetcher paused: " << !_pendingGetMore.isEmpty();
     output << " database worked callback handle: " << (_dbWorkCallbackHandle.isValid() ? "valid"
                                                                                        : "invalid");
     return output;
@@ -143,6 +171,11 @@ void CollectionCloner::cancel() {
         }
 
         dbWorkCallbackHandle = _dbWorkCallbackHandle;
+
+        // A database worker that is already running must not resume a paused fetcher.
+        if (_dbWorkerActive && _status.isOK()) {
+            _status = Status(ErrorCodes::CallbackCanceled, "collection cloner canceled");
+        }
     }
 
     _listIndexesFetcher.cancel();
@@ -223,29 +256,56 @@ void CollectionCloner::_listIndexesCallback(const Fetcher::QueryResponseStatus&
 void CollectionCloner::_findCallback(const StatusWith<Fetcher::QueryResponse>& fetchResult,
                                      Fetcher::NextAction* nextAction,
                                      BSONObjBuilder* getMoreBob) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+    // Cloning has already failed. Let the fetcher kill the cursor.
+    if (!_status.isOK()) {
+        if (nextAction) {
+            *nextAction = Fetcher::NextAction::kNoAction;
+        }
+        return;
+    }
+
     if (!fetchResult.isOK()) {
+        _status = fetchResult.getStatus();
+        if (_dbWorkerActive) {
+            // The database worker finishes the cloner when it is done with its current batch.
+            return;
+        }
+        lk.unlock();
         _finishCallback(nullptr, fetchResult.getStatus());
         return;
     }
 
     auto batchData(fetchResult.getValue());
-    _documents = batchData.documents;
-
-    bool lastBatch = *nextAction == Fetcher::NextAction::kNoAction;
-    auto&& scheduleResult = _scheduleDbWorkFn(stdx::bind(
-        &CollectionCloner::_insertDocumentsCallback, this, stdx::placeholders::_1, lastBatch));
-    if (!scheduleResult.isOK()) {
-        _finishCallback(nullptr, scheduleResult.getStatus());
-        return;
-    }
+    const long long bytes = batchSizeBytes(batchData.documents);
+    _batches.push_back(std::move(batchData.documents));
+    _batchesBytes += bytes;
+    const long long totalBytes = totalBufferedBytes.addAndFetch(bytes);
 
+    _lastBatchReceived = *nextAction == Fetcher::NextAction::kNoAction;
     if (*nextAction == Fetcher::NextAction::kGetMore) {
-        invariant(getMoreBob);
-        getMoreBob->append("getMore", batchData.cursorId);
-        getMoreBob->append("collection", batchData.nss.coll());
+        BSONObj getMoreCmdObj =
+            BSON("getMore" << batchData.cursorId << "collection" << batchData.nss.coll());
+        if (totalBytes > initialSyncClonerBufferSizeBytes) {
+            // Keep the cursor open on the sync source but stop reading until the database worker
+            // has made room in the buffer.
+            _pendingGetMore = getMoreCmdObj;
+            *nextAction = Fetcher::NextAction::kExitAndKeepCursorAlive;
+        } else {
+            invariant(getMoreBob);
+            getMoreBob->appendElements(getMoreCmdObj);
+        }
     }
 
-    _dbWorkCallbackHandle = scheduleResult.getValue();
+    if (!_scheduleDbWorker_inlock()) {
+        *nextAction = Fetcher::NextAction::kNoAction;
+        _pendingGetMore = BSONObj();
+        _clearBatches_inlock();
+        Status status = _status;
+        lk.unlock();
+        _finishCallback(nullptr, status);
+    }
 }
 
 void CollectionCloner::_beginCollectionCallback(const ReplicationExecutor::CallbackArgs& cbd) {
@@ -268,28 +328,116 @@ void CollectionCloner::_beginCollectionCallback(const ReplicationExecutor::Callb
     }
 }
 
-void CollectionCloner::_insertDocumentsCallback(const ReplicationExecutor::CallbackArgs& cbd,
-                                                bool lastBatch) {
+void CollectionCloner::_insertDocumentsCallback(const ReplicationExecutor::CallbackArgs& cbd) {
     OperationContext* txn = cbd.txn;
-    if (!cbd.status.isOK()) {
-        _finishCallback(txn, cbd.status);
-        return;
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (!cbd.status.isOK() && _status.isOK()) {
+        _status = cbd.status;
     }
 
-    Status status = _storageInterface->insertDocuments(txn, _destNss, _documents);
-    if (!status.isOK()) {
-        _finishCallback(txn, status);
-        return;
+    while (_status.isOK() && !_batches.empty()) {
+        std::vector<BSONObj> documents = std::move(_batches.front());
+        _batches.pop_front();
+        const long long bytes = batchSizeBytes(documents);
+
+        // The fetcher keeps queueing batches while this one is inserted.
+        lk.unlock();
+        Status status = _storageInterface->insertDocuments(txn, _destNss, documents);
+        lk.lock();
+
+        _batchesBytes -= bytes;
+        totalBufferedBytes.subtractAndFetch(bytes);
+        if (!status.isOK()) {
+            _status = status;
+            break;
+        }
+
+        // Resume reading once this cloner has caught up with the fetched batches or all cloners
+        // together are back under budget.
+        if (!_pendingGetMore.isEmpty() &&
+            (_batches.empty() || totalBufferedBytes.load() <= initialSyncClonerBufferSizeBytes)) {
+            Status resumeStatus = _resumeFetch_inlock();
+            if (!resumeStatus.isOK()) {
+                _status = resumeStatus;
+                break;
+            }
+        }
     }
 
-    if (!lastBatch) {
+    _dbWorkerActive = false;
+
+    // The fetcher schedules the worker again when the next batch arrives.
+    if (_status.isOK() && !_lastBatchReceived) {
         return;
     }
 
-    _finishCallback(txn, Status::OK());
+    Status status = _status;
+    _clearBatches_inlock();
+    lk.unlock();
+    _finishCallback(txn, status);
+}
+
+bool CollectionCloner::_scheduleDbWorker_inlock() {
+    if (_dbWorkerActive) {
+        return true;
+    }
+
+    auto&& scheduleResult = _scheduleDbWorkFn(
+        stdx::bind(&CollectionCloner::_insertDocumentsCallback, this, stdx::placeholders::_1));
+    if (!scheduleResult.isOK()) {
+        _status = scheduleResult.getStatus();
+        return false;
+    }
+
+    _dbWorkerActive = true;
+    _dbWorkCallbackHandle = scheduleResult.getValue();
+    return true;
+}
+
+Status CollectionCloner::_resumeFetch_inlock() {
+    invariant(!_pendingGetMore.isEmpty());
+
+    // The fetcher stays active until the callback that left the cursor alive has returned.
+    _findFetcher.wait();
+    Status status = _findFetcher.scheduleGetMore(_pendingGetMore);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    _pendingGetMore = BSONObj();
+    return Status::OK();
+}
+
+void CollectionCloner::_clearBatches_inlock() {
+    totalBufferedBytes.subtractAndFetch(_batchesBytes);
+    _batchesBytes = 0;
+    _batches.clear();
 }
 
 void CollectionCloner::_finishCallback(OperationContext* txn, const Status& status) {
+    BSONObj pendingGetMore;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        pendingGetMore.swap(_pendingGetMore);
+    }
+
+    // Nobody will read the rest of a cursor that was left alive by a pause.
+    if (!pendingGetMore.isEmpty()) {
+        BSONObj killCursorsCmdObj =
+            BSON("killCursors" << _sourceNss.coll() << "cursors"
+                               << BSON_ARRAY(pendingGetMore.firstElement().numberLong()));
+        auto scheduleResult = _executor->scheduleRemoteCommand(
+            executor::RemoteCommandRequest(_source, _sourceNss.db().toString(), killCursorsCmdObj),
+            [](const ReplicationExecutor::RemoteCommandCallbackArgs& args) {
+                if (!args.response.isOK()) {
+                    log() << "killCursors command failed: " << args.response.getStatus();
+                }
+            });
+        if (!scheduleResult.isOK()) {
+            log() << "failed to schedule killCursors command: " << scheduleResult.getStatus();
+        }
+    }
+
     if (status.isOK()) {
         auto commitStatus = _storageInterface->commitCollection(txn, _destNss);
         if (!commitStatus.isOK()) {
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -48,6 +49,10 @@
 namespace mongo {
 namespace repl {
 
+// Bytes of fetched documents that all collection cloners together may hold in memory while they
+// wait to be inserted. Cloners stop reading from the sync source while the total is over it.
+extern int initialSyncClonerBufferSizeBytes;
+
 class CollectionCloner : public BaseCloner {
     MONGO_DISALLOW_COPYING(CollectionCloner);
 
@@ -145,14 +150,29 @@ private:
     void _beginCollectionCallback(const ReplicationExecutor::CallbackArgs& callbackData);
 
     /**
-     * Called multiple times if there are more than one batch of documents from the fetcher.
-     * On the last batch, 'lastBatch' will be true.
+     * Database worker that inserts the queued batches of documents, oldest first, via the
+     * storage interface while the fetcher keeps reading. At most one is scheduled at a time.
      *
-     * Each document returned will be inserted via the storage interfaceRequest storage
-     * interface.
+     * Resumes reading from a cursor that was left alive while the buffer was over budget, and
+     * finishes the cloner after the last batch has been inserted or on error.
+     */
+    void _insertDocumentsCallback(const ReplicationExecutor::CallbackArgs& callbackData);
+
+    /**
+     * Schedules the database worker unless it is already active.
+     * Returns false and records the error in '_status' if the worker could not be scheduled.
+     */
+    bool _scheduleDbWorker_inlock();
+
+    /**
+     * Issues the getMore saved in '_pendingGetMore'.
+     */
+    Status _resumeFetch_inlock();
+
+    /**
+     * Drops batches that will not be inserted and returns their bytes to the shared budget.
      */
-    void _insertDocumentsCallback(const ReplicationExecutor::CallbackArgs& callbackData,
-                                  bool lastBatch);
+    void _clearBatches_inlock();
 
     /**
      * Reports completion status.
@@ -183,15 +203,31 @@ private:
     // _active is true when Collection Cloner is started.
     bool _active;
 
+    // Batches of documents read by the find fetcher and not yet inserted, oldest first, and
+    // their total size in bytes.
+    std::deque<std::vector<BSONObj>> _batches;
+    long long _batchesBytes;
+
+    // True while the database worker inserting '_batches' is scheduled or running.
+    bool _dbWorkerActive;
+
+    // True once the find fetcher has delivered the last batch of the collection.
+    bool _lastBatchReceived;
+
+    // getMore command for the find cursor, saved instead of issued while the buffer was over
+    // budget. Empty while the find fetcher is reading.
+    BSONObj _pendingGetMore;
+
+    // First error seen by the fetcher or the database worker. Once it is set, no more batches are
+    // read and the cloner finishes as soon as the database worker is not active.
+    Status _status;
+
     // Fetcher instances for running listIndexes and find commands.
     Fetcher _listIndexesFetcher;
     Fetcher _findFetcher;
 
     std::vector<BSONObj> _indexSpecs;
 
-    // Current batch of documents read from fetcher to insert into collection.
-    std::vector<BSONObj> _documents;
-
     // Callback handle for database worker.
     ReplicationExecutor::CallbackHandle _dbWorkCallbackHandle;
 
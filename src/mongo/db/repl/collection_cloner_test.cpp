@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "mongo/db/commands.h"
@@ -52,10 +53,12 @@ protected:
 
     CollectionOptions options;
     std::unique_ptr<CollectionCloner> collectionCloner;
+    int savedBufferSizeBytes;
 };
 
 void CollectionClonerTest::setUp() {
     BaseClonerTest::setUp();
+    savedBufferSizeBytes = initialSyncClonerBufferSizeBytes;
     options.reset();
     options.storageEngine = BSON("storageEngine1" << BSONObj());
     collectionCloner.reset(new CollectionCloner(
@@ -72,6 +75,7 @@ void CollectionClonerTest::tearDown() {
     // Executor may still invoke collection cloner's callback before shutting down.
     collectionCloner.reset();
     options.reset();
+    initialSyncClonerBufferSizeBytes = savedBufferSizeBytes;
 }
 
 BaseCloner* CollectionClonerTest::getCloner() const {
@@ -489,4 +493,112 @@ TEST_F(CollectionClonerTest, InsertDocumentsMultipleBatches) {
     ASSERT_FALSE(collectionCloner->isActive());
 }
 
+TEST_F(CollectionClonerTest, InsertDocumentsQueuesBatchesWhileWorkerIsActive) {
+    ASSERT_OK(collectionCloner->start());
+
+    std::vector<BSONObj> collDocuments;
+    storageInterface->insertDocumentsFn = [&](OperationContext* txn,
+                                              const NamespaceString& theNss,
+                                              const std::vector<BSONObj>& theDocuments) {
+        collDocuments.insert(collDocuments.end(), theDocuments.begin(), theDocuments.end());
+        return Status::OK();
+    };
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+
+    collectionCloner->waitForDbWorker();
+
+    // Hold on to the database work so that the fetcher gets ahead of the inserts.
+    auto&& executor = getReplExecutor();
+    std::vector<std::pair<ReplicationExecutor::CallbackFn, ReplicationExecutor::CallbackHandle>>
+        dbWork;
+    collectionCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+        auto scheduleResult =
+            executor.scheduleWork([](const ReplicationExecutor::CallbackArgs&) {});
+        ASSERT_OK(scheduleResult.getStatus());
+        dbWork.emplace_back(workFn, scheduleResult.getValue());
+        return scheduleResult;
+    });
+
+    const BSONObj doc = BSON("_id" << 1);
+    processNetworkResponse(createCursorResponse(1, BSON_ARRAY(doc)));
+    ASSERT_EQUALS(1U, dbWork.size());
+    ASSERT_TRUE(collDocuments.empty());
+
+    // The second batch is queued behind the first one for the same database worker.
+    const BSONObj doc2 = BSON("_id" << 2);
+    processNetworkResponse(createCursorResponse(0, BSON_ARRAY(doc2), "nextBatch"));
+    ASSERT_EQUALS(1U, dbWork.size());
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    dbWork[0].first(ReplicationExecutor::CallbackArgs(&executor, dbWork[0].second, Status::OK()));
+    ASSERT_EQUALS(2U, collDocuments.size());
+    ASSERT_EQUALS(doc, collDocuments[0]);
+    ASSERT_EQUALS(doc2, collDocuments[1]);
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+}
+
+TEST_F(CollectionClonerTest, InsertDocumentsPausesFetcherWhenBufferIsFull) {
+    ASSERT_OK(collectionCloner->start());
+
+    std::vector<BSONObj> collDocuments;
+    storageInterface->insertDocumentsFn = [&](OperationContext* txn,
+                                              const NamespaceString& theNss,
+                                              const std::vector<BSONObj>& theDocuments) {
+        collDocuments.insert(collDocuments.end(), theDocuments.begin(), theDocuments.end());
+        return Status::OK();
+    };
+
+    processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+
+    collectionCloner->waitForDbWorker();
+
+    auto&& executor = getReplExecutor();
+    std::vector<std::pair<ReplicationExecutor::CallbackFn, ReplicationExecutor::CallbackHandle>>
+        dbWork;
+    collectionCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+        auto scheduleResult =
+            executor.scheduleWork([](const ReplicationExecutor::CallbackArgs&) {});
+        ASSERT_OK(scheduleResult.getStatus());
+        dbWork.emplace_back(workFn, scheduleResult.getValue());
+        return scheduleResult;
+    });
+
+    // Any batch is over this budget.
+    initialSyncClonerBufferSizeBytes = 1;
+
+    const BSONObj doc = BSON("_id" << 1);
+    processNetworkResponse(createCursorResponse(1, BSON_ARRAY(doc)));
+
+    // The cursor is left open but no getMore is sent until the batch has been inserted.
+    auto net = getNet();
+    ASSERT_FALSE(net->hasReadyRequests());
+    ASSERT_TRUE(collectionCloner->isActive());
+    ASSERT_EQUALS(1U, dbWork.size());
+
+    dbWork[0].first(ReplicationExecutor::CallbackArgs(&executor, dbWork[0].second, Status::OK()));
+    ASSERT_EQUALS(1U, collDocuments.size());
+    ASSERT_EQUALS(doc, collDocuments[0]);
+
+    ASSERT_TRUE(net->hasReadyRequests());
+    NetworkOperationIterator noi = net->getNextReadyRequest();
+    auto&& noiRequest = noi->getRequest();
+    ASSERT_EQUALS("getMore", std::string(noiRequest.cmdObj.firstElementFieldName()));
+    ASSERT_EQUALS(1LL, noiRequest.cmdObj.firstElement().numberLong());
+
+    const BSONObj doc2 = BSON("_id" << 2);
+    scheduleNetworkResponse(noi, createCursorResponse(0, BSON_ARRAY(doc2), "nextBatch"));
+    finishProcessingNetworkResponse();
+    ASSERT_EQUALS(2U, dbWork.size());
+
+    dbWork[1].first(ReplicationExecutor::CallbackArgs(&executor, dbWork[1].second, Status::OK()));
+    ASSERT_EQUALS(2U, collDocuments.size());
+    ASSERT_EQUALS(doc2, collDocuments[1]);
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+}
+
 }  // namespace
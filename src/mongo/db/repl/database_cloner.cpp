@@ -37,6 +37,7 @@
 #include <set>
 
 #include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
@@ -45,6 +46,8 @@
 namespace mongo {
 namespace repl {
 
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncMaxConcurrentCollectionCloners, int, 4);
+
 namespace {
 
 const char* kNameFieldName = "name";
@@ -97,6 +100,8 @@ DatabaseCloner::DatabaseCloner(ReplicationExecutor* executor,
                                          stdx::placeholders::_1,
                                          stdx::placeholders::_2,
                                          stdx::placeholders::_3)),
+      _activeCollectionCloners(0),
+      _startCollectionClonerStatus(Status::OK()),
       _scheduleDbWorkFn([this](const ReplicationExecutor::CallbackFn& work) {
           return _executor->scheduleDBWork(work);
       }),
@@ -128,6 +133,7 @@ std::string DatabaseCloner::getDiagnosticString() const {
     output << " active: " << _active;
     output << " collection info objects (empty if listCollections is in progress): "
            << _collectionInfos.size();
+    output << " active collection cloners: " << _activeCollectionCloners;
     return output;
 }
 
@@ -284,18 +290,9 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         collectionCloner.setScheduleDbWorkFn(_scheduleDbWorkFn);
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
-
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
-
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << startStatus;
-        _finishCallback(startStatus);
-        return;
-    }
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    _startCollectionCloners_inlock(&lk);
 }
 
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
@@ -304,22 +301,40 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     // from cloning the rest of the collections in the listCollections result.
     _collectionWork(status, nss);
 
-    _currentCollectionClonerIter++;
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
+    _startCollectionCloners_inlock(&lk);
+}
+
+void DatabaseCloner::_startCollectionCloners_inlock(stdx::unique_lock<stdx::mutex>* lk) {
+    // Starting a collection cloner only schedules its first remote command, so its completion
+    // callback cannot run until the mutex is released.
+    const size_t maxActive = std::max(1, initialSyncMaxConcurrentCollectionCloners);
+    while (_startCollectionClonerStatus.isOK() && _activeCollectionCloners < maxActive &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto&& collectionCloner = *_nextCollectionClonerIter++;
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
 
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
+        Status startStatus = _startCollectionCloner(collectionCloner);
         if (!startStatus.isOK()) {
             LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": " << startStatus;
-            _finishCallback(startStatus);
-            return;
+                   << collectionCloner.getSourceNamespace() << ": " << startStatus;
+            _startCollectionClonerStatus = startStatus;
+            break;
         }
+        ++_activeCollectionCloners;
+    }
+
+    // Wait for the collection cloners that are still running.
+    if (_activeCollectionCloners > 0) {
         return;
     }
 
-    _finishCallback(Status::OK());
+    Status status = _startCollectionClonerStatus;
+    lk->unlock();
+    _finishCallback(status);
 }
 
 void DatabaseCloner::_finishCallback(const Status& status) {
@@ -47,6 +47,9 @@
 namespace mongo {
 namespace repl {
 
+// Number of collections of a database that are cloned at the same time.
+extern int initialSyncMaxConcurrentCollectionCloners;
+
 class DatabaseCloner : public BaseCloner {
     MONGO_DISALLOW_COPYING(DatabaseCloner);
 
@@ -70,6 +73,7 @@ public:
      *     - source namespace of the collection cloner that completed (or failed).
      *
      * Called exactly once for every collection cloner started by the the database cloner.
+     * Collection cloners run concurrently, so calls for different collections may overlap.
      */
     using CollectionCallbackFn = stdx::function<void(const Status&, const NamespaceString&)>;
 
@@ -147,6 +151,14 @@ private:
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners in listCollections order until
+     * initialSyncMaxConcurrentCollectionCloners of them are active.
+     * Reports completion once no cloner is active and none is left to start, or a cloner
+     * failed to start.
+     */
+    void _startCollectionCloners_inlock(stdx::unique_lock<stdx::mutex>* lk);
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -191,7 +203,15 @@ private:
     std::vector<NamespaceString> _collectionNamespaces;
 
     std::list<CollectionCloner> _collectionCloners;
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;
+
+    // Next collection cloner to start.
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;
+
+    // Number of collection cloners started and not finished yet.
+    size_t _activeCollectionCloners;
+
+    // Error from starting a collection cloner. No more cloners are started once it is set.
+    Status _startCollectionClonerStatus;
 
     // Function for scheduling database work using the executor.
     CollectionCloner::ScheduleDbWorkFn _scheduleDbWorkFn;
@@ -57,6 +57,7 @@ protected:
 
     std::list<std::pair<Status, NamespaceString>> collectionWorkResults;
     std::unique_ptr<DatabaseCloner> databaseCloner;
+    int savedMaxConcurrentCollectionCloners;
 };
 
 DatabaseClonerTest::DatabaseClonerTest() : collectionWorkResults(), databaseCloner() {}
@@ -67,6 +68,7 @@ void DatabaseClonerTest::collectionWork(const Status& status, const NamespaceStr
 
 void DatabaseClonerTest::setUp() {
     BaseClonerTest::setUp();
+    savedMaxConcurrentCollectionCloners = initialSyncMaxConcurrentCollectionCloners;
     collectionWorkResults.clear();
     databaseCloner.reset(new DatabaseCloner(
         &getReplExecutor(),
@@ -86,6 +88,7 @@ void DatabaseClonerTest::tearDown() {
     BaseClonerTest::tearDown();
     databaseCloner.reset();
     collectionWorkResults.clear();
+    initialSyncMaxConcurrentCollectionCloners = savedMaxConcurrentCollectionCloners;
 }
 
 void DatabaseClonerTest::clear() {}
@@ -441,6 +444,7 @@ TEST_F(DatabaseClonerTest, StartSecondCollectionClonerFailed) {
 }
 
 TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
+    initialSyncMaxConcurrentCollectionCloners = 1;
     ASSERT_OK(databaseCloner->start());
 
     // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
@@ -462,7 +466,7 @@ TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially.
     // This affects the order of the network responses.
     processNetworkResponse(BSON("ok" << 0 << "errmsg"
                                      << ""
@@ -486,6 +490,7 @@ TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
 }
 
 TEST_F(DatabaseClonerTest, CreateCollections) {
+    initialSyncMaxConcurrentCollectionCloners = 1;
     ASSERT_OK(databaseCloner->start());
 
     // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
@@ -507,7 +512,7 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially.
     // This affects the order of the network responses.
     processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
     processNetworkResponse(createCursorResponse(0, BSONArray()));
@@ -529,4 +534,70 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     }
 }
 
+TEST_F(DatabaseClonerTest, CreateCollectionsConcurrently) {
+    initialSyncMaxConcurrentCollectionCloners = 2;
+    ASSERT_OK(databaseCloner->start());
+
+    // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
+    // will run through network interface.
+    auto&& executor = getReplExecutor();
+    databaseCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+        return executor.scheduleWork(workFn);
+    });
+
+    const std::vector<BSONObj> sourceInfos = {BSON("name"
+                                                   << "a"
+                                                   << "options" << BSONObj()),
+                                              BSON("name"
+                                                   << "b"
+                                                   << "options" << BSONObj()),
+                                              BSON("name"
+                                                   << "c"
+                                                   << "options" << BSONObj())};
+    processNetworkResponse(createListCollectionsResponse(
+        0, BSON_ARRAY(sourceInfos[0] << sourceInfos[1] << sourceInfos[2])));
+
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+    ASSERT_TRUE(databaseCloner->isActive());
+
+    auto net = getNet();
+    auto processResponseFor = [&](const std::string& commandName,
+                                  const std::string& collectionName,
+                                  const BSONObj& response) {
+        ASSERT_TRUE(net->hasReadyRequests());
+        NetworkOperationIterator noi = net->getNextReadyRequest();
+        auto&& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_EQUALS(commandName, std::string(cmdObj.firstElementFieldName()));
+        ASSERT_EQUALS(collectionName, cmdObj.firstElement().str());
+        scheduleNetworkResponse(noi, response);
+        finishProcessingNetworkResponse();
+    };
+
+    // The first two collections are cloned at the same time. The third collection cloner starts
+    // when one of them finishes.
+    processResponseFor("listIndexes", "a", createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    processResponseFor("listIndexes", "b", createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    processResponseFor("find", "a", createCursorResponse(0, BSONArray()));
+    processResponseFor("find", "b", createCursorResponse(0, BSONArray()));
+    processResponseFor("listIndexes", "c", createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    ASSERT_TRUE(databaseCloner->isActive());
+    processResponseFor("find", "c", createCursorResponse(0, BSONArray()));
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(databaseCloner->isActive());
+
+    ASSERT_EQUALS(3U, collectionWorkResults.size());
+    {
+        auto i = collectionWorkResults.cbegin();
+        ASSERT_OK(i->first);
+        ASSERT_EQUALS(i->second.ns(), NamespaceString(dbname, "a").ns());
+        i++;
+        ASSERT_OK(i->first);
+        ASSERT_EQUALS(i->second.ns(), NamespaceString(dbname, "b").ns());
+        i++;
+        ASSERT_OK(i->first);
+        ASSERT_EQUALS(i->second.ns(), NamespaceString(dbname, "c").ns());
+    }
+}
+
 }  // namespace
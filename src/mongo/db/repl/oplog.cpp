@@ -122,10 +122,12 @@ stdx::condition_variable newTimestampNotifier;
 static std::string _oplogCollectionName;
 
 // so we can fail the same way
+void checkOplogInsert(const Status& status) {
+    massert(17322, str::stream() << "write to oplog failed: " << status.toString(), status.isOK());
+}
+
 void checkOplogInsert(StatusWith<RecordId> result) {
-    massert(17322,
-            str::stream() << "write to oplog failed: " << result.getStatus().toString(),
-            result.isOK());
+    checkOplogInsert(result.getStatus());
 }
 
 /**
@@ -138,15 +140,14 @@ void checkOplogInsert(StatusWith<RecordId> result) {
  * function registers the new optime with the storage system and the replication coordinator,
  * and provides no facility to revert those registrations on rollback.
  */
-std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
-                                           Collection* oplog,
-                                           const char* ns,
-                                           ReplicationCoordinator* replCoord,
-                                           const char* opstr,
-                                           ReplicationCoordinator::Mode replicationMode) {
+void getNextOpTimes(OperationContext* txn,
+                    Collection* oplog,
+                    ReplicationCoordinator* replCoord,
+                    ReplicationCoordinator::Mode replicationMode,
+                    size_t count,
+                    std::vector<std::pair<OpTime, long long>>* slots) {
     synchronizeOnCappedInFlightResource(txn->lockState());
 
-    long long hashNew = 0;
     long long term = OpTime::kProtocolVersionV0Term;
 
     // Fetch term out of the newOpMutex.
@@ -157,18 +158,30 @@ std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
     }
 
     stdx::lock_guard<stdx::mutex> lk(newOpMutex);
-    Timestamp ts = getNextGlobalTimestamp();
-    newTimestampNotifier.notify_all();
-
-    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+    for (size_t i = 0; i < count; i++) {
+        Timestamp ts = getNextGlobalTimestamp();
+        fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+
+        // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
+        long long hashNew = 0;
+        if (replicationMode == ReplicationCoordinator::modeReplSet) {
+            hashNew = hashGenerator.nextInt64();
+        }
 
-    // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
-    if (replicationMode == ReplicationCoordinator::modeReplSet) {
-        hashNew = hashGenerator.nextInt64();
+        slots->push_back(std::pair<OpTime, long long>(OpTime(ts, term), hashNew));
     }
+    newTimestampNotifier.notify_all();
+}
 
-    OpTime opTime(ts, term);
-    return std::pair<OpTime, long long>(opTime, hashNew);
+std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
+                                           Collection* oplog,
+                                           const char* ns,
+                                           ReplicationCoordinator* replCoord,
+                                           const char* opstr,
+                                           ReplicationCoordinator::Mode replicationMode) {
+    std::vector<std::pair<OpTime, long long>> slots;
+    getNextOpTimes(txn, oplog, replCoord, replicationMode, 1, &slots);
+    return slots.front();
 }
 
 /**
@@ -256,45 +269,43 @@ void setOplogCollectionName() {
 
 */
 
-void _logOp(OperationContext* txn,
-            const char* opstr,
-            const char* ns,
-            const BSONObj& obj,
-            BSONObj* o2,
-            bool fromMigrate,
-            const std::string& oplogCollectionName,
-            ReplicationCoordinator::Mode replicationMode,
-            bool updateReplOpTime) {
-    NamespaceString nss(ns);
+/**
+ * Returns whether writes to "nss" are recorded in the oplog.
+ */
+bool shouldLogOp(OperationContext* txn,
+                 const NamespaceString& nss,
+                 ReplicationCoordinator::Mode replicationMode) {
     if (nss.db() == "local") {
-        return;
+        return false;
     }
 
     if (nss.isSystemDotProfile()) {
-        return;
+        return false;
     }
 
     if (replicationMode == ReplicationCoordinator::modeNone) {
-        return;
+        return false;
     }
 
-    if (!txn->writesAreReplicated()) {
-        return;
-    }
+    return txn->writesAreReplicated();
+}
 
+/**
+ * Checks that this node may log writes to "nss", and looks up the oplog collection the first
+ * time it is needed. The caller must hold the local database and oplog collection in MODE_IX.
+ */
+void prepareToLogOp(OperationContext* txn,
+                    const NamespaceString& nss,
+                    const std::string& oplogCollectionName,
+                    ReplicationCoordinator::Mode replicationMode,
+                    ReplicationCoordinator* replCoord) {
     fassert(28626, txn->recoveryUnit());
 
-    Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
-
-    ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
-
-    if (ns[0] && replicationMode == ReplicationCoordinator::modeReplSet &&
+    if (!nss.ns().empty() && replicationMode == ReplicationCoordinator::modeReplSet &&
         !replCoord->canAcceptWritesFor(nss)) {
-        severe() << "logOp() but can't accept write to collection " << ns;
+        severe() << "logOp() but can't accept write to collection " << nss.ns();
         fassertFailed(17405);
     }
-    Lock::CollectionLock lk2(txn->lockState(), oplogCollectionName, MODE_IX);
-
 
     if (_localOplogCollection == nullptr) {
         OldClientContext ctx(txn, oplogCollectionName);
@@ -306,6 +317,26 @@ void _logOp(OperationContext* txn,
                     " missing. did you drop it? if so, restart the server",
                 _localOplogCollection);
     }
+}
+
+void _logOp(OperationContext* txn,
+            const char* opstr,
+            const char* ns,
+            const BSONObj& obj,
+            BSONObj* o2,
+            bool fromMigrate,
+            const std::string& oplogCollectionName,
+            ReplicationCoordinator::Mode replicationMode,
+            bool updateReplOpTime) {
+    NamespaceString nss(ns);
+    if (!shouldLogOp(txn, nss, replicationMode)) {
+        return;
+    }
+
+    Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
+    Lock::CollectionLock lk2(txn->lockState(), oplogCollectionName, MODE_IX);
+    ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
+    prepareToLogOp(txn, nss, oplogCollectionName, replicationMode, replCoord);
 
     std::pair<OpTime, long long> slot =
         getNextOpTime(txn, _localOplogCollection, ns, replCoord, opstr, replicationMode);
@@ -342,6 +373,62 @@ void _logOp(OperationContext* txn,
     ReplClientInfo::forClient(txn->getClient()).setLastOp(slot.first);
 }
 
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const char* ns,
+             std::vector<BSONObj>::const_iterator begin,
+             std::vector<BSONObj>::const_iterator end,
+             bool fromMigrate) {
+    const std::string& oplogCollectionName = _oplogCollectionName;
+    const ReplicationCoordinator::Mode replicationMode =
+        ReplicationCoordinator::get(txn)->getReplicationMode();
+
+    NamespaceString nss(ns);
+    if (begin == end || !shouldLogOp(txn, nss, replicationMode)) {
+        return;
+    }
+
+    Lock::DBLock lk(txn->lockState(), "local", MODE_IX);
+    Lock::CollectionLock lk2(txn->lockState(), oplogCollectionName, MODE_IX);
+    ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
+    prepareToLogOp(txn, nss, oplogCollectionName, replicationMode, replCoord);
+
+    // All of the group's optimes are reserved together so that its entries are contiguous in
+    // the oplog, and written with a single call into the record store.
+    const size_t count = std::distance(begin, end);
+    std::vector<std::pair<OpTime, long long>> slots;
+    slots.reserve(count);
+    getNextOpTimes(txn, _localOplogCollection, replCoord, replicationMode, count, &slots);
+
+    std::vector<BSONObj> entries;
+    std::vector<Record> records;
+    entries.reserve(count);
+    records.reserve(count);
+    auto it = begin;
+    for (const auto& slot : slots) {
+        BSONObjBuilder b(256 + it->objsize());
+        slot.first.append(&b);
+        b.append("h", slot.second);
+        b.append("v", OPLOG_VERSION);
+        b.append("op", opstr);
+        b.append("ns", ns);
+        if (fromMigrate) {
+            b.appendBool("fromMigrate", true);
+        }
+        b.append("o", *it++);
+        entries.push_back(b.obj());
+        records.push_back(Record{RecordId(), RecordData(entries.back().objdata(),
+                                                        entries.back().objsize())});
+    }
+
+    // This transaction might roll back.
+    checkOplogInsert(_localOplogCollection->insertDocumentsForOplog(txn, &records));
+
+    const OpTime& lastOpTime = slots.back().first;
+    txn->recoveryUnit()->registerChange(new UpdateReplOpTimeChange(lastOpTime, replCoord));
+    ReplClientInfo::forClient(txn->getClient()).setLastOp(lastOpTime);
+}
+
 void _logOp(OperationContext* txn,
             const char* opstr,
             const char* ns,
@@ -588,6 +675,49 @@ std::map<std::string, ApplyOpMetadata> opsMap = {
           -> Status { return emptyCapped(txn, parseNs(ns, cmd)); }}},
 };
 
+/**
+ * Applies an insert whose "o" field is an array of documents rather than a single document.
+ * Such grouped inserts are built by the oplog applier from consecutive inserts into the same
+ * collection and are never written to the oplog.
+ *
+ * All of the documents are inserted in one WriteUnitOfWork. Any failure, including a duplicate
+ * _id, rolls back the whole group so that the applier can fall back to applying the original
+ * inserts one at a time.
+ */
+Status applyGroupedInsert_inlock(OperationContext* txn,
+                                 const char* ns,
+                                 Collection* collection,
+                                 const BSONElement& docs,
+                                 OpCounters* opCounters) {
+    uassert(ErrorCodes::NamespaceNotFound,
+            str::stream() << "Failed to apply grouped insert due to missing collection: " << ns,
+            collection);
+
+    std::vector<BSONObj> toInsert;
+    for (const BSONElement& elem : docs.Obj()) {
+        const BSONObj doc = elem.Obj();
+        uassert(ErrorCodes::NoSuchKey,
+                str::stream() << "Failed to apply grouped insert due to missing _id: " << doc,
+                doc.hasField("_id"));
+
+        toInsert.push_back(doc);
+    }
+
+    WriteUnitOfWork wuow(txn);
+    Status status = collection->insertDocuments(txn, toInsert.begin(), toInsert.end(), true);
+    if (!status.isOK()) {
+        return status;
+    }
+    wuow.commit();
+
+    // Only count the inserts once the group is committed. A failed group is applied again one
+    // insert at a time, which counts each insert then.
+    for (size_t i = 0; i < toInsert.size(); ++i) {
+        opCounters->gotInsert();
+    }
+    return Status::OK();
+}
+
 }  // namespace
 
 // @return failure status if an update should have happened and the document DNE.
@@ -640,6 +770,10 @@ Status applyOperation_inlock(OperationContext* txn,
     invariant(*opType != 'c');  // commands are processed in applyCommand_inlock()
 
     if (*opType == 'i') {
+        if (fieldO.type() == Array) {
+            return applyGroupedInsert_inlock(txn, ns, collection, fieldO, opCounters);
+        }
+
         opCounters->gotInsert();
 
         const char* p = strchr(ns, '.');
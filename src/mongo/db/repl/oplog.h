@@ -31,6 +31,7 @@
 #include <cstddef>
 #include <deque>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/disallow_copying.h"
@@ -109,6 +110,17 @@ void _logOp(OperationContext* txn,
             BSONObj* o2,
             bool fromMigrate);
 
+/**
+ * Logs an insert-style operation for each of the documents in [begin, end), reserving their
+ * optimes together and writing the entries to the oplog in one batch.
+ */
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const char* ns,
+             std::vector<BSONObj>::const_iterator begin,
+             std::vector<BSONObj>::const_iterator end,
+             bool fromMigrate);
+
 // Flush out the cached pointers to the local database and oplog.
 // Used by the closeDatabase command to ensure we don't cache closed things.
 void oplogCheckCloseDatabase(OperationContext* txn, Database* db);
@@ -33,7 +33,10 @@
 
 #include "mongo/db/repl/sync_tail.h"
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include "third_party/murmurhash3/MurmurHash3.h"
 
@@ -118,6 +121,18 @@ void initializePrefetchThread() {
     }
 }
 namespace {
+
+// With document-level locking, a batch is split into this many writer vectors per writer thread.
+// Operations on any one document still land in the same vector and are applied in order, but a
+// writer that finishes its vector early picks up another one rather than idling at the end of the
+// batch while a single thread works through a large share of a hot collection.
+const size_t kWriterVectorsPerThread = 4;
+
+// Limits on how many consecutive inserts into the same collection a writer combines into a single
+// grouped insert.
+const size_t kMaxGroupedInsertOps = 64;
+const int kMaxGroupedInsertBytes = 1024 * 1024;
+
 bool isCrudOpType(const char* field) {
     switch (field[0]) {
         case 'd':
@@ -369,7 +384,11 @@ OpTime SyncTail::multiApply(OperationContext* txn,
         prefetchOps(ops.getDeque(), prefetcherPool);
     }
 
-    std::vector<std::vector<BSONObj>> writerVectors(replWriterThreadCount);
+    const size_t numWriterVectors =
+        getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking()
+        ? replWriterThreadCount * kWriterVectorsPerThread
+        : replWriterThreadCount;
+    std::vector<std::vector<BSONObj>> writerVectors(numWriterVectors);
 
     fillWriterVectors(ops.getDeque(), &writerVectors);
     LOG(2) << "replication batch size is " << ops.getDeque().size() << endl;
@@ -831,36 +850,145 @@ static void initializeWriterThread() {
     }
 }
 
-// This free function is used by the writer threads to apply each op
-void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
-    initializeWriterThread();
+namespace {
 
-    OperationContextImpl txn;
-    txn.setReplicatedWrites(false);
-    DisableDocumentValidation validationDisabler(&txn);
+/**
+ * Returns true if "op" is an insert that can be combined with other inserts into the same
+ * collection.
+ */
+bool isGroupableInsert(const BSONObj& op) {
+    if (op["op"].valuestrsafe()[0] != 'i' || op["o"].type() != Object) {
+        return false;
+    }
+    const char* ns = op["ns"].valuestrsafe();
+    return *ns != '\0' && nsToCollectionSubstring(ns) != "system.indexes";
+}
 
-    // allow us to get through the magic barrier
-    txn.lockState()->setIsBatchWriter(true);
+/**
+ * Builds a single insert operation whose "o" field holds the documents of all of the inserts in
+ * [begin, end), which must all be into the same collection.
+ */
+BSONObj makeGroupedInsert(std::vector<BSONObj>::const_iterator begin,
+                          std::vector<BSONObj>::const_iterator end) {
+    BSONObjBuilder groupedInsert;
+    for (const BSONElement& elem : *begin) {
+        if (elem.fieldNameStringData() != "o") {
+            groupedInsert.append(elem);
+        }
+    }
+
+    BSONArrayBuilder docs(groupedInsert.subarrayStart("o"));
+    for (auto it = begin; it != end; ++it) {
+        docs.append(it->getObjectField("o"));
+    }
+    docs.done();
+    return groupedInsert.obj();
+}
 
-    bool convertUpdatesToUpserts = true;
+}  // namespace
+
+Status multiSyncApply_noAbort(OperationContext* txn,
+                              std::vector<BSONObj>* ops,
+                              SyncApplyFn syncApply) {
+    // Bring inserts into the same collection together. The sort is stable, so operations on any
+    // one document, which always share a namespace, keep their relative order.
+    std::stable_sort(ops->begin(),
+                     ops->end(),
+                     [](const BSONObj& lhs, const BSONObj& rhs) {
+                         return strcmp(lhs.getStringField("ns"), rhs.getStringField("ns")) < 0;
+                     });
+
+    const bool convertUpdatesToUpserts = true;
+
+    for (auto it = ops->cbegin(); it != ops->cend();) {
+        if (isGroupableInsert(*it)) {
+            const StringData ns = it->getStringField("ns");
+            int groupBytes = it->objsize();
+            auto groupEnd = std::next(it);
+            while (groupEnd != ops->cend() &&
+                   static_cast<size_t>(groupEnd - it) < kMaxGroupedInsertOps &&
+                   groupBytes + groupEnd->objsize() <= kMaxGroupedInsertBytes &&
+                   isGroupableInsert(*groupEnd) && groupEnd->getStringField("ns") == ns) {
+                groupBytes += groupEnd->objsize();
+                ++groupEnd;
+            }
+
+            if (groupEnd - it > 1) {
+                try {
+                    const Status s =
+                        syncApply(txn, makeGroupedInsert(it, groupEnd), convertUpdatesToUpserts);
+                    if (s.isOK()) {
+                        opsAppliedStats.increment(groupEnd - it - 1);
+                        it = groupEnd;
+                        continue;
+                    }
+                    LOG(1) << "Error applying grouped insert into " << ns
+                           << ", applying the inserts individually: " << s;
+                } catch (const DBException& e) {
+                    LOG(1) << "Error applying grouped insert into " << ns
+                           << ", applying the inserts individually: " << causedBy(e);
+                }
+
+                // Apply the group's inserts one at a time so that duplicate keys are turned into
+                // updates and any real error is reported against the op that caused it.
+                for (; it != groupEnd; ++it) {
+                    Status s = Status::OK();
+                    try {
+                        s = syncApply(txn, *it, convertUpdatesToUpserts);
+                    } catch (const DBException& e) {
+                        severe() << "writer worker caught exception: " << causedBy(e)
+                                 << " on: " << it->toString();
+                        return e.toStatus();
+                    }
+                    if (!s.isOK()) {
+                        severe() << "Error applying operation (" << it->toString() << "): " << s;
+                        return s;
+                    }
+                }
+                continue;
+            }
+        }
 
-    for (std::vector<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
         try {
-            const Status s = SyncTail::syncApply(&txn, *it, convertUpdatesToUpserts);
+            const Status s = syncApply(txn, *it, convertUpdatesToUpserts);
             if (!s.isOK()) {
                 severe() << "Error applying operation (" << it->toString() << "): " << s;
-                fassertFailedNoTrace(16359);
+                return s;
             }
         } catch (const DBException& e) {
             severe() << "writer worker caught exception: " << causedBy(e)
                      << " on: " << it->toString();
+            return e.toStatus();
+        }
+        ++it;
+    }
+    return Status::OK();
+}
 
-            if (inShutdown()) {
-                return;
-            }
+// This free function is used by the writer threads to apply each op
+void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
+    initializeWriterThread();
+
+    OperationContextImpl txn;
+    txn.setReplicatedWrites(false);
+    DisableDocumentValidation validationDisabler(&txn);
+
+    // allow us to get through the magic barrier
+    txn.lockState()->setIsBatchWriter(true);
 
-            fassertFailedNoTrace(16360);
+    std::vector<BSONObj> opsToApply(ops);
+    const Status status = multiSyncApply_noAbort(
+        &txn,
+        &opsToApply,
+        [](OperationContext* txn, const BSONObj& op, bool convertUpdateToUpsert) {
+            return SyncTail::syncApply(txn, op, convertUpdateToUpsert);
+        });
+
+    if (!status.isOK()) {
+        if (inShutdown()) {
+            return;
         }
+        fassertFailedNoTrace(16359);
     }
 }
 
@@ -200,6 +200,24 @@ private:
 
 // These free functions are used by the thread pool workers to write ops to the db.
 void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st);
+
+/**
+ * Type of function that applies a single op, as used by multiSyncApply_noAbort.
+ */
+using SyncApplyFn =
+    stdx::function<Status(OperationContext* txn, const BSONObj& op, bool convertUpdateToUpsert)>;
+
+/**
+ * Applies the ops of one writer vector with "syncApply", as multiSyncApply does, and returns the
+ * first error instead of aborting.
+ *
+ * "ops" is first stably sorted by namespace, and runs of inserts into the same collection are
+ * applied as a single grouped insert whose "o" field is an array of the documents. If a grouped
+ * insert fails, its inserts are applied again one at a time. Exposed for testing.
+ */
+Status multiSyncApply_noAbort(OperationContext* txn,
+                              std::vector<BSONObj>* ops,
+                              SyncApplyFn syncApply);
 void multiInitialSyncApply(const std::vector<BSONObj>& ops, SyncTail* st);
 
 }  // namespace repl
@@ -39,11 +39,13 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/bgsync.h"
+#include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/operation_context_repl_mock.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/sync_tail.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/counters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/unittest/temp_dir.h"
@@ -357,4 +359,111 @@ TEST_F(SyncTailTest, SyncApplyCommandThrowsException) {
     ASSERT_EQUALS(1U, _opsApplied);
 }
 
+BSONObj makeInsertOp(const std::string& ns, int id) {
+    return BSON("op"
+                << "i"
+                << "ns" << ns << "o" << BSON("_id" << id));
+}
+
+BSONObj makeUpdateOp(const std::string& ns, int id) {
+    return BSON("op"
+                << "u"
+                << "ns" << ns << "o2" << BSON("_id" << id) << "o"
+                << BSON("$set" << BSON("x" << 1)));
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyGroupsInsertsIntoSameCollection) {
+    std::vector<BSONObj> ops = {makeInsertOp("test.a", 1),
+                                makeInsertOp("test.b", 1),
+                                makeInsertOp("test.a", 2),
+                                makeUpdateOp("test.a", 2),
+                                makeInsertOp("test.b", 2)};
+    std::vector<BSONObj> applied;
+    SyncApplyFn syncApply = [&](OperationContext* txn, const BSONObj& op, bool) {
+        applied.push_back(op.getOwned());
+        return Status::OK();
+    };
+    ASSERT_OK(multiSyncApply_noAbort(_txn.get(), &ops, syncApply));
+
+    // Ops are sorted by namespace, the update on test.a stays after the inserts it follows, and
+    // each run of inserts is applied as one grouped insert.
+    ASSERT_EQUALS(3U, applied.size());
+    ASSERT_EQUALS("test.a", applied[0]["ns"].str());
+    ASSERT_EQUALS(BSON_ARRAY(BSON("_id" << 1) << BSON("_id" << 2)), applied[0]["o"].Obj());
+    ASSERT_EQUALS(makeUpdateOp("test.a", 2), applied[1]);
+    ASSERT_EQUALS("test.b", applied[2]["ns"].str());
+    ASSERT_EQUALS(BSON_ARRAY(BSON("_id" << 1) << BSON("_id" << 2)), applied[2]["o"].Obj());
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyDoesNotGroupSingleInsert) {
+    std::vector<BSONObj> ops = {makeInsertOp("test.a", 1), makeUpdateOp("test.a", 1)};
+    std::vector<BSONObj> applied;
+    SyncApplyFn syncApply = [&](OperationContext* txn, const BSONObj& op, bool) {
+        applied.push_back(op.getOwned());
+        return Status::OK();
+    };
+    ASSERT_OK(multiSyncApply_noAbort(_txn.get(), &ops, syncApply));
+    ASSERT_EQUALS(2U, applied.size());
+    ASSERT_EQUALS(makeInsertOp("test.a", 1), applied[0]);
+    ASSERT_EQUALS(makeUpdateOp("test.a", 1), applied[1]);
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyFallsBackToIndividualInsertsWhenGroupFails) {
+    std::vector<BSONObj> ops = {
+        makeInsertOp("test.a", 1), makeInsertOp("test.a", 2), makeInsertOp("test.a", 3)};
+    std::vector<BSONObj> applied;
+    SyncApplyFn syncApply = [&](OperationContext* txn, const BSONObj& op, bool) {
+        if (op["o"].type() == Array) {
+            return Status(ErrorCodes::DuplicateKey, "grouped insert failed");
+        }
+        applied.push_back(op.getOwned());
+        return Status::OK();
+    };
+    ASSERT_OK(multiSyncApply_noAbort(_txn.get(), &ops, syncApply));
+    ASSERT_EQUALS(3U, applied.size());
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQUALS(makeInsertOp("test.a", i + 1), applied[i]);
+    }
+}
+
+TEST_F(SyncTailTest, ApplyGroupedInsertCountsInsertsOnlyOnceApplied) {
+    Lock::GlobalWrite globalLock(_txn->lockState());
+    bool justCreated = false;
+    Database* db = dbHolder().openDb(_txn.get(), "test", &justCreated);
+    ASSERT_TRUE(db);
+    ASSERT_TRUE(db->createCollection(_txn.get(), "test.t"));
+
+    const unsigned int insertsBefore = globalOpCounters.getInsert()->load();
+
+    // The group is rejected before anything is written because one document has no _id. The
+    // applier then applies the inserts one at a time, so the group must not count them.
+    BSONObj badGroup = BSON("op"
+                            << "i"
+                            << "ns"
+                            << "test.t"
+                            << "o" << BSON_ARRAY(BSON("_id" << 1) << BSON("x" << 2)));
+    ASSERT_THROWS(applyOperation_inlock(_txn.get(), db, badGroup), UserException);
+    ASSERT_EQUALS(insertsBefore, globalOpCounters.getInsert()->load());
+
+    BSONObj group = BSON("op"
+                         << "i"
+                         << "ns"
+                         << "test.t"
+                         << "o" << BSON_ARRAY(BSON("_id" << 1) << BSON("_id" << 2)));
+    ASSERT_OK(applyOperation_inlock(_txn.get(), db, group));
+    ASSERT_EQUALS(insertsBefore + 2, globalOpCounters.getInsert()->load());
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyReturnsFirstError) {
+    std::vector<BSONObj> ops = {makeUpdateOp("test.a", 1), makeUpdateOp("test.a", 2)};
+    int calls = 0;
+    SyncApplyFn syncApply = [&](OperationContext* txn, const BSONObj& op, bool) {
+        ++calls;
+        return Status(ErrorCodes::OperationFailed, "");
+    };
+    ASSERT_EQUALS(ErrorCodes::OperationFailed,
+                  multiSyncApply_noAbort(_txn.get(), &ops, syncApply).code());
+    ASSERT_EQUALS(1, calls);
+}
+
 }  // namespace
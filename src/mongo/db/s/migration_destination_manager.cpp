@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/migration_destination_manager.h"
 
+#include <algorithm>
+#include <deque>
 #include <list>
 #include <vector>
 
@@ -42,6 +44,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/client.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
@@ -53,6 +56,7 @@
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/s/sharded_connection_info.h"
@@ -65,6 +69,7 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -171,6 +176,141 @@ MONGO_FP_DECLARE(migrateThreadHangAtStep3);
 MONGO_FP_DECLARE(migrateThreadHangAtStep4);
 MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+// Number of _migrateClone requests the recipient keeps in flight to the donor during the initial
+// clone, each on its own connection, and number of threads inserting the batches they return.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneConcurrency, int, 3);
+
+/**
+ * Requests batches of the initial clone from the donor on several connections at once, and queues
+ * them for the migrate thread to apply. Each connection keeps asking until the donor returns an
+ * empty batch; the donor hands each document out once, whichever request it is serving.
+ *
+ * At most one batch per connection is queued, so the donor doesn't get far ahead of the inserts.
+ */
+class MigrationDestinationManager::CloneFetcher {
+    MONGO_DISALLOW_COPYING(CloneFetcher);
+
+public:
+    CloneFetcher(const string& fromShard, int numConnections)
+        : _maxQueued(numConnections), _numRunning(numConnections) {
+        for (int i = 0; i < numConnections; ++i) {
+            _threads.emplace_back([this, fromShard]() { _fetch(fromShard); });
+        }
+    }
+
+    ~CloneFetcher() {
+        shutdown();
+
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Stops fetching, and wakes up the callers of next().
+     */
+    void shutdown() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _inShutdown = true;
+        _condvar.notify_all();
+    }
+
+    /**
+     * Waits for the next batch of documents, which is empty once the donor has sent them all.
+     * Safe to call from several threads; each batch is returned once.
+     */
+    StatusWith<BSONObj> next() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (_queue.empty() && _numRunning > 0 && _status.isOK() && !_inShutdown) {
+            _condvar.wait(lk);
+        }
+
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        if (_inShutdown) {
+            return Status(ErrorCodes::CallbackCanceled, "migration clone was stopped");
+        }
+
+        if (_queue.empty()) {
+            return BSONObj();
+        }
+
+        BSONObj batch = _queue.front();
+        _queue.pop_front();
+        _condvar.notify_all();
+        return batch;
+    }
+
+    size_t queueDepth() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _queue.size();
+    }
+
+private:
+    void _fetch(const string& fromShard) {
+        Client::initThread("migrateCloneFetcher");
+
+        Status status = Status::OK();
+        try {
+            ScopedDbConnection conn(fromShard);
+
+            while (true) {
+                BSONObj res;
+                if (!conn->runCommand("admin", BSON("_migrateClone" << 1), res)) {
+                    status = Status(ErrorCodes::OperationFailed,
+                                    str::stream() << "_migrateClone failed: " << res);
+                    conn.kill();
+                    break;
+                }
+
+                BSONObj batch = res["objects"].Obj();
+                if (batch.isEmpty()) {
+                    conn.done();
+                    break;
+                }
+
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                while (_queue.size() >= _maxQueued && !_inShutdown) {
+                    _condvar.wait(lk);
+                }
+
+                if (_inShutdown) {
+                    conn.done();
+                    break;
+                }
+
+                _queue.push_back(batch);
+                _condvar.notify_all();
+            }
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!status.isOK() && _status.isOK()) {
+            _status = status;
+        }
+        --_numRunning;
+        _condvar.notify_all();
+    }
+
+    const size_t _maxQueued;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _condvar;
+
+    std::deque<BSONObj> _queue;
+    int _numRunning;
+    bool _inShutdown = false;
+
+    // The first error from any connection
+    Status _status = Status::OK();
+
+    std::vector<stdx::thread> _threads;
+};
+
 
 MigrationDestinationManager::MigrationDestinationManager()
     : _active(false),
@@ -178,6 +318,8 @@ MigrationDestinationManager::MigrationDestinationManager()
       _clonedBytes(0),
       _numCatchup(0),
       _numSteady(0),
+      _cloneMillis(0),
+      _cloneFetcher(nullptr),
       _state(READY) {}
 
 MigrationDestinationManager::~MigrationDestinationManager() = default;
@@ -220,6 +362,13 @@ void MigrationDestinationManager::report(BSONObjBuilder& b) {
     bb.append("catchup", _numCatchup);
     bb.append("steady", _numSteady);
     bb.done();
+
+    BSONObjBuilder cloneBuilder(b.subobjStart("clone"));
+    cloneBuilder.appendNumber("bytesPerSec",
+                              _cloneMillis > 0 ? _clonedBytes * 1000 / _cloneMillis : 0LL);
+    cloneBuilder.appendNumber(
+        "queueDepth", static_cast<long long>(_cloneFetcher ? _cloneFetcher->queueDepth() : 0));
+    cloneBuilder.done();
 }
 
 Status MigrationDestinationManager::start(const string& ns,
@@ -251,6 +400,7 @@ Status MigrationDestinationManager::start(const string& ns,
     _clonedBytes = 0;
     _numCatchup = 0;
     _numSteady = 0;
+    _cloneMillis = 0;
 
     _active = true;
 
@@ -561,77 +711,81 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
         // 3. Initial bulk clone
         setState(CLONE);
 
-        while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  BSON("_migrateClone" << 1),
-                                  res)) {  // gets array of objects to copy, in disk order
-                setState(FAIL);
-                errmsg = "_migrateClone failed: ";
-                errmsg += res.toString();
-                error() << errmsg << migrateLog;
-                conn.done();
-                return;
-            }
-
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+        Timer cloneTimer;
+        CloneFetcher fetcher(fromShard, std::max(1, migrateCloneConcurrency));
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            _cloneFetcher = &fetcher;
+        }
 
-            BSONObjIterator i(arr);
-            while (i.more()) {
-                txn->checkForInterrupt();
+        ON_BLOCK_EXIT([this] {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            _cloneFetcher = nullptr;
+        });
+
+        // The migrate thread applies batches alongside the extra writer threads.
+        const int numWriters = std::max(1, migrateCloneConcurrency);
+        stdx::mutex cloneStatusMutex;
+        Status cloneStatus = Status::OK();
+        auto applyBatches = [&](OperationContext* writerTxn) {
+            Status status = Status::OK();
+            try {
+                status = _applyCloneBatches(
+                    writerTxn, &fetcher, ns, min, max, shardKeyPattern, writeConcern, cloneTimer);
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            } catch (const std::exception& ex) {
+                status = Status(ErrorCodes::UnknownError, ex.what());
+            }
 
-                if (getState() == ABORT) {
-                    errmsg = str::stream() << "Migration abort requested while "
-                                           << "copying documents";
-                    error() << errmsg << migrateLog;
-                    return;
+            if (!status.isOK()) {
+                fetcher.shutdown();
+                stdx::lock_guard<stdx::mutex> lk(cloneStatusMutex);
+                // The other writers see the fetcher stop after the first error.
+                if (cloneStatus.isOK()) {
+                    cloneStatus = status;
                 }
+            }
+        };
+
+        std::vector<stdx::thread> writers;
+        for (int i = 1; i < numWriters; ++i) {
+            writers.emplace_back([&]() {
+                Client::initThread("migrateCloneWriter");
+                OperationContextImpl writerTxn;
+                if (getGlobalAuthorizationManager()->isAuthEnabled()) {
+                    AuthorizationSession::get(writerTxn.getClient())->grantInternalAuthorization();
+                }
+                applyBatches(&writerTxn);
+            });
+        }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(txn, ns);
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(
-                            txn, ns, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << localDoc << " has same _id as cloned "
-                                                      << "remote document " << docToClone;
-
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
+        applyBatches(txn);
+        for (auto& writer : writers) {
+            writer.join();
+        }
 
-                    Helpers::upsert(txn, ns, docToClone, true);
-                }
-                thisTime++;
+        // The writers' inserts must be waited for along with the migrate thread's own.
+        repl::ReplClientInfo::forClient(txn->getClient()).setLastOpToSystemLastOpTime(txn);
 
-                {
-                    stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
-                }
+        if (getState() == ABORT) {
+            errmsg = str::stream() << "Migration abort requested while "
+                                   << "copying documents";
+            error() << errmsg << migrateLog;
+            return;
+        }
 
-                if (writeConcern.shouldWaitForOtherNodes()) {
-                    repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                        repl::getGlobalReplicationCoordinator()->awaitReplication(
-                            txn,
-                            repl::ReplClientInfo::forClient(txn->getClient()).getLastOp(),
-                            writeConcern);
-                    if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
-                        warning() << "secondaryThrottle on, but doc insert timed out; "
-                                     "continuing";
-                    } else {
-                        massertStatusOK(replStatus.status);
-                    }
-                }
+        if (!cloneStatus.isOK()) {
+            if (cloneStatus.code() == 16976) {
+                // Exception will abort migration cleanly
+                uassertStatusOK(cloneStatus);
             }
 
-            if (thisTime == 0)
-                break;
+            setState(FAIL);
+            errmsg = cloneStatus.reason();
+            error() << errmsg << migrateLog;
+            conn.done();
+            return;
         }
 
         timing.done(3);
@@ -795,6 +949,120 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
     conn.done();
 }
 
+Status MigrationDestinationManager::_applyCloneBatches(OperationContext* txn,
+                                                       CloneFetcher* fetcher,
+                                                       const string& ns,
+                                                       const BSONObj& min,
+                                                       const BSONObj& max,
+                                                       const BSONObj& shardKeyPattern,
+                                                       const WriteConcernOptions& writeConcern,
+                                                       const Timer& cloneTimer) {
+    DisableDocumentValidation validationDisabler(txn);
+
+    while (true) {
+        // gets arrays of objects to copy, in disk order
+        auto batchStatus = fetcher->next();
+        if (!batchStatus.isOK()) {
+            return batchStatus.getStatus();
+        }
+
+        const BSONObj arr = batchStatus.getValue();
+        if (arr.isEmpty()) {
+            return Status::OK();
+        }
+
+        long long batchDocs = 0;
+        long long batchBytes = 0;
+
+        {
+            // The write context only takes intent locks unless the collection has to be created,
+            // so the writers insert their batches concurrently where the storage engine allows.
+            OldClientWriteContext cx(txn, ns);
+            Collection* const collection = cx.getCollection();
+
+            // Documents which aren't on this shard yet are inserted together, the others
+            // replace the local copy one at a time.
+            std::vector<BSONObj> toInsert;
+
+            BSONObjIterator i(arr);
+            while (i.more()) {
+                txn->checkForInterrupt();
+
+                if (getState() == ABORT) {
+                    return Status(ErrorCodes::Interrupted,
+                                  "Migration abort requested while copying documents");
+                }
+
+                BSONObj docToClone = i.next().Obj();
+
+                BSONObj localDoc;
+                if (willOverrideLocalId(
+                        txn, ns, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
+                    string errMsg = str::stream() << "cannot migrate chunk, local document "
+                                                  << localDoc << " has same _id as cloned "
+                                                  << "remote document " << docToClone;
+
+                    warning() << errMsg;
+                    return Status(ErrorCodes::Error(16976), errMsg);
+                }
+
+                if (collection && localDoc.isEmpty()) {
+                    toInsert.push_back(docToClone);
+                } else {
+                    Helpers::upsert(txn, ns, docToClone, true);
+                }
+
+                batchDocs++;
+                batchBytes += docToClone.objsize();
+            }
+
+            if (!toInsert.empty()) {
+                bool inserted = false;
+                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                    WriteUnitOfWork wunit(txn);
+                    inserted = collection->insertDocuments(txn,
+                                                           toInsert.begin(),
+                                                           toInsert.end(),
+                                                           true /* enforceQuota */,
+                                                           true /* fromMigrate */).isOK();
+                    if (inserted) {
+                        wunit.commit();
+                    }
+                }
+                MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "migrateClone", ns);
+
+                if (!inserted) {
+                    // Upsert the documents one at a time so that the one at fault is reported.
+                    for (const auto& doc : toInsert) {
+                        Helpers::upsert(txn, ns, doc, true);
+                    }
+                }
+            }
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+            _numCloned += batchDocs;
+            _clonedBytes += batchBytes;
+            _cloneMillis = cloneTimer.millis();
+        }
+
+        if (writeConcern.shouldWaitForOtherNodes()) {
+            repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                repl::getGlobalReplicationCoordinator()->awaitReplication(
+                    txn,
+                    repl::ReplClientInfo::forClient(txn->getClient()).getLastOp(),
+                    writeConcern);
+            if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
+                warning() << "secondaryThrottle on, but doc insert timed out; "
+                             "continuing";
+            } else if (!replStatus.status.isOK()) {
+                return replStatus.status;
+            }
+        }
+    }
+}
+
 bool MigrationDestinationManager::_applyMigrateOp(OperationContext* txn,
                                                   const string& ns,
                                                   const BSONObj& min,
@@ -87,6 +87,8 @@ public:
     bool startCommit();
 
 private:
+    class CloneFetcher;
+
     /**
      * Thread which drives the migration apply process on the recipient side.
      */
@@ -107,6 +109,20 @@ private:
                         const OID& epoch,
                         const WriteConcernOptions& writeConcern);
 
+    /**
+     * Applies batches of the initial clone from 'fetcher' until the donor has sent them all, on
+     * 'txn'. Several threads run this at once, each with its own operation context. Returns the
+     * first error, which also stops the fetcher.
+     */
+    Status _applyCloneBatches(OperationContext* txn,
+                              CloneFetcher* fetcher,
+                              const std::string& ns,
+                              const BSONObj& min,
+                              const BSONObj& max,
+                              const BSONObj& shardKeyPattern,
+                              const WriteConcernOptions& writeConcern,
+                              const Timer& cloneTimer);
+
     bool _applyMigrateOp(OperationContext* txn,
                          const std::string& ns,
                          const BSONObj& min,
@@ -144,6 +160,12 @@ private:
     long long _numCatchup;
     long long _numSteady;
 
+    // Time spent in the initial clone so far, for reporting its throughput
+    long long _cloneMillis;
+
+    // Fetches batches from the donor during the initial clone, null otherwise
+    CloneFetcher* _cloneFetcher;
+
     State _state;
     std::string _errmsg;
 };
@@ -102,6 +102,12 @@ struct ServerGlobalParams {
 
     int maxConns;  // Maximum number of simultaneous open connections.
 
+    // How incoming connections are serviced. "threadPerConnection" runs each connection on its
+    // own thread; "epoll" multiplexes them over a pool of serviceExecutorThreads workers, which
+    // only pick up connections that have a request to read.
+    std::string serviceExecutor = "threadPerConnection";  // --serviceExecutor
+    int serviceExecutorThreads = 0;  // --serviceExecutorThreads, 0 means twice the core count
+
     int unixSocketPermissions;  // permissions for the UNIX domain socket
 
     std::string keyFile;  // Path to keyfile, or empty if none.
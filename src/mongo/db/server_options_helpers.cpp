@@ -207,6 +207,21 @@ Status addGeneralServerOptions(moe::OptionSection* options) {
     options->addOptionChaining(
         "net.maxIncomingConnections", "maxConns", moe::Int, maxConnInfoBuilder.str().c_str());
 
+#ifdef __linux__
+    options->addOptionChaining("net.serviceExecutor",
+                               "serviceExecutor",
+                               moe::String,
+                               "how connections are serviced: threadPerConnection (default) or "
+                               "epoll, which multiplexes connections over a worker pool")
+        .format("(:?threadPerConnection)|(:?epoll)", "(threadPerConnection/epoll)");
+
+    options->addOptionChaining("net.serviceExecutorThreads",
+                               "serviceExecutorThreads",
+                               moe::Int,
+                               "number of worker threads used by the epoll service executor "
+                               "(default: twice the number of cores)");
+#endif
+
     options->addOptionChaining(
                  "logpath",
                  "logpath",
@@ -804,6 +819,19 @@ Status storeServerOptions(const moe::Environment& params, const std::vector<std:
         }
     }
 
+    if (params.count("net.serviceExecutor")) {
+        serverGlobalParams.serviceExecutor = params["net.serviceExecutor"].as<string>();
+    }
+
+    if (params.count("net.serviceExecutorThreads")) {
+        serverGlobalParams.serviceExecutorThreads =
+            params["net.serviceExecutorThreads"].as<int>();
+
+        if (serverGlobalParams.serviceExecutorThreads < 1) {
+            return Status(ErrorCodes::BadValue, "serviceExecutorThreads has to be at least 1");
+        }
+    }
+
     if (params.count("net.wireObjectCheck")) {
         serverGlobalParams.objcheck = params["net.wireObjectCheck"].as<bool>();
     }
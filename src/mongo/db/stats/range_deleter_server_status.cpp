@@ -28,6 +28,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/range_deleter_service.h"
 
 namespace mongo {
@@ -38,13 +39,24 @@ namespace mongo {
  * Sample format:
  *
  * rangeDeleter: {
+ *   totals: {
+ *     deletedDocs: NumberLong(5),
+ *     deletedBytes: NumberLong(160),
+ *     batches: NumberLong(1),
+ *     throttledMillis: NumberLong(0)
+ *   },
  *   lastDeleteStats: [
  *     {
- *       deleteDocs: NumberLong(5);
+ *       deletedDocs: NumberLong(5),
+ *       deletedBytes: NumberLong(160),
+ *       batches: NumberLong(1),
+ *       throttledMillis: NumberLong(0),
  *       queueStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       queueEnd: ISODate("2014-06-11T22:45:30.221Z"),
  *       deleteStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       deleteEnd: ISODate("2014-06-11T22:45:30.221Z"),
+ *       docsPerSec: 5000,
+ *       bytesPerSec: 160000,
  *       waitForReplStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       waitForReplEnd: ISODate("2014-06-11T22:45:30.221Z")
  *     }
@@ -66,6 +78,11 @@ public:
 
         BSONObjBuilder result;
 
+        // Updated as deletes progress, rather than when they finish.
+        BSONObjBuilder totalsBuilder(result.subobjStart("totals"));
+        Helpers::appendRemoveRangeTotals(&totalsBuilder);
+        totalsBuilder.doneFast();
+
         OwnedPointerVector<DeleteJobStats> statsList;
         deleter->getStatsHistory(&statsList.mutableVector());
         BSONArrayBuilder oldStatsBuilder;
@@ -74,6 +91,9 @@ public:
              ++it) {
             BSONObjBuilder entryBuilder;
             entryBuilder.append("deletedDocs", (*it)->deletedDocCount);
+            entryBuilder.append("deletedBytes", (*it)->deletedBytes);
+            entryBuilder.append("batches", (*it)->batchCount);
+            entryBuilder.append("throttledMillis", (*it)->throttledMillis);
 
             if ((*it)->queueEndTS > Date_t()) {
                 entryBuilder.append("queueStart", (*it)->queueStartTS);
@@ -84,6 +104,14 @@ public:
                 entryBuilder.append("deleteStart", (*it)->deleteStartTS);
                 entryBuilder.append("deleteEnd", (*it)->deleteEndTS);
 
+                const long long deleteMillis =
+                    durationCount<Milliseconds>((*it)->deleteEndTS - (*it)->deleteStartTS);
+                if (deleteMillis > 0) {
+                    entryBuilder.append("docsPerSec",
+                                        (*it)->deletedDocCount * 1000.0 / deleteMillis);
+                    entryBuilder.append("bytesPerSec", (*it)->deletedBytes * 1000.0 / deleteMillis);
+                }
+
                 if ((*it)->waitForReplEndTS > Date_t()) {
                     entryBuilder.append("waitForReplStart", (*it)->waitForReplStartTS);
                     entryBuilder.append("waitForReplEnd", (*it)->waitForReplEndTS);
@@ -36,8 +36,11 @@
 
 #include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/in_memory/in_memory_key_string_btree.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/bufreader.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -480,13 +483,400 @@ private:
     IndexSet* _data;
     long long _currentKeySize;
 };
+
+//
+// The implementation below keeps each index in a KeyStringBTree. Entries are the KeyString
+// encoding of the key followed by its RecordId, so they sort with memcmp and every entry is
+// unique. The TypeBits needed to decode the key are stored as the value, and are empty in the
+// common case where all of them are zero.
+//
+
+StringData toStringData(const KeyString& keyString) {
+    return StringData(keyString.getBuffer(), keyString.getSize());
+}
+
+StringData typeBitsData(const KeyString::TypeBits& typeBits) {
+    if (typeBits.isAllZeros())
+        return StringData();
+    return StringData(reinterpret_cast<const char*>(typeBits.getBuffer()), typeBits.getSize());
+}
+
+// Returns the part of an entry before its RecordId.
+StringData keyWithoutRecordId(StringData entry, RecordId* locOut) {
+    *locOut = KeyString::decodeRecordIdAtEnd(entry.rawData(), entry.size());
+    const size_t locSize = KeyString(*locOut).getSize();
+    return entry.substr(0, entry.size() - locSize);
+}
+
+int compareKeyStrings(StringData lhs, StringData rhs) {
+    const int cmp = memcmp(lhs.rawData(), rhs.rawData(), std::min(lhs.size(), rhs.size()));
+    if (cmp != 0)
+        return cmp;
+    return lhs.size() < rhs.size() ? -1 : (lhs.size() > rhs.size() ? 1 : 0);
+}
+
+class InMemoryKeyStringBtreeBuilderImpl : public SortedDataBuilderInterface {
+public:
+    InMemoryKeyStringBtreeBuilderImpl(KeyStringBTree* data,
+                                      const Ordering& ordering,
+                                      bool dupsAllowed)
+        : _data(data), _ordering(ordering), _dupsAllowed(dupsAllowed) {
+        invariant(_data->empty());
+    }
+
+    Status addKey(const BSONObj& key, const RecordId& loc) {
+        // inserts should be in ascending (key, RecordId) order.
+
+        if (key.objsize() >= TempKeyMaxSize) {
+            return Status(ErrorCodes::KeyTooLong, "key too big");
+        }
+
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        const KeyString keyString(key, _ordering, loc);
+        const StringData entry = toStringData(keyString);
+
+        if (!_last.empty()) {
+            // Compare specified key with last inserted key, ignoring its RecordId
+            RecordId unused;
+            const int cmp = compareKeyStrings(keyWithoutRecordId(entry, &unused),
+                                              keyWithoutRecordId(_last, &unused));
+            if (cmp < 0 || (_dupsAllowed && cmp == 0 && loc < _lastLoc)) {
+                return Status(ErrorCodes::InternalError,
+                              "expected ascending (key, RecordId) order in bulk builder");
+            } else if (!_dupsAllowed && cmp == 0 && loc != _lastLoc) {
+                return dupKeyError(key);
+            }
+        }
+
+        _data->insert(entry, typeBitsData(keyString.getTypeBits()));
+        _last = entry.toString();
+        _lastLoc = loc;
+
+        return Status::OK();
+    }
+
+private:
+    KeyStringBTree* const _data;
+    const Ordering _ordering;
+    const bool _dupsAllowed;
+
+    std::string _last;  // used by the bulk builder to detect duplicate keys
+    RecordId _lastLoc;  // or (key, RecordId) ordering violations
+};
+
+class InMemoryKeyStringBtreeImpl : public SortedDataInterface {
+public:
+    InMemoryKeyStringBtreeImpl(KeyStringBTree* data, const Ordering& ordering)
+        : _data(data), _ordering(ordering) {}
+
+    virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn, bool dupsAllowed) {
+        return new InMemoryKeyStringBtreeBuilderImpl(_data, _ordering, dupsAllowed);
+    }
+
+    virtual Status insert(OperationContext* txn,
+                          const BSONObj& key,
+                          const RecordId& loc,
+                          bool dupsAllowed) {
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        if (key.objsize() >= TempKeyMaxSize) {
+            string msg = mongoutils::str::stream()
+                << "InMemoryBtree::insert: key too large to index, failing " << ' ' << key.objsize()
+                << ' ' << key;
+            return Status(ErrorCodes::KeyTooLong, msg);
+        }
+
+        if (!dupsAllowed && isDup(key, loc))
+            return dupKeyError(key);
+
+        const KeyString keyString(key, _ordering, loc);
+        const StringData entry = toStringData(keyString);
+        const StringData typeBits = typeBitsData(keyString.getTypeBits());
+        if (_data->insert(entry, typeBits)) {
+            txn->recoveryUnit()->registerChange(new IndexChange(_data, entry, typeBits, true));
+        }
+        return Status::OK();
+    }
+
+    virtual void unindex(OperationContext* txn,
+                         const BSONObj& key,
+                         const RecordId& loc,
+                         bool dupsAllowed) {
+        invariant(loc.isNormal());
+        invariant(!hasFieldNames(key));
+
+        const KeyString keyString(key, _ordering, loc);
+        const StringData entry = toStringData(keyString);
+        if (_data->erase(entry)) {
+            txn->recoveryUnit()->registerChange(
+                new IndexChange(_data, entry, typeBitsData(keyString.getTypeBits()), false));
+        }
+    }
+
+    virtual void fullValidate(OperationContext* txn,
+                              bool full,
+                              long long* numKeysOut,
+                              BSONObjBuilder* output) const {
+        *numKeysOut = _data->size();
+    }
+
+    virtual bool appendCustomStats(OperationContext* txn,
+                                   BSONObjBuilder* output,
+                                   double scale) const {
+        _data->appendStats(output);
+        return true;
+    }
+
+    virtual long long getSpaceUsedBytes(OperationContext* txn) const {
+        return _data->memoryUsage();
+    }
+
+    virtual Status dupKeyCheck(OperationContext* txn, const BSONObj& key, const RecordId& loc) {
+        invariant(!hasFieldNames(key));
+        if (isDup(key, loc))
+            return dupKeyError(key);
+        return Status::OK();
+    }
+
+    virtual bool isEmpty(OperationContext* txn) {
+        return _data->empty();
+    }
+
+    virtual Status touch(OperationContext* txn) const {
+        // already in memory...
+        return Status::OK();
+    }
+
+    class Cursor final : public SortedDataInterface::Cursor {
+    public:
+        Cursor(OperationContext* txn,
+               const KeyStringBTree& data,
+               const Ordering& ordering,
+               bool isForward)
+            : _txn(txn), _ordering(ordering), _forward(isForward), _it(data) {}
+
+        boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
+            if (_lastMoveWasRestore) {
+                // Return current position rather than advancing.
+                _lastMoveWasRestore = false;
+            } else if (!_isEOF) {
+                const bool found = _forward ? _it.next() : _it.prev();
+                _isEOF = !found || atOrPastEndPoint();
+            }
+            return curr(parts);
+        }
+
+        void setEndPosition(const BSONObj& key, bool inclusive) override {
+            if (key.isEmpty()) {
+                // This means scan to end of index.
+                _endPosition.reset();
+                return;
+            }
+
+            // NOTE: this uses the opposite rules as a normal seek because a forward scan should
+            // end after the key if inclusive and before if exclusive.
+            const auto discriminator =
+                _forward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
+            _endPosition = stdx::make_unique<KeyString>();
+            _endPosition->resetToKey(stripFieldNames(key), _ordering, discriminator);
+        }
+
+        boost::optional<IndexKeyEntry> seek(const BSONObj& key,
+                                            bool inclusive,
+                                            RequestedInfo parts) override {
+            const auto discriminator =
+                _forward == inclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+            _query.resetToKey(stripFieldNames(key), _ordering, discriminator);
+            locate(toStringData(_query));
+            return curr(parts);
+        }
+
+        boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
+                                            RequestedInfo parts) override {
+            // makeQueryObject handles the discriminator in the real exclusive cases.
+            const BSONObj key = IndexEntryComparison::makeQueryObject(seekPoint, _forward);
+            const auto discriminator =
+                _forward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+            _query.resetToKey(key, _ordering, discriminator);
+            locate(toStringData(_query));
+            return curr(parts);
+        }
+
+        void savePositioned() override {
+            _txn = nullptr;
+
+            // Keep original position if we haven't moved since the last restore.
+            if (!_lastMoveWasRestore) {
+                if (_isEOF) {
+                    saveUnpositioned();
+                    return;
+                }
+                _savedAtEnd = false;
+                _savedKey = _it.key().toString();
+            }
+
+            if (!_isEOF)
+                _it.save();
+        }
+
+        void saveUnpositioned() override {
+            _savedAtEnd = true;
+        }
+
+        void restore() override {
+            if (_savedAtEnd) {
+                _isEOF = true;
+                return;
+            }
+
+            // If the leaf we were on hasn't changed, neither has our position or anything
+            // between it and the end point, which is only ever compared by key.
+            if (!_isEOF && _it.restore())
+                return;
+
+            // Need to find our position from the root.
+            locate(_savedKey);
+
+            _lastMoveWasRestore = _isEOF  // We weren't EOF but now are.
+                || _it.key() != StringData(_savedKey);
+        }
+
+        void detachFromOperationContext() final {
+            _txn = nullptr;
+        }
+
+        void reattachToOperationContext(OperationContext* txn) final {
+            _txn = txn;
+        }
+
+    private:
+        bool atOrPastEndPoint() const {
+            if (!_endPosition)
+                return false;
+
+            // The end position is a query with a discriminator, so it never equals an entry.
+            const int cmp = compareKeyStrings(_it.key(), toStringData(*_endPosition));
+            return _forward ? cmp > 0 : cmp < 0;
+        }
+
+        void locate(StringData query) {
+            _lastMoveWasRestore = false;
+            const bool found = _forward ? _it.seekAtOrAfter(query) : _it.seekAtOrBefore(query);
+            _isEOF = !found || atOrPastEndPoint();
+        }
+
+        boost::optional<IndexKeyEntry> curr(RequestedInfo parts) const {
+            if (_isEOF)
+                return {};
+
+            const StringData entry = _it.key();
+            const RecordId loc = KeyString::decodeRecordIdAtEnd(entry.rawData(), entry.size());
+
+            BSONObj key;
+            if (parts & kWantKey) {
+                const StringData typeBits = _it.value();
+                BufReader reader(typeBits.rawData(), typeBits.size());
+                key = KeyString::toBson(entry.rawData(),
+                                        entry.size(),
+                                        _ordering,
+                                        KeyString::TypeBits::fromBuffer(&reader));
+            }
+
+            return {{std::move(key), loc}};
+        }
+
+        OperationContext* _txn;  // not owned
+        const Ordering _ordering;
+        const bool _forward;
+        bool _isEOF = true;
+        KeyStringBTree::Cursor _it;
+
+        std::unique_ptr<KeyString> _endPosition;
+        KeyString _query;
+
+        // Used by next to decide to return current position rather than moving. Should be reset
+        // to false by any operation that moves the cursor, other than subsequent save/restore
+        // pairs.
+        bool _lastMoveWasRestore = false;
+
+        // For save/restore in case the tree changed around our position during a yield.
+        bool _savedAtEnd = false;
+        std::string _savedKey;
+    };
+
+    virtual std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* txn,
+                                                                   bool isForward) const {
+        return stdx::make_unique<Cursor>(txn, *_data, _ordering, isForward);
+    }
+
+    virtual Status initAsEmpty(OperationContext* txn) {
+        // No-op
+        return Status::OK();
+    }
+
+private:
+    bool isDup(const BSONObj& key, const RecordId& loc) const {
+        const KeyString query(key, _ordering);
+        const StringData queryKey = toStringData(query);
+
+        // The entries for the key, ordered by RecordId, come first among those at or after it.
+        KeyStringBTree::Cursor cursor(*_data);
+        for (bool found = cursor.seekAtOrAfter(queryKey); found; found = cursor.next()) {
+            RecordId entryLoc;
+            if (keyWithoutRecordId(cursor.key(), &entryLoc) != queryKey)
+                return false;
+
+            // Not a dup if the entry is for the same loc.
+            if (entryLoc != loc)
+                return true;
+        }
+        return false;
+    }
+
+    class IndexChange : public RecoveryUnit::Change {
+    public:
+        IndexChange(KeyStringBTree* data, StringData entry, StringData typeBits, bool insert)
+            : _data(data),
+              _entry(entry.toString()),
+              _typeBits(typeBits.toString()),
+              _insert(insert) {}
+
+        virtual void commit() {}
+        virtual void rollback() {
+            if (_insert)
+                _data->erase(_entry);
+            else
+                _data->insert(_entry, _typeBits);
+        }
+
+    private:
+        KeyStringBTree* _data;
+        const std::string _entry;
+        const std::string _typeBits;
+        const bool _insert;
+    };
+
+    KeyStringBTree* _data;
+    const Ordering _ordering;
+};
 }  // namespace
 
-// IndexCatalogEntry argument taken by non-const pointer for consistency with other Btree
-// factories. We don't actually modify it.
 SortedDataInterface* getInMemoryBtreeImpl(const Ordering& ordering,
                                           std::shared_ptr<void>* dataInOut) {
     invariant(dataInOut);
+    if (!*dataInOut) {
+        *dataInOut = std::make_shared<KeyStringBTree>();
+    }
+    return new InMemoryKeyStringBtreeImpl(static_cast<KeyStringBTree*>(dataInOut->get()),
+                                          ordering);
+}
+
+SortedDataInterface* getInMemorySetBtreeImpl(const Ordering& ordering,
+                                             std::shared_ptr<void>* dataInOut) {
+    invariant(dataInOut);
     if (!*dataInOut) {
         *dataInOut = std::make_shared<IndexSet>(IndexEntryComparison(ordering));
     }
@@ -40,8 +40,17 @@ class IndexCatalogEntry;
 /**
  * Caller takes ownership.
  * All permanent data will be stored and fetch from dataInOut.
+ *
+ * Keys are KeyString encoded and kept in a prefix compressed B+tree.
  */
 SortedDataInterface* getInMemoryBtreeImpl(const Ordering& ordering,
                                           std::shared_ptr<void>* dataInOut);
 
+/**
+ * As above, but keeps BSON keys in a std::set. This was the original implementation, and is
+ * kept as a baseline for benchmarks. dataInOut must not be shared with getInMemoryBtreeImpl().
+ */
+SortedDataInterface* getInMemorySetBtreeImpl(const Ordering& ordering,
+                                             std::shared_ptr<void>* dataInOut);
+
 }  // namespace mongo
@@ -0,0 +1,304 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_column_store.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+/**
+ * The bytes identifying the value of 'elt' regardless of its field name. Values are only
+ * shared when they are identical, including their type, so rows are rebuilt exactly.
+ */
+string valueKey(const BSONElement& elt) {
+    string key(1, static_cast<char>(elt.type()));
+    key.append(elt.value(), elt.valuesize());
+    return key;
+}
+
+}  // namespace
+
+const size_t ColumnStore::kRowsPerSegment;
+
+void ColumnStore::Runs::append(uint32_t code) {
+    if (!_runs.empty() && _runs.back().code == code &&
+        _runs.back().length < std::numeric_limits<uint32_t>::max()) {
+        ++_runs.back().length;
+        return;
+    }
+    _runs.push_back(Run{code, 1});
+}
+
+void ColumnStore::append(const RecordId& id, const BSONObj& doc) {
+    invariant(id > lastId());
+
+    if (_segments.empty() || _segments.back()->ids.size() == kRowsPerSegment) {
+        if (!_segments.empty()) {
+            _seal(_segments.back().get());
+        }
+        _segments.emplace_back(new Segment());
+    }
+
+    Segment* segment = _segments.back().get();
+    segment->ids.push_back(id);
+    segment->shapes.append(_shapeCode(doc));
+
+    BSONObjIterator it(doc);
+    while (it.more()) {
+        const BSONElement elt = it.next();
+        std::unique_ptr<Column>& column = segment->columns[elt.fieldName()];
+        if (!column) {
+            column.reset(new Column());
+        }
+
+        const auto inserted = column->lookup.emplace(valueKey(elt), column->dictionary.size());
+        if (inserted.second) {
+            BSONObjBuilder value;
+            value.appendAs(elt, "");
+            column->dictionary.push_back(value.obj());
+        }
+        column->codes.append(inserted.first->second);
+    }
+
+    ++_numRows;
+}
+
+RecordId ColumnStore::lastId() const {
+    return _segments.empty() ? RecordId() : _segments.back()->ids.back();
+}
+
+uint32_t ColumnStore::_shapeCode(const BSONObj& doc) {
+    string key;
+    BSONObjIterator it(doc);
+    while (it.more()) {
+        const BSONElement elt = it.next();
+        key.append(elt.fieldName(), elt.fieldNameSize());
+    }
+
+    const auto inserted = _shapeLookup.emplace(key, _shapes.size());
+    if (inserted.second) {
+        vector<string> fields;
+        BSONObjIterator fieldIt(doc);
+        while (fieldIt.more()) {
+            fields.push_back(fieldIt.next().fieldName());
+        }
+        _shapes.push_back(std::move(fields));
+    }
+    return inserted.first->second;
+}
+
+void ColumnStore::_seal(Segment* segment) {
+    // Full segments never see new values, so only the dictionaries themselves are kept.
+    for (auto& column : segment->columns) {
+        std::unordered_map<string, uint32_t>().swap(column.second->lookup);
+    }
+}
+
+void ColumnStore::appendStats(BSONObjBuilder* builder) const {
+    long long columns = 0;
+    long long dictionaryValues = 0;
+    long long runs = 0;
+    long long values = 0;
+    for (const auto& segment : _segments) {
+        for (const auto& column : segment->columns) {
+            ++columns;
+            dictionaryValues += column.second->dictionary.size();
+            runs += column.second->codes.runs().size();
+            for (const Run& run : column.second->codes.runs()) {
+                values += run.length;
+            }
+        }
+    }
+
+    builder->appendNumber("rows", static_cast<long long>(_numRows));
+    builder->appendNumber("segments", static_cast<long long>(_segments.size()));
+    builder->appendNumber("shapes", static_cast<long long>(_shapes.size()));
+    builder->appendNumber("columns", columns);
+    builder->appendNumber("values", values);
+    builder->appendNumber("dictionaryValues", dictionaryValues);
+    builder->appendNumber("runs", runs);
+}
+
+//
+// Cursor
+//
+
+ColumnStore::Cursor::Cursor(const ColumnStore* store, vector<string> fields)
+    : _store(store),
+      _fields(std::move(fields)),
+      _columns(_fields.size()),
+      _columnPos(_fields.size()) {}
+
+// static
+uint32_t ColumnStore::Cursor::_advance(const Runs& runs, Position* pos) {
+    const Run& run = runs.runs()[pos->run];
+    if (++pos->offset == run.length) {
+        ++pos->run;
+        pos->offset = 0;
+    }
+    return run.code;
+}
+
+void ColumnStore::Cursor::_enterSegment(size_t segment) {
+    _segment = segment;
+    _row = 0;
+    _inSegment = true;
+    _shapePos = Position();
+
+    const Segment& seg = *_store->_segments[segment];
+    for (size_t i = 0; i < _fields.size(); ++i) {
+        auto it = seg.columns.find(_fields[i]);
+        _columns[i] = it == seg.columns.end() ? NULL : it->second.get();
+        _columnPos[i] = Position();
+    }
+}
+
+const ColumnStore::Column* ColumnStore::Cursor::_column(size_t field) {
+    if (!_columns[field]) {
+        // The column was added to the last segment after the cursor entered it.
+        const Segment& seg = *_store->_segments[_segment];
+        _columns[field] = seg.columns.find(_fields[field])->second.get();
+    }
+    return _columns[field];
+}
+
+const vector<size_t>& ColumnStore::Cursor::_requestedForShape(uint32_t shape) {
+    if (shape >= _shapeFields.size()) {
+        _shapeFields.resize(shape + 1);
+    }
+
+    std::unique_ptr<vector<size_t>>& requested = _shapeFields[shape];
+    if (!requested) {
+        requested.reset(new vector<size_t>());
+        for (const string& field : _store->_shapes[shape]) {
+            auto it = std::find(_fields.begin(), _fields.end(), field);
+            if (it != _fields.end()) {
+                requested->push_back(it - _fields.begin());
+            }
+        }
+    }
+    return *requested;
+}
+
+bool ColumnStore::Cursor::next(RecordId* idOut, BSONObjBuilder* out) {
+    while (true) {
+        if (_segment >= _store->_segments.size()) {
+            return false;
+        }
+        if (!_inSegment) {
+            _enterSegment(_segment);
+        }
+
+        const Segment& seg = *_store->_segments[_segment];
+        if (_row < seg.ids.size()) {
+            break;
+        }
+
+        // Stay at the end of the last segment so that rows appended to it later are returned.
+        if (_segment + 1 == _store->_segments.size()) {
+            return false;
+        }
+        ++_segment;
+        _inSegment = false;
+    }
+
+    const Segment& seg = *_store->_segments[_segment];
+    *idOut = seg.ids[_row++];
+
+    const uint32_t shape = _advance(seg.shapes, &_shapePos);
+    for (size_t field : _requestedForShape(shape)) {
+        const Column* column = _column(field);
+        const uint32_t code = _advance(column->codes, &_columnPos[field]);
+        out->appendAs(column->dictionary[code].firstElement(), _fields[field]);
+    }
+    return true;
+}
+
+void ColumnStore::Cursor::_skipRows(size_t count) {
+    const Segment& seg = *_store->_segments[_segment];
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t shape = _advance(seg.shapes, &_shapePos);
+        for (size_t field : _requestedForShape(shape)) {
+            _advance(_column(field)->codes, &_columnPos[field]);
+        }
+        ++_row;
+    }
+}
+
+void ColumnStore::Cursor::seekAfter(const RecordId& id) {
+    const auto& segments = _store->_segments;
+    auto segIt = std::upper_bound(segments.begin(),
+                                  segments.end(),
+                                  id,
+                                  [](const RecordId& id, const std::unique_ptr<Segment>& seg) {
+                                      return id < seg->ids.back();
+                                  });
+    if (segIt == segments.end()) {
+        // Every row is at or before 'id'. Position at the end of the store.
+        if (segments.empty()) {
+            _segment = 0;
+            _inSegment = false;
+            return;
+        }
+        _enterSegment(segments.size() - 1);
+        _skipRows(segments.back()->ids.size());
+        return;
+    }
+
+    _enterSegment(segIt - segments.begin());
+    const vector<RecordId>& ids = (*segIt)->ids;
+    _skipRows(std::upper_bound(ids.begin(), ids.end(), id) - ids.begin());
+}
+
+bool ColumnStore::Cursor::hasRow(const RecordId& id) const {
+    const auto& segments = _store->_segments;
+    auto segIt = std::lower_bound(segments.begin(),
+                                  segments.end(),
+                                  id,
+                                  [](const std::unique_ptr<Segment>& seg, const RecordId& id) {
+                                      return seg->ids.back() < id;
+                                  });
+    if (segIt == segments.end()) {
+        return false;
+    }
+    const vector<RecordId>& ids = (*segIt)->ids;
+    return std::binary_search(ids.begin(), ids.end(), id);
+}
+
+}  // namespace mongo
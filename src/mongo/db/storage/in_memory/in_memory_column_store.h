@@ -0,0 +1,209 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+/**
+ * A column-oriented copy of a set of documents, used to scan a few top-level fields of every
+ * document without touching the rest.
+ *
+ * Rows are appended in RecordId order and grouped into segments of kRowsPerSegment rows. Within
+ * a segment each top-level field name has a column holding the values of that field, in row
+ * order, for the rows which have it. Each column is dictionary encoded: the distinct values are
+ * stored once and the rows refer to them by code, with runs of the same code run-length encoded.
+ * The list of top-level field names of each row, its "shape", is encoded the same way using a
+ * dictionary shared by the whole store. Shapes record which columns a row has values in and in
+ * what order, so rows can be rebuilt with their fields in their original order.
+ *
+ * Rows can't be modified or removed once appended. Callers rebuild the store instead.
+ */
+class ColumnStore {
+    MONGO_DISALLOW_COPYING(ColumnStore);
+
+public:
+    static const size_t kRowsPerSegment = 4096;
+
+    class Cursor;
+
+    ColumnStore() = default;
+
+    /**
+     * Appends 'doc' as the row for 'id', which must be greater than lastId().
+     */
+    void append(const RecordId& id, const BSONObj& doc);
+
+    /**
+     * The id of the last row appended, or a null RecordId if the store is empty.
+     */
+    RecordId lastId() const;
+
+    size_t numRows() const {
+        return _numRows;
+    }
+
+    size_t numSegments() const {
+        return _segments.size();
+    }
+
+    /**
+     * Appends counts describing how well the data is encoded, for collection stats.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    /**
+     * Run-length encoded dictionary codes.
+     */
+    struct Run {
+        uint32_t code;
+        uint32_t length;
+    };
+
+    class Runs {
+    public:
+        void append(uint32_t code);
+
+        const std::vector<Run>& runs() const {
+            return _runs;
+        }
+
+    private:
+        std::vector<Run> _runs;
+    };
+
+    /**
+     * The values of one top-level field in one segment.
+     */
+    struct Column {
+        // Each distinct value, as the only element of an owned object.
+        std::vector<BSONObj> dictionary;
+        Runs codes;
+
+        // Maps the type and value bytes of each entry in 'dictionary' to its code. Only kept
+        // while the segment is still being appended to.
+        std::unordered_map<std::string, uint32_t> lookup;
+    };
+
+    struct Segment {
+        std::vector<RecordId> ids;
+        Runs shapes;
+        std::unordered_map<std::string, std::unique_ptr<Column>> columns;
+    };
+
+    uint32_t _shapeCode(const BSONObj& doc);
+    void _seal(Segment* segment);
+
+    std::vector<std::unique_ptr<Segment>> _segments;
+    size_t _numRows = 0;
+
+    // The distinct shapes, as lists of top-level field names, and their codes.
+    std::vector<std::vector<std::string>> _shapes;
+    std::unordered_map<std::string, uint32_t> _shapeLookup;
+};
+
+/**
+ * Iterates over the rows of a ColumnStore in RecordId order, rebuilding each row with only the
+ * requested top-level fields. Fields keep the order they had in the original document, and rows
+ * without any of the fields come back as empty objects.
+ *
+ * The store may have rows appended while a cursor is open. The cursor sees them once it gets
+ * there.
+ */
+class ColumnStore::Cursor {
+public:
+    Cursor(const ColumnStore* store, std::vector<std::string> fields);
+
+    /**
+     * Moves to the next row, writing its id to 'idOut' and its requested fields to 'out'.
+     * Returns false at the end of the store.
+     */
+    bool next(RecordId* idOut, BSONObjBuilder* out);
+
+    /**
+     * Positions the cursor so that next() returns the first row with an id greater than 'id'.
+     */
+    void seekAfter(const RecordId& id);
+
+    /**
+     * Returns true if the row for 'id' is in the store.
+     */
+    bool hasRow(const RecordId& id) const;
+
+private:
+    struct Position {
+        size_t run = 0;
+        uint32_t offset = 0;
+    };
+
+    /**
+     * Returns the code at 'pos' in 'runs' and moves 'pos' past it.
+     */
+    static uint32_t _advance(const Runs& runs, Position* pos);
+
+    void _enterSegment(size_t segment);
+    void _skipRows(size_t count);
+
+    /**
+     * Returns the column in the current segment for the requested field at index 'field'. Only
+     * valid if the current row has the field.
+     */
+    const Column* _column(size_t field);
+    const std::vector<size_t>& _requestedForShape(uint32_t shape);
+
+    const ColumnStore* const _store;
+    const std::vector<std::string> _fields;
+
+    // Current position: the next row returned is row '_row' of segment '_segment'.
+    size_t _segment = 0;
+    size_t _row = 0;
+    bool _inSegment = false;
+    Position _shapePos;
+
+    // For each requested field, its column in the current segment (or NULL) and the position of
+    // the next value in it.
+    std::vector<const Column*> _columns;
+    std::vector<Position> _columnPos;
+
+    // For each shape seen, the requested fields it has, in document order, as indexes into
+    // '_fields'. A field repeated in the document is listed once per occurrence.
+    std::vector<std::unique_ptr<std::vector<size_t>>> _shapeFields;
+};
+
+}  // namespace mongo
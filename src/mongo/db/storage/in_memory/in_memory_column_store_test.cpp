@@ -0,0 +1,216 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_column_store.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using std::string;
+using std::vector;
+
+/**
+ * Reads the next row from 'cursor', asserting that it exists and has id 'expectedId'.
+ */
+BSONObj nextRow(ColumnStore::Cursor* cursor, long long expectedId) {
+    RecordId id;
+    BSONObjBuilder builder;
+    ASSERT(cursor->next(&id, &builder));
+    ASSERT_EQUALS(RecordId(expectedId), id);
+    return builder.obj();
+}
+
+void assertEOF(ColumnStore::Cursor* cursor) {
+    RecordId id;
+    BSONObjBuilder builder;
+    ASSERT_FALSE(cursor->next(&id, &builder));
+}
+
+TEST(ColumnStoreTest, Empty) {
+    ColumnStore store;
+    ASSERT_EQUALS(RecordId(), store.lastId());
+    ASSERT_EQUALS(0U, store.numRows());
+
+    ColumnStore::Cursor cursor(&store, {"a"});
+    assertEOF(&cursor);
+    ASSERT_FALSE(cursor.hasRow(RecordId(1)));
+}
+
+TEST(ColumnStoreTest, ReturnsRequestedFieldsInDocumentOrder) {
+    ColumnStore store;
+    store.append(RecordId(1), fromjson("{_id: 1, a: 'x', b: {c: 2}, d: [1, 2]}"));
+    store.append(RecordId(2), fromjson("{b: 5, _id: 2, e: 1}"));
+    store.append(RecordId(5), fromjson("{_id: 3}"));
+    ASSERT_EQUALS(RecordId(5), store.lastId());
+    ASSERT_EQUALS(3U, store.numRows());
+
+    ColumnStore::Cursor cursor(&store, {"d", "b", "_id"});
+    ASSERT_EQUALS(fromjson("{_id: 1, b: {c: 2}, d: [1, 2]}"), nextRow(&cursor, 1));
+    ASSERT_EQUALS(fromjson("{b: 5, _id: 2}"), nextRow(&cursor, 2));
+    ASSERT_EQUALS(fromjson("{_id: 3}"), nextRow(&cursor, 5));
+    assertEOF(&cursor);
+}
+
+TEST(ColumnStoreTest, MissingFieldsGiveEmptyRows) {
+    ColumnStore store;
+    store.append(RecordId(1), fromjson("{a: 1}"));
+    store.append(RecordId(2), fromjson("{b: 1}"));
+
+    ColumnStore::Cursor cursor(&store, {"c"});
+    ASSERT_EQUALS(BSONObj(), nextRow(&cursor, 1));
+    ASSERT_EQUALS(BSONObj(), nextRow(&cursor, 2));
+    assertEOF(&cursor);
+}
+
+TEST(ColumnStoreTest, ValuesKeepTheirType) {
+    // Numerically equal values of different types must not share a dictionary entry.
+    ColumnStore store;
+    store.append(RecordId(1), BSON("a" << 1));
+    store.append(RecordId(2), BSON("a" << 1.0));
+    store.append(RecordId(3), BSON("a" << 1LL));
+
+    ColumnStore::Cursor cursor(&store, {"a"});
+    ASSERT_EQUALS(NumberInt, nextRow(&cursor, 1).firstElement().type());
+    ASSERT_EQUALS(NumberDouble, nextRow(&cursor, 2).firstElement().type());
+    ASSERT_EQUALS(NumberLong, nextRow(&cursor, 3).firstElement().type());
+    assertEOF(&cursor);
+}
+
+TEST(ColumnStoreTest, RepeatedValuesAreEncodedOnce) {
+    ColumnStore store;
+    for (int i = 1; i <= 1000; i++) {
+        store.append(RecordId(i), BSON("_id" << i << "status" << (i <= 500 ? "open" : "closed")));
+    }
+
+    BSONObjBuilder stats;
+    store.appendStats(&stats);
+    const BSONObj obj = stats.obj();
+    ASSERT_EQUALS(1000, obj["rows"].numberLong());
+    ASSERT_EQUALS(1, obj["shapes"].numberLong());
+    ASSERT_EQUALS(2, obj["columns"].numberLong());
+    ASSERT_EQUALS(2000, obj["values"].numberLong());
+    // 1000 distinct _ids, but only two statuses.
+    ASSERT_EQUALS(1002, obj["dictionaryValues"].numberLong());
+    // Every _id is its own run, while each status is one run.
+    ASSERT_EQUALS(1002, obj["runs"].numberLong());
+
+    ColumnStore::Cursor cursor(&store, {"status"});
+    for (int i = 1; i <= 1000; i++) {
+        ASSERT_EQUALS(BSON("status" << (i <= 500 ? "open" : "closed")), nextRow(&cursor, i));
+    }
+    assertEOF(&cursor);
+}
+
+TEST(ColumnStoreTest, SpansSegments) {
+    const int numRows = ColumnStore::kRowsPerSegment * 2 + 10;
+
+    ColumnStore store;
+    for (int i = 1; i <= numRows; i++) {
+        // Alternate shapes so that columns are sparse.
+        if (i % 3 == 0) {
+            store.append(RecordId(i), BSON("b" << i << "a" << i % 7));
+        } else {
+            store.append(RecordId(i), BSON("a" << i % 7));
+        }
+    }
+    ASSERT_EQUALS(3U, store.numSegments());
+
+    ColumnStore::Cursor cursor(&store, {"a", "b"});
+    for (int i = 1; i <= numRows; i++) {
+        const BSONObj expected =
+            i % 3 == 0 ? BSON("b" << i << "a" << i % 7) : BSON("a" << i % 7);
+        ASSERT_EQUALS(expected, nextRow(&cursor, i));
+    }
+    assertEOF(&cursor);
+}
+
+TEST(ColumnStoreTest, SeekAfter) {
+    const int numRows = ColumnStore::kRowsPerSegment + 10;
+
+    ColumnStore store;
+    for (int i = 1; i <= numRows; i++) {
+        store.append(RecordId(i * 2), BSON("a" << i));
+    }
+
+    ColumnStore::Cursor cursor(&store, {"a"});
+
+    // Seeking to a missing id positions after it.
+    cursor.seekAfter(RecordId(5));
+    ASSERT_EQUALS(BSON("a" << 3), nextRow(&cursor, 6));
+
+    // Seeking into the second segment.
+    cursor.seekAfter(RecordId(ColumnStore::kRowsPerSegment * 2));
+    ASSERT_EQUALS(BSON("a" << static_cast<int>(ColumnStore::kRowsPerSegment + 1)),
+                  nextRow(&cursor, (ColumnStore::kRowsPerSegment + 1) * 2));
+
+    // Seeking backwards.
+    cursor.seekAfter(RecordId());
+    ASSERT_EQUALS(BSON("a" << 1), nextRow(&cursor, 2));
+
+    // Seeking past the end.
+    cursor.seekAfter(RecordId(numRows * 2));
+    assertEOF(&cursor);
+
+    ASSERT(cursor.hasRow(RecordId(numRows * 2)));
+    ASSERT_FALSE(cursor.hasRow(RecordId(3)));
+}
+
+TEST(ColumnStoreTest, SeesRowsAppendedWhileOpen) {
+    ColumnStore store;
+    store.append(RecordId(1), fromjson("{a: 1}"));
+
+    ColumnStore::Cursor cursor(&store, {"a", "b"});
+    ASSERT_EQUALS(fromjson("{a: 1}"), nextRow(&cursor, 1));
+    assertEOF(&cursor);
+
+    // The new row adds a column the cursor hasn't seen yet.
+    store.append(RecordId(2), fromjson("{a: 2, b: 3}"));
+    ASSERT_EQUALS(fromjson("{a: 2, b: 3}"), nextRow(&cursor, 2));
+    assertEOF(&cursor);
+
+    // Fill the segment so the next row starts a new one.
+    for (size_t i = 3; i <= ColumnStore::kRowsPerSegment + 1; i++) {
+        store.append(RecordId(i), BSON("a" << 0));
+    }
+    for (size_t i = 3; i <= ColumnStore::kRowsPerSegment + 1; i++) {
+        ASSERT_EQUALS(BSON("a" << 0), nextRow(&cursor, i));
+    }
+    assertEOF(&cursor);
+    ASSERT_EQUALS(2U, store.numSegments());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -31,6 +31,7 @@
 #include "mongo/db/storage/in_memory/in_memory_engine.h"
 
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
 #include "mongo/db/storage/in_memory/in_memory_record_store.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
@@ -61,7 +62,11 @@ RecordStore* InMemoryEngine::getRecordStore(OperationContext* opCtx,
                                        options.cappedSize ? options.cappedSize : 4096,
                                        options.cappedMaxDocs ? options.cappedMaxDocs : -1);
     } else {
-        return new InMemoryRecordStore(ns, &_dataMap[ident]);
+        InMemoryRecordStore* rs = new InMemoryRecordStore(ns, &_dataMap[ident]);
+        if (_columnScans && !NamespaceString::oplog(ns)) {
+            rs->enableColumnScans();
+        }
+        return rs;
     }
 }
 
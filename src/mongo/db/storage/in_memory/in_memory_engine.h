@@ -38,6 +38,12 @@ namespace mongo {
 
 class InMemoryEngine : public KVEngine {
 public:
+    /**
+     * If 'columnScans' is true, record stores for regular collections keep a columnar copy of
+     * their records for scans which only need a few fields. See InMemoryRecordStore.
+     */
+    explicit InMemoryEngine(bool columnScans = false) : _columnScans(columnScans) {}
+
     virtual RecoveryUnit* newRecoveryUnit();
 
     virtual Status createRecordStore(OperationContext* opCtx,
@@ -93,6 +99,8 @@ public:
 private:
     typedef StringMap<std::shared_ptr<void>> DataMap;
 
+    const bool _columnScans;
+
     mutable stdx::mutex _mutex;
     DataMap _dataMap;  // All actual data is owned in here
 };
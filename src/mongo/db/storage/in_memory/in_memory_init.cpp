@@ -41,17 +41,18 @@ namespace {
 
 class InMemoryFactory : public StorageEngine::Factory {
 public:
+    explicit InMemoryFactory(bool columnScans = false) : _columnScans(columnScans) {}
     virtual ~InMemoryFactory() {}
     virtual StorageEngine* create(const StorageGlobalParams& params,
                                   const StorageEngineLockFile& lockFile) const {
         KVStorageEngineOptions options;
         options.directoryPerDB = params.directoryperdb;
         options.forRepair = params.repair;
-        return new KVStorageEngine(new InMemoryEngine(), options);
+        return new KVStorageEngine(new InMemoryEngine(_columnScans), options);
     }
 
     virtual StringData getCanonicalName() const {
-        return "inMemoryExperiment";
+        return _columnScans ? "inMemoryColumnarExperiment" : "inMemoryExperiment";
     }
 
     virtual Status validateMetadata(const StorageEngineMetadata& metadata,
@@ -62,6 +63,9 @@ public:
     virtual BSONObj createMetadataOptions(const StorageGlobalParams& params) const {
         return BSONObj();
     }
+
+private:
+    const bool _columnScans;
 };
 
 }  // namespace
@@ -69,6 +73,8 @@ public:
 MONGO_INITIALIZER_WITH_PREREQUISITES(InMemoryEngineInit, ("SetGlobalEnvironment"))
 (InitializerContext* context) {
     getGlobalServiceContext()->registerStorageEngine("inMemoryExperiment", new InMemoryFactory());
+    getGlobalServiceContext()->registerStorageEngine("inMemoryColumnarExperiment",
+                                                     new InMemoryFactory(true));
     return Status::OK();
 }
 
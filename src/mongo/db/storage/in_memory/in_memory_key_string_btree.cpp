@@ -0,0 +1,523 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_key_string_btree.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using std::string;
+
+namespace {
+
+uint32_t makeHead(StringData bytes) {
+    uint32_t head = 0;
+    const size_t n = std::min(bytes.size(), size_t(4));
+    for (size_t i = 0; i < n; i++) {
+        head |= uint32_t(static_cast<unsigned char>(bytes[i])) << (24 - 8 * i);
+    }
+    return head;
+}
+
+int compareBytes(StringData lhs, StringData rhs) {
+    const size_t n = std::min(lhs.size(), rhs.size());
+    const int cmp = n ? memcmp(lhs.rawData(), rhs.rawData(), n) : 0;
+    if (cmp)
+        return cmp;
+    if (lhs.size() == rhs.size())
+        return 0;
+    return lhs.size() < rhs.size() ? -1 : 1;
+}
+
+size_t commonPrefixSize(StringData lhs, StringData rhs) {
+    const size_t n = std::min(lhs.size(), rhs.size());
+    size_t i = 0;
+    while (i < n && lhs[i] == rhs[i]) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * Returns the shortest string which is > 'left' and <= 'right', where 'left' < 'right'.
+ */
+string shortestSeparator(StringData left, StringData right) {
+    return right.substr(0, commonPrefixSize(left, right) + 1).toString();
+}
+
+}  // namespace
+
+const size_t KeyStringBTree::kMaxSlots;
+const size_t KeyStringBTree::kMaxSize;
+
+//
+// Node
+//
+
+void KeyStringBTree::Node::appendKey(size_t i, string* out) const {
+    out->append(prefix);
+    const StringData rest = suffix(i);
+    out->append(rest.rawData(), rest.size());
+}
+
+template <bool SkipEqual>
+size_t KeyStringBTree::Node::_search(StringData key) const {
+    // Every key in the node starts with the prefix, so comparing against it first either
+    // decides the position outright or leaves only the rest of 'key' to compare.
+    const size_t n = std::min(key.size(), prefix.size());
+    const int cmp = n ? memcmp(key.rawData(), prefix.data(), n) : 0;
+    if (cmp < 0 || (cmp == 0 && key.size() < prefix.size()))
+        return 0;
+    if (cmp > 0)
+        return slots.size();
+
+    const StringData rest = key.substr(prefix.size());
+    const uint32_t head = makeHead(rest);
+
+    size_t low = 0;
+    size_t high = slots.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        int slotCmp;
+        if (slots[mid].head != head) {
+            slotCmp = slots[mid].head < head ? -1 : 1;
+        } else {
+            slotCmp = compareBytes(suffix(mid), rest);
+        }
+
+        if (slotCmp < 0 || (SkipEqual && slotCmp == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+size_t KeyStringBTree::Node::lowerBound(StringData key) const {
+    return _search<false>(key);
+}
+
+size_t KeyStringBTree::Node::upperBound(StringData key) const {
+    return _search<true>(key);
+}
+
+bool KeyStringBTree::Node::keyEquals(size_t i, StringData key) const {
+    return key.size() == prefix.size() + slots[i].keySize && key.startsWith(prefix) &&
+        key.substr(prefix.size()) == suffix(i);
+}
+
+void KeyStringBTree::Node::insertAt(size_t i, StringData key, StringData value) {
+    invariant(key.size() <= kMaxSize);
+    invariant(value.size() <= kMaxSize);
+
+    if (slots.empty()) {
+        arena.clear();
+        garbage = 0;
+        prefix = key.toString();
+    } else if (!key.startsWith(prefix)) {
+        // Shorten the prefix to what 'key' shares with it, moving the rest into the slots.
+        Entries entries;
+        copyEntries(&entries);
+        assign(entries.begin(), entries.end(), commonPrefixSize(prefix, key));
+    }
+
+    const StringData rest = key.substr(prefix.size());
+    Slot slot;
+    slot.head = makeHead(rest);
+    slot.offset = arena.size();
+    slot.keySize = rest.size();
+    slot.valueSize = value.size();
+    arena.append(rest.rawData(), rest.size());
+    arena.append(value.rawData(), value.size());
+    slots.insert(slots.begin() + i, slot);
+    version++;
+}
+
+void KeyStringBTree::Node::eraseAt(size_t i) {
+    garbage += slots[i].keySize + slots[i].valueSize;
+    slots.erase(slots.begin() + i);
+    version++;
+
+    if (slots.empty()) {
+        arena.clear();
+        garbage = 0;
+        prefix.clear();
+    } else if (garbage > 256 && garbage * 2 > arena.size()) {
+        Entries entries;
+        copyEntries(&entries);
+        assign(entries.begin(), entries.end());
+    }
+}
+
+void KeyStringBTree::Node::copyEntries(Entries* out) const {
+    out->reserve(out->size() + slots.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        string key;
+        appendKey(i, &key);
+        out->emplace_back(std::move(key), value(i).toString());
+    }
+}
+
+void KeyStringBTree::Node::assign(Entries::const_iterator begin,
+                                  Entries::const_iterator end,
+                                  size_t maxPrefixSize) {
+    slots.clear();
+    arena.clear();
+    garbage = 0;
+    prefix.clear();
+    version++;
+
+    if (begin == end)
+        return;
+
+    // The keys are sorted, so what the first and last share is shared by all of them.
+    const string& first = begin->first;
+    const string& last = (end - 1)->first;
+    prefix = first.substr(0, std::min(commonPrefixSize(first, last), maxPrefixSize));
+
+    slots.reserve(end - begin);
+    for (auto it = begin; it != end; ++it) {
+        const StringData rest = StringData(it->first).substr(prefix.size());
+        Slot slot;
+        slot.head = makeHead(rest);
+        slot.offset = arena.size();
+        slot.keySize = rest.size();
+        slot.valueSize = it->second.size();
+        arena.append(rest.rawData(), rest.size());
+        arena.append(it->second);
+        slots.push_back(slot);
+    }
+}
+
+//
+// KeyStringBTree
+//
+
+KeyStringBTree::KeyStringBTree() : _root(new Leaf()) {}
+
+KeyStringBTree::~KeyStringBTree() {
+    _freeNode(_root);
+}
+
+void KeyStringBTree::_freeNode(Node* node) {
+    if (!node->isLeaf) {
+        for (Node* child : static_cast<Inner*>(node)->children) {
+            _freeNode(child);
+        }
+    }
+    delete node;
+}
+
+const KeyStringBTree::Leaf* KeyStringBTree::_findLeaf(StringData key) const {
+    const Node* node = _root;
+    while (!node->isLeaf) {
+        const Inner* inner = static_cast<const Inner*>(node);
+        node = inner->children[inner->upperBound(key)];
+    }
+    return static_cast<const Leaf*>(node);
+}
+
+KeyStringBTree::Leaf* KeyStringBTree::_findLeaf(StringData key, Path* path) {
+    Node* node = _root;
+    while (!node->isLeaf) {
+        Inner* inner = static_cast<Inner*>(node);
+        const size_t i = inner->upperBound(key);
+        path->emplace_back(inner, i);
+        node = inner->children[i];
+    }
+    return static_cast<Leaf*>(node);
+}
+
+bool KeyStringBTree::insert(StringData key, StringData value) {
+    Path path;
+    Leaf* leaf = _findLeaf(key, &path);
+    const size_t i = leaf->lowerBound(key);
+    if (i < leaf->slots.size() && leaf->keyEquals(i, key))
+        return false;
+
+    leaf->insertAt(i, key, value);
+    _size++;
+
+    if (leaf->slots.size() > kMaxSlots)
+        _splitLeaf(leaf, i, &path);
+    return true;
+}
+
+void KeyStringBTree::_splitLeaf(Leaf* leaf, size_t insertedAt, Path* path) {
+    Entries entries;
+    leaf->copyEntries(&entries);
+
+    // Appending to the end of the tree leaves the old leaf full rather than half empty.
+    const size_t n = entries.size();
+    const size_t mid = (!leaf->next && insertedAt == n - 1) ? n - 1 : n / 2;
+
+    Leaf* right = new Leaf();
+    right->assign(entries.begin() + mid, entries.end());
+    leaf->assign(entries.begin(), entries.begin() + mid);
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (right->next)
+        right->next->prev = right;
+    leaf->next = right;
+
+    _insertIntoParent(
+        path, leaf, shortestSeparator(entries[mid - 1].first, entries[mid].first), right);
+}
+
+void KeyStringBTree::_insertIntoParent(Path* path,
+                                       Node* left,
+                                       const string& separator,
+                                       Node* right) {
+    if (path->empty()) {
+        Inner* root = new Inner();
+        root->insertAt(0, separator, StringData());
+        root->children.push_back(left);
+        root->children.push_back(right);
+        _root = root;
+        _height++;
+        return;
+    }
+
+    Inner* parent = path->back().first;
+    const size_t i = path->back().second;
+    path->pop_back();
+
+    parent->insertAt(i, separator, StringData());
+    parent->children.insert(parent->children.begin() + i + 1, right);
+    if (parent->slots.size() <= kMaxSlots)
+        return;
+
+    // The middle separator moves up and the others are split between the two halves.
+    Entries separators;
+    parent->copyEntries(&separators);
+    const size_t mid = separators.size() / 2;
+
+    Inner* sibling = new Inner();
+    sibling->assign(separators.begin() + mid + 1, separators.end());
+    sibling->children.assign(parent->children.begin() + mid + 1, parent->children.end());
+    parent->assign(separators.begin(), separators.begin() + mid);
+    parent->children.resize(mid + 1);
+
+    _insertIntoParent(path, parent, separators[mid].first, sibling);
+}
+
+bool KeyStringBTree::erase(StringData key) {
+    Path path;
+    Leaf* leaf = _findLeaf(key, &path);
+    const size_t i = leaf->lowerBound(key);
+    if (i == leaf->slots.size() || !leaf->keyEquals(i, key))
+        return false;
+
+    leaf->eraseAt(i);
+    _size--;
+
+    if (leaf->slots.empty() && leaf != _root)
+        _removeEmpty(leaf, &path);
+    return true;
+}
+
+void KeyStringBTree::_removeEmpty(Node* node, Path* path) {
+    if (node->isLeaf) {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        if (leaf->prev)
+            leaf->prev->next = leaf->next;
+        if (leaf->next)
+            leaf->next->prev = leaf->prev;
+    }
+
+    Inner* parent = path->back().first;
+    const size_t i = path->back().second;
+    path->pop_back();
+
+    delete node;
+    _structureVersion++;
+
+    // The neighbour to the left, if any, takes over the range of the removed child.
+    parent->children.erase(parent->children.begin() + i);
+    if (!parent->slots.empty())
+        parent->eraseAt(i == 0 ? 0 : i - 1);
+
+    if (parent->children.empty()) {
+        if (parent == _root) {
+            delete parent;
+            _root = new Leaf();
+            _height = 1;
+        } else {
+            _removeEmpty(parent, path);
+        }
+        return;
+    }
+
+    while (!_root->isLeaf && static_cast<Inner*>(_root)->children.size() == 1) {
+        Inner* oldRoot = static_cast<Inner*>(_root);
+        _root = oldRoot->children[0];
+        delete oldRoot;
+        _height--;
+    }
+}
+
+size_t KeyStringBTree::memoryUsage() const {
+    size_t bytes = 0;
+    std::vector<const Node*> stack{_root};
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        bytes += node->prefix.capacity() + node->arena.capacity() +
+            node->slots.capacity() * sizeof(Slot);
+        if (node->isLeaf) {
+            bytes += sizeof(Leaf);
+        } else {
+            const Inner* inner = static_cast<const Inner*>(node);
+            bytes += sizeof(Inner) + inner->children.capacity() * sizeof(Node*);
+            stack.insert(stack.end(), inner->children.begin(), inner->children.end());
+        }
+    }
+    return bytes;
+}
+
+void KeyStringBTree::appendStats(BSONObjBuilder* builder) const {
+    long long leaves = 0;
+    long long innerNodes = 0;
+    long long keyBytes = 0;
+    long long storedKeyBytes = 0;
+
+    std::vector<const Node*> stack{_root};
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        storedKeyBytes += node->prefix.size();
+        for (const Slot& slot : node->slots) {
+            storedKeyBytes += slot.keySize;
+            if (node->isLeaf)
+                keyBytes += node->prefix.size() + slot.keySize;
+        }
+
+        if (node->isLeaf) {
+            leaves++;
+        } else {
+            innerNodes++;
+            const Inner* inner = static_cast<const Inner*>(node);
+            stack.insert(stack.end(), inner->children.begin(), inner->children.end());
+        }
+    }
+
+    builder->appendNumber("entries", static_cast<long long>(_size));
+    builder->appendNumber("height", static_cast<long long>(_height));
+    builder->appendNumber("leaves", leaves);
+    builder->appendNumber("innerNodes", innerNodes);
+    builder->appendNumber("keyBytes", keyBytes);
+    builder->appendNumber("storedKeyBytes", storedKeyBytes);
+    builder->appendNumber("memoryUsage", static_cast<long long>(memoryUsage()));
+}
+
+//
+// Cursor
+//
+
+bool KeyStringBTree::Cursor::_setPosition(const Leaf* leaf, size_t slot) {
+    if (!leaf || slot >= leaf->slots.size()) {
+        _leaf = nullptr;
+        return false;
+    }
+
+    _leaf = leaf;
+    _slot = slot;
+    _key.clear();
+    _leaf->appendKey(_slot, &_key);
+    return true;
+}
+
+bool KeyStringBTree::Cursor::seekAtOrAfter(StringData key) {
+    const Leaf* leaf = _tree._findLeaf(key);
+    const size_t i = leaf->lowerBound(key);
+    if (i == leaf->slots.size()) {
+        // Leaves other than the root are never empty, so the next one starts with a key
+        // greater than 'key'.
+        return _setPosition(leaf->next, 0);
+    }
+    return _setPosition(leaf, i);
+}
+
+bool KeyStringBTree::Cursor::seekAtOrBefore(StringData key) {
+    const Leaf* leaf = _tree._findLeaf(key);
+    const size_t i = leaf->upperBound(key);
+    if (i == 0) {
+        const Leaf* prev = leaf->prev;
+        return _setPosition(prev, prev ? prev->slots.size() - 1 : 0);
+    }
+    return _setPosition(leaf, i - 1);
+}
+
+bool KeyStringBTree::Cursor::next() {
+    if (!_leaf)
+        return false;
+    if (_slot + 1 < _leaf->slots.size())
+        return _setPosition(_leaf, _slot + 1);
+    return _setPosition(_leaf->next, 0);
+}
+
+bool KeyStringBTree::Cursor::prev() {
+    if (!_leaf)
+        return false;
+    if (_slot > 0)
+        return _setPosition(_leaf, _slot - 1);
+    const Leaf* prev = _leaf->prev;
+    return _setPosition(prev, prev ? prev->slots.size() - 1 : 0);
+}
+
+void KeyStringBTree::Cursor::save() {
+    _savedLeaf = _leaf;
+    _savedSlot = _slot;
+    _savedLeafVersion = _leaf ? _leaf->version : 0;
+    _savedStructureVersion = _tree._structureVersion;
+    _leaf = nullptr;
+}
+
+bool KeyStringBTree::Cursor::restore() {
+    // The saved leaf may only be read if no node has been freed since.
+    if (!_savedLeaf || _savedStructureVersion != _tree._structureVersion ||
+        _savedLeafVersion != _savedLeaf->version) {
+        _leaf = nullptr;
+        return false;
+    }
+
+    _leaf = _savedLeaf;
+    _slot = _savedSlot;
+    return true;
+}
+
+}  // namespace mongo
@@ -0,0 +1,250 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * An ordered map from byte strings to small byte string values, kept in a B+tree. Keys compare
+ * with memcmp, which makes it suitable for KeyString encoded index keys.
+ *
+ * Each node stores the prefix shared by all of its keys once, followed by an array of
+ * fixed-size slots and an arena holding the remaining key bytes and the values. Slots carry the
+ * first four bytes of their key after the prefix, so binary searching a node mostly reads the
+ * slot array and only touches the arena to break ties. Leaves are split in half when they
+ * overflow, except when appending to the last leaf, which is left full so that loading keys in
+ * order packs the leaves. The separators in inner nodes are the shortest byte strings that
+ * separate their children. Nodes are freed once they become empty, rather than merged.
+ *
+ * Every leaf has a version which changes whenever the leaf is modified, and the tree has a
+ * version which changes whenever a node is freed. Cursors save their position along with both
+ * versions, and can resume from it on restore without searching from the root if neither has
+ * changed.
+ *
+ * Not thread safe for writes. Any number of readers may use the tree at the same time as long
+ * as no writer does.
+ */
+class KeyStringBTree {
+    MONGO_DISALLOW_COPYING(KeyStringBTree);
+
+public:
+    // The most entries a node holds before it is split.
+    static const size_t kMaxSlots = 64;
+
+    // The largest key or value which can be stored.
+    static const size_t kMaxSize = UINT16_MAX;
+
+    class Cursor;
+
+    KeyStringBTree();
+    ~KeyStringBTree();
+
+    /**
+     * Inserts 'key' with 'value'. Returns false, leaving the tree unchanged, if 'key' is already
+     * present.
+     */
+    bool insert(StringData key, StringData value);
+
+    /**
+     * Removes 'key'. Returns false if it isn't present.
+     */
+    bool erase(StringData key);
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Returns the bytes of memory used by the nodes of the tree and their contents.
+     */
+    size_t memoryUsage() const;
+
+    /**
+     * Appends counts describing the shape of the tree and how well keys are compressed.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    struct Slot {
+        uint32_t head;       // First four bytes of the key after the prefix, big-endian.
+        uint32_t offset;     // Of the key in the arena. The value follows it.
+        uint16_t keySize;    // Not counting the prefix.
+        uint16_t valueSize;
+    };
+
+    typedef std::vector<std::pair<std::string, std::string>> Entries;
+
+    struct Node {
+        explicit Node(bool isLeaf) : isLeaf(isLeaf) {}
+        virtual ~Node() = default;
+
+        StringData suffix(size_t i) const {
+            return StringData(arena.data() + slots[i].offset, slots[i].keySize);
+        }
+        StringData value(size_t i) const {
+            return StringData(arena.data() + slots[i].offset + slots[i].keySize,
+                              slots[i].valueSize);
+        }
+        void appendKey(size_t i, std::string* out) const;
+
+        // Binary search for the first slot whose key is >= 'key' or > 'key'.
+        size_t lowerBound(StringData key) const;
+        size_t upperBound(StringData key) const;
+        bool keyEquals(size_t i, StringData key) const;
+
+        void insertAt(size_t i, StringData key, StringData value);
+        void eraseAt(size_t i);
+
+        void copyEntries(Entries* out) const;
+        // Replaces the contents with the sorted entries in [begin, end), using the longest
+        // prefix they share, up to 'maxPrefixSize' bytes.
+        void assign(Entries::const_iterator begin,
+                    Entries::const_iterator end,
+                    size_t maxPrefixSize = std::string::npos);
+
+        const bool isLeaf;
+        uint64_t version = 0;
+
+        std::string prefix;
+        std::vector<Slot> slots;
+        std::string arena;
+        size_t garbage = 0;  // Bytes of the arena no slot refers to.
+
+    private:
+        template <bool SkipEqual>
+        size_t _search(StringData key) const;
+    };
+
+    struct Leaf final : public Node {
+        Leaf() : Node(true) {}
+        Leaf* prev = nullptr;
+        Leaf* next = nullptr;
+    };
+
+    // An inner node's slots are separators with empty values. Child i holds the keys which are
+    // >= separator i - 1 and < separator i.
+    struct Inner final : public Node {
+        Inner() : Node(false) {}
+        std::vector<Node*> children;
+    };
+
+    typedef std::vector<std::pair<Inner*, size_t>> Path;
+
+    const Leaf* _findLeaf(StringData key) const;
+    Leaf* _findLeaf(StringData key, Path* path);
+
+    void _splitLeaf(Leaf* leaf, size_t insertedAt, Path* path);
+    void _insertIntoParent(Path* path, Node* left, const std::string& separator, Node* right);
+    void _removeEmpty(Node* node, Path* path);
+    void _freeNode(Node* node);
+
+    Node* _root;
+    size_t _height = 1;
+    size_t _size = 0;
+
+    // Changes whenever a node is freed. See Cursor::restore().
+    uint64_t _structureVersion = 0;
+};
+
+/**
+ * A position in a KeyStringBTree, which reads the entries in either direction from there.
+ */
+class KeyStringBTree::Cursor {
+public:
+    explicit Cursor(const KeyStringBTree& tree) : _tree(tree) {}
+
+    /**
+     * Positions the cursor on the first entry with a key >= 'key', or the last entry with a key
+     * <= 'key'. Returns false, leaving the cursor at EOF, if there is no such entry.
+     */
+    bool seekAtOrAfter(StringData key);
+    bool seekAtOrBefore(StringData key);
+
+    /**
+     * Moves to the following or preceding entry. Returns false, leaving the cursor at EOF, if
+     * there is none.
+     */
+    bool next();
+    bool prev();
+
+    bool isEOF() const {
+        return !_leaf;
+    }
+
+    StringData key() const {
+        return _key;
+    }
+
+    StringData value() const {
+        return _leaf->value(_slot);
+    }
+
+    /**
+     * Remembers the current position so that restore() can return to it, and invalidates it
+     * until then. The tree may be modified in between.
+     */
+    void save();
+
+    /**
+     * Returns to the position remembered by save() if the tree hasn't changed in a way which
+     * could have moved the entry there, and returns true. Otherwise leaves the cursor at EOF
+     * and returns false. Callers should then seek to the saved key.
+     */
+    bool restore();
+
+private:
+    bool _setPosition(const Leaf* leaf, size_t slot);
+
+    const KeyStringBTree& _tree;
+
+    const Leaf* _leaf = nullptr;
+    size_t _slot = 0;
+    std::string _key;  // The full key of the current entry.
+
+    const Leaf* _savedLeaf = nullptr;
+    size_t _savedSlot = 0;
+    uint64_t _savedLeafVersion = 0;
+    uint64_t _savedStructureVersion = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,233 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_key_string_btree.h"
+
+#include <map>
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using std::string;
+
+typedef std::map<string, string> Model;
+
+string makeKey(int i) {
+    // Fixed width so that numeric and byte order agree, with a long shared prefix.
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key-prefix-%08d", i);
+    return buf;
+}
+
+/**
+ * Asserts that 'tree' holds exactly the entries of 'model', reading it in both directions.
+ */
+void assertSameContents(const KeyStringBTree& tree, const Model& model) {
+    ASSERT_EQUALS(model.size(), tree.size());
+
+    KeyStringBTree::Cursor cursor(tree);
+    bool more = cursor.seekAtOrAfter(StringData());
+    for (auto it = model.begin(); it != model.end(); ++it) {
+        ASSERT(more);
+        ASSERT_EQUALS(it->first, cursor.key().toString());
+        ASSERT_EQUALS(it->second, cursor.value().toString());
+        more = cursor.next();
+    }
+    ASSERT_FALSE(more);
+    ASSERT(cursor.isEOF());
+
+    const string maxKey(8, '\xff');
+    more = cursor.seekAtOrBefore(maxKey);
+    for (auto it = model.rbegin(); it != model.rend(); ++it) {
+        ASSERT(more);
+        ASSERT_EQUALS(it->first, cursor.key().toString());
+        more = cursor.prev();
+    }
+    ASSERT_FALSE(more);
+}
+
+TEST(KeyStringBTreeTest, Empty) {
+    KeyStringBTree tree;
+    ASSERT(tree.empty());
+
+    KeyStringBTree::Cursor cursor(tree);
+    ASSERT_FALSE(cursor.seekAtOrAfter("a"));
+    ASSERT_FALSE(cursor.seekAtOrBefore("a"));
+    ASSERT_FALSE(tree.erase("a"));
+}
+
+TEST(KeyStringBTreeTest, InsertAndErase) {
+    KeyStringBTree tree;
+    ASSERT(tree.insert("b", "1"));
+    ASSERT(tree.insert("a", ""));
+    ASSERT(tree.insert("ab", "2"));
+    ASSERT_FALSE(tree.insert("b", "3"));
+    assertSameContents(tree, {{"a", ""}, {"ab", "2"}, {"b", "1"}});
+
+    ASSERT(tree.erase("a"));
+    ASSERT_FALSE(tree.erase("a"));
+    assertSameContents(tree, {{"ab", "2"}, {"b", "1"}});
+}
+
+TEST(KeyStringBTreeTest, Seek) {
+    KeyStringBTree tree;
+    for (int i = 0; i < 1000; i += 2) {
+        ASSERT(tree.insert(makeKey(i), ""));
+    }
+
+    KeyStringBTree::Cursor cursor(tree);
+    ASSERT(cursor.seekAtOrAfter(makeKey(10)));
+    ASSERT_EQUALS(makeKey(10), cursor.key().toString());
+    ASSERT(cursor.seekAtOrAfter(makeKey(11)));
+    ASSERT_EQUALS(makeKey(12), cursor.key().toString());
+    ASSERT(cursor.seekAtOrBefore(makeKey(11)));
+    ASSERT_EQUALS(makeKey(10), cursor.key().toString());
+    ASSERT(cursor.seekAtOrBefore(makeKey(10)));
+    ASSERT_EQUALS(makeKey(10), cursor.key().toString());
+
+    // Before and after everything, and shorter than the shared prefix.
+    ASSERT_FALSE(cursor.seekAtOrAfter(makeKey(999)));
+    ASSERT_FALSE(cursor.seekAtOrBefore("key"));
+    ASSERT(cursor.seekAtOrAfter("key"));
+    ASSERT_EQUALS(makeKey(0), cursor.key().toString());
+    ASSERT(cursor.seekAtOrBefore("z"));
+    ASSERT_EQUALS(makeKey(998), cursor.key().toString());
+}
+
+TEST(KeyStringBTreeTest, SequentialLoadPacksLeaves) {
+    KeyStringBTree tree;
+    const int n = KeyStringBTree::kMaxSlots * 50;
+    for (int i = 0; i < n; i++) {
+        ASSERT(tree.insert(makeKey(i), ""));
+    }
+
+    BSONObjBuilder builder;
+    tree.appendStats(&builder);
+    const BSONObj stats = builder.obj();
+    ASSERT_EQUALS(n, stats["entries"].numberLong());
+    ASSERT_EQUALS(50, stats["leaves"].numberLong());
+    ASSERT_EQUALS(2, stats["height"].numberLong());
+
+    // The shared prefix of each leaf is stored once.
+    ASSERT_LESS_THAN(stats["storedKeyBytes"].numberLong(), stats["keyBytes"].numberLong() / 2);
+}
+
+TEST(KeyStringBTreeTest, RandomOperationsMatchMap) {
+    PseudoRandom random(1234);
+    KeyStringBTree tree;
+    Model model;
+
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 20000; i++) {
+            const string key = makeKey(random.nextInt32(50000));
+            if (random.nextInt32(3) == 0) {
+                ASSERT_EQUALS(model.erase(key) == 1, tree.erase(key));
+            } else {
+                const string value(random.nextInt32(4), 'v');
+                const bool inserted = model.insert(std::make_pair(key, value)).second;
+                ASSERT_EQUALS(inserted, tree.insert(key, value));
+            }
+        }
+        assertSameContents(tree, model);
+    }
+
+    // Emptying the tree frees all but the root.
+    for (auto it = model.begin(); it != model.end(); ++it) {
+        ASSERT(tree.erase(it->first));
+    }
+    ASSERT(tree.empty());
+    BSONObjBuilder builder;
+    tree.appendStats(&builder);
+    ASSERT_EQUALS(1, builder.obj()["height"].numberLong());
+}
+
+TEST(KeyStringBTreeTest, VariablePrefixes) {
+    // Keys which share nothing, everything but the last byte, or are prefixes of each other.
+    KeyStringBTree tree;
+    Model model;
+    PseudoRandom random(42);
+    for (int i = 0; i < 5000; i++) {
+        string key(random.nextInt32(20), 'a');
+        key.push_back(static_cast<char>(random.nextInt32(256)));
+        model[key] = "";
+        tree.insert(key, "");
+    }
+    assertSameContents(tree, model);
+}
+
+TEST(KeyStringBTreeTest, RestoreWithoutChanges) {
+    KeyStringBTree tree;
+    for (int i = 0; i < 1000; i++) {
+        tree.insert(makeKey(i), "");
+    }
+
+    KeyStringBTree::Cursor cursor(tree);
+    ASSERT(cursor.seekAtOrAfter(makeKey(500)));
+    cursor.save();
+
+    // Changing other leaves doesn't affect the saved position.
+    ASSERT(tree.insert(makeKey(5000), ""));
+    ASSERT(cursor.restore());
+    ASSERT_EQUALS(makeKey(500), cursor.key().toString());
+    ASSERT(cursor.next());
+    ASSERT_EQUALS(makeKey(501), cursor.key().toString());
+}
+
+TEST(KeyStringBTreeTest, RestoreAfterChanges) {
+    KeyStringBTree tree;
+    for (int i = 0; i < 1000; i++) {
+        tree.insert(makeKey(i), "");
+    }
+
+    KeyStringBTree::Cursor cursor(tree);
+    ASSERT(cursor.seekAtOrAfter(makeKey(500)));
+
+    // A change to the same leaf.
+    cursor.save();
+    ASSERT(tree.erase(makeKey(501)));
+    ASSERT_FALSE(cursor.restore());
+    ASSERT(cursor.isEOF());
+
+    // A node being freed anywhere.
+    ASSERT(cursor.seekAtOrAfter(makeKey(500)));
+    cursor.save();
+    for (int i = 0; i < 200; i++) {
+        tree.erase(makeKey(i));
+    }
+    ASSERT_FALSE(cursor.restore());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -33,10 +33,12 @@
 
 #include "mongo/db/storage/in_memory/in_memory_record_store.h"
 
+#include <algorithm>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/storage/in_memory/in_memory_column_store.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/stdx/memory.h"
@@ -58,6 +60,7 @@ public:
             _data->dataSize -= it->second.size;
             _data->records.erase(it);
         }
+        _data->invalidateColumns();
     }
 
 private:
@@ -80,6 +83,7 @@ public:
 
         _data->dataSize += _rec.size;
         _data->records[_loc] = _rec;
+        _data->invalidateColumns();
     }
 
 private:
@@ -94,6 +98,7 @@ public:
         using std::swap;
         swap(_dataSize, _data->dataSize);
         swap(_records, _data->records);
+        _data->invalidateColumns();
     }
 
     virtual void commit() {}
@@ -101,6 +106,7 @@ public:
         using std::swap;
         swap(_dataSize, _data->dataSize);
         swap(_records, _data->records);
+        _data->invalidateColumns();
     }
 
 private:
@@ -248,6 +254,106 @@ private:
 };
 
 
+class InMemoryRecordStore::ColumnCursor final : public RecordCursor {
+public:
+    ColumnCursor(OperationContext* txn,
+                 const InMemoryRecordStore& rs,
+                 const std::vector<std::string>& fields)
+        : _rs(rs), _fields(fields), _isCapped(rs.isCapped()) {}
+
+    boost::optional<Record> next() final {
+        if (_eof)
+            return {};
+
+        if (!_cursor)
+            _openCursor();
+
+        RecordId id;
+        BSONObjBuilder builder(_buffer);
+        if (!_cursor->next(&id, &builder)) {
+            builder.doneFast();
+            _buffer.reset();
+            return {};
+        }
+        _lastId = id;
+        return {{id, _toRecordData(builder.done())}};
+    }
+
+    boost::optional<Record> seekExact(const RecordId& id) final {
+        _eof = false;
+        _cursor.reset();
+
+        const Records& records = _rs._data->records;
+        Records::const_iterator it = records.find(id);
+        if (it == records.end()) {
+            _eof = true;
+            return {};
+        }
+        _lastId = id;
+
+        const BSONObj doc(it->second.data.get());
+        BSONObjBuilder builder(_buffer);
+        BSONObjIterator fieldIt(doc);
+        while (fieldIt.more()) {
+            const BSONElement elt = fieldIt.next();
+            if (std::find(_fields.begin(), _fields.end(), elt.fieldName()) != _fields.end())
+                builder.append(elt);
+        }
+        return {{id, _toRecordData(builder.done())}};
+    }
+
+    void savePositioned() final {}
+
+    void saveUnpositioned() final {
+        _eof = true;
+    }
+
+    bool restore() final {
+        if (_eof || !_cursor)
+            return true;
+
+        // A write in between discards the columns. Continue from the same id in a new copy.
+        const std::shared_ptr<const ColumnStore> columns = _rs.getColumns();
+        if (columns != _columns)
+            _openCursor();
+
+        // Capped iterators die on invalidation rather than advancing.
+        return !(_isCapped && !_lastId.isNull() && !_cursor->hasRow(_lastId));
+    }
+
+    void detachFromOperationContext() final {}
+    void reattachToOperationContext(OperationContext* txn) final {}
+
+private:
+    void _openCursor() {
+        _columns = _rs.getColumns();
+        _cursor.reset(new ColumnStore::Cursor(_columns.get(), _fields));
+        if (!_lastId.isNull())
+            _cursor->seekAfter(_lastId);
+    }
+
+    RecordData _toRecordData(const BSONObj& obj) {
+        // Each record gets its own buffer since callers may hold on to it past the next call.
+        SharedBuffer buffer = SharedBuffer::allocate(obj.objsize());
+        memcpy(buffer.get(), obj.objdata(), obj.objsize());
+        _buffer.reset();
+        return RecordData(std::move(buffer), obj.objsize());
+    }
+
+    const InMemoryRecordStore& _rs;
+    const std::vector<std::string> _fields;
+    const bool _isCapped;
+
+    std::shared_ptr<const ColumnStore> _columns;
+    std::unique_ptr<ColumnStore::Cursor> _cursor;
+    RecordId _lastId;  // The last record returned. The cursor continues after it.
+    bool _eof = false;
+
+    // Scratch space for building records.
+    BufBuilder _buffer;
+};
+
+
 //
 // RecordStore
 //
@@ -321,6 +427,7 @@ void InMemoryRecordStore::deleteRecord(OperationContext* txn, const RecordId& lo
     txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *rec));
     _data->dataSize -= rec->size;
     invariant(_data->records.erase(loc) == 1);
+    _data->invalidateColumns();
 }
 
 bool InMemoryRecordStore::cappedAndNeedDelete(OperationContext* txn) const {
@@ -389,6 +496,7 @@ StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
     txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
     _data->dataSize += len;
     _data->records[loc] = rec;
+    addToColumns(loc, rec);
 
     cappedDeleteAsNeeded(txn);
 
@@ -421,6 +529,7 @@ StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
     txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
     _data->dataSize += len;
     _data->records[loc] = rec;
+    addToColumns(loc, rec);
 
     cappedDeleteAsNeeded(txn);
 
@@ -456,6 +565,7 @@ StatusWith<RecordId> InMemoryRecordStore::updateRecord(OperationContext* txn,
     txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *oldRecord));
     _data->dataSize += len - oldLen;
     *oldRecord = newRecord;
+    _data->invalidateColumns();
 
     cappedDeleteAsNeeded(txn);
 
@@ -499,6 +609,7 @@ Status InMemoryRecordStore::updateWithDamages(OperationContext* txn,
     }
 
     *oldRecord = newRecord;
+    _data->invalidateColumns();
 
     return Status::OK();
 }
@@ -510,6 +621,41 @@ std::unique_ptr<RecordCursor> InMemoryRecordStore::getCursor(OperationContext* t
     return stdx::make_unique<ReverseCursor>(txn, *this);
 }
 
+std::unique_ptr<RecordCursor> InMemoryRecordStore::getCursorForFields(
+    OperationContext* txn, const std::vector<std::string>& fields) const {
+    if (!_columnScans)
+        return {};
+    return stdx::make_unique<ColumnCursor>(txn, *this, fields);
+}
+
+std::shared_ptr<const ColumnStore> InMemoryRecordStore::getColumns() const {
+    stdx::lock_guard<stdx::mutex> lk(_data->columnsMutex);
+    if (!_data->columns) {
+        auto columns = std::make_shared<ColumnStore>();
+        for (Records::const_iterator it = _data->records.begin(); it != _data->records.end();
+             ++it) {
+            columns->append(it->first, BSONObj(it->second.data.get()));
+        }
+        _data->columns = std::move(columns);
+    }
+    return _data->columns;
+}
+
+void InMemoryRecordStore::addToColumns(const RecordId& loc, const InMemoryRecord& rec) {
+    if (!_columnScans)
+        return;
+
+    stdx::lock_guard<stdx::mutex> lk(_data->columnsMutex);
+    if (!_data->columns)
+        return;
+
+    if (loc > _data->columns->lastId()) {
+        _data->columns->append(loc, BSONObj(rec.data.get()));
+    } else {
+        _data->columns.reset();
+    }
+}
+
 Status InMemoryRecordStore::truncate(OperationContext* txn) {
     // Unlike other changes, TruncateChange mutates _data on construction to perform the
     // truncate
@@ -527,6 +673,7 @@ void InMemoryRecordStore::temp_cappedTruncateAfter(OperationContext* txn,
         _data->dataSize -= it->second.size;
         _data->records.erase(it++);
     }
+    _data->invalidateColumns();
 }
 
 Status InMemoryRecordStore::validate(OperationContext* txn,
@@ -563,6 +710,14 @@ void InMemoryRecordStore::appendCustomStats(OperationContext* txn,
         result->appendIntOrLL("max", _cappedMaxDocs);
         result->appendIntOrLL("maxSize", _cappedMaxSize / scale);
     }
+
+    if (_columnScans) {
+        stdx::lock_guard<stdx::mutex> lk(_data->columnsMutex);
+        if (_data->columns) {
+            BSONObjBuilder columns(result->subobjStart("columns"));
+            _data->columns->appendStats(&columns);
+        }
+    }
 }
 
 Status InMemoryRecordStore::touch(OperationContext* txn, BSONObjBuilder* output) const {
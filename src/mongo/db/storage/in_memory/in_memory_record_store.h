@@ -35,9 +35,12 @@
 
 #include "mongo/db/storage/capped_callback.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
+class ColumnStore;
+
 /**
  * A RecordStore that stores all data in-memory.
  *
@@ -86,6 +89,13 @@ public:
 
     std::unique_ptr<RecordCursor> getCursor(OperationContext* txn, bool forward) const final;
 
+    bool supportsCursorForFields() const final {
+        return _columnScans;
+    }
+
+    std::unique_ptr<RecordCursor> getCursorForFields(
+        OperationContext* txn, const std::vector<std::string>& fields) const final;
+
     virtual Status truncate(OperationContext* txn);
 
     virtual void temp_cappedTruncateAfter(OperationContext* txn, RecordId end, bool inclusive);
@@ -156,6 +166,17 @@ public:
     void setCappedDeleteCallback(CappedDocumentDeleteCallback* cb) {
         _cappedDeleteCallback = cb;
     }
+
+    /**
+     * Keeps a columnar copy of the records so that getCursorForFields() only reads the
+     * requested fields. The copy is built by the first scan that needs it. Inserts past the
+     * end of the store are added to it as they happen, and any other write discards it.
+     */
+    void enableColumnScans() {
+        invariant(!_data->isOplog);
+        _columnScans = true;
+    }
+
     bool cappedMaxDocs() const {
         invariant(_isCapped);
         return _cappedMaxDocs;
@@ -172,6 +193,7 @@ private:
 
     class Cursor;
     class ReverseCursor;
+    class ColumnCursor;
 
     StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len) const;
 
@@ -179,20 +201,37 @@ private:
     bool cappedAndNeedDelete(OperationContext* txn) const;
     void cappedDeleteAsNeeded(OperationContext* txn);
 
+    std::shared_ptr<const ColumnStore> getColumns() const;
+    void addToColumns(const RecordId& loc, const InMemoryRecord& rec);
+
     // TODO figure out a proper solution to metadata
     const bool _isCapped;
     const int64_t _cappedMaxSize;
     const int64_t _cappedMaxDocs;
     CappedDocumentDeleteCallback* _cappedDeleteCallback;
+    bool _columnScans = false;
 
     // This is the "persistent" data.
     struct Data {
         Data(bool isOplog) : dataSize(0), nextId(1), isOplog(isOplog) {}
 
+        void invalidateColumns() {
+            stdx::lock_guard<stdx::mutex> lk(columnsMutex);
+            columns.reset();
+        }
+
         int64_t dataSize;
         Records records;
         int64_t nextId;
         const bool isOplog;
+
+        // Columnar copy of 'records' for record stores with column scans enabled, or NULL if
+        // it must be rebuilt before the next scan. Cursors hold a reference, so a copy that is
+        // discarded stays valid until they restore.
+        std::shared_ptr<ColumnStore> columns;
+
+        // Serializes building 'columns', which readers may do concurrently.
+        stdx::mutex columnsMutex;
     };
 
     Data* const _data;
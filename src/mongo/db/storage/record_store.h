@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -359,6 +360,27 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota) = 0;
 
+    /**
+     * Inserts each of 'records', and sets its id to where it was inserted. Stops at the first
+     * failure, after which the caller must roll back the WriteUnitOfWork.
+     *
+     * By default the records are inserted one at a time. Record stores which can share work
+     * between the inserts, such as a cursor or size accounting, should override this.
+     */
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota) {
+        for (auto& record : *records) {
+            StatusWith<RecordId> res =
+                insertRecord(txn, record.data.data(), record.data.size(), enforceQuota);
+            if (!res.isOK()) {
+                return res.getStatus();
+            }
+            record.id = res.getValue();
+        }
+        return Status::OK();
+    }
+
     /**
      * @param notifier - Only used by record stores which do not support doc-locking.
      *                   In the case of a document move, this is called after the document
@@ -447,6 +469,27 @@ public:
         return out;
     }
 
+    /**
+     * Returns true if getCursorForFields() returns cursors which avoid reading the fields that
+     * weren't asked for. Callers may use this to decide whether it is worth narrowing scans.
+     */
+    virtual bool supportsCursorForFields() const {
+        return false;
+    }
+
+    /**
+     * Constructs a forward cursor which only returns the top-level 'fields' of each record.
+     * Records must be BSON documents. The fields of each returned document are in the order
+     * they have in the stored document, and documents with none of 'fields' are returned as
+     * empty documents. seekExact() also only returns 'fields'.
+     *
+     * Returns {} if not supported, in which case callers should use getCursor().
+     */
+    virtual std::unique_ptr<RecordCursor> getCursorForFields(
+        OperationContext* txn, const std::vector<std::string>& fields) const {
+        return {};
+    }
+
     // higher level
 
 
@@ -174,4 +174,42 @@ TEST(RecordStoreTestHarness, InsertMultipleRecordsUsingDocWriter) {
     }
 }
 
+// Insert a group of records in one call and verify that each can be read back at the RecordId
+// it was assigned.
+TEST(RecordStoreTestHarness, InsertRecords) {
+    unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    std::vector<string> datas;
+    for (int i = 0; i < nToInsert; i++) {
+        stringstream ss;
+        ss << "record " << i;
+        datas.push_back(ss.str());
+    }
+
+    std::vector<Record> records;
+    for (const auto& data : datas) {
+        records.push_back(Record{RecordId(), RecordData(data.c_str(), data.size() + 1)});
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(rs->insertRecords(opCtx.get(), &records, false));
+            uow.commit();
+        }
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert, rs->numRecords(opCtx.get()));
+        for (int i = 0; i < nToInsert; i++) {
+            ASSERT(!records[i].id.isNull());
+            ASSERT_EQUALS(datas[i], rs->dataFor(opCtx.get(), records[i].id).data());
+        }
+    }
+}
+
 }  // namespace mongo
@@ -35,6 +35,8 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
+#include <algorithm>
+#include <cmath>
 #include <wiredtiger.h>
 
 #include "mongo/base/checked_cast.h"
@@ -46,6 +48,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
@@ -378,6 +381,291 @@ private:
 };
 
 
+namespace {
+
+// Divide the oplog into between 10 and 100 stones, each at least the size of the largest
+// document, so that truncating a stone never removes more than a tenth of the oplog.
+const uint64_t kMinStonesToKeep = 10;
+const uint64_t kMaxStonesToKeep = 100;
+
+// Number of random records to read for each stone estimated when opening a large oplog.
+const int kRandomSamplesPerStone = 10;
+
+// Scan the oplog instead of sampling it unless it holds this many times the records sampling
+// would read.
+const int kMinSampleRatioForRandCursor = 20;
+
+}  // namespace
+
+class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
+public:
+    InsertChange(OplogStones* oplogStones,
+                 int64_t bytesInserted,
+                 const RecordId& highestInserted,
+                 int64_t countInserted)
+        : _oplogStones(oplogStones),
+          _bytesInserted(bytesInserted),
+          _highestInserted(highestInserted),
+          _countInserted(countInserted) {}
+
+    void commit() final {
+        invariant(_bytesInserted >= 0);
+        invariant(_highestInserted.isNormal());
+
+        _oplogStones->_currentRecords.addAndFetch(_countInserted);
+        int64_t newCurrentBytes = _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
+        if (newCurrentBytes >= _oplogStones->_minBytesPerStone) {
+            _oplogStones->_createNewStoneIfNeeded(_highestInserted);
+        }
+    }
+
+    void rollback() final {}
+
+private:
+    OplogStones* _oplogStones;
+    int64_t _bytesInserted;
+    RecordId _highestInserted;
+    int64_t _countInserted;
+};
+
+class WiredTigerRecordStore::OplogStones::TruncateChange final : public RecoveryUnit::Change {
+public:
+    TruncateChange(OplogStones* oplogStones) : _oplogStones(oplogStones) {}
+
+    void commit() final {
+        _oplogStones->_currentRecords.store(0);
+        _oplogStones->_currentBytes.store(0);
+
+        stdx::lock_guard<stdx::mutex> lk(_oplogStones->_mutex);
+        _oplogStones->_stones.clear();
+    }
+
+    void rollback() final {}
+
+private:
+    OplogStones* _oplogStones;
+};
+
+WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* txn, WiredTigerRecordStore* rs)
+    : _rs(rs) {
+    invariant(rs->isCapped());
+    invariant(rs->cappedMaxSize() > 0);
+    const uint64_t maxSize = rs->cappedMaxSize();
+
+    const uint64_t numStones = maxSize / BSONObjMaxInternalSize;
+    _numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
+    _minBytesPerStone = maxSize / _numStonesToKeep;
+    invariant(_minBytesPerStone > 0);
+
+    _calculateStones(txn);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _pokeReclaimThreadIfNeeded_inlock();
+}
+
+void WiredTigerRecordStore::OplogStones::kill() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _isDead = true;
+    _excessStonesCV.notify_all();
+}
+
+bool WiredTigerRecordStore::OplogStones::hasExcessStones() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _hasExcessStones_inlock();
+}
+
+bool WiredTigerRecordStore::OplogStones::_hasExcessStones_inlock() const {
+    return _stones.size() > _numStonesToKeep;
+}
+
+bool WiredTigerRecordStore::OplogStones::awaitHasExcessStones(Milliseconds timeout) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _excessStonesCV.wait_for(lk, timeout, [this] { return _isDead || _hasExcessStones_inlock(); });
+    return !_isDead && _hasExcessStones_inlock();
+}
+
+boost::optional<WiredTigerRecordStore::OplogStones::Stone>
+WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_hasExcessStones_inlock()) {
+        return {};
+    }
+    return _stones.front();
+}
+
+void WiredTigerRecordStore::OplogStones::popOldestStone() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _stones.pop_front();
+}
+
+void WiredTigerRecordStore::OplogStones::_createNewStoneIfNeeded(const RecordId& lastRecord) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    if (_currentBytes.load() < _minBytesPerStone) {
+        // Another commit raced with us and already ended the stone.
+        return;
+    }
+
+    if (!_stones.empty() && lastRecord < _stones.back().lastRecord) {
+        // Inserts commit out of order, and one with a later RecordId already ended a stone.
+        // These records are counted towards the next stone instead.
+        return;
+    }
+
+    Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
+    _stones.push_back(stone);
+
+    _pokeReclaimThreadIfNeeded_inlock();
+}
+
+void WiredTigerRecordStore::OplogStones::updateCurrentStoneAfterInsertOnCommit(
+    OperationContext* txn,
+    int64_t bytesInserted,
+    const RecordId& highestInserted,
+    int64_t countInserted) {
+    txn->recoveryUnit()->registerChange(
+        new InsertChange(this, bytesInserted, highestInserted, countInserted));
+}
+
+void WiredTigerRecordStore::OplogStones::clearStonesOnCommit(OperationContext* txn) {
+    txn->recoveryUnit()->registerChange(new TruncateChange(this));
+}
+
+void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
+    int64_t recordsRemoved, int64_t bytesRemoved, const RecordId& firstRemovedId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    int64_t recordsInRemovedStones = 0;
+    int64_t bytesInRemovedStones = 0;
+    while (!_stones.empty() && _stones.back().lastRecord >= firstRemovedId) {
+        recordsInRemovedStones += _stones.back().records;
+        bytesInRemovedStones += _stones.back().bytes;
+        _stones.pop_back();
+    }
+
+    // Whatever remains of the last stone removed, if anything, now belongs to the stone being
+    // filled.
+    _currentRecords.addAndFetch(recordsInRemovedStones - recordsRemoved);
+    _currentBytes.addAndFetch(bytesInRemovedStones - bytesRemoved);
+}
+
+void WiredTigerRecordStore::OplogStones::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    builder->appendNumber("stones", static_cast<long long>(_stones.size()));
+    builder->appendNumber("stonesToKeep", static_cast<long long>(_numStonesToKeep));
+    builder->appendNumber("minBytesPerStone", static_cast<long long>(_minBytesPerStone));
+    builder->appendNumber("currentStoneRecords", static_cast<long long>(_currentRecords.load()));
+    builder->appendNumber("currentStoneBytes", static_cast<long long>(_currentBytes.load()));
+}
+
+size_t WiredTigerRecordStore::OplogStones::numStones() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _stones.size();
+}
+
+void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
+    invariant(size > 0);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Only allow changing the minimum bytes per stone if no data has been inserted.
+    invariant(_stones.size() == 0 && _currentRecords.load() == 0);
+    _minBytesPerStone = size;
+}
+
+void WiredTigerRecordStore::OplogStones::setNumStonesToKeep(size_t numStones) {
+    invariant(numStones > 0);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _numStonesToKeep = numStones;
+}
+
+void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* txn) {
+    const long long numRecords = _rs->numRecords(txn);
+    const long long dataSize = _rs->dataSize(txn);
+
+    log() << "The size storer reports that the oplog contains " << numRecords
+          << " records totaling to " << dataSize << " bytes";
+
+    // Don't calculate stones for an empty oplog. Stones are created as records are inserted.
+    if (numRecords <= 0 || dataSize <= 0) {
+        return;
+    }
+
+    // Sampling would read a significant fraction of a small oplog anyway.
+    if (static_cast<uint64_t>(numRecords) <
+        kMinSampleRatioForRandCursor * kRandomSamplesPerStone * _numStonesToKeep) {
+        _calculateStonesByScanning(txn);
+        return;
+    }
+
+    // Assume the records are of similar size, so that a stone holds about the same number of
+    // records wherever it is in the oplog.
+    const double avgRecordSize = double(dataSize) / double(numRecords);
+    const double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
+    const double estBytesPerStone = estRecordsPerStone * avgRecordSize;
+
+    _calculateStonesBySampling(txn, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
+}
+
+void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* txn) {
+    log() << "Scanning the oplog to determine where to place markers for truncation";
+
+    Cursor cursor(txn, *_rs, /*forward=*/true);
+    while (auto record = cursor.next()) {
+        _currentRecords.addAndFetch(1);
+        int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
+        if (newCurrentBytes >= _minBytesPerStone) {
+            _createNewStoneIfNeeded(record->id);
+        }
+    }
+}
+
+void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationContext* txn,
+                                                                    int64_t estRecordsPerStone,
+                                                                    int64_t estBytesPerStone) {
+    log() << "Sampling the oplog to determine where to place markers for truncation";
+
+    const long long numRecords = _rs->numRecords(txn);
+    const long long dataSize = _rs->dataSize(txn);
+
+    // Sorting random samples of the oplog gives estimates of the RecordIds which divide it
+    // into chunks holding kRandomSamplesPerStone samples each.
+    const uint64_t wholeStones = numRecords / estRecordsPerStone;
+    const uint64_t numSamples = kRandomSamplesPerStone * numRecords / estRecordsPerStone;
+
+    std::vector<RecordId> oplogEstimates;
+    oplogEstimates.reserve(numSamples);
+    RandomCursor cursor(txn, *_rs);
+    for (uint64_t i = 0; i < numSamples; ++i) {
+        auto record = cursor.next();
+        if (!record) {
+            // The size storer is far from reality. Fall back to counting the records.
+            log() << "Failed to get enough random samples, falling back to scanning the oplog";
+            _calculateStonesByScanning(txn);
+            return;
+        }
+        oplogEstimates.push_back(record->id);
+    }
+    std::sort(oplogEstimates.begin(), oplogEstimates.end());
+
+    for (uint64_t i = 1; i <= wholeStones; ++i) {
+        // Every kRandomSamplesPerStone-th sample ends a stone.
+        const RecordId lastRecord = oplogEstimates[kRandomSamplesPerStone * i - 1];
+        _stones.push_back({estRecordsPerStone, estBytesPerStone, lastRecord});
+    }
+
+    // The remainder is the stone being filled.
+    _currentRecords.store(numRecords - estRecordsPerStone * wholeStones);
+    _currentBytes.store(dataSize - estBytesPerStone * wholeStones);
+}
+
+void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded_inlock() {
+    if (_hasExcessStones_inlock()) {
+        _excessStonesCV.notify_one();
+    }
+}
+
 // static
 StatusWith<std::string> WiredTigerRecordStore::generateCreateString(
     StringData ns, const CollectionOptions& options, StringData extraStrings) {
@@ -505,6 +793,10 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
     }
 
     _hasBackgroundThread = WiredTigerKVEngine::initRsOplogBackgroundThread(ns);
+    if (_hasBackgroundThread && _isCapped) {
+        // The background thread truncates the oplog a stone at a time.
+        _oplogStones = std::make_shared<OplogStones>(ctx, this);
+    }
 }
 
 WiredTigerRecordStore::~WiredTigerRecordStore() {
@@ -513,6 +805,10 @@ WiredTigerRecordStore::~WiredTigerRecordStore() {
         _shuttingDown = true;
     }
 
+    if (_oplogStones) {
+        _oplogStones->kill();
+    }
+
     LOG(1) << "~WiredTigerRecordStore for: " << ns();
     if (_sizeStorer) {
         _sizeStorer->onDestroy(this);
@@ -649,6 +945,12 @@ int64_t WiredTigerRecordStore::cappedDeleteAsNeeded(OperationContext* txn,
     // This variable isn't thread safe, but has loose semantics anyway.
     dassert(!_isOplog || _cappedMaxDocs == -1);
 
+    if (_oplogStones) {
+        // Old records are removed by reclaimOplog() on the background thread instead, which
+        // never needs to hold back inserts.
+        return 0;
+    }
+
     if (!cappedAndNeedDelete())
         return 0;
 
@@ -854,11 +1156,88 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
     _changeNumRecords(txn, 1);
     _increaseDataSize(txn, len);
 
+    if (_oplogStones) {
+        _oplogStones->updateCurrentStoneAfterInsertOnCommit(txn, len, loc, 1);
+    }
+
     cappedDeleteAsNeeded(txn, loc);
 
     return StatusWith<RecordId>(loc);
 }
 
+Status WiredTigerRecordStore::insertRecords(OperationContext* txn,
+                                            std::vector<Record>* records,
+                                            bool enforceQuota) {
+    // Other capped collections must check their size, and perhaps delete, after every insert.
+    if (_isCapped && !_useOplogHack) {
+        return RecordStore::insertRecords(txn, records, enforceQuota);
+    }
+
+    if (records->empty()) {
+        return Status::OK();
+    }
+
+    RecordId highestLoc;
+    int64_t totalLength = 0;
+    for (auto& record : *records) {
+        const int len = record.data.size();
+        if (_isCapped && len > _cappedMaxSize) {
+            return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+        }
+
+        RecordId loc;
+        if (_useOplogHack) {
+            StatusWith<RecordId> status = extractAndCheckLocForOplog(record.data.data(), len);
+            if (!status.isOK())
+                return status.getStatus();
+            loc = status.getValue();
+        } else {
+            loc = _nextId();
+        }
+
+        record.id = loc;
+        highestLoc = std::max(highestLoc, loc);
+        totalLength += len;
+    }
+
+    if (_useOplogHack && highestLoc > _oplog_highestSeen) {
+        stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
+        if (highestLoc > _oplog_highestSeen) {
+            _oplog_highestSeen = highestLoc;
+        }
+    }
+
+    // One cursor serves every insert in the group.
+    WiredTigerCursor curwrap(_uri, _tableId, true, txn);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+
+    for (const auto& record : *records) {
+        c->set_key(c, _makeKey(record.id));
+        WiredTigerItem value(record.data.data(), record.data.size());
+        c->set_value(c, value.Get());
+        int ret = WT_OP_CHECK(c->insert(c));
+        if (ret) {
+            return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecords");
+        }
+    }
+
+    _changeNumRecords(txn, records->size());
+    _increaseDataSize(txn, totalLength);
+
+    if (_oplogStones) {
+        _oplogStones->updateCurrentStoneAfterInsertOnCommit(
+            txn, totalLength, highestLoc, records->size());
+    }
+
+    if (_isCapped) {
+        cappedDeleteAsNeeded(txn, records->front().id);
+    }
+
+    return Status::OK();
+}
+
 void WiredTigerRecordStore::dealtWithCappedLoc(const RecordId& loc) {
     stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
     SortedDiskLocs::iterator it =
@@ -984,6 +1363,10 @@ Status WiredTigerRecordStore::truncate(OperationContext* txn) {
     _changeNumRecords(txn, -numRecords(txn));
     _increaseDataSize(txn, -dataSize(txn));
 
+    if (_oplogStones) {
+        _oplogStones->clearStonesOnCommit(txn);
+    }
+
     return Status::OK();
 }
 
@@ -1080,6 +1463,10 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* txn,
         result->appendIntOrLL("maxSize", static_cast<long long>(_cappedMaxSize / scale));
         result->appendIntOrLL("sleepCount", _cappedSleep.load());
         result->appendIntOrLL("sleepMS", _cappedSleepMS.load());
+        if (_oplogStones) {
+            BSONObjBuilder stones(result->subobjStart("oplogStones"));
+            _oplogStones->appendStats(&stones);
+        }
     }
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn);
     WT_SESSION* s = session->getSession();
@@ -1266,14 +1653,72 @@ void WiredTigerRecordStore::temp_cappedTruncateAfter(OperationContext* txn,
                                                      bool inclusive) {
     WriteUnitOfWork wuow(txn);
     Cursor cursor(txn, *this);
+    RecordId firstRemovedId;
+    int64_t recordsRemoved = 0;
+    int64_t bytesRemoved = 0;
     while (auto record = cursor.next()) {
         RecordId loc = record->id;
         if (end < loc || (inclusive && end == loc)) {
             if (_cappedDeleteCallback)
                 uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(txn, loc, record->data));
+            if (firstRemovedId.isNull())
+                firstRemovedId = loc;
+            ++recordsRemoved;
+            bytesRemoved += record->data.size();
             deleteRecord(txn, loc);
         }
     }
     wuow.commit();
+
+    if (_oplogStones && recordsRemoved > 0) {
+        _oplogStones->updateStonesAfterCappedTruncateAfter(
+            recordsRemoved, bytesRemoved, firstRemovedId);
+    }
+}
+
+int64_t WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
+    invariant(_oplogStones);
+
+    WT_SESSION* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
+
+    int64_t recordsRemoved = 0;
+    while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
+        invariant(stone->lastRecord.isNormal());
+
+        LOG(1) << "Truncating the oplog through " << stone->lastRecord
+               << " to remove approximately " << stone->records << " records totaling to "
+               << stone->bytes << " bytes";
+
+        try {
+            WriteUnitOfWork wuow(txn);
+
+            WiredTigerCursor startWrap(_uri, _tableId, true, txn);
+            WT_CURSOR* start = startWrap.get();
+            int ret = WT_OP_CHECK(start->next(start));
+            if (ret != WT_NOTFOUND) {
+                invariantWTOK(ret);
+
+                WiredTigerCursor endWrap(_uri, _tableId, true, txn);
+                WT_CURSOR* end = endWrap.get();
+                end->set_key(end, _makeKey(stone->lastRecord));
+
+                invariantWTOK(WT_OP_CHECK(session->truncate(session, NULL, start, end, NULL)));
+            }
+
+            _changeNumRecords(txn, -stone->records);
+            _increaseDataSize(txn, -stone->bytes);
+
+            wuow.commit();
+        } catch (const WriteConflictException& wce) {
+            // Leave the stone in place for the next attempt.
+            LOG(1) << "got conflict truncating the oplog, will try again later";
+            break;
+        }
+
+        _oplogStones->popOldestStone();
+        recordsRemoved += stone->records;
+    }
+
+    return recordsRemoved;
 }
 }
@@ -32,6 +32,7 @@
 #pragma once
 
 #include <boost/thread/mutex.hpp>
+#include <memory>
 #include <set>
 #include <string>
 
@@ -59,6 +60,8 @@ extern const std::string kWiredTigerEngineName;
 
 class WiredTigerRecordStore : public RecordStore {
 public:
+    class OplogStones;
+
     /**
      * Parses collections options for wired tiger configuration string for table creation.
      * The document 'options' is typically obtained from the 'wiredTiger' field of
@@ -122,6 +125,10 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota);
 
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -215,6 +222,20 @@ public:
         return _cappedDeleterMutex;
     }
 
+    /**
+     * Returns the stones dividing the oplog, or NULL if this isn't an oplog whose old records
+     * are truncated by a background thread.
+     */
+    const std::shared_ptr<OplogStones>& oplogStones() const {
+        return _oplogStones;
+    }
+
+    /**
+     * Truncates the oldest stones of the oplog while it holds more than it needs. Returns the
+     * number of records removed.
+     */
+    int64_t reclaimOplog(OperationContext* txn);
+
 private:
     class Cursor;
     class RandomCursor;
@@ -273,6 +294,9 @@ private:
 
     bool _shuttingDown;
     bool _hasBackgroundThread;
+
+    // Non-null if old records are truncated a stone at a time. See reclaimOplog().
+    std::shared_ptr<OplogStones> _oplogStones;
 };
 
 // WT failpoint to throw write conflict exceptions randomly
@@ -31,6 +31,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <memory>
 #include <set>
 
 #include "mongo/base/checked_cast.h"
@@ -44,6 +45,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/background.h"
@@ -70,8 +72,11 @@ public:
 
     /**
      * @return Number of documents deleted.
+     *
+     * If the oplog is truncated a stone at a time, sets 'stonesOut' so that the caller can
+     * wait for the next stone to fill without holding any locks.
      */
-    int64_t _deleteExcessDocuments() {
+    int64_t _deleteExcessDocuments(std::shared_ptr<WiredTigerRecordStore::OplogStones>* stonesOut) {
         if (!getGlobalServiceContext()->getGlobalStorageEngine()) {
             LOG(1) << "no global storage engine yet";
             return 0;
@@ -100,6 +105,11 @@ public:
             OldClientContext ctx(&txn, _ns.ns(), false);
             WiredTigerRecordStore* rs =
                 checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+            if (rs->oplogStones()) {
+                *stonesOut = rs->oplogStones();
+                return rs->reclaimOplog(&txn);
+            }
+
             WriteUnitOfWork wuow(&txn);
             stdx::lock_guard<boost::timed_mutex> lock(rs->cappedDeleterMutex());  // NOLINT
             int64_t removed = rs->cappedDeleteAsNeeded_inlock(&txn, RecordId::max());
@@ -117,9 +127,19 @@ public:
         Client::initThread(_name.c_str());
 
         while (!inShutdown()) {
-            int64_t removed = _deleteExcessDocuments();
+            std::shared_ptr<WiredTigerRecordStore::OplogStones> stones;
+            int64_t removed = _deleteExcessDocuments(&stones);
             LOG(2) << "WiredTigerRecordStoreThread deleted " << removed;
-            if (removed == 0) {
+            if (stones) {
+                if (removed == 0 && stones->hasExcessStones()) {
+                    // Truncating conflicted with another operation. Back off before retrying.
+                    sleepmillis(10);
+                } else {
+                    // Sleep until inserts fill another stone. The timeout makes sure that
+                    // shutdown is noticed.
+                    stones->awaitHasExcessStones(Milliseconds(1000));
+                }
+            } else if (removed == 0) {
                 // If we removed 0 documents, sleep a bit in case we're on a laptop
                 // or something to be nice.
                 sleepmillis(1000);
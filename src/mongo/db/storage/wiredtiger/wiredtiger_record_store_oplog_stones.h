@@ -0,0 +1,162 @@
+// wiredtiger_record_store_oplog_stones.h
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Divides the oplog into regions of roughly equal size, "stones", as records are inserted. Each
+ * stone only remembers the RecordId of its last record, along with the number and size of its
+ * records. Once the oplog holds more stones than it needs to stay within cappedMaxSize, the
+ * oldest stone is removed with a single range truncate, rather than by finding and deleting its
+ * records one at a time.
+ *
+ * Stones built from inserts count their records exactly. Stones built when the oplog is opened
+ * may instead be estimated by sampling it, in which case the size of the oplog is approximate
+ * until those stones have been truncated.
+ */
+class WiredTigerRecordStore::OplogStones {
+public:
+    struct Stone {
+        int64_t records;      // Number of records in the stone.
+        int64_t bytes;        // Size of the records in the stone.
+        RecordId lastRecord;  // RecordId of the last record in the stone.
+    };
+
+    OplogStones(OperationContext* txn, WiredTigerRecordStore* rs);
+
+    /**
+     * Wakes up anyone waiting for excess stones and makes them return. Called when the record
+     * store is destroyed.
+     */
+    void kill();
+
+    bool hasExcessStones() const;
+
+    /**
+     * Waits until there are more stones than needed, kill() is called, or 'timeout' passes.
+     * Returns whether there are stones to truncate.
+     */
+    bool awaitHasExcessStones(Milliseconds timeout);
+
+    /**
+     * Returns the oldest stone if there are more stones than needed.
+     */
+    boost::optional<Stone> peekOldestStoneIfNeeded() const;
+
+    /**
+     * Forgets the oldest stone, once its records have been truncated.
+     */
+    void popOldestStone();
+
+    /**
+     * Counts records inserted by 'txn' towards the stone being filled once it commits, and ends
+     * that stone if it has become full.
+     */
+    void updateCurrentStoneAfterInsertOnCommit(OperationContext* txn,
+                                               int64_t bytesInserted,
+                                               const RecordId& highestInserted,
+                                               int64_t countInserted);
+
+    /**
+     * Forgets all stones once 'txn' commits. Used when the whole oplog is truncated.
+     */
+    void clearStonesOnCommit(OperationContext* txn);
+
+    /**
+     * Forgets the stones which ended after 'firstRemovedId', counting whatever remains of them
+     * towards the stone being filled. Used when the end of the oplog is truncated on rollback.
+     */
+    void updateStonesAfterCappedTruncateAfter(int64_t recordsRemoved,
+                                              int64_t bytesRemoved,
+                                              const RecordId& firstRemovedId);
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+    //
+    // The methods below are for testing.
+    //
+
+    size_t numStones() const;
+    int64_t currentRecords() const {
+        return _currentRecords.load();
+    }
+    int64_t currentBytes() const {
+        return _currentBytes.load();
+    }
+
+    void setMinBytesPerStone(int64_t size);
+    void setNumStonesToKeep(size_t numStones);
+
+private:
+    class InsertChange;
+    class TruncateChange;
+
+    void _calculateStones(OperationContext* txn);
+    void _calculateStonesByScanning(OperationContext* txn);
+    void _calculateStonesBySampling(OperationContext* txn,
+                                    int64_t estRecordsPerStone,
+                                    int64_t estBytesPerStone);
+
+    void _createNewStoneIfNeeded(const RecordId& lastRecord);
+
+    bool _hasExcessStones_inlock() const;
+    void _pokeReclaimThreadIfNeeded_inlock();
+
+    WiredTigerRecordStore* const _rs;
+
+    mutable stdx::mutex _mutex;  // Protects the members below, other than the atomics.
+    stdx::condition_variable _excessStonesCV;
+    bool _isDead = false;
+
+    size_t _numStonesToKeep;
+    int64_t _minBytesPerStone;
+
+    // The stone currently being filled, which ends after the last stone in _stones.
+    AtomicInt64 _currentRecords;
+    AtomicInt64 _currentBytes;
+
+    std::deque<Stone> _stones;  // Oldest first.
+};
+
+}  // namespace mongo
@@ -42,6 +42,7 @@
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -877,4 +878,173 @@ TEST(WiredTigerRecordStoreTest, CappedCursorYieldFirst) {
     ASSERT(!cursor->next());
 }
 
+// Returns the oplog stones of 'rs', which must have some.
+WiredTigerRecordStore::OplogStones* _oplogStones(RecordStore* rs) {
+    WiredTigerRecordStore::OplogStones* stones =
+        checked_cast<WiredTigerRecordStore*>(rs)->oplogStones().get();
+    ASSERT(stones);
+    return stones;
+}
+
+// Inserts an oplog entry for Timestamp(1, inc) which is exactly 'size' bytes.
+RecordId _oplogStonesInsert(OperationContext* txn, RecordStore* rs, int inc, int size) {
+    // A document with a timestamp and a string of length n takes 25 + n bytes.
+    BSONObj obj = BSON("ts" << Timestamp(1, inc) << "s" << string(size - 25, 'x'));
+    ASSERT_EQ(size, obj.objsize());
+
+    WriteUnitOfWork wuow(txn);
+    StatusWith<RecordId> res = rs->insertRecord(txn, obj.objdata(), obj.objsize(), false);
+    ASSERT_OK(res.getStatus());
+    wuow.commit();
+    return res.getValue();
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStonesOnlyForOplog) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("a.b", 100000, -1));
+    ASSERT(!checked_cast<WiredTigerRecordStore*>(rs.get())->oplogStones());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStonesCreateNewStone) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", 100000, -1));
+    WiredTigerRecordStore::OplogStones* stones = _oplogStones(rs.get());
+    stones->setMinBytesPerStone(100);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+    // Inserts which roll back aren't counted.
+    {
+        WriteUnitOfWork wuow(opCtx.get());
+        BSONObj obj = BSON("ts" << Timestamp(1, 1));
+        ASSERT_OK(rs->insertRecord(opCtx.get(), obj.objdata(), obj.objsize(), false).getStatus());
+    }
+    ASSERT_EQ(0, stones->currentRecords());
+    ASSERT_EQ(0, stones->currentBytes());
+
+    _oplogStonesInsert(opCtx.get(), rs.get(), 1, 50);
+    ASSERT_EQ(0U, stones->numStones());
+    ASSERT_EQ(1, stones->currentRecords());
+    ASSERT_EQ(50, stones->currentBytes());
+
+    // Reaching the minimum size ends the stone.
+    _oplogStonesInsert(opCtx.get(), rs.get(), 2, 60);
+    ASSERT_EQ(1U, stones->numStones());
+    ASSERT_EQ(0, stones->currentRecords());
+    ASSERT_EQ(0, stones->currentBytes());
+
+    _oplogStonesInsert(opCtx.get(), rs.get(), 3, 30);
+    ASSERT_EQ(1U, stones->numStones());
+    ASSERT_EQ(1, stones->currentRecords());
+    ASSERT_EQ(30, stones->currentBytes());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStonesReclaim) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", 100000, -1));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* stones = _oplogStones(rs.get());
+    stones->setMinBytesPerStone(100);
+    stones->setNumStonesToKeep(2);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+    std::vector<RecordId> locs;
+    for (int i = 1; i <= 9; i++) {
+        locs.push_back(_oplogStonesInsert(opCtx.get(), rs.get(), i, 50));
+    }
+    ASSERT_EQ(4U, stones->numStones());
+    ASSERT(stones->hasExcessStones());
+    ASSERT_EQ(9, rs->numRecords(opCtx.get()));
+
+    // The two oldest stones are truncated.
+    ASSERT_EQ(4, wrs->reclaimOplog(opCtx.get()));
+    ASSERT_EQ(2U, stones->numStones());
+    ASSERT_FALSE(stones->hasExcessStones());
+    ASSERT_EQ(5, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(250, rs->dataSize(opCtx.get()));
+
+    auto cursor = rs->getCursor(opCtx.get());
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(locs[4], record->id);
+
+    // Nothing more to truncate.
+    ASSERT_EQ(0, wrs->reclaimOplog(opCtx.get()));
+    ASSERT_EQ(5, rs->numRecords(opCtx.get()));
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStonesTruncate) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", 100000, -1));
+    WiredTigerRecordStore::OplogStones* stones = _oplogStones(rs.get());
+    stones->setMinBytesPerStone(100);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+    for (int i = 1; i <= 5; i++) {
+        _oplogStonesInsert(opCtx.get(), rs.get(), i, 50);
+    }
+    ASSERT_EQ(2U, stones->numStones());
+
+    {
+        WriteUnitOfWork wuow(opCtx.get());
+        ASSERT_OK(rs->truncate(opCtx.get()));
+        wuow.commit();
+    }
+    ASSERT_EQ(0U, stones->numStones());
+    ASSERT_EQ(0, stones->currentRecords());
+    ASSERT_EQ(0, stones->currentBytes());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStonesCappedTruncateAfter) {
+    WiredTigerHarnessHelper harnessHelper;
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", 100000, -1));
+    WiredTigerRecordStore::OplogStones* stones = _oplogStones(rs.get());
+    stones->setMinBytesPerStone(100);
+
+    unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+    std::vector<RecordId> locs;
+    for (int i = 1; i <= 5; i++) {
+        locs.push_back(_oplogStonesInsert(opCtx.get(), rs.get(), i, 50));
+    }
+    ASSERT_EQ(2U, stones->numStones());
+
+    // Removing the last three records removes the second stone, leaving one of its records.
+    rs->temp_cappedTruncateAfter(opCtx.get(), locs[1], false);
+    ASSERT_EQ(1U, stones->numStones());
+    ASSERT_EQ(1, stones->currentRecords());
+    ASSERT_EQ(50, stones->currentBytes());
+
+    // Stones are created as before from there.
+    _oplogStonesInsert(opCtx.get(), rs.get(), 10, 50);
+    ASSERT_EQ(2U, stones->numStones());
+    ASSERT_EQ(0, stones->currentRecords());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogStonesCalculatedOnStartup) {
+    WiredTigerHarnessHelper harnessHelper;
+
+    // A cap of 1000 bytes gives stones of at least 100 bytes.
+    unique_ptr<RecordStore> rs(harnessHelper.newCappedRecordStore("local.oplog.stones", 1000, -1));
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+        for (int i = 1; i <= 5; i++) {
+            _oplogStonesInsert(opCtx.get(), rs.get(), i, 50);
+        }
+    }
+    ASSERT_EQ(2U, _oplogStones(rs.get())->numStones());
+
+    // Reopen the same table, which scans it for stones since it is small.
+    OperationContextNoop txn(harnessHelper.newRecoveryUnit());
+    WiredTigerRecordStore reopened(&txn, "local.oplog.stones", "table:a.b", true, 1000, -1);
+    WiredTigerRecordStore::OplogStones* stones = _oplogStones(&reopened);
+    ASSERT_EQ(2U, stones->numStones());
+    ASSERT_EQ(1, stones->currentRecords());
+    ASSERT_EQ(50, stones->currentBytes());
+}
+
 }  // namespace mongo
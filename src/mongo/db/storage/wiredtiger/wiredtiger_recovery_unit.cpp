@@ -30,6 +30,8 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
+#include <algorithm>
+
 #include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobjbuilder.h"
@@ -44,6 +46,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -277,24 +280,145 @@ TicketServerParameter openWriteTransactionParam(&openWriteTransaction,
 TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
+
+// When set, the number of read and write tickets is tuned at runtime and any value given for
+// wiredTigerConcurrentReadTransactions or wiredTigerConcurrentWriteTransactions is only the
+// starting point.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrency, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrencyMinTickets, int, 16);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrencyMaxTickets, int, 1024);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrencyIntervalMillis, int, 1000);
+
+/**
+ * Hill climbs the size of a TicketHolder towards the number of concurrent transactions that
+ * gives the most throughput.
+ *
+ * Once per interval it compares the tickets acquired per second, and the mean time spent queued
+ * for one, with the previous interval. If the last change helped, the next one goes the same
+ * way, otherwise it goes the other way. Equal throughput with longer waits counts as worse.
+ * Intervals in which nobody had to queue carry no signal and leave the size alone.
+ *
+ * There is no background thread: whichever operation first gets a ticket after the interval
+ * elapses does the adjustment.
+ */
+class TicketTuner {
+    MONGO_DISALLOW_COPYING(TicketTuner);
+
+public:
+    explicit TicketTuner(TicketHolder* holder) : _holder(holder) {}
+
+    void maybeAdjust() {
+        if (!wiredTigerAdaptiveConcurrency)
+            return;
+
+        const long long now = curTimeMillis64();
+        const long long next = _nextAdjustMillis.load();
+        if (now < next)
+            return;
+
+        // Only the thread that moves the deadline forward adjusts.
+        const long long interval = std::max(1, wiredTigerAdaptiveConcurrencyIntervalMillis);
+        if (_nextAdjustMillis.compareAndSwap(next, now + interval) != next)
+            return;
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _adjust(now);
+    }
+
+private:
+    // A change in throughput within this fraction of the last interval's is noise.
+    static constexpr double kTolerance = 0.05;
+
+    void _adjust(long long now) {
+        const TicketHolder::QueueStats stats = _holder->queueStats();
+        const long long acquired = stats.immediate + stats.queued;
+        const long long queued = stats.queued - _lastQueued;
+        const long long elapsed = now - _lastSampleMillis;
+        const bool haveSample = _lastSampleMillis != 0 && elapsed > 0;
+
+        const double throughput = haveSample ? (acquired - _lastAcquired) * 1000.0 / elapsed : 0;
+        const double meanWait =
+            queued > 0 ? double(stats.totalQueuedMicros - _lastQueuedMicros) / queued : 0;
+
+        _lastSampleMillis = now;
+        _lastAcquired = acquired;
+        _lastQueued = stats.queued;
+        _lastQueuedMicros = stats.totalQueuedMicros;
+
+        if (!haveSample || queued == 0)
+            return;
+
+        if (throughput < _lastThroughput * (1 - kTolerance) ||
+            (throughput <= _lastThroughput * (1 + kTolerance) && meanWait > _lastMeanWait)) {
+            _direction = -_direction;
+        }
+        _lastThroughput = throughput;
+        _lastMeanWait = meanWait;
+
+        const int minTickets = std::max(5, wiredTigerAdaptiveConcurrencyMinTickets);
+        const int maxTickets = std::max(minTickets, wiredTigerAdaptiveConcurrencyMaxTickets);
+        const int current = _holder->outof();
+        const int step = std::max(1, current / 8);
+        const int target = std::min(maxTickets, std::max(minTickets, current + _direction * step));
+        if (target == current) {
+            // Pinned at a bound; try the other way next time.
+            _direction = -_direction;
+            return;
+        }
+
+        LOG(1) << "adjusting WiredTiger tickets from " << current << " to " << target
+               << " (throughput " << throughput << "/s, mean queue wait " << meanWait << "us)";
+        fassert(28793, _holder->resize(target));
+    }
+
+    TicketHolder* const _holder;
+    AtomicInt64 _nextAdjustMillis;
+
+    stdx::mutex _mutex;  // Guards the members below.
+    long long _lastSampleMillis = 0;
+    long long _lastAcquired = 0;
+    long long _lastQueued = 0;
+    long long _lastQueuedMicros = 0;
+    double _lastThroughput = 0;
+    double _lastMeanWait = 0;
+    int _direction = 1;
+};
+
+TicketTuner openWriteTransactionTuner(&openWriteTransaction);
+TicketTuner openReadTransactionTuner(&openReadTransaction);
+
+void appendTicketStats(BSONObjBuilder* b, StringData name, const TicketHolder& holder) {
+    BSONObjBuilder bb(b->subobjStart(name));
+    bb.append("out", holder.used());
+    bb.append("available", holder.available());
+    bb.append("totalTickets", holder.outof());
+    bb.append("waiting", holder.waiters());
+
+    const TicketHolder::QueueStats stats = holder.queueStats();
+    BSONObjBuilder queue(bb.subobjStart("queue"));
+    queue.append("immediate", stats.immediate);
+    queue.append("queued", stats.queued);
+    queue.append("totalQueuedMicros", stats.totalQueuedMicros);
+
+    // Only the non-empty buckets, each labelled by the shortest wait it holds.
+    BSONArrayBuilder histogram(queue.subarrayStart("waitMicros"));
+    for (size_t i = 0; i < TicketHolder::kNumWaitBuckets; i++) {
+        if (stats.waitBuckets[i] == 0)
+            continue;
+        histogram.append(BSON("lowerBound" << (i == 0 ? 0LL : 1LL << i) << "count"
+                                           << stats.waitBuckets[i]));
+    }
+    histogram.done();
+    queue.done();
+    bb.done();
+}
 }
 
 void WiredTigerRecoveryUnit::appendGlobalStats(BSONObjBuilder& b) {
     BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
-    {
-        BSONObjBuilder bbb(bb.subobjStart("write"));
-        bbb.append("out", openWriteTransaction.used());
-        bbb.append("available", openWriteTransaction.available());
-        bbb.append("totalTickets", openWriteTransaction.outof());
-        bbb.done();
-    }
-    {
-        BSONObjBuilder bbb(bb.subobjStart("read"));
-        bbb.append("out", openReadTransaction.used());
-        bbb.append("available", openReadTransaction.available());
-        bbb.append("totalTickets", openReadTransaction.outof());
-        bbb.done();
-    }
+    appendTicketStats(&bb, "write", openWriteTransaction);
+    appendTicketStats(&bb, "read", openReadTransaction);
+    bb.append("adaptive", wiredTigerAdaptiveConcurrency);
     bb.done();
 }
 
@@ -366,6 +490,8 @@ void WiredTigerRecoveryUnit::_getTicket(OperationContext* opCtx) {
 
     holder->waitForTicket();
     _ticket.reset(holder);
+
+    (writeLocked ? openWriteTransactionTuner : openReadTransactionTuner).maybeAdjust();
 }
 
 void WiredTigerRecoveryUnit::_txnOpen(OperationContext* opCtx) {
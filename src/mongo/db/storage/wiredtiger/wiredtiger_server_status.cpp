@@ -56,8 +56,8 @@ bool WiredTigerServerStatusSection::includeByDefault() const {
 
 BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* txn,
                                                        const BSONElement& configElement) const {
-    WiredTigerSession* session =
-        checked_cast<WiredTigerRecoveryUnit*>(txn->recoveryUnit())->getSession(txn);
+    WiredTigerRecoveryUnit* ru = checked_cast<WiredTigerRecoveryUnit*>(txn->recoveryUnit());
+    WiredTigerSession* session = ru->getSession(txn);
     invariant(session);
 
     WT_SESSION* s = session->getSession();
@@ -74,6 +74,11 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* txn,
 
     WiredTigerRecoveryUnit::appendGlobalStats(bob);
 
+    {
+        BSONObjBuilder sessionCache(bob.subobjStart("sessionCache"));
+        ru->getSessionCache()->appendStats(&sessionCache);
+    }
+
     return bob.obj();
 }
 
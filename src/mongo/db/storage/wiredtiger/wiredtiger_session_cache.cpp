@@ -31,8 +31,17 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
+#include "mongo/platform/basic.h"
+
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <functional>
+
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
@@ -120,6 +129,9 @@ uint64_t WiredTigerSession::genTableId() {
 
 // -----------------------
 
+const size_t WiredTigerSessionCache::kSlotsPerPartition;
+const unsigned WiredTigerSessionCache::kNumPartitions;
+
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
     : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
 
@@ -161,16 +173,60 @@ void WiredTigerSessionCache::closeAll() {
         _sessions.swap(swap);
     }
 
+    // Anything stored in a slot from here on is either from the new epoch, or will be taken back
+    // out by releaseSession once it sees the new epoch.
+    for (Partition& partition : _partitions) {
+        for (auto& slot : partition.slots) {
+            if (WiredTigerSession* session = slot.swap(nullptr)) {
+                swap.push_back(session);
+            }
+        }
+    }
+
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
         delete (*i);
     }
 }
 
+WiredTigerSessionCache::Partition* WiredTigerSessionCache::_currentPartition() {
+    // The CPU may change right after we look, which only costs a trip to the overflow pool.
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return &_partitions[cpu % kNumPartitions];
+    }
+#endif
+    const size_t thread = std::hash<stdx::thread::id>()(stdx::this_thread::get_id());
+    return &_partitions[thread % kNumPartitions];
+}
+
 WiredTigerSession* WiredTigerSessionCache::getSession() {
     // We should never be able to get here after _shuttingDown is set, because no new
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
+    Partition* partition = _currentPartition();
+    for (auto& slot : partition->slots) {
+        if (!slot.loadRelaxed())
+            continue;
+
+        WiredTigerSession* cachedSession = slot.swap(nullptr);
+        if (!cachedSession) {
+            // Another thread on this CPU emptied the slot first.
+            partition->contended.fetchAndAdd(1);
+            continue;
+        }
+
+        if (cachedSession->_getEpoch() != _epoch.load()) {
+            // Released just as closeAll emptied the slots.
+            delete cachedSession;
+            continue;
+        }
+
+        partition->hits.fetchAndAdd(1);
+        return cachedSession;
+    }
+
     {
         stdx::lock_guard<SpinLock> lock(_cacheLock);
         if (!_sessions.empty()) {
@@ -178,11 +234,13 @@ WiredTigerSession* WiredTigerSessionCache::getSession() {
             // discarding older ones
             WiredTigerSession* cachedSession = _sessions.back();
             _sessions.pop_back();
+            _overflowHits.fetchAndAdd(1);
             return cachedSession;
         }
     }
 
-    // Outside of the cache partition lock, but on release will be put back on the cache
+    // Outside of the cache lock, but on release will be put back on the cache
+    _sessionsOpened.fetchAndAdd(1);
     return new WiredTigerSession(_conn, _epoch.load());
 }
 
@@ -210,22 +268,78 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
         invariant(range == 0);
     }
 
-    bool returnedToCache = false;
-    uint64_t currentEpoch = _epoch.load();
+    const uint64_t currentEpoch = _epoch.load();
+
+    if (session->_getEpoch() == currentEpoch) {
+        Partition* partition = _currentPartition();
+        AtomicWord<WiredTigerSession*>* stored = NULL;
+        for (auto& slot : partition->slots) {
+            if (slot.loadRelaxed())
+                continue;
+            if (!slot.compareAndSwap(nullptr, session)) {
+                stored = &slot;
+                break;
+            }
+            partition->contended.fetchAndAdd(1);
+        }
 
-    if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<SpinLock> lock(_cacheLock);
-        if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
-            returnedToCache = true;
-            _sessions.push_back(session);
+        if (!stored) {
+            _releaseToOverflow(session);
+        } else if (_epoch.load() != currentEpoch) {
+            // closeAll may have already emptied this partition, so take back whatever is now in
+            // the slot rather than leave a stale session there.
+            if (WiredTigerSession* s = stored->swap(nullptr)) {
+                _releaseToOverflow(s);
+            }
         }
-    } else
+    } else {
         invariant(session->_getEpoch() < currentEpoch);
-
-    if (!returnedToCache)
         delete session;
+    }
 
     if (_engine && _engine->haveDropsQueued())
         _engine->dropAllQueued();
 }
+
+void WiredTigerSessionCache::_releaseToOverflow(WiredTigerSession* session) {
+    {
+        stdx::lock_guard<SpinLock> lock(_cacheLock);
+        if (session->_getEpoch() == _epoch.load()) {  // check inside the lock for correctness
+            _sessions.push_back(session);
+            _overflowReleases.fetchAndAdd(1);
+            return;
+        }
+    }
+
+    delete session;
+}
+
+void WiredTigerSessionCache::appendStats(BSONObjBuilder* builder) const {
+    long long slotHits = 0;
+    long long slotContention = 0;
+    long long inSlots = 0;
+    for (const Partition& partition : _partitions) {
+        slotHits += partition.hits.loadRelaxed();
+        slotContention += partition.contended.loadRelaxed();
+        for (const auto& slot : partition.slots) {
+            if (slot.loadRelaxed())
+                ++inSlots;
+        }
+    }
+
+    long long inOverflow;
+    {
+        stdx::lock_guard<SpinLock> lock(_cacheLock);
+        inOverflow = _sessions.size();
+    }
+
+    builder->appendNumber("slotHits", slotHits);
+    builder->appendNumber("overflowHits", static_cast<long long>(_overflowHits.loadRelaxed()));
+    builder->appendNumber("misses", static_cast<long long>(_sessionsOpened.loadRelaxed()));
+    builder->appendNumber("overflowReleases",
+                          static_cast<long long>(_overflowReleases.loadRelaxed()));
+    builder->appendNumber("slotContention", slotContention);
+    builder->appendNumber("sessionsInSlots", inSlots);
+    builder->appendNumber("sessionsInOverflow", inOverflow);
+}
 }
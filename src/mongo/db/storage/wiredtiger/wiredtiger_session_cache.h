@@ -33,17 +33,20 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <boost/thread/shared_mutex.hpp>
 #include <wiredtiger.h>
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 
 class WiredTigerCachedCursor {
@@ -67,9 +70,6 @@ public:
      * Creates a new WT session on the specified connection.
      *
      * @param conn WT connection
-     * @param cachePartition If the session comes from the session cache, this indicates to
-     *          which partition it should be returned. Value of -1 means it doesn't come from
-     *          cache and that it should not be cached, but closed directly.
      * @param epoch In which session cache cleanup epoch was this session instantiated. Value
      *          of -1 means that this value is not necessary since the session will not be
      *          cached.
@@ -119,6 +119,15 @@ private:
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  Sessions are released to a small array of slots belonging to the CPU the releasing thread is
+ *  running on, and taken from the slots of the CPU the requesting thread is running on. The
+ *  slots are claimed and filled with atomic swaps, so threads on different CPUs never share a
+ *  lock or a cache line. Sessions which don't fit, and requests which find their CPU's slots
+ *  empty, go to an overflow pool under a spinlock.
+ *
+ *  closeAll bumps the epoch before emptying the slots. A session from an older epoch which is
+ *  found in a slot is closed instead of being returned.
  */
 class WiredTigerSessionCache {
 public:
@@ -152,6 +161,12 @@ public:
      */
     void shuttingDown();
 
+    /**
+     * Appends counts of how often sessions were found in the per-CPU slots or the overflow pool,
+     * how often new sessions had to be opened, and how often threads raced on a slot.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
     WT_CONNECTION* conn() const {
         return _conn;
     }
@@ -163,7 +178,28 @@ public:
         return _snapshotManager;
     }
 
+    // The number of sessions cached for each CPU, outside of the overflow pool.
+    static const size_t kSlotsPerPartition = 6;
+
 private:
+    // One per CPU, padded so that partitions don't share cache lines. The counters are only
+    // written by threads which are already writing the slots, and with six slots the whole
+    // partition fits in one line.
+    struct MONGO_COMPILER_ALIGN_TYPE(64) Partition {
+        AtomicWord<WiredTigerSession*> slots[kSlotsPerPartition];
+        AtomicUInt64 hits;
+        AtomicUInt64 contended;
+    };
+
+    static const unsigned kNumPartitions = 64;
+
+    Partition* _currentPartition();
+
+    /**
+     * Returns the session to the overflow pool, or closes it if it is from an older epoch.
+     */
+    void _releaseToOverflow(WiredTigerSession* session);
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -174,10 +210,17 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    SpinLock _cacheLock;
+    Partition _partitions[kNumPartitions];
+
+    // Protects the overflow pool.
+    mutable SpinLock _cacheLock;
     typedef std::vector<WiredTigerSession*> SessionCache;
     SessionCache _sessions;
 
+    AtomicUInt64 _overflowHits;
+    AtomicUInt64 _overflowReleases;
+    AtomicUInt64 _sessionsOpened;
+
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
 };
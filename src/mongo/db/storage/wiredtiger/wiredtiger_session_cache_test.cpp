@@ -0,0 +1,157 @@
+// wiredtiger_util_test.cpp
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest() : _dbpath("wt_test"), _conn(NULL) {
+        int ret = wiredtiger_open(_dbpath.path().c_str(), NULL, "create,", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+        _cache.reset(new WiredTigerSessionCache(_conn));
+    }
+
+    ~WiredTigerSessionCacheTest() {
+        _cache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+protected:
+    BSONObj stats() const {
+        BSONObjBuilder builder;
+        _cache->appendStats(&builder);
+        return builder.obj();
+    }
+
+    long long cachedSessions() const {
+        const BSONObj obj = stats();
+        return obj["sessionsInSlots"].numberLong() + obj["sessionsInOverflow"].numberLong();
+    }
+
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn;
+    std::unique_ptr<WiredTigerSessionCache> _cache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedSessionsAreCached) {
+    // More than fit in the slots of one CPU, so some may go to the overflow pool.
+    const size_t n = WiredTigerSessionCache::kSlotsPerPartition * 2;
+    std::vector<WiredTigerSession*> sessions;
+    for (size_t i = 0; i < n; i++) {
+        sessions.push_back(_cache->getSession());
+    }
+    ASSERT_EQUALS(static_cast<long long>(n), stats()["misses"].numberLong());
+
+    for (WiredTigerSession* session : sessions) {
+        _cache->releaseSession(session);
+    }
+    ASSERT_EQUALS(static_cast<long long>(n), cachedSessions());
+
+    // Sessions are only opened again once the cache is empty.
+    sessions.clear();
+    for (size_t i = 0; i < n; i++) {
+        sessions.push_back(_cache->getSession());
+    }
+    const BSONObj obj = stats();
+    ASSERT_EQUALS(static_cast<long long>(n) * 2,
+                  obj["slotHits"].numberLong() + obj["overflowHits"].numberLong() +
+                      obj["misses"].numberLong());
+
+    for (WiredTigerSession* session : sessions) {
+        _cache->releaseSession(session);
+    }
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllEmptiesCache) {
+    WiredTigerSession* first = _cache->getSession();
+    WiredTigerSession* second = _cache->getSession();
+    _cache->releaseSession(first);
+    ASSERT_EQUALS(1, cachedSessions());
+
+    _cache->closeAll();
+    ASSERT_EQUALS(0, cachedSessions());
+
+    // A session from before closeAll is closed when released, rather than cached.
+    _cache->releaseSession(second);
+    ASSERT_EQUALS(0, cachedSessions());
+
+    WiredTigerSession* third = _cache->getSession();
+    ASSERT_EQUALS(3, stats()["misses"].numberLong());
+    _cache->releaseSession(third);
+    ASSERT_EQUALS(1, cachedSessions());
+}
+
+TEST_F(WiredTigerSessionCacheTest, ConcurrentUseWithCloseAll) {
+    const int numThreads = 8;
+    const int iterations = 2000;
+
+    std::vector<stdx::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([this] {
+            for (int i = 0; i < iterations; i++) {
+                WiredTigerSession* first = _cache->getSession();
+                WiredTigerSession* second = _cache->getSession();
+                _cache->releaseSession(second);
+                _cache->releaseSession(first);
+            }
+        });
+    }
+    for (int i = 0; i < 20; i++) {
+        _cache->closeAll();
+        stdx::this_thread::yield();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const BSONObj obj = stats();
+    ASSERT_EQUALS(static_cast<long long>(numThreads) * iterations * 2,
+                  obj["slotHits"].numberLong() + obj["overflowHits"].numberLong() +
+                      obj["misses"].numberLong());
+    // Each cached session was opened once and cached at most once.
+    ASSERT_LESS_THAN_OR_EQUALS(cachedSessions(), obj["misses"].numberLong());
+    _cache->closeAll();
+    ASSERT_EQUALS(0, cachedSessions());
+}
+
+}  // namespace
+}  // namespace mongo
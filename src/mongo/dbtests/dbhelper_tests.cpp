@@ -36,9 +36,11 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/range_arithmetic.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -113,6 +115,47 @@ public:
     }
 } myall;
 
+/** Helpers::removeRange deletes in batches of rangeDeleterBatchSize documents. */
+TEST(DBHelperTests, RemoveRangeInBatches) {
+    OperationContextImpl txn;
+    DBDirectClient client(&txn);
+
+    client.remove(ns, BSONObj());
+    long long expectedBytes = 0;
+    for (int i = 0; i < 20; ++i) {
+        const BSONObj doc = BSON("_id" << i << "x" << std::string(i, 'x'));
+        if (i < 10) {
+            expectedBytes += doc.objsize();
+        }
+        client.insert(ns, doc);
+    }
+
+    ServerParameter* batchSize = ServerParameterSet::getGlobal()->getMap().find(
+        "rangeDeleterBatchSize")->second;
+    ASSERT_OK(batchSize->setFromString("3"));
+    ON_BLOCK_EXIT([batchSize] { batchSize->setFromString("64"); });
+
+    Helpers::RemoveRangeStats stats;
+    {
+        ScopedTransaction transaction(&txn, MODE_IX);
+        Lock::DBLock lk(txn.lockState(), nsToDatabaseSubstring(ns), MODE_X);
+        OldClientContext ctx(&txn, ns);
+
+        KeyRange range(ns, BSON("_id" << 0), BSON("_id" << 10), BSON("_id" << 1));
+        ASSERT_EQUALS(10,
+                      Helpers::removeRange(
+                          &txn, range, false, WriteConcernOptions(), NULL, false, false, &stats));
+    }
+
+    ASSERT_EQUALS(10, stats.deletedDocs);
+    ASSERT_EQUALS(expectedBytes, stats.deletedBytes);
+    ASSERT_EQUALS(4, stats.batches);
+    ASSERT_EQUALS(0, stats.throttledMillis);
+
+    ASSERT_EQUALS(10U, client.count(ns));
+    ASSERT_EQUALS(0U, client.count(ns, BSON("_id" << LT << 10)));
+}
+
 //
 // Tests getting disk locs for an index range
 //
@@ -38,6 +38,7 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/service_context_d.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/dbtests/dbtests.h"
@@ -882,6 +883,138 @@ public:
     }
 };
 
+/**
+ * Fixture for building an index straight through IndexAccessMethod::BulkBuilder, with the
+ * documents split over several builders which are then merged, the way a parallel foreground
+ * build splits them over its workers.
+ */
+class BulkBuilderMergeBase : public IndexBuildBase {
+protected:
+    /**
+     * Creates the index 'spec' on the empty collection and bulk loads keys for 'docs' into it,
+     * dealing the documents out to 'numBuilders' builders in turn. The documents aren't in the
+     * collection; each is given a RecordId from its position in 'docs'.
+     */
+    Status bulkBuild(const BSONObj& spec, const std::vector<BSONObj>& docs, size_t numBuilders) {
+        ASSERT_OK(createIndex("unittests", spec));
+        IndexCatalog* catalog = collection()->getIndexCatalog();
+        IndexDescriptor* desc = catalog->findIndexByName(&_txn, spec["name"].String());
+        ASSERT(desc);
+        IndexAccessMethod* iam = catalog->getIndex(desc);
+
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> builders;
+        for (size_t i = 0; i < numBuilders; ++i) {
+            builders.push_back(iam->initiateBulk());
+        }
+
+        InsertDeleteOptions options;
+        options.dupsAllowed = !spec["unique"].trueValue();
+        for (size_t i = 0; i < docs.size(); ++i) {
+            ASSERT_OK(builders[i % numBuilders]->insert(
+                &_txn, docs[i], recordIdFor(i), options, NULL));
+        }
+
+        for (size_t i = 1; i < numBuilders; ++i) {
+            builders[0]->merge(std::move(builders[i]));
+        }
+        return iam->commitBulk(&_txn, std::move(builders[0]), false, options.dupsAllowed, NULL);
+    }
+
+    /**
+     * Returns the entries of the index named 'name', which must be on a single field, in index
+     * order.
+     */
+    std::vector<IndexKeyEntry> indexEntries(const std::string& name) {
+        IndexCatalog* catalog = collection()->getIndexCatalog();
+        IndexDescriptor* desc = catalog->findIndexByName(&_txn, name);
+        ASSERT(desc);
+
+        std::vector<IndexKeyEntry> entries;
+        auto cursor = catalog->getIndex(desc)->newCursor(&_txn);
+        for (auto entry = cursor->seek(BSON("" << MINKEY), true); entry; entry = cursor->next()) {
+            entries.push_back(*entry);
+        }
+        return entries;
+    }
+
+    bool isMultikey(const std::string& name) {
+        IndexCatalog* catalog = collection()->getIndexCatalog();
+        return catalog->isMultikey(&_txn, catalog->findIndexByName(&_txn, name));
+    }
+
+    void dropIndex(const std::string& name) {
+        IndexCatalog* catalog = collection()->getIndexCatalog();
+        WriteUnitOfWork wunit(&_txn);
+        ASSERT_OK(catalog->dropIndex(&_txn, catalog->findIndexByName(&_txn, name)));
+        wunit.commit();
+    }
+
+    static RecordId recordIdFor(size_t i) {
+        return RecordId(1, 16 * (i + 1));
+    }
+};
+
+/** Merging builders yields the same index as building with one. */
+class BulkBuilderMergeMatchesSerial : public BulkBuilderMergeBase {
+public:
+    void run() {
+        // 'a' repeats, so equal keys from different builders must come out in RecordId order,
+        // and only some documents make 'b' multikey.
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < 300; ++i) {
+            if (i % 7 == 0) {
+                docs.push_back(BSON("a" << i % 41 << "b" << BSON_ARRAY(i << -i)));
+            } else {
+                docs.push_back(BSON("a" << i % 41 << "b" << i));
+            }
+        }
+
+        for (const char* field : {"a", "b"}) {
+            const std::string name = std::string(field) + "_1";
+            const BSONObj spec = BSON("ns" << _ns << "name" << name << "key" << BSON(field << 1));
+
+            ASSERT_OK(bulkBuild(spec, docs, 1));
+            const std::vector<IndexKeyEntry> serial = indexEntries(name);
+            const bool serialMultikey = isMultikey(name);
+            dropIndex(name);
+
+            ASSERT_OK(bulkBuild(spec, docs, 4));
+            const std::vector<IndexKeyEntry> merged = indexEntries(name);
+            ASSERT_EQUALS(serialMultikey, isMultikey(name));
+            dropIndex(name);
+
+            ASSERT_EQUALS(serial.size(), merged.size());
+            for (size_t i = 0; i < serial.size(); ++i) {
+                ASSERT_EQUALS(serial[i], merged[i]);
+            }
+        }
+        ASSERT_FALSE(isMultikey("_id_"));
+    }
+};
+
+/** A unique index build fails on a duplicate even when its keys came from different builders. */
+class BulkBuilderMergeEnforcesUnique : public BulkBuilderMergeBase {
+public:
+    void run() {
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < 100; ++i) {
+            docs.push_back(BSON("a" << i));
+        }
+        // With 4 builders this lands in a different one than {a: 5}.
+        docs.push_back(BSON("a" << 5));
+
+        const BSONObj spec = BSON("ns" << _ns << "name"
+                                       << "a_1"
+                                       << "key" << BSON("a" << 1) << "unique" << true);
+
+        ASSERT_EQUALS(ErrorCodes::DuplicateKey, bulkBuild(spec, docs, 1).code());
+        dropIndex("a_1");
+
+        ASSERT_EQUALS(ErrorCodes::DuplicateKey, bulkBuild(spec, docs, 4).code());
+        dropIndex("a_1");
+    }
+};
+
 class IndexUpdateTests : public Suite {
 public:
     IndexUpdateTests() : Suite("indexupdate") {}
@@ -914,6 +1047,8 @@ public:
         add<SameSpecDifferentSparse>();
         add<SameSpecDifferentTTL>();
         add<StorageEngineOptions>();
+        add<BulkBuilderMergeMatchesSerial>();
+        add<BulkBuilderMergeEnforcesUnique>();
 
         add<IndexCatatalogFixIndexKey>();
     }
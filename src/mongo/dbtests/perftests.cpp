@@ -52,14 +52,18 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/platform/random.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 
@@ -444,6 +448,113 @@ public:
     }
 };
 
+/**
+ * Benchmarks for the in-memory storage engine's indexes. getInMemoryBtreeImpl() keeps KeyStrings
+ * in a B+tree, while getInMemorySetBtreeImpl() is the std::set of BSON keys it replaced. Keys are
+ * compound, with a string that many keys share followed by a unique number.
+ */
+template <bool UseSet>
+class InMemoryIndexBase : public B {
+public:
+    InMemoryIndexBase()
+        : _ordering(Ordering::make(BSON("a" << 1 << "b" << 1))),
+          _index(UseSet ? getInMemorySetBtreeImpl(_ordering, &_data)
+                        : getInMemoryBtreeImpl(_ordering, &_data)),
+          _random(17) {}
+
+protected:
+    virtual int howLongMillis() {
+        return 2000;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+
+    string indexName() const {
+        return UseSet ? "std::set" : "KeyString btree";
+    }
+
+    BSONObj makeKey(int i) const {
+        const string prefix = mongoutils::str::stream() << "customer-" << i % 1000;
+        return BSON("" << prefix << "" << i);
+    }
+
+    void insertKey(int i) {
+        WriteUnitOfWork wuow(&_opCtx);
+        ASSERT_OK(_index->insert(&_opCtx, makeKey(i), RecordId(int64_t(i) + 1), true));
+        wuow.commit();
+    }
+
+    // Keys and RecordIds must not be negative, but PseudoRandom covers the whole signed range.
+    int nextKey() {
+        return _random.nextInt32() & 0x7fffffff;
+    }
+
+    // Every key below this has been inserted by fill().
+    static const int kNumKeys = 100000;
+
+    void fill() {
+        for (int i = 0; i < kNumKeys; i++) {
+            insertKey(i);
+        }
+    }
+
+    OperationContextNoop _opCtx;
+    const Ordering _ordering;
+    std::shared_ptr<void> _data;
+    const std::unique_ptr<SortedDataInterface> _index;
+    PseudoRandom _random;
+};
+
+template <bool UseSet>
+class InMemoryIndexInsert : public InMemoryIndexBase<UseSet> {
+public:
+    string name() {
+        return "in-memory index insert, " + this->indexName();
+    }
+    void timed() {
+        this->insertKey(this->nextKey());
+    }
+};
+
+template <bool UseSet>
+class InMemoryIndexSeek : public InMemoryIndexBase<UseSet> {
+public:
+    string name() {
+        return "in-memory index seek, " + this->indexName();
+    }
+    void prep() {
+        this->fill();
+        _cursor = this->_index->newCursor(&this->_opCtx, true);
+    }
+    void timed() {
+        // A short range read, as for a point query on the leading field.
+        const int start = this->nextKey() % this->kNumKeys;
+        auto entry = _cursor->seek(this->makeKey(start), true);
+        for (int i = 0; entry && i < 10; i++) {
+            entry = _cursor->next();
+        }
+    }
+
+private:
+    std::unique_ptr<SortedDataInterface::Cursor> _cursor;
+};
+
+template <bool UseSet>
+class InMemoryIndexScan : public InMemoryIndexBase<UseSet> {
+public:
+    string name() {
+        return "in-memory index scan, " + this->indexName();
+    }
+    void prep() {
+        this->fill();
+    }
+    void timed() {
+        auto cursor = this->_index->newCursor(&this->_opCtx, true);
+        for (auto entry = cursor->seek(BSONObj(), true); entry; entry = cursor->next()) {
+        }
+    }
+};
 
 class All : public Suite {
 public:
@@ -457,6 +568,12 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+        add<InMemoryIndexInsert<true>>();
+        add<InMemoryIndexInsert<false>>();
+        add<InMemoryIndexSeek<true>>();
+        add<InMemoryIndexSeek<false>>();
+        add<InMemoryIndexScan<true>>();
+        add<InMemoryIndexScan<false>>();
     }
 } myall;
 }
@@ -48,6 +48,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor_manager.h"
 
 namespace mongo {
 namespace executor {
@@ -99,6 +100,8 @@ private:
         rpc::ProtocolSet clientProtocols() const;
         void setServerProtocols(rpc::ProtocolSet protocols);
 
+        MessageCompressorManager& compressorManager();
+
 // Explicit move construction and assignment to support MSVC
 #if defined(_MSC_VER) && _MSC_VER < 1900
         AsyncConnection(AsyncConnection&&);
@@ -113,6 +116,8 @@ private:
 
         rpc::ProtocolSet _serverProtocols;
         rpc::ProtocolSet _clientProtocols{rpc::supports::kAll};
+
+        MessageCompressorManager _compressorManager;
     };
 
     /**
@@ -55,7 +55,11 @@ void NetworkInterfaceASIO::_runIsMaster(AsyncOp* op) {
     requestBuilder.setDatabase("admin");
     requestBuilder.setCommandName("isMaster");
     requestBuilder.setMetadata(rpc::makeEmptyMetadata());
-    requestBuilder.setCommandArgs(BSON("isMaster" << 1));
+
+    BSONObjBuilder isMasterArgs;
+    isMasterArgs.append("isMaster", 1);
+    op->connection().compressorManager().clientBegin(&isMasterArgs);
+    requestBuilder.setCommandArgs(isMasterArgs.done());
 
     // Set current command to ismaster request and run
     auto& cmd = op->beginCommand(std::move(*(requestBuilder.done())), now());
@@ -71,6 +75,7 @@ void NetworkInterfaceASIO::_runIsMaster(AsyncOp* op) {
                 return _completeOperation(op, protocolSet.getStatus());
 
             op->connection().setServerProtocols(protocolSet.getValue());
+            op->connection().compressorManager().clientFinish(isMasterReply);
 
             // Set the operation protocol
             auto negotiatedProtocol = rpc::negotiate(op->connection().serverProtocols(),
@@ -229,14 +229,24 @@ void NetworkInterfaceASIO::_completeOperation(AsyncOp* op, const ResponseStatus&
 
 void NetworkInterfaceASIO::_asyncRunCommand(AsyncCommand* cmd, NetworkOpHandler handler) {
     // We invert the following steps below to run a command:
-    // 1 - send the given command
+    // 1 - compress and send the given command
     // 2 - receive a header for the response
     // 3 - validate and receive response body
-    // 4 - advance the state machine by calling handler()
+    // 4 - decompress the response and advance the state machine by calling handler()
 
     // Step 4
-    auto recvMessageCallback =
-        [this, cmd, handler](std::error_code ec, size_t bytes) { handler(ec, bytes); };
+    auto recvMessageCallback = [this, cmd, handler](std::error_code ec, size_t bytes) {
+        if (ec == ErrorCodes::OK && cmd->toRecv().operation() == dbCompressed) {
+            Message decompressed;
+            Status status =
+                cmd->conn().compressorManager().decompressMessage(cmd->toRecv(), &decompressed);
+            if (!status.isOK())
+                return handler(make_error_code(status.code()), bytes);
+            cmd->toRecv().reset();
+            cmd->toRecv() = std::move(decompressed);
+        }
+        handler(ec, bytes);
+    };
 
     // Step 3
     auto recvHeaderCallback = [this, cmd, handler, recvMessageCallback](std::error_code ec,
@@ -268,6 +278,15 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncCommand* cmd, NetworkOpHandler
     };
 
     // Step 1
+    auto& compressorManager = cmd->conn().compressorManager();
+    if (compressorManager.getNegotiatedCompressor()) {
+        Message compressed;
+        Status status = compressorManager.compressMessage(cmd->toSend(), &compressed);
+        if (!status.isOK())
+            return handler(make_error_code(status.code()), 0);
+        cmd->toSend().reset();
+        cmd->toSend() = std::move(compressed);
+    }
     asyncSendMessage(cmd->conn().stream(), &cmd->toSend(), std::move(sendMessageCallback));
 }
 
@@ -179,10 +179,12 @@ void ChunkManager::loadExistingRanges(OperationContext* txn, const ChunkManager*
         ChunkMap chunkMap;
         set<ShardId> shardIds;
         ShardVersionMap shardVersions;
+        vector<ChunkRoutingTable::ChunkBounds> changedChunks;
 
         Timer t;
 
-        bool success = _load(txn, chunkMap, shardIds, &shardVersions, oldManager);
+        bool success =
+            _load(txn, chunkMap, shardIds, &shardVersions, oldManager, &changedChunks);
         if (success) {
             log() << "ChunkManager: time to load chunks for " << _ns << ": " << t.millis() << "ms"
                   << " sequenceNumber: " << _sequenceNumber << " version: " << _version.toString()
@@ -195,6 +197,7 @@ void ChunkManager::loadExistingRanges(OperationContext* txn, const ChunkManager*
                 _shardIds.swap(shardIds);
                 _shardVersions.swap(shardVersions);
                 _chunkRanges.reloadAll(_chunkMap);
+                _buildRoutingTable(oldManager, changedChunks);
 
                 return;
             }
@@ -219,7 +222,8 @@ bool ChunkManager::_load(OperationContext* txn,
                          ChunkMap& chunkMap,
                          set<ShardId>& shardIds,
                          ShardVersionMap* shardVersions,
-                         const ChunkManager* oldManager) {
+                         const ChunkManager* oldManager,
+                         vector<ChunkRoutingTable::ChunkBounds>* changedChunks) {
     // Reset the max version, but not the epoch, when we aren't loading from the oldManager
     _version = ChunkVersion(0, 0, _version.epoch());
 
@@ -270,6 +274,12 @@ bool ChunkManager::_load(OperationContext* txn,
         LOG(2) << "loaded " << diffsApplied << " chunks into new chunk manager for " << _ns
                << " with version " << _version;
 
+        if (oldManager && oldManager->getVersion().isSet()) {
+            for (const auto& chunk : chunks) {
+                changedChunks->emplace_back(chunk.getMin(), chunk.getMax());
+            }
+        }
+
         // Add all existing shards we find to the shards set
         for (ShardVersionMap::iterator it = shardVersions->begin(); it != shardVersions->end();) {
             shared_ptr<Shard> shard = grid.shardRegistry()->getShard(it->first);
@@ -318,6 +328,53 @@ bool ChunkManager::_load(OperationContext* txn,
     }
 }
 
+void ChunkManager::_buildRoutingTable(const ChunkManager* oldManager,
+                                      const vector<ChunkRoutingTable::ChunkBounds>& changedChunks) {
+    // Splicing only copies the bounds of the chunks which didn't change, where building encodes
+    // every bound.
+    bool spliced = false;
+    if (oldManager && !changedChunks.empty() &&
+        oldManager->_routingTable.size() == oldManager->_chunkMap.size()) {
+        // The chunks which now cover the changed ranges. The diff may have returned both a chunk
+        // and its split children, so these are taken from the resulting chunk map.
+        vector<BSONObj> changedMaxKeys;
+        for (const auto& bounds : changedChunks) {
+            for (ChunkMap::const_iterator it = _chunkMap.upper_bound(bounds.first),
+                                          end = _chunkMap.upper_bound(bounds.second);
+                 it != end;
+                 ++it) {
+                changedMaxKeys.push_back(it->first);
+            }
+        }
+        _routingTable =
+            ChunkRoutingTable::splice(oldManager->_routingTable, changedChunks, changedMaxKeys);
+        spliced = true;
+
+        if (_routingTable.size() != _chunkMap.size()) {
+            warning() << "spliced routing table for " << _ns << " has " << _routingTable.size()
+                      << " chunks but the chunk map has " << _chunkMap.size()
+                      << ", rebuilding it";
+            spliced = false;
+        }
+    }
+
+    if (!spliced) {
+        vector<BSONObj> maxKeys;
+        maxKeys.reserve(_chunkMap.size());
+        for (const auto& chunkMapEntry : _chunkMap) {
+            maxKeys.push_back(chunkMapEntry.first);
+        }
+        _routingTable = ChunkRoutingTable(maxKeys);
+    }
+    invariant(_routingTable.size() == _chunkMap.size());
+
+    _routedChunks.clear();
+    _routedChunks.reserve(_chunkMap.size());
+    for (ChunkMap::const_iterator it = _chunkMap.begin(); it != _chunkMap.end(); ++it) {
+        _routedChunks.push_back(it);
+    }
+}
+
 shared_ptr<ChunkManager> ChunkManager::reload(OperationContext* txn, bool force) const {
     const NamespaceString nss(_ns);
     auto status = grid.catalogCache()->getDatabase(txn, nss.db().toString());
@@ -440,10 +497,10 @@ ChunkPtr ChunkManager::findIntersectingChunk(OperationContext* txn, const BSONOb
         BSONObj chunkMin;
         ChunkPtr chunk;
         {
-            ChunkMap::const_iterator it = _chunkMap.upper_bound(shardKey);
-            if (it != _chunkMap.end()) {
-                chunkMin = it->first;
-                chunk = it->second;
+            const size_t pos = _routingTable.findIntersecting(shardKey);
+            if (pos < _routedChunks.size()) {
+                chunkMin = _routedChunks[pos]->first;
+                chunk = _routedChunks[pos]->second;
             }
         }
 
@@ -34,6 +34,7 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/chunk_routing_table.h"
 #include "mongo/s/shard_key_pattern.h"
 
 namespace mongo {
@@ -244,12 +245,19 @@ public:
                                          bool force = true) const;  // doesn't modify self!
 
 private:
-    // returns true if load was consistent
+    // returns true if load was consistent. If the chunks were loaded as a diff against
+    // oldManager's, the bounds of the chunks which changed are added to changedChunks.
     bool _load(OperationContext* txn,
                ChunkMap& chunks,
                std::set<ShardId>& shardIds,
                ShardVersionMap* shardVersions,
-               const ChunkManager* oldManager);
+               const ChunkManager* oldManager,
+               std::vector<ChunkRoutingTable::ChunkBounds>* changedChunks);
+
+    // Builds the routing table for _chunkMap, by splicing changedChunks into oldManager's table
+    // if there are any, or from scratch otherwise.
+    void _buildRoutingTable(const ChunkManager* oldManager,
+                            const std::vector<ChunkRoutingTable::ChunkBounds>& changedChunks);
 
 
     // All members should be const for thread-safety
@@ -265,6 +273,11 @@ private:
     ChunkMap _chunkMap;
     ChunkRangeManager _chunkRanges;
 
+    // Finds chunks for findIntersectingChunk. The chunk at each position in the table is at the
+    // same position in _routedChunks.
+    ChunkRoutingTable _routingTable;
+    std::vector<ChunkMap::const_iterator> _routedChunks;
+
     std::set<ShardId> _shardIds;
 
     // Max known version per shard
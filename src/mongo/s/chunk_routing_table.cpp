@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_routing_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Shard key values are compared in ascending order regardless of the key pattern, the same as
+// BSONObjCmp does for a ChunkMap.
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
+/**
+ * Encodes 'key' without its field names, which KeyString only accepts for index keys.
+ */
+void encodeKey(const BSONObj& key, KeyString* encoded) {
+    BSONObjBuilder unnamed(key.objsize());
+    BSONObjIterator it(key);
+    while (it.more()) {
+        unnamed.appendAs(it.next(), "");
+    }
+    encoded->resetToKey(unnamed.done(), kAllAscending);
+}
+
+int compareKeys(const char* left, size_t leftSize, const char* right, size_t rightSize) {
+    const int cmp = memcmp(left, right, std::min(leftSize, rightSize));
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    if (leftSize == rightSize) {
+        return 0;
+    }
+    return leftSize < rightSize ? -1 : 1;
+}
+
+}  // namespace
+
+ChunkRoutingTable::ChunkRoutingTable(const vector<BSONObj>& maxKeys) {
+    _offsets.reserve(maxKeys.size() + 1);
+
+    KeyString encoded;
+    for (const auto& maxKey : maxKeys) {
+        encodeKey(maxKey, &encoded);
+        dassert(empty() ||
+                compareKeys(_keyData(size() - 1),
+                            _keySize(size() - 1),
+                            encoded.getBuffer(),
+                            encoded.getSize()) < 0);
+        _append(encoded.getBuffer(), encoded.getSize());
+    }
+}
+
+ChunkRoutingTable ChunkRoutingTable::splice(const ChunkRoutingTable& previous,
+                                            const vector<ChunkBounds>& changed,
+                                            const vector<BSONObj>& changedMaxKeys) {
+    vector<bool> dropped(previous.size(), false);
+
+    KeyString min;
+    KeyString max;
+    for (const auto& bounds : changed) {
+        encodeKey(bounds.first, &min);
+        encodeKey(bounds.second, &max);
+
+        for (size_t i = previous._upperBound(min), end = previous._upperBound(max); i < end; ++i) {
+            dropped[i] = true;
+        }
+    }
+
+    vector<string> added;
+    added.reserve(changedMaxKeys.size());
+    for (const auto& maxKey : changedMaxKeys) {
+        encodeKey(maxKey, &max);
+        added.emplace_back(max.getBuffer(), max.getSize());
+    }
+
+    // std::string orders its bytes as unsigned, the same as memcmp().
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+
+    ChunkRoutingTable spliced;
+    spliced._keys.reserve(previous._keys.size());
+    spliced._offsets.reserve(previous._offsets.size() + added.size());
+
+    size_t i = 0;
+    auto addedIt = added.begin();
+    while (i < previous.size() || addedIt != added.end()) {
+        if (i < previous.size() && dropped[i]) {
+            ++i;
+            continue;
+        }
+
+        if (addedIt == added.end() ||
+            (i < previous.size() &&
+             compareKeys(previous._keyData(i),
+                         previous._keySize(i),
+                         addedIt->data(),
+                         addedIt->size()) < 0)) {
+            spliced._append(previous._keyData(i), previous._keySize(i));
+            ++i;
+        } else {
+            spliced._append(addedIt->data(), addedIt->size());
+            ++addedIt;
+        }
+    }
+
+    return spliced;
+}
+
+size_t ChunkRoutingTable::findIntersecting(const BSONObj& shardKey) const {
+    KeyString encoded;
+    encodeKey(shardKey, &encoded);
+    return _upperBound(encoded);
+}
+
+size_t ChunkRoutingTable::_upperBound(const KeyString& key) const {
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (compareKeys(_keyData(mid), _keySize(mid), key.getBuffer(), key.getSize()) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void ChunkRoutingTable::_append(const char* data, size_t size) {
+    if (_offsets.empty()) {
+        _offsets.push_back(0);
+    }
+
+    _keys.append(data, size);
+    invariant(_keys.size() <= std::numeric_limits<uint32_t>::max());
+    _offsets.push_back(_keys.size());
+}
+
+}  // namespace mongo
@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/storage/key_string.h"
+
+namespace mongo {
+
+/**
+ * The upper bounds of a collection's chunks, KeyString encoded and sorted, for finding the chunk
+ * which contains a shard key without comparing BSON.
+ *
+ * Chunks are identified by their position in ascending order of their bounds, which is the same
+ * as their order in a ChunkMap. The encoded bounds are kept back to back in a single buffer, so
+ * a lookup is a binary search of memcmp() calls over memory which is mostly contiguous.
+ *
+ * All bounds and keys must have the fields of the shard key pattern, in order. Field names are
+ * not encoded.
+ */
+class ChunkRoutingTable {
+public:
+    /**
+     * A chunk changed by a reload, as [min, max).
+     */
+    typedef std::pair<BSONObj, BSONObj> ChunkBounds;
+
+    ChunkRoutingTable() = default;
+
+    /**
+     * Builds a table from the upper bounds of all chunks, which must be in ascending order.
+     */
+    explicit ChunkRoutingTable(const std::vector<BSONObj>& maxKeys);
+
+    /**
+     * Returns a copy of 'previous' with the chunks in 'changed' spliced in. Every chunk whose
+     * upper bound falls in (min, max] of a changed chunk is dropped, the same way that
+     * ConfigDiffTracker removes overlapping chunks from a ChunkMap, and 'changedMaxKeys' are
+     * added. The bounds which didn't change are copied rather than encoded again.
+     *
+     * 'changedMaxKeys' are the upper bounds of the chunks which cover the changed ranges once the
+     * diff is applied, in any order and possibly repeated. They must come from the reloaded
+     * ChunkMap rather than from 'changed' itself, since the config diff query can return both a
+     * chunk and the chunks it was split into.
+     */
+    static ChunkRoutingTable splice(const ChunkRoutingTable& previous,
+                                    const std::vector<ChunkBounds>& changed,
+                                    const std::vector<BSONObj>& changedMaxKeys);
+
+    /**
+     * Returns the position of the chunk which contains 'shardKey', which is the first chunk whose
+     * upper bound is greater than it, or size() if there is none.
+     */
+    size_t findIntersecting(const BSONObj& shardKey) const;
+
+    size_t size() const {
+        return _offsets.empty() ? 0 : _offsets.size() - 1;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    /**
+     * Returns the position of the first upper bound greater than 'key'.
+     */
+    size_t _upperBound(const KeyString& key) const;
+
+    const char* _keyData(size_t i) const {
+        return _keys.data() + _offsets[i];
+    }
+
+    size_t _keySize(size_t i) const {
+        return _offsets[i + 1] - _offsets[i];
+    }
+
+    void _append(const char* data, size_t size);
+
+    // The encoded upper bounds of all chunks, back to back.
+    std::string _keys;
+
+    // The offset of each chunk's upper bound in '_keys', followed by the size of '_keys'.
+    std::vector<uint32_t> _offsets;
+};
+
+}  // namespace mongo
@@ -0,0 +1,243 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/next_prior.hpp>
+#include <map>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk_routing_table.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using std::map;
+using std::vector;
+
+const BSONObj kMin = BSON("a" << MINKEY);
+const BSONObj kMax = BSON("a" << MAXKEY);
+
+BSONObj key(int value) {
+    return BSON("a" << value);
+}
+
+/**
+ * Returns the upper bounds of chunks split at 'splitPoints', which must be ascending.
+ */
+vector<BSONObj> maxKeysFor(const vector<int>& splitPoints) {
+    vector<BSONObj> maxKeys;
+    for (int splitPoint : splitPoints) {
+        maxKeys.push_back(key(splitPoint));
+    }
+    maxKeys.push_back(kMax);
+    return maxKeys;
+}
+
+TEST(ChunkRoutingTable, Empty) {
+    ChunkRoutingTable table;
+    ASSERT(table.empty());
+    ASSERT_EQUALS(0U, table.findIntersecting(key(1)));
+}
+
+TEST(ChunkRoutingTable, SingleChunk) {
+    ChunkRoutingTable table(maxKeysFor({}));
+    ASSERT_EQUALS(1U, table.size());
+    ASSERT_EQUALS(0U, table.findIntersecting(kMin));
+    ASSERT_EQUALS(0U, table.findIntersecting(key(-100)));
+    ASSERT_EQUALS(0U, table.findIntersecting(BSON("a"
+                                                  << "string")));
+    ASSERT_EQUALS(1U, table.findIntersecting(kMax));
+}
+
+TEST(ChunkRoutingTable, FindsChunkContainingKey) {
+    ChunkRoutingTable table(maxKeysFor({0, 10, 20}));
+    ASSERT_EQUALS(4U, table.size());
+
+    ASSERT_EQUALS(0U, table.findIntersecting(kMin));
+    ASSERT_EQUALS(0U, table.findIntersecting(key(-1)));
+
+    // Chunks include their min and exclude their max.
+    ASSERT_EQUALS(1U, table.findIntersecting(key(0)));
+    ASSERT_EQUALS(1U, table.findIntersecting(key(9)));
+    ASSERT_EQUALS(2U, table.findIntersecting(key(10)));
+    ASSERT_EQUALS(3U, table.findIntersecting(key(20)));
+    ASSERT_EQUALS(3U, table.findIntersecting(BSON("a"
+                                                  << "string")));
+}
+
+TEST(ChunkRoutingTable, NumbersCompareByValue) {
+    ChunkRoutingTable table(maxKeysFor({0, 10}));
+
+    ASSERT_EQUALS(1U, table.findIntersecting(BSON("a" << 0.0)));
+    ASSERT_EQUALS(1U, table.findIntersecting(BSON("a" << 9.5)));
+    ASSERT_EQUALS(2U, table.findIntersecting(BSON("a" << 10LL)));
+    ASSERT_EQUALS(0U, table.findIntersecting(BSON("a" << -0.5)));
+}
+
+TEST(ChunkRoutingTable, CompoundKeys) {
+    ChunkRoutingTable table({BSON("a" << 1 << "b" << 5),
+                             BSON("a" << 2 << "b" << MINKEY),
+                             BSON("a" << MAXKEY << "b" << MAXKEY)});
+
+    ASSERT_EQUALS(0U, table.findIntersecting(BSON("a" << 1 << "b" << 4)));
+    ASSERT_EQUALS(1U, table.findIntersecting(BSON("a" << 1 << "b" << 5)));
+    ASSERT_EQUALS(1U, table.findIntersecting(BSON("a" << 1 << "b" << MAXKEY)));
+    ASSERT_EQUALS(2U, table.findIntersecting(BSON("a" << 2 << "b" << MINKEY)));
+}
+
+TEST(ChunkRoutingTable, SpliceSplit) {
+    ChunkRoutingTable table(maxKeysFor({10}));
+
+    // Split [MinKey, 10) at 5. Both halves are reported as changed.
+    ChunkRoutingTable spliced =
+        ChunkRoutingTable::splice(table, {{kMin, key(5)}, {key(5), key(10)}}, {key(5), key(10)});
+    ASSERT_EQUALS(3U, spliced.size());
+    ASSERT_EQUALS(0U, spliced.findIntersecting(key(4)));
+    ASSERT_EQUALS(1U, spliced.findIntersecting(key(5)));
+    ASSERT_EQUALS(2U, spliced.findIntersecting(key(10)));
+
+    // The original table is unchanged.
+    ASSERT_EQUALS(2U, table.size());
+    ASSERT_EQUALS(0U, table.findIntersecting(key(5)));
+}
+
+TEST(ChunkRoutingTable, SpliceMerge) {
+    ChunkRoutingTable table(maxKeysFor({0, 10, 20, 30}));
+
+    ChunkRoutingTable spliced = ChunkRoutingTable::splice(table, {{key(0), key(30)}}, {key(30)});
+    ASSERT_EQUALS(3U, spliced.size());
+    ASSERT_EQUALS(0U, spliced.findIntersecting(key(-1)));
+    ASSERT_EQUALS(1U, spliced.findIntersecting(key(0)));
+    ASSERT_EQUALS(1U, spliced.findIntersecting(key(29)));
+    ASSERT_EQUALS(2U, spliced.findIntersecting(key(30)));
+}
+
+TEST(ChunkRoutingTable, SpliceUnchangedBounds) {
+    ChunkRoutingTable table(maxKeysFor({0, 10}));
+
+    // A migration changes only the version of a chunk, which replaces it with itself.
+    ChunkRoutingTable spliced = ChunkRoutingTable::splice(table, {{key(0), key(10)}}, {key(10)});
+    ASSERT_EQUALS(3U, spliced.size());
+    ASSERT_EQUALS(1U, spliced.findIntersecting(key(5)));
+    ASSERT_EQUALS(2U, spliced.findIntersecting(key(10)));
+}
+
+TEST(ChunkRoutingTable, SpliceOverlappingChangedChunks) {
+    ChunkRoutingTable table(maxKeysFor({10}));
+
+    // A non-snapshot diff query returned both [MinKey, 10) and the chunks it was split into. The
+    // chunk map ends up with the split chunks, and so must the table.
+    ChunkRoutingTable spliced = ChunkRoutingTable::splice(
+        table,
+        {{kMin, key(10)}, {kMin, key(5)}, {key(5), key(10)}},
+        {key(5), key(10), key(5), key(10)});
+    ASSERT_EQUALS(3U, spliced.size());
+    ASSERT_EQUALS(0U, spliced.findIntersecting(key(4)));
+    ASSERT_EQUALS(1U, spliced.findIntersecting(key(5)));
+    ASSERT_EQUALS(1U, spliced.findIntersecting(key(9)));
+    ASSERT_EQUALS(2U, spliced.findIntersecting(key(10)));
+}
+
+TEST(ChunkRoutingTable, SpliceMatchesChunkMap) {
+    PseudoRandom random(1);
+
+    // Chunk bounds, keyed by max as in a ChunkMap.
+    map<BSONObj, BSONObj, BSONObjCmp> chunks;
+    chunks[kMax] = kMin;
+    ChunkRoutingTable table(vector<BSONObj>{kMax});
+
+    for (int round = 0; round < 200; ++round) {
+        // Each round either splits a chunk or merges a few, and reports the chunks which result
+        // as changed, the way a config diff does.
+        vector<ChunkRoutingTable::ChunkBounds> changed;
+
+        if (random.nextInt32(3) != 0 || chunks.size() < 3) {
+            const BSONObj point = key(random.nextInt32(1000));
+            auto it = chunks.upper_bound(point);
+            if (it->second.woCompare(point) == 0) {
+                continue;
+            }
+
+            const BSONObj min = it->second;
+            const BSONObj max = it->first;
+            chunks.erase(it);
+            chunks[point] = min;
+            chunks[max] = point;
+            changed.emplace_back(min, point);
+            changed.emplace_back(point, max);
+        } else {
+            auto first = chunks.upper_bound(key(random.nextInt32(1000)));
+            auto last = first;
+            for (int i = random.nextInt32(3); i > 0 && boost::next(last) != chunks.end(); --i) {
+                ++last;
+            }
+
+            const BSONObj min = first->second;
+            const BSONObj max = last->first;
+            chunks.erase(first, boost::next(last));
+            chunks[max] = min;
+            changed.emplace_back(min, max);
+        }
+
+        vector<BSONObj> changedMaxKeys;
+        for (const auto& bounds : changed) {
+            const auto end = chunks.upper_bound(bounds.second);
+            for (auto it = chunks.upper_bound(bounds.first); it != end; ++it) {
+                changedMaxKeys.push_back(it->first);
+            }
+        }
+
+        table = ChunkRoutingTable::splice(table, changed, changedMaxKeys);
+        ASSERT_EQUALS(chunks.size(), table.size());
+
+        for (int i = 0; i < 20; ++i) {
+            const BSONObj point = key(random.nextInt32(1100) - 50);
+            const auto it = chunks.upper_bound(point);
+            ASSERT_EQUALS(static_cast<size_t>(std::distance(chunks.begin(), it)),
+                          table.findIntersecting(point));
+        }
+    }
+
+    // Splicing gives the same table as building from scratch.
+    vector<BSONObj> maxKeys;
+    for (const auto& chunk : chunks) {
+        maxKeys.push_back(chunk.first);
+    }
+    ChunkRoutingTable built(maxKeys);
+    ASSERT_EQUALS(built.size(), table.size());
+    for (const auto& chunk : chunks) {
+        ASSERT_EQUALS(built.findIntersecting(chunk.second), table.findIntersecting(chunk.second));
+    }
+}
+
+}  // namespace
+}  // namespace mongo
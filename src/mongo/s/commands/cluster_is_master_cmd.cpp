@@ -28,9 +28,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/write_ops/batched_command_request.h"
+#include "mongo/util/net/abstract_message_port.h"
 
 namespace mongo {
 namespace {
@@ -75,6 +78,10 @@ public:
         result.append("maxWireVersion", maxWireVersion);
         result.append("minWireVersion", minWireVersion);
 
+        if (AbstractMessagingPort* port = txn->getClient()->port()) {
+            port->compressorManager().serverNegotiate(cmdObj, &result);
+        }
+
         return true;
     }
 
@@ -42,6 +42,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/platform/random.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/catalog/catalog_cache.h"
@@ -64,6 +65,10 @@ using std::vector;
 
 namespace {
 
+// Whether a $group is merged on every shard involved in an aggregation, each merging the groups
+// whose _id hashes to its partition, rather than all on one shard.
+MONGO_EXPORT_SERVER_PARAMETER(clusterAggregationPartitionedMerge, bool, false);
+
 /**
  * Implements the aggregation (pipeline command for sharding).
  */
@@ -150,31 +155,63 @@ public:
         // 'pipeline' will become the merger side.
         intrusive_ptr<Pipeline> shardPipeline(needSplit ? pipeline->splitForSharded() : pipeline);
 
+        // If the merge is a $group, it can be split across all of the shards which run the
+        // pipeline, with each merging the groups in one partition of the shards' results. The
+        // shards hold their results in memory to partition them, so when the client allows the
+        // merge to spill to disk it runs on a single shard instead.
+        int numPartitions = 0;
+        if (needSplit && !needPrimaryShardMerger && !pipeline->isExplain() &&
+            !mergeCtx->extSortAllowed && clusterAggregationPartitionedMerge &&
+            pipeline->canMergeInPartitions()) {
+            std::set<ShardId> shardIds;
+            chunkMgr->getShardIdsForQuery(shardIds, shardPipeline->getInitialQuery());
+            if (shardIds.size() > 1) {
+                numPartitions = shardIds.size();
+            }
+        }
+
         // Create the command for the shards. The 'fromRouter' field means produce output to
         // be merged.
-        MutableDocument commandBuilder(shardPipeline->serialize());
-        if (needSplit) {
-            commandBuilder.setField("fromRouter", Value(true));
-            commandBuilder.setField("cursor", Value(DOC("batchSize" << 0)));
-        } else {
-            commandBuilder.setField("cursor", Value(cmdObj["cursor"]));
-        }
+        vector<Strategy::CommandResult> shardResults;
+        auto runOnShards = [&] {
+            MutableDocument commandBuilder(shardPipeline->serialize());
+            if (needSplit) {
+                commandBuilder.setField("fromRouter", Value(true));
+                commandBuilder.setField("cursor", Value(DOC("batchSize" << 0)));
+                if (numPartitions > 0) {
+                    commandBuilder.setField(Pipeline::partitionOutputName, Value(numPartitions));
+                }
+            } else {
+                commandBuilder.setField("cursor", Value(cmdObj["cursor"]));
+            }
 
-        const std::initializer_list<StringData> fieldsToPropagateToShards = {
-            "$queryOptions", "$readMajorityTemporaryName", LiteParsedQuery::cmdOptionMaxTimeMS,
-        };
-        for (auto&& field : fieldsToPropagateToShards) {
-            commandBuilder[field] = Value(cmdObj[field]);
-        }
+            const std::initializer_list<StringData> fieldsToPropagateToShards = {
+                "$queryOptions", "$readMajorityTemporaryName", LiteParsedQuery::cmdOptionMaxTimeMS,
+            };
+            for (auto&& field : fieldsToPropagateToShards) {
+                commandBuilder[field] = Value(cmdObj[field]);
+            }
 
-        BSONObj shardedCommand = commandBuilder.freeze().toBson();
-        BSONObj shardQuery = shardPipeline->getInitialQuery();
+            BSONObj shardedCommand = commandBuilder.freeze().toBson();
+            BSONObj shardQuery = shardPipeline->getInitialQuery();
 
-        // Run the command on the shards
-        // TODO need to make sure cursors are killed if a retry is needed
-        vector<Strategy::CommandResult> shardResults;
-        Strategy::commandOp(
-            txn, dbname, shardedCommand, options, fullns, shardQuery, &shardResults);
+            // Run the command on the shards
+            // TODO need to make sure cursors are killed if a retry is needed
+            shardResults.clear();
+            Strategy::commandOp(
+                txn, dbname, shardedCommand, options, fullns, shardQuery, &shardResults);
+        };
+        runOnShards();
+
+        if (numPartitions > 0 && partitionedOutputTooLarge(shardResults)) {
+            // Some shard couldn't hold its results in memory to partition them. Run the
+            // aggregation again with a single merger, as if partitioned merges were off.
+            log() << "merging aggregation on " << fullns << " on a single shard, since the "
+                  << "shards' results were too large to partition";
+            killAllCursors(shardResults);
+            numPartitions = 0;
+            runOnShards();
+        }
 
         if (pipeline->isExplain()) {
             // This must be checked before we start modifying result.
@@ -206,6 +243,11 @@ public:
             return reply["ok"].trueValue();
         }
 
+        if (numPartitions > 0) {
+            return runPartitionedMerge(
+                txn, dbname, cmdObj, options, pipeline, mergeCtx, shardResults, fullns, result);
+        }
+
         DocumentSourceMergeCursors::CursorIds cursorIds = parseCursors(shardResults, fullns);
         pipeline->addInitialSource(DocumentSourceMergeCursors::create(cursorIds, mergeCtx));
 
@@ -251,6 +293,56 @@ private:
     DocumentSourceMergeCursors::CursorIds parseCursors(
         const vector<Strategy::CommandResult>& shardResults, const string& fullns);
 
+    /**
+     * Throws the error of the shard command that produced shardResults[i], if it failed.
+     */
+    void uassertShardResultOK(const vector<Strategy::CommandResult>& shardResults, size_t i);
+
+    /**
+     * Checks that 'cursor', returned by the shard of 'shardResult', is an open cursor on 'fullns'
+     * that returned no documents yet, and returns its id.
+     */
+    CursorId checkShardCursor(const Strategy::CommandResult& shardResult,
+                              const BSONObj& cursor,
+                              const string& fullns);
+
+    /**
+     * Returns whether a shard asked to partition its output failed because its results didn't
+     * fit in the memory it may use to partition them.
+     */
+    static bool partitionedOutputTooLarge(const vector<Strategy::CommandResult>& shardResults);
+
+    /**
+     * Returns the cursors for each partition of the shards' results, when they were asked to
+     * partition their output.
+     */
+    vector<DocumentSourceMergeCursors::CursorIds> parsePartitionedCursors(
+        const vector<Strategy::CommandResult>& shardResults, const string& fullns);
+
+    /**
+     * Merges each partition of the shards' results on a different shard, and has one more shard
+     * return the merged partitions to the client through a single cursor.
+     */
+    bool runPartitionedMerge(OperationContext* txn,
+                             const string& dbname,
+                             const BSONObj& cmdObj,
+                             int options,
+                             const intrusive_ptr<Pipeline>& mergePipeline,
+                             const intrusive_ptr<ExpressionContext>& mergeCtx,
+                             const vector<Strategy::CommandResult>& shardResults,
+                             const string& fullns,
+                             BSONObjBuilder& result);
+
+    /**
+     * Starts the merge of one partition on 'shardId' and returns its cursor. Unlike
+     * aggRunCommand(), the cursor isn't registered with mongos, since only the final merger reads
+     * from it.
+     */
+    std::pair<ConnectionString, CursorId> startPartitionMerger(const ShardId& shardId,
+                                                               const string& db,
+                                                               BSONObj cmd,
+                                                               int queryOptions);
+
     void killAllCursors(const vector<Strategy::CommandResult>& shardResults);
     void uassertAllShardsSupportExplain(const vector<Strategy::CommandResult>& shardResults);
 
@@ -273,52 +365,226 @@ DocumentSourceMergeCursors::CursorIds PipelineCommand::parseCursors(
         DocumentSourceMergeCursors::CursorIds cursors;
 
         for (size_t i = 0; i < shardResults.size(); i++) {
-            BSONObj result = shardResults[i].result;
+            uassertShardResultOK(shardResults, i);
 
-            if (!result["ok"].trueValue()) {
-                // If the failure of the sharded command can be accounted to a single error,
-                // throw a UserException with that error code; otherwise, throw with a
-                // location uassert code.
-                int errCode = getUniqueCodeFromCommandResults(shardResults);
-                if (errCode == 0) {
-                    errCode = 17022;
-                }
+            const BSONObj cursor = shardResults[i].result["cursor"].Obj();
+            cursors.push_back(std::make_pair(shardResults[i].target,
+                                             checkShardCursor(shardResults[i], cursor, fullns)));
+        }
+
+        return cursors;
+    } catch (...) {
+        // Need to clean up any cursors we successfully created on the shards
+        killAllCursors(shardResults);
+        throw;
+    }
+}
+
+void PipelineCommand::uassertShardResultOK(const vector<Strategy::CommandResult>& shardResults,
+                                           size_t i) {
+    const BSONObj result = shardResults[i].result;
+    if (result["ok"].trueValue()) {
+        return;
+    }
+
+    // If the failure of the sharded command can be accounted to a single error, throw a
+    // UserException with that error code; otherwise, throw with a location uassert code.
+    int errCode = getUniqueCodeFromCommandResults(shardResults);
+    if (errCode == 0) {
+        errCode = 17022;
+    }
+
+    invariant(errCode == result["code"].numberInt() || errCode == 17022);
+    uasserted(errCode,
+              str::stream() << "sharded pipeline failed on shard "
+                            << shardResults[i].shardTargetId << ": " << result.toString());
+}
+
+CursorId PipelineCommand::checkShardCursor(const Strategy::CommandResult& shardResult,
+                                           const BSONObj& cursor,
+                                           const string& fullns) {
+    massert(17023,
+            str::stream() << "shard " << shardResult.shardTargetId
+                          << " returned non-empty first batch",
+            cursor["firstBatch"].Obj().isEmpty());
+
+    massert(17024,
+            str::stream() << "shard " << shardResult.shardTargetId << " returned cursorId 0",
+            cursor["id"].Long() != 0);
+
+    massert(17025,
+            str::stream() << "shard " << shardResult.shardTargetId
+                          << " returned different ns: " << cursor["ns"],
+            cursor["ns"].String() == fullns);
+
+    return cursor["id"].Long();
+}
+
+bool PipelineCommand::partitionedOutputTooLarge(
+    const vector<Strategy::CommandResult>& shardResults) {
+    // The code of the memory limit check in handlePartitionedCursorCommand() on mongod.
+    const int kPartitionedOutputTooLargeCode = 28794;
+
+    for (auto&& shardResult : shardResults) {
+        if (!shardResult.result["ok"].trueValue() &&
+            shardResult.result["code"].numberInt() == kPartitionedOutputTooLargeCode) {
+            return true;
+        }
+    }
+    return false;
+}
 
-                invariant(errCode == result["code"].numberInt() || errCode == 17022);
-                uasserted(errCode,
-                          str::stream() << "sharded pipeline failed on shard "
-                                        << shardResults[i].shardTargetId << ": "
-                                        << result.toString());
+vector<DocumentSourceMergeCursors::CursorIds> PipelineCommand::parsePartitionedCursors(
+    const vector<Strategy::CommandResult>& shardResults, const string& fullns) {
+    try {
+        vector<DocumentSourceMergeCursors::CursorIds> partitions;
+
+        for (size_t i = 0; i < shardResults.size(); i++) {
+            uassertShardResultOK(shardResults, i);
+
+            vector<BSONElement> cursors = shardResults[i].result["cursors"].Array();
+            if (i == 0) {
+                partitions.resize(cursors.size());
             }
 
-            BSONObj cursor = result["cursor"].Obj();
+            massert(28797,
+                    str::stream() << "shard " << shardResults[i].shardTargetId << " returned "
+                                  << cursors.size() << " partitions rather than "
+                                  << partitions.size(),
+                    cursors.size() == partitions.size());
+
+            for (size_t p = 0; p < cursors.size(); p++) {
+                partitions[p].push_back(std::make_pair(
+                    shardResults[i].target,
+                    checkShardCursor(shardResults[i], cursors[p].Obj(), fullns)));
+            }
+        }
+
+        return partitions;
+    } catch (...) {
+        killAllCursors(shardResults);
+        throw;
+    }
+}
+
+bool PipelineCommand::runPartitionedMerge(OperationContext* txn,
+                                          const string& dbname,
+                                          const BSONObj& cmdObj,
+                                          int options,
+                                          const intrusive_ptr<Pipeline>& mergePipeline,
+                                          const intrusive_ptr<ExpressionContext>& mergeCtx,
+                                          const vector<Strategy::CommandResult>& shardResults,
+                                          const string& fullns,
+                                          BSONObjBuilder& result) {
+    const vector<DocumentSourceMergeCursors::CursorIds> partitions =
+        parsePartitionedCursors(shardResults, fullns);
+
+    const Document mergerSpec = mergePipeline->serialize();
+    const vector<Value>& mergerStages = mergerSpec["pipeline"].getArray();
+
+    // Both the partition mergers and the final merger get the client's options.
+    MutableDocument commonFields;
+    if (cmdObj.hasField("$queryOptions")) {
+        commonFields["$queryOptions"] = Value(cmdObj["$queryOptions"]);
+    }
+    if (cmdObj.hasField(LiteParsedQuery::cmdOptionMaxTimeMS)) {
+        commonFields[LiteParsedQuery::cmdOptionMaxTimeMS] =
+            Value(cmdObj[LiteParsedQuery::cmdOptionMaxTimeMS]);
+    }
+    const Document common = commonFields.freeze();
 
-            massert(17023,
-                    str::stream() << "shard " << shardResults[i].shardTargetId
-                                  << " returned non-empty first batch",
-                    cursor["firstBatch"].Obj().isEmpty());
+    DocumentSourceMergeCursors::CursorIds mergerCursors;
+    try {
+        // The partition mergers don't do any work until the final merger asks them all for their
+        // first batch at once, after which they run in parallel.
+        for (size_t p = 0; p < partitions.size(); p++) {
+            vector<Value> stages;
+            DocumentSourceMergeCursors::create(partitions[p], mergeCtx)->serializeToArray(stages);
+            stages.insert(stages.end(), mergerStages.begin(), mergerStages.end());
+
+            MutableDocument partitionCmd(mergerSpec);
+            partitionCmd["pipeline"] = Value(stages);
+            partitionCmd["cursor"] = Value(DOC("batchSize" << 0));
+            for (auto it = common.fieldIterator(); it.more();) {
+                const auto field = it.next();
+                partitionCmd[field.first] = field.second;
+            }
 
-            massert(17024,
-                    str::stream() << "shard " << shardResults[i].shardTargetId
-                                  << " returned cursorId 0",
-                    cursor["id"].Long() != 0);
+            const auto& shardId = shardResults[p % shardResults.size()].shardTargetId;
+            mergerCursors.push_back(startPartitionMerger(
+                shardId, dbname, partitionCmd.freeze().toBson(), options));
+        }
 
-            massert(17025,
-                    str::stream() << "shard " << shardResults[i].shardTargetId
-                                  << " returned different ns: " << cursor["ns"],
-                    cursor["ns"].String() == fullns);
+        vector<Value> gatherStages;
+        DocumentSourceMergeCursors::create(mergerCursors, mergeCtx)->serializeToArray(gatherStages);
 
-            cursors.push_back(std::make_pair(shardResults[i].target, cursor["id"].Long()));
+        MutableDocument gatherCmd(mergerSpec);
+        gatherCmd["pipeline"] = Value(gatherStages);
+        gatherCmd["cursor"] = Value(cmdObj["cursor"]);
+        for (auto it = common.fieldIterator(); it.more();) {
+            const auto field = it.next();
+            gatherCmd[field.first] = field.second;
         }
 
-        return cursors;
+        auto& prng = txn->getClient()->getPrng();
+        const auto& gatheringShardId =
+            shardResults[prng.nextInt32(shardResults.size())].shardTargetId;
+        const auto gatheringShard = grid.shardRegistry()->getShard(gatheringShardId);
+        ShardConnection conn(gatheringShard->getConnString(), "");
+        BSONObj mergedResults =
+            aggRunCommand(conn.get(), dbname, gatherCmd.freeze().toBson(), options);
+        conn.done();
+
+        result.appendElements(mergedResults);
+        return mergedResults["ok"].trueValue();
     } catch (...) {
-        // Need to clean up any cursors we successfully created on the shards
+        // Best effort, as in killAllCursors(). Cursors which a partition merger already read
+        // from are gone by now, and the rest time out on the shards.
+        for (auto&& cursor : mergerCursors) {
+            try {
+                ScopedDbConnection conn(cursor.first);
+                conn->killCursor(cursor.second);
+                conn.done();
+            } catch (const DBException& e) {
+                log() << "Couldn't kill aggregation cursor on shard: " << cursor.first
+                      << " due to DBException: " << e.toString();
+            }
+        }
         killAllCursors(shardResults);
         throw;
     }
 }
 
+std::pair<ConnectionString, CursorId> PipelineCommand::startPartitionMerger(
+    const ShardId& shardId, const string& db, BSONObj cmd, int queryOptions) {
+    const auto shard = grid.shardRegistry()->getShard(shardId);
+    ShardConnection conn(shard->getConnString(), "");
+
+    auto cursor = conn->query(db + ".$cmd",
+                              cmd,
+                              -1,    // nToReturn
+                              0,     // nToSkip
+                              NULL,  // fieldsToReturn
+                              queryOptions);
+    massert(28798,
+            str::stream() << "aggregate command didn't return results on host: "
+                          << conn->toString(),
+            cursor && cursor->more());
+
+    BSONObj result = cursor->nextSafe().getOwned();
+    const ConnectionString host(HostAndPort(cursor->originalHost()));
+    conn.done();
+
+    uassertStatusOK(getStatusFromCommandResult(result));
+
+    const CursorId cursorId = result["cursor"]["id"].Long();
+    massert(28799,
+            str::stream() << "partition merger on shard " << shardId << " returned cursorId 0",
+            cursorId != 0);
+
+    return std::make_pair(host, cursorId);
+}
+
 void PipelineCommand::uassertAllShardsSupportExplain(
     const vector<Strategy::CommandResult>& shardResults) {
     for (size_t i = 0; i < shardResults.size(); i++) {
@@ -346,13 +612,21 @@ void PipelineCommand::killAllCursors(const vector<Strategy::CommandResult>& shar
                 continue;
             }
 
-            const long long cursor = result["cursor"]["id"].Long();
-            if (!cursor) {
-                continue;
+            vector<long long> cursors;
+            if (result.hasField("cursors")) {
+                for (auto&& cursor : result["cursors"].Array()) {
+                    cursors.push_back(cursor["id"].Long());
+                }
+            } else {
+                cursors.push_back(result["cursor"]["id"].Long());
             }
 
             ScopedDbConnection conn(shardResults[i].target);
-            conn->killCursor(cursor);
+            for (const long long cursor : cursors) {
+                if (cursor) {
+                    conn->killCursor(cursor);
+                }
+            }
             conn.done();
         } catch (const DBException& e) {
             log() << "Couldn't kill aggregation cursor on shard: " << shardResults[i].target
@@ -32,6 +32,7 @@
 
 #include "mongo/s/query/async_results_merger.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/getmore_response.h"
 #include "mongo/db/query/killcursors_request.h"
@@ -145,8 +146,7 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadySorted() {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    BSONObj front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    BSONObj front = _remotes[smallestRemote].popNext();
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -154,6 +154,7 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadySorted() {
         _mergeQueue.push(smallestRemote);
     }
 
+    readAhead_inlock(smallestRemote);
     return front;
 }
 
@@ -164,8 +165,8 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadyUnsorted() {
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            BSONObj front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            BSONObj front = _remotes[_gettingFromRemote].popNext();
+            readAhead_inlock(_gettingFromRemote);
             return front;
         }
 
@@ -201,9 +202,32 @@ Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.requestSentAt = _executor->now();
     return Status::OK();
 }
 
+void AsyncResultsMerger::readAhead_inlock(size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    if (_params.readAheadBatches <= 0 || _lifecycleState != kAlive || !remote.status.isOK()) {
+        return;
+    }
+
+    // Only getMores are sent ahead, once the remote has established its cursor.
+    if (!remote.cursorId || remote.exhausted() || remote.cbHandle.isValid()) {
+        return;
+    }
+
+    // The buffer holds the batch being returned, and those read ahead of it.
+    if (remote.batchesBuffered.size() > static_cast<size_t>(_params.readAheadBatches) ||
+        remote.bytesBuffered >= _params.maxBufferedBytesPerRemote) {
+        return;
+    }
+
+    // On failure, nextEvent() asks again once the buffer is empty, and reports the error then.
+    askForNextBatch_inlock(remoteIndex);
+}
+
 StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
@@ -221,12 +245,18 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent()
     }
 
     // Schedule remote work on hosts for which we need more results.
+    const Date_t now = _executor->now();
     for (size_t i = 0; i < _remotes.size(); ++i) {
         auto& remote = _remotes[i];
 
         // It is illegal to call this method if there is an error received from any shard.
         invariant(remote.status.isOK());
 
+        // The caller is about to wait for every remote with nothing buffered.
+        if (!remote.hasNext() && !remote.exhausted() && !remote.waitingSince) {
+            remote.waitingSince = now;
+        }
+
         if (!remote.hasNext() && !remote.exhausted() && !remote.cbHandle.isValid()) {
             // If we already have established a cursor with this remote, and there is no outstanding
             // request for which we have a valid callback handle, then schedule work to retrieve the
@@ -281,6 +311,13 @@ void AsyncResultsMerger::handleBatchResponse(
         return;
     }
 
+    const Date_t now = _executor->now();
+    remote.roundTripTime += now - remote.requestSentAt;
+    if (remote.waitingSince) {
+        remote.waitTime += now - *remote.waitingSince;
+        remote.waitingSince = boost::none;
+    }
+
     // Early return from this point on signal anyone waiting on an event, if ready() is true.
     ScopeGuard signaller = MakeGuard(&AsyncResultsMerger::signalCurrentEvent_inlock, this);
 
@@ -312,13 +349,11 @@ void AsyncResultsMerger::handleBatchResponse(
 
     remote.cursorId = getMoreResponse.cursorId;
 
-    for (const auto& obj : getMoreResponse.batch) {
-        remote.docBuffer.push(obj);
-    }
-
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
-    if (!_params.sort.isEmpty() && !getMoreResponse.batch.empty()) {
+    // merge queue. It is already there if this batch was read ahead of buffered results.
+    const bool wasInMergeQueue = remote.hasNext();
+    remote.bufferBatch(getMoreResponse.batch);
+    if (!_params.sort.isEmpty() && !wasInMergeQueue && remote.hasNext()) {
         _mergeQueue.push(remoteIndex);
     }
 
@@ -330,6 +365,8 @@ void AsyncResultsMerger::handleBatchResponse(
             remote.status = nextBatchStatus;
             return;
         }
+    } else {
+        readAhead_inlock(remoteIndex);
     }
 
     // ScopeGuard requires dismiss on success, but we want waiter to be signalled on success as
@@ -423,6 +460,21 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill() {
     return _killCursorsScheduledEvent;
 }
 
+void AsyncResultsMerger::appendStats(BSONObjBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    BSONArrayBuilder remotes(builder->subarrayStart("remotes"));
+    for (const auto& remote : _remotes) {
+        BSONObjBuilder remoteBuilder(remotes.subobjStart());
+        remoteBuilder.append("host", remote.hostAndPort.toString());
+        remoteBuilder.appendNumber("batches", remote.batchesReceived);
+        remoteBuilder.appendNumber("bytes", remote.bytesReceived);
+        remoteBuilder.appendNumber("roundTripMillis",
+                                   static_cast<long long>(remote.roundTripTime.count()));
+        remoteBuilder.appendNumber("waitMillis", static_cast<long long>(remote.waitTime.count()));
+    }
+}
+
 //
 // AsyncResultsMerger::RemoteCursorData
 //
@@ -439,6 +491,31 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
     return cursorId && (*cursorId == 0);
 }
 
+void AsyncResultsMerger::RemoteCursorData::bufferBatch(const std::vector<BSONObj>& batch) {
+    ++batchesReceived;
+    if (batch.empty()) {
+        return;
+    }
+
+    for (const auto& obj : batch) {
+        docBuffer.push(obj);
+        bytesBuffered += obj.objsize();
+        bytesReceived += obj.objsize();
+    }
+    batchesBuffered.push(batch.size());
+}
+
+BSONObj AsyncResultsMerger::RemoteCursorData::popNext() {
+    BSONObj front = docBuffer.front();
+    docBuffer.pop();
+
+    bytesBuffered -= front.objsize();
+    if (--batchesBuffered.front() == 0) {
+        batchesBuffered.pop();
+    }
+    return front;
+}
+
 //
 // AsyncResultsMerger::MergingComparator
 //
@@ -40,9 +40,12 @@
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
+
 /**
  * AsyncResultsMerger is used to generate results from cursor-generating commands on one or more
  * remote hosts. A cursor-generating command (e.g. the find command) is one that establishes a
@@ -61,6 +64,13 @@ namespace mongo {
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * Each remote has at most one request in flight, since a cursor serves one getMore at a time. To
+ * keep the merge from stalling for a round trip whenever a remote's buffer runs dry, the ARM asks
+ * for further batches while results are still buffered, up to 'readAheadBatches' batches and
+ * 'maxBufferedBytesPerRemote' bytes ahead of what has been returned. For each remote it counts
+ * the batches and bytes received, the time spent on round trips, and the time the caller spent
+ * waiting on it; see appendStats().
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -140,6 +150,13 @@ public:
      */
     executor::TaskExecutor::EventHandle kill();
 
+    /**
+     * Appends an array with an entry for each remote, giving its host, the number of batches and
+     * bytes received from it, the time spent waiting for its responses, and how much of that time
+     * the caller was blocked with nothing to return.
+     */
+    void appendStats(BSONObjBuilder* builder);
+
 private:
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
@@ -160,6 +177,16 @@ private:
          */
         bool exhausted() const;
 
+        /**
+         * Adds the results of a batch to the end of the buffer.
+         */
+        void bufferBatch(const std::vector<BSONObj>& batch);
+
+        /**
+         * Removes and returns the next buffered result.
+         */
+        BSONObj popNext();
+
         HostAndPort hostAndPort;
         BSONObj cmdObj;
         boost::optional<CursorId> cursorId;
@@ -169,6 +196,18 @@ private:
 
         // Set to true once we have heard from the remote node at least once.
         bool gotFirstResponse = false;
+
+        // The number of results left in each batch in 'docBuffer', oldest first, and their size.
+        std::queue<size_t> batchesBuffered;
+        long long bytesBuffered = 0;
+
+        // Statistics reported by appendStats().
+        long long batchesReceived = 0;
+        long long bytesReceived = 0;
+        Date_t requestSentAt;
+        Milliseconds roundTripTime{0};
+        boost::optional<Date_t> waitingSince;
+        Milliseconds waitTime{0};
     };
 
     class MergingComparator {
@@ -202,6 +241,14 @@ private:
      */
     Status askForNextBatch_inlock(size_t remoteIndex);
 
+    /**
+     * Asks the remote at 'remoteIndex' for its next batch if it still has results, no request is
+     * in flight, and it has room to buffer another batch ahead of the results being returned.
+     * Failing to schedule the request is not an error here; nextEvent() will try again once the
+     * remote's buffer is empty.
+     */
+    void readAhead_inlock(size_t remoteIndex);
+
     //
     // Helpers for ready().
     //
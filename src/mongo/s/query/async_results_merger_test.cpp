@@ -81,6 +81,8 @@ protected:
         params.limit = lpq->getLimit();
         params.batchSize = getMoreBatchSize ? getMoreBatchSize : lpq->getBatchSize();
         params.skip = lpq->getSkip();
+        params.readAheadBatches = readAheadBatches;
+        params.maxBufferedBytesPerRemote = maxBufferedBytesPerRemote;
 
         for (const auto& hostAndPort : remotes) {
             ClusterClientCursorParams::Remote remoteParams;
@@ -145,6 +147,32 @@ protected:
         net->exitNetwork();
     }
 
+    bool hasReadyRequests() {
+        executor::NetworkInterfaceMock* net = getNet();
+        net->enterNetwork();
+        bool hasReadyRequests = net->hasReadyRequests();
+        net->exitNetwork();
+        return hasReadyRequests;
+    }
+
+    /**
+     * Returns the remaining results of 'arm', waiting for batches as needed, up to and including
+     * the boost::none which marks the end of the stream.
+     */
+    std::vector<BSONObj> drainResults() {
+        std::vector<BSONObj> results;
+        while (true) {
+            if (!arm->ready()) {
+                executor->waitForEvent(unittest::assertGet(arm->nextEvent()));
+            }
+            auto next = unittest::assertGet(arm->nextReady());
+            if (!next) {
+                return results;
+            }
+            results.push_back(*next);
+        }
+    }
+
     const NamespaceString _nss;
     const std::vector<HostAndPort> _remotes;
 
@@ -153,6 +181,10 @@ protected:
 
     ClusterClientCursorParams params;
     std::unique_ptr<AsyncResultsMerger> arm;
+
+    // Applied to the params of the next ARM made by makeCursorFromFindCmd().
+    int readAheadBatches = 0;
+    long long maxBufferedBytesPerRemote = 16 * 1024 * 1024;
 };
 
 TEST_F(AsyncResultsMergerTest, ClusterFind) {
@@ -735,6 +767,136 @@ TEST_F(AsyncResultsMergerTest, KillCalledTwice) {
     executor->waitForEvent(killedEvent2);
 }
 
+TEST_F(AsyncResultsMergerTest, ReadAheadRequestsNextBatchBeforeBufferDrains) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 2}");
+    readAheadBatches = 1;
+    makeCursorFromFindCmd(findCmd, {_remotes[0]});
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<GetMoreResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(10), batch1);
+    scheduleNetworkResponses(responses);
+    executor->waitForEvent(readyEvent);
+
+    // The getMore for the second batch is sent while the first is still buffered.
+    ASSERT_TRUE(arm->ready());
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(responses);
+
+    auto results = drainResults();
+    ASSERT_EQ(4U, results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_EQ(BSON("_id" << static_cast<int>(i + 1)), results[i]);
+    }
+    ASSERT_FALSE(hasReadyRequests());
+
+    BSONObjBuilder statsBuilder;
+    arm->appendStats(&statsBuilder);
+    BSONObj stats = statsBuilder.obj();
+    std::vector<BSONElement> remoteStats = stats["remotes"].Array();
+    ASSERT_EQ(1U, remoteStats.size());
+    ASSERT_EQ(_remotes[0].toString(), remoteStats[0]["host"].str());
+    ASSERT_EQ(2, remoteStats[0]["batches"].numberLong());
+    ASSERT_EQ(4 * batch1[0].objsize(), remoteStats[0]["bytes"].numberLong());
+    ASSERT_TRUE(remoteStats[0]["roundTripMillis"].isNumber());
+    ASSERT_TRUE(remoteStats[0]["waitMillis"].isNumber());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadStopsAtBufferedBytesLimit) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 2}");
+    readAheadBatches = 1;
+    maxBufferedBytesPerRemote = 1;
+    makeCursorFromFindCmd(findCmd, {_remotes[0]});
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<GetMoreResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(10), batch1);
+    scheduleNetworkResponses(responses);
+    executor->waitForEvent(readyEvent);
+
+    // Nothing is read ahead until the buffered results are returned.
+    ASSERT_FALSE(hasReadyRequests());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(hasReadyRequests());
+    ASSERT_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(hasReadyRequests());
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(responses);
+
+    auto results = drainResults();
+    ASSERT_EQ(1U, results.size());
+    ASSERT_EQ(fromjson("{_id: 3}"), results[0]);
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadSortedMerge) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, batchSize: 2}");
+    readAheadBatches = 1;
+    makeCursorFromFindCmd(findCmd, {_remotes[0], _remotes[1]});
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<GetMoreResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 4}")};
+    responses.emplace_back(_nss, CursorId(10), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 2}"), fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(11), batch2);
+    scheduleNetworkResponses(responses);
+    executor->waitForEvent(readyEvent);
+
+    // Both remotes read ahead. Answer each by cursor id, since the order in which the getMores
+    // were sent depends on the order in which the first batches were handled.
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noi = net->getNextReadyRequest();
+        std::vector<BSONObj> batch;
+        if (noi->getRequest().cmdObj["getMore"].numberLong() == 10) {
+            batch = {fromjson("{_id: 5}"), fromjson("{_id: 7}")};
+        } else {
+            batch = {fromjson("{_id: 6}")};
+        }
+        GetMoreResponse response(_nss, CursorId(0), batch);
+        RemoteCommandResponse commandResponse(response.toBSON(), BSONObj(), Milliseconds(0));
+        net->scheduleResponse(
+            noi, net->now(), executor::TaskExecutor::ResponseStatus(commandResponse));
+    }
+    net->runReadyNetworkOperations();
+    net->exitNetwork();
+
+    // Each remote is merged once, even though its read ahead batch arrived while it was queued.
+    auto results = drainResults();
+    ASSERT_EQ(7U, results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_EQ(BSON("_id" << static_cast<int>(i + 1)), results[i]);
+    }
+}
+
+TEST_F(AsyncResultsMergerTest, KillWithOutstandingReadAhead) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 2}");
+    readAheadBatches = 1;
+    makeCursorFromFindCmd(findCmd, {_remotes[0]});
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<GetMoreResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(10), batch1);
+    scheduleNetworkResponses(responses);
+    executor->waitForEvent(readyEvent);
+    ASSERT_TRUE(hasReadyRequests());
+
+    // The kill waits for the getMore sent ahead to be cancelled.
+    auto killedEvent = arm->kill();
+    runReadyNetworkOperations();
+    executor->waitForEvent(killedEvent);
+}
+
 }  // namespace
 
 }  // namespace mongo
@@ -71,6 +71,14 @@ struct ClusterClientCursorParams {
     // Limits the number of results returned by the ClusterClientCursor to this many. Optional.
     // Should be forwarded to the remote hosts in 'cmdObj'.
     boost::optional<long long> limit;
+
+    // How many batches to request from each remote ahead of the one being returned. With zero, a
+    // remote is only asked for its next batch once all of its buffered results have been returned.
+    int readAheadBatches = 0;
+
+    // Reading ahead from a remote stops while at least this many bytes of its results are
+    // buffered.
+    long long maxBufferedBytesPerRemote = 16 * 1024 * 1024;
 };
 
 }  // mongo
@@ -32,6 +32,7 @@
 
 #include "mongo/s/query/cluster_find.h"
 
+#include <algorithm>
 #include <set>
 #include <vector>
 
@@ -41,6 +42,7 @@
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/getmore_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/client/shard_registry.h"
@@ -55,6 +57,12 @@ namespace mongo {
 
 namespace {
 
+// How many batches mongos requests from each shard ahead of the results it is returning, and the
+// most bytes of results it buffers from a shard before it stops reading ahead. See
+// AsyncResultsMerger.
+MONGO_EXPORT_SERVER_PARAMETER(clusterCursorReadAheadBatches, int, 1);
+MONGO_EXPORT_SERVER_PARAMETER(clusterCursorMaxBufferedBytesPerShard, int, 16 * 1024 * 1024);
+
 /**
  * Given the LiteParsedQuery 'lpq' being executed by mongos, returns a copy of the query which is
  * suitable for forwarding to the targeted hosts.
@@ -123,6 +131,8 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* txn,
     params.limit = query.getParsed().getLimit();
     params.sort = query.getParsed().getSort();
     params.skip = query.getParsed().getSkip();
+    params.readAheadBatches = std::max(0, clusterCursorReadAheadBatches);
+    params.maxBufferedBytesPerRemote = clusterCursorMaxBufferedBytesPerShard;
 
     const auto lpqToForward = transformQueryForShards(query.getParsed());
 
@@ -32,6 +32,8 @@
 
 #include "mongo/s/query/router_stage_merge.h"
 
+#include "mongo/db/jsobj.h"
+#include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -58,6 +60,12 @@ StatusWith<boost::optional<BSONObj>> RouterStageMerge::next() {
     auto statusWithNext = _arm.nextReady();
     if (statusWithNext.isOK()) {
         killer.Dismiss();
+
+        if (!statusWithNext.getValue() && shouldLog(logger::LogSeverity::Debug(1))) {
+            BSONObjBuilder stats;
+            _arm.appendStats(&stats);
+            LOG(1) << "merged results from remote cursors: " << stats.obj();
+        }
     }
     return statusWithNext;
 }
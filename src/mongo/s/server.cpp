@@ -119,6 +119,15 @@ static BSONObj buildErrReply(const DBException& ex) {
     return errB.obj();
 }
 
+/**
+ * The connection's Client, parked while a service executor worker is not servicing it.
+ */
+struct ClientSessionState : public MessageHandler::SessionState {
+    explicit ClientSessionState(ServiceContext::UniqueClient client) : client(std::move(client)) {}
+
+    ServiceContext::UniqueClient client;
+};
+
 class ShardedMessageHandler : public MessageHandler {
 public:
     virtual ~ShardedMessageHandler() {}
@@ -127,6 +136,18 @@ public:
         Client::initThread("conn", getGlobalServiceContext(), p);
     }
 
+    virtual std::unique_ptr<SessionState> suspend(AbstractMessagingPort* p) {
+        if (!haveClient()) {
+            return nullptr;
+        }
+        return stdx::make_unique<ClientSessionState>(Client::releaseCurrent());
+    }
+
+    virtual void resume(AbstractMessagingPort* p, std::unique_ptr<SessionState> state) {
+        invariant(state);
+        Client::setCurrent(std::move(static_cast<ClientSessionState*>(state.get())->client));
+    }
+
     virtual void process(Message& m, AbstractMessagingPort* p) {
         verify(p);
         Request r(m, p);
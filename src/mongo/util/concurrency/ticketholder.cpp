@@ -25,65 +25,79 @@
  *    then also delete it in the license file.
  */
 
-#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
-
 #include "mongo/platform/basic.h"
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
+#include <algorithm>
 
-#include "mongo/util/log.h"
+#include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
-#if defined(__linux__)
-namespace {
-void _check(int ret) {
-    if (ret == 0)
-        return;
-    int err = errno;
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
-}
-}
+struct TicketHolder::Waiter {
+    stdx::condition_variable cv;
+    Waiter* next = nullptr;
+    bool granted = false;  // Set by whoever hands this waiter its ticket.
+};
 
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    _check(sem_init(&_sem, 0, num));
-}
+TicketHolder::TicketHolder(int num) : _available(num), _outof(num) {}
 
 TicketHolder::~TicketHolder() {
-    _check(sem_destroy(&_sem));
+    invariant(!_queueHead);
 }
 
 bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        switch (errno) {
-            case EAGAIN:
-                return false;
-            case EINTR:
-                break;
-            default:
-                _check(-1);
-        }
-    }
+    // Queued waiters are first in line for any ticket that frees up.
+    if (_numWaiters.load() > 0 || !_tryAcquireAvailable())
+        return false;
+
+    _immediate.fetchAndAdd(1);
     return true;
 }
 
 void TicketHolder::waitForTicket() {
-    while (0 != sem_wait(&_sem)) {
-        switch (errno) {
-            case EINTR:
-                break;
-            default:
-                _check(-1);
+    if (tryAcquire())
+        return;
+
+    const unsigned long long start = curTimeMicros64();
+    Waiter self;
+    {
+        stdx::unique_lock<stdx::mutex> lk(_queueMutex);
+        _numWaiters.fetchAndAdd(1);
+
+        // A release() that ran since tryAcquire() failed may not have seen us waiting, so check
+        // again now that it would. The ticket is only ours if nobody is queued ahead of us.
+        if (!_queueHead && _tryAcquireAvailable()) {
+            _numWaiters.fetchAndSubtract(1);
+            _immediate.fetchAndAdd(1);
+            return;
+        }
+
+        if (_queueTail)
+            _queueTail->next = &self;
+        else
+            _queueHead = &self;
+        _queueTail = &self;
+
+        while (!self.granted) {
+            self.cv.wait(lk);
         }
     }
+
+    const unsigned long long end = curTimeMicros64();
+    _recordWait(end > start ? end - start : 0);
 }
 
 void TicketHolder::release() {
-    _check(sem_post(&_sem));
+    _available.fetchAndAdd(1);
+
+    // Waiters increment _numWaiters before checking _available, and we increment _available
+    // before checking _numWaiters, so at least one of us sees the other.
+    if (_numWaiters.load() > 0)
+        _grantToWaiters();
 }
 
 Status TicketHolder::resize(int newSize) {
@@ -91,111 +105,81 @@ Status TicketHolder::resize(int newSize) {
 
     if (newSize < 5)
         return Status(ErrorCodes::BadValue,
-                      str::stream() << "Minimum value for semaphore is 5; given " << newSize);
-
-    if (newSize > SEM_VALUE_MAX)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given " << newSize);
+                      str::stream() << "Minimum value for tickets is 5; given " << newSize);
 
-    while (_outof.load() < newSize) {
-        release();
-        _outof.fetchAndAdd(1);
-    }
+    const int delta = newSize - _outof.load();
+    _outof.store(newSize);
+    _available.fetchAndAdd(delta);
 
-    while (_outof.load() > newSize) {
-        waitForTicket();
-        _outof.subtractAndFetch(1);
-    }
+    if (delta > 0 && _numWaiters.load() > 0)
+        _grantToWaiters();
 
-    invariant(_outof.load() == newSize);
     return Status::OK();
 }
 
 int TicketHolder::available() const {
-    int val = 0;
-    _check(sem_getvalue(&_sem, &val));
-    return val;
+    return std::max(0, _available.load());
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return outof() - _available.load();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
-
-bool TicketHolder::tryAcquire() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
+int TicketHolder::waiters() const {
+    return _numWaiters.load();
 }
 
-void TicketHolder::waitForTicket() {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    while (!_tryAcquire()) {
-        _newTicket.wait(lk);
+TicketHolder::QueueStats TicketHolder::queueStats() const {
+    QueueStats stats;
+    stats.immediate = _immediate.load();
+    stats.queued = _queued.load();
+    stats.totalQueuedMicros = _totalQueuedMicros.load();
+    for (size_t i = 0; i < kNumWaitBuckets; i++) {
+        stats.waitBuckets[i] = _waitBuckets[i].load();
     }
+    return stats;
 }
 
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
+bool TicketHolder::_tryAcquireAvailable() {
+    int available = _available.load();
+    while (available > 0) {
+        const int old = _available.compareAndSwap(available, available - 1);
+        if (old == available)
+            return true;
+        available = old;
     }
-    _newTicket.notify_one();
+    return false;
 }
 
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+void TicketHolder::_grantToWaiters() {
+    stdx::lock_guard<stdx::mutex> lk(_queueMutex);
+    while (_queueHead && _tryAcquireAvailable()) {
+        Waiter* waiter = _queueHead;
+        _queueHead = waiter->next;
+        if (!_queueHead)
+            _queueTail = nullptr;
 
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
+        _numWaiters.fetchAndSubtract(1);
+        waiter->granted = true;
 
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+        // Notify while holding the lock: once it sees 'granted' the waiter may return and
+        // destroy its condition variable.
+        waiter->cv.notify_one();
     }
-
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
-}
-
-int TicketHolder::available() const {
-    return _num;
-}
-
-int TicketHolder::used() const {
-    return outof() - _num;
-}
-
-int TicketHolder::outof() const {
-    return _outof.load();
 }
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
+void TicketHolder::_recordWait(long long micros) {
+    size_t bucket = 0;
+    while (bucket + 1 < kNumWaitBuckets && (micros >> (bucket + 1)) > 0) {
+        bucket++;
     }
-    _num--;
-    return true;
+
+    _queued.fetchAndAdd(1);
+    _totalQueuedMicros.fetchAndAdd(micros);
+    _waitBuckets[bucket].fetchAndAdd(1);
 }
-#endif
 }
@@ -26,21 +26,43 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <cstddef>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+/**
+ * A counting semaphore that hands out a fixed number of tickets.
+ *
+ * Acquiring and releasing a ticket is a single atomic operation on the available count as long
+ * as a ticket is free. Callers of waitForTicket() that find none are queued and served in FIFO
+ * order: a released ticket goes to the oldest waiter, and new callers don't take tickets ahead
+ * of anyone already queued. The queue's mutex is only taken when somebody has to wait.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
 public:
+    /**
+     * Waits are counted in buckets of powers of two microseconds: bucket 0 holds waits shorter
+     * than 2 microseconds, bucket i >= 1 those in [2^i, 2^(i+1)), and the last bucket everything
+     * longer.
+     */
+    static const size_t kNumWaitBuckets = 24;
+
+    struct QueueStats {
+        long long immediate = 0;  // Tickets acquired without waiting.
+        long long queued = 0;     // Tickets acquired after waiting in the queue.
+        long long totalQueuedMicros = 0;
+        long long waitBuckets[kNumWaitBuckets] = {};
+    };
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
@@ -50,6 +72,10 @@ public:
 
     void release();
 
+    /**
+     * Changes the total number of tickets. Shrinking below the number in use doesn't wait: new
+     * tickets are only handed out again once enough of the outstanding ones are released.
+     */
     Status resize(int newSize);
 
     int available() const;
@@ -58,21 +84,42 @@ public:
 
     int outof() const;
 
+    /**
+     * Returns the number of callers currently queued in waitForTicket().
+     */
+    int waiters() const;
+
+    QueueStats queueStats() const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    struct Waiter;
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
+    /**
+     * Takes a ticket if one is available, regardless of anyone queued.
+     */
+    bool _tryAcquireAvailable();
+
+    /**
+     * Hands available tickets to queued waiters, oldest first.
+     */
+    void _grantToWaiters();
+
+    void _recordWait(long long micros);
+
+    // May go negative after a resize() below the number of tickets in use.
+    AtomicInt32 _available;
     AtomicInt32 _outof;
+    AtomicInt32 _numWaiters;
     stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
 
-    AtomicInt32 _outof;
-    int _num;
-    stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
-#endif
+    stdx::mutex _queueMutex;
+    Waiter* _queueHead = nullptr;  // Guarded by _queueMutex.
+    Waiter* _queueTail = nullptr;  // Guarded by _queueMutex.
+
+    AtomicInt64 _immediate;
+    AtomicInt64 _queued;
+    AtomicInt64 _totalQueuedMicros;
+    AtomicInt64 _waitBuckets[kNumWaitBuckets];
 };
 
 class ScopedTicket {
@@ -0,0 +1,172 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+const int kTickets = 5;
+
+void waitForWaiters(const TicketHolder& holder, int waiters) {
+    while (holder.waiters() != waiters) {
+        sleepmillis(1);
+    }
+}
+
+TEST(TicketHolderTest, AcquireAndRelease) {
+    TicketHolder holder(kTickets);
+    ASSERT_EQUALS(kTickets, holder.outof());
+    ASSERT_EQUALS(kTickets, holder.available());
+
+    for (int i = 0; i < kTickets; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+    ASSERT_FALSE(holder.tryAcquire());
+    ASSERT_EQUALS(0, holder.available());
+    ASSERT_EQUALS(kTickets, holder.used());
+
+    holder.release();
+    ASSERT_EQUALS(1, holder.available());
+    holder.waitForTicket();
+    ASSERT_EQUALS(0, holder.available());
+}
+
+TEST(TicketHolderTest, ResizeBelowUsed) {
+    TicketHolder holder(10);
+    for (int i = 0; i < 8; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    // Shrinking doesn't wait for the outstanding tickets.
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQUALS(5, holder.outof());
+    ASSERT_EQUALS(8, holder.used());
+    ASSERT_EQUALS(0, holder.available());
+
+    for (int i = 0; i < 3; i++) {
+        holder.release();
+        ASSERT_FALSE(holder.tryAcquire());
+    }
+    holder.release();
+    ASSERT_EQUALS(1, holder.available());
+    ASSERT(holder.tryAcquire());
+}
+
+TEST(TicketHolderTest, ResizeLimits) {
+    TicketHolder holder(kTickets);
+    ASSERT_NOT_OK(holder.resize(4));
+    ASSERT_EQUALS(kTickets, holder.outof());
+    ASSERT_OK(holder.resize(100));
+    ASSERT_EQUALS(100, holder.available());
+}
+
+TEST(TicketHolderTest, ResizeWakesWaiters) {
+    TicketHolder holder(kTickets);
+    for (int i = 0; i < kTickets; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    stdx::thread waiter([&holder] { holder.waitForTicket(); });
+    waitForWaiters(holder, 1);
+    ASSERT_OK(holder.resize(kTickets + 1));
+    waiter.join();
+    ASSERT_EQUALS(0, holder.available());
+    ASSERT_EQUALS(kTickets + 1, holder.used());
+}
+
+TEST(TicketHolderTest, WaitersAreServedInOrder) {
+    TicketHolder holder(kTickets);
+    for (int i = 0; i < kTickets; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    const int kWaiters = 4;
+    stdx::mutex mutex;
+    std::vector<int> order;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kWaiters; i++) {
+        threads.emplace_back([&, i] {
+            holder.waitForTicket();
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            order.push_back(i);
+        });
+        waitForWaiters(holder, i + 1);
+    }
+
+    for (int i = 0; i < kWaiters; i++) {
+        holder.release();
+        // The ticket went straight to a waiter, not to whoever asks next.
+        ASSERT_FALSE(holder.tryAcquire());
+        waitForWaiters(holder, kWaiters - i - 1);
+        threads[i].join();
+    }
+
+    ASSERT_EQUALS(static_cast<size_t>(kWaiters), order.size());
+    for (int i = 0; i < kWaiters; i++) {
+        ASSERT_EQUALS(i, order[i]);
+    }
+}
+
+TEST(TicketHolderTest, QueueStats) {
+    TicketHolder holder(kTickets);
+    for (int i = 0; i < kTickets; i++) {
+        holder.waitForTicket();
+    }
+
+    stdx::thread waiter([&holder] { holder.waitForTicket(); });
+    waitForWaiters(holder, 1);
+    sleepmillis(10);
+    holder.release();
+    waiter.join();
+
+    TicketHolder::QueueStats stats = holder.queueStats();
+    ASSERT_EQUALS(kTickets, stats.immediate);
+    ASSERT_EQUALS(1, stats.queued);
+    ASSERT_GREATER_THAN_OR_EQUALS(stats.totalQueuedMicros, 10 * 1000);
+
+    long long bucketTotal = 0;
+    for (size_t i = 0; i < TicketHolder::kNumWaitBuckets; i++) {
+        bucketTotal += stats.waitBuckets[i];
+        if (stats.waitBuckets[i]) {
+            // 2^13 micros <= 10ms
+            ASSERT_GREATER_THAN_OR_EQUALS(i, 13U);
+        }
+    }
+    ASSERT_EQUALS(1, bucketTotal);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -32,6 +32,7 @@
 
 #include "mongo/config.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor_manager.h"
 #include "mongo/util/net/sock.h"
 
 namespace mongo {
@@ -64,6 +65,13 @@ public:
     }
     void setConnectionId(long long connectionId);
 
+    /**
+     * The compressor negotiated for this connection by isMaster, if any.
+     */
+    MessageCompressorManager& compressorManager() {
+        return _compressorManager;
+    }
+
 public:
     // TODO make this private with some helpers
 
@@ -73,6 +81,7 @@ public:
 private:
     long long _connectionId;
     std::string _x509SubjectName;
+    MessageCompressorManager _compressorManager;
 };
 
 }  // namespace mongo
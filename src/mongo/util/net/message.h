@@ -67,6 +67,7 @@ enum Operations {
     dbKillCursors = 2007,
     dbCommand = 2008,
     dbCommandReply = 2009,
+    dbCompressed = 2012, /* another message compressed with a negotiated compressor */
 };
 
 bool doesOpGetAResponse(int op);
@@ -95,6 +96,8 @@ inline const char* opToString(int op) {
             return "command";
         case dbCommandReply:
             return "commandReply";
+        case dbCompressed:
+            return "compressed";
         default:
             massert(16141, str::stream() << "cannot translate opcode " << op, !op);
             return "";
@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Identifies the compressor used for the body of an OP_COMPRESSED message. These values are sent
+ * on the wire and must never change.
+ */
+enum class MessageCompressorId : uint8_t {
+    kNoop = 0,
+    kSnappy = 1,
+    kZlib = 2,
+};
+
+/**
+ * A compression algorithm which can be negotiated for the messages sent over a connection.
+ * Implementations must be thread safe; a single instance is shared by every connection.
+ *
+ * Each compressor counts the bytes it has consumed and produced and the time it has spent, in
+ * both directions, so that serverStatus can report what compression saves and what it costs.
+ */
+class MessageCompressorBase {
+    MONGO_DISALLOW_COPYING(MessageCompressorBase);
+
+public:
+    virtual ~MessageCompressorBase() = default;
+
+    const std::string& getName() const {
+        return _name;
+    }
+
+    MessageCompressorId getId() const {
+        return _id;
+    }
+
+    /**
+     * Returns the largest number of bytes compressData() may write for 'inputSize' bytes of input.
+     */
+    virtual std::size_t getMaxCompressedSize(std::size_t inputSize) const = 0;
+
+    /**
+     * Compresses 'inputSize' bytes at 'input' into the 'outputSize' bytes at 'output', and returns
+     * the number of bytes written.
+     */
+    StatusWith<std::size_t> compressData(const char* input,
+                                         std::size_t inputSize,
+                                         char* output,
+                                         std::size_t outputSize);
+
+    /**
+     * Decompresses 'inputSize' bytes at 'input' into the 'outputSize' bytes at 'output', and
+     * returns the number of bytes written. Fails if the input is corrupt or doesn't fit.
+     */
+    StatusWith<std::size_t> decompressData(const char* input,
+                                           std::size_t inputSize,
+                                           char* output,
+                                           std::size_t outputSize);
+
+    /**
+     * Appends the counters for both directions.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+protected:
+    MessageCompressorBase(MessageCompressorId id, std::string name)
+        : _id(id), _name(std::move(name)) {}
+
+    virtual StatusWith<std::size_t> _compress(const char* input,
+                                              std::size_t inputSize,
+                                              char* output,
+                                              std::size_t outputSize) = 0;
+
+    virtual StatusWith<std::size_t> _decompress(const char* input,
+                                                std::size_t inputSize,
+                                                char* output,
+                                                std::size_t outputSize) = 0;
+
+private:
+    struct Counters {
+        AtomicInt64 bytesIn;
+        AtomicInt64 bytesOut;
+        AtomicInt64 micros;
+    };
+
+    const MessageCompressorId _id;
+    const std::string _name;
+
+    Counters _compressor;
+    Counters _decompressor;
+};
+
+}  // namespace mongo
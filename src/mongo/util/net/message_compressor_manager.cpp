@@ -0,0 +1,218 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor_manager.h"
+
+#include <cstring>
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor_registry.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+namespace {
+
+const char kCompressionField[] = "compression";
+
+// Offsets of the fields which follow the header of an OP_COMPRESSED message.
+const std::size_t kOriginalOpCodeOffset = 0;
+const std::size_t kUncompressedSizeOffset = 4;
+const std::size_t kCompressorIdOffset = 8;
+
+}  // namespace
+
+MessageCompressorManager::MessageCompressorManager()
+    : MessageCompressorManager(&MessageCompressorRegistry::get()) {}
+
+MessageCompressorManager::MessageCompressorManager(MessageCompressorRegistry* registry)
+    : _registry(registry), _negotiated(nullptr) {}
+
+MessageCompressorManager::MessageCompressorManager(const MessageCompressorManager& other)
+    : _registry(other._registry), _negotiated(other._negotiated.load()) {}
+
+MessageCompressorManager& MessageCompressorManager::operator=(
+    const MessageCompressorManager& other) {
+    _registry = other._registry;
+    _negotiated.store(other._negotiated.load());
+    return *this;
+}
+
+void MessageCompressorManager::clientBegin(BSONObjBuilder* isMasterRequest) const {
+    const auto enabled = _registry->getEnabledCompressors();
+    if (enabled.empty()) {
+        return;
+    }
+    BSONArrayBuilder names(isMasterRequest->subarrayStart(kCompressionField));
+    for (auto compressor : enabled) {
+        names.append(compressor->getName());
+    }
+}
+
+void MessageCompressorManager::clientFinish(const BSONObj& isMasterReply) {
+    const BSONElement chosen = isMasterReply[kCompressionField];
+    if (chosen.type() != Array) {
+        return;
+    }
+    for (auto&& name : chosen.Obj()) {
+        if (name.type() != String) {
+            continue;
+        }
+        if (auto compressor = _registry->getCompressor(name.valueStringData())) {
+            _negotiated.store(compressor);
+            return;
+        }
+    }
+}
+
+void MessageCompressorManager::serverNegotiate(const BSONObj& isMasterRequest,
+                                               BSONObjBuilder* isMasterReply) {
+    const BSONElement offered = isMasterRequest[kCompressionField];
+    if (offered.eoo()) {
+        return;
+    }
+
+    MessageCompressorBase* chosen = nullptr;
+    if (offered.type() == Array) {
+        for (auto&& name : offered.Obj()) {
+            if (name.type() != String) {
+                continue;
+            }
+            if ((chosen = _registry->getCompressor(name.valueStringData()))) {
+                break;
+            }
+        }
+    }
+    _negotiated.store(chosen);
+
+    if (chosen) {
+        BSONArrayBuilder names(isMasterReply->subarrayStart(kCompressionField));
+        names.append(chosen->getName());
+    }
+}
+
+Status MessageCompressorManager::compressMessage(const Message& msg, Message* compressed) const {
+    MessageCompressorBase* const compressor = getNegotiatedCompressor();
+    invariant(compressor);
+
+    const MsgData::ConstView input = msg.singleData();
+    const std::size_t inputSize = input.dataLen();
+    const std::size_t maxOutputSize = compressor->getMaxCompressedSize(inputSize);
+
+    MsgData::View output = reinterpret_cast<char*>(
+        mongoMalloc(MsgData::MsgDataHeaderSize + kCompressionHeaderSize + maxOutputSize));
+    ScopeGuard guard = MakeGuard(free, output.view2ptr());
+
+    char* const body = output.data();
+    DataView(body).write(tagLittleEndian<int32_t>(input.getOperation()), kOriginalOpCodeOffset);
+    DataView(body).write(tagLittleEndian<int32_t>(inputSize), kUncompressedSizeOffset);
+    body[kCompressorIdOffset] = static_cast<char>(compressor->getId());
+
+    auto written = compressor->compressData(
+        input.data(), inputSize, body + kCompressionHeaderSize, maxOutputSize);
+    if (!written.isOK()) {
+        return written.getStatus();
+    }
+
+    output.setLen(MsgData::MsgDataHeaderSize + kCompressionHeaderSize + written.getValue());
+    output.setId(input.getId());
+    output.setResponseTo(input.getResponseTo());
+    output.setOperation(dbCompressed);
+
+    guard.Dismiss();
+    compressed->setData(output.view2ptr(), true);
+    return Status::OK();
+}
+
+Status MessageCompressorManager::decompressMessage(const Message& msg,
+                                                   Message* decompressed) const {
+    const MsgData::ConstView input = msg.singleData();
+    invariant(input.getOperation() == dbCompressed);
+
+    if (input.dataLen() < kCompressionHeaderSize) {
+        return {ErrorCodes::BadValue, "compressed message is too short"};
+    }
+
+    const ConstDataView body(input.data());
+    const int32_t originalOperation = body.read<LittleEndian<int32_t>>(kOriginalOpCodeOffset);
+    const int32_t uncompressedSize = body.read<LittleEndian<int32_t>>(kUncompressedSizeOffset);
+    const auto id =
+        static_cast<MessageCompressorId>(static_cast<uint8_t>(input.data()[kCompressorIdOffset]));
+
+    if (originalOperation == dbCompressed) {
+        return {ErrorCodes::BadValue, "compressed messages may not be nested"};
+    }
+    if (uncompressedSize < 0 ||
+        static_cast<std::size_t>(uncompressedSize) + MsgData::MsgDataHeaderSize >
+            MaxMessageSizeBytes) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "invalid uncompressed size " << uncompressedSize
+                              << " in compressed message"};
+    }
+
+    MessageCompressorBase* const compressor = _registry->getCompressor(id);
+    if (!compressor) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "received a message using compressor "
+                              << static_cast<int>(id) << ", which is not enabled"};
+    }
+
+    MsgData::View output =
+        reinterpret_cast<char*>(mongoMalloc(MsgData::MsgDataHeaderSize + uncompressedSize));
+    ScopeGuard guard = MakeGuard(free, output.view2ptr());
+
+    auto written = compressor->decompressData(input.data() + kCompressionHeaderSize,
+                                              input.dataLen() - kCompressionHeaderSize,
+                                              output.data(),
+                                              uncompressedSize);
+    if (!written.isOK()) {
+        return written.getStatus();
+    }
+    if (written.getValue() != static_cast<std::size_t>(uncompressedSize)) {
+        return {ErrorCodes::BadValue, "compressed message has the wrong uncompressed size"};
+    }
+
+    output.setLen(MsgData::MsgDataHeaderSize + uncompressedSize);
+    output.setId(input.getId());
+    output.setResponseTo(input.getResponseTo());
+    output.setOperation(originalOperation);
+
+    guard.Dismiss();
+    decompressed->setData(output.view2ptr(), true);
+    return Status::OK();
+}
+
+}  // namespace mongo
@@ -0,0 +1,112 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/net/message_compressor_base.h"
+
+namespace mongo {
+
+class BSONObj;
+class BSONObjBuilder;
+class Message;
+class MessageCompressorRegistry;
+
+/**
+ * Negotiates the compressor used by one connection, and wraps and unwraps the OP_COMPRESSED
+ * messages sent over it.
+ *
+ * The client offers the compressors it has enabled, most preferred first, as a "compression"
+ * array in its isMaster request. The server picks the first of them it has enabled too, starts
+ * compressing what it sends, and answers with a "compression" array holding only that name. The
+ * client compresses what it sends once it has read the answer. Either side decompresses any
+ * message which uses a compressor it has enabled, so the isMaster reply may already be
+ * compressed. A peer which doesn't know about compression never sends or receives the field and
+ * is never sent an OP_COMPRESSED message.
+ *
+ * An OP_COMPRESSED message has the usual header with opCode dbCompressed, followed by the
+ * original opCode (int32), the size of the original message without its header (int32), the
+ * compressor id (uint8) and the compressed bytes.
+ */
+class MessageCompressorManager {
+public:
+    // The size of the fields which follow the header of an OP_COMPRESSED message.
+    static const int kCompressionHeaderSize = 4 + 4 + 1;
+
+    MessageCompressorManager();
+    explicit MessageCompressorManager(MessageCompressorRegistry* registry);
+
+    MessageCompressorManager(const MessageCompressorManager& other);
+    MessageCompressorManager& operator=(const MessageCompressorManager& other);
+
+    /**
+     * Adds the compressors to offer to the isMaster request a client sends.
+     */
+    void clientBegin(BSONObjBuilder* isMasterRequest) const;
+
+    /**
+     * Starts compressing with the compressor chosen in 'isMasterReply', if there is one.
+     */
+    void clientFinish(const BSONObj& isMasterReply);
+
+    /**
+     * Chooses a compressor from those offered in 'isMasterRequest', if it has a "compression"
+     * field, and reports the choice in 'isMasterReply'. A request without the field leaves the
+     * previous choice in place.
+     */
+    void serverNegotiate(const BSONObj& isMasterRequest, BSONObjBuilder* isMasterReply);
+
+    /**
+     * Returns the negotiated compressor, or null if messages are sent uncompressed.
+     */
+    MessageCompressorBase* getNegotiatedCompressor() const {
+        return _negotiated.load();
+    }
+
+    /**
+     * Wraps 'msg' in an OP_COMPRESSED message with the negotiated compressor, keeping its request
+     * id and responseTo. 'msg' must be a single buffer, and a compressor must have been negotiated.
+     */
+    Status compressMessage(const Message& msg, Message* compressed) const;
+
+    /**
+     * Unwraps the OP_COMPRESSED message 'msg'. Fails if it uses a compressor which isn't enabled,
+     * or is malformed.
+     */
+    Status decompressMessage(const Message& msg, Message* decompressed) const;
+
+private:
+    MessageCompressorRegistry* _registry;
+
+    // Set by the thread handling isMaster and read by any thread sending on the connection.
+    AtomicWord<MessageCompressorBase*> _negotiated;
+};
+
+}  // namespace mongo
@@ -0,0 +1,157 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor_registry.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message_compressor_snappy.h"
+#include "mongo/util/net/message_compressor_zlib.h"
+
+namespace mongo {
+
+namespace {
+
+const char kDisabled[] = "disabled";
+
+class NetworkMessageCompressorsParameter final
+    : public ExportedServerParameter<std::vector<std::string>> {
+public:
+    NetworkMessageCompressorsParameter()
+        : ExportedServerParameter<std::vector<std::string>>(
+              ServerParameterSet::getGlobal(),
+              "networkMessageCompressors",
+              MessageCompressorRegistry::get().enabledCompressorsStorage(),
+              true,    // Change at startup
+              false) {}  // Change at runtime
+
+protected:
+    Status validate(const std::vector<std::string>& potentialNewValue) override {
+        return MessageCompressorRegistry::get().validateEnabledCompressors(potentialNewValue);
+    }
+} networkMessageCompressorsParameter;
+
+}  // namespace
+
+MessageCompressorRegistry::MessageCompressorRegistry() : _enabledNames{"snappy", "zlib"} {}
+
+MessageCompressorRegistry& MessageCompressorRegistry::get() {
+    static MessageCompressorRegistry* registry = [] {
+        auto registry = new MessageCompressorRegistry();
+        registry->registerImplementation(stdx::make_unique<SnappyMessageCompressor>());
+        registry->registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+        return registry;
+    }();
+    return *registry;
+}
+
+void MessageCompressorRegistry::registerImplementation(
+    std::unique_ptr<MessageCompressorBase> compressor) {
+    auto& slot = _compressors[static_cast<uint8_t>(compressor->getId())];
+    invariant(!slot);
+    invariant(compressor->getName() != kDisabled);
+    invariant(!_findRegistered(compressor->getName()));
+    slot = std::move(compressor);
+}
+
+Status MessageCompressorRegistry::validateEnabledCompressors(
+    const std::vector<std::string>& names) const {
+    if (names.size() == 1 && names[0] == kDisabled) {
+        return Status::OK();
+    }
+    for (const auto& name : names) {
+        if (!_findRegistered(name)) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "unknown network message compressor '" << name
+                                  << "', expected a list of snappy and zlib, or '" << kDisabled
+                                  << "'"};
+        }
+    }
+    return Status::OK();
+}
+
+Status MessageCompressorRegistry::setEnabledCompressors(std::vector<std::string> names) {
+    Status status = validateEnabledCompressors(names);
+    if (!status.isOK()) {
+        return status;
+    }
+    _enabledNames = std::move(names);
+    return Status::OK();
+}
+
+std::vector<MessageCompressorBase*> MessageCompressorRegistry::getEnabledCompressors() const {
+    std::vector<MessageCompressorBase*> enabled;
+    for (const auto& name : _enabledNames) {
+        // "disabled" is never registered.
+        if (auto compressor = _findRegistered(name)) {
+            enabled.push_back(compressor);
+        }
+    }
+    return enabled;
+}
+
+MessageCompressorBase* MessageCompressorRegistry::getCompressor(StringData name) const {
+    for (const auto& enabled : _enabledNames) {
+        if (enabled == name) {
+            return _findRegistered(name);
+        }
+    }
+    return nullptr;
+}
+
+MessageCompressorBase* MessageCompressorRegistry::getCompressor(MessageCompressorId id) const {
+    auto compressor = _compressors[static_cast<uint8_t>(id)].get();
+    if (!compressor) {
+        return nullptr;
+    }
+    return getCompressor(compressor->getName());
+}
+
+void MessageCompressorRegistry::appendStats(BSONObjBuilder* builder) const {
+    for (auto compressor : getEnabledCompressors()) {
+        BSONObjBuilder sub(builder->subobjStart(compressor->getName()));
+        compressor->appendStats(&sub);
+    }
+}
+
+MessageCompressorBase* MessageCompressorRegistry::_findRegistered(StringData name) const {
+    for (const auto& compressor : _compressors) {
+        if (compressor && compressor->getName() == name) {
+            return compressor.get();
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/util/net/message_compressor_base.h"
+
+namespace mongo {
+
+/**
+ * Holds every compressor this binary knows about, and which of them may be negotiated.
+ *
+ * The enabled compressors are listed in order of preference and default to snappy, then zlib.
+ * They are set once at startup by the networkMessageCompressors server parameter; the value
+ * "disabled" turns compression off.
+ */
+class MessageCompressorRegistry {
+    MONGO_DISALLOW_COPYING(MessageCompressorRegistry);
+
+public:
+    MessageCompressorRegistry();
+
+    /**
+     * The registry used by all connections, holding the snappy and zlib compressors.
+     */
+    static MessageCompressorRegistry& get();
+
+    void registerImplementation(std::unique_ptr<MessageCompressorBase> compressor);
+
+    /**
+     * Checks that 'names' is a list of registered compressors, or just "disabled".
+     */
+    Status validateEnabledCompressors(const std::vector<std::string>& names) const;
+
+    /**
+     * Sets the compressors which may be negotiated. Must not be called while connections are open.
+     */
+    Status setEnabledCompressors(std::vector<std::string> names);
+
+    /**
+     * The storage for the server parameter, which is checked by validateEnabledCompressors().
+     */
+    std::vector<std::string>* enabledCompressorsStorage() {
+        return &_enabledNames;
+    }
+
+    /**
+     * Returns the enabled compressors, most preferred first.
+     */
+    std::vector<MessageCompressorBase*> getEnabledCompressors() const;
+
+    /**
+     * Returns the compressor with 'name' or 'id' if it is registered and enabled, or null.
+     */
+    MessageCompressorBase* getCompressor(StringData name) const;
+    MessageCompressorBase* getCompressor(MessageCompressorId id) const;
+
+    /**
+     * Appends a subobject of counters for every enabled compressor, keyed by its name.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    MessageCompressorBase* _findRegistered(StringData name) const;
+
+    std::array<std::unique_ptr<MessageCompressorBase>, 256> _compressors;
+    std::vector<std::string> _enabledNames;
+};
+
+}  // namespace mongo
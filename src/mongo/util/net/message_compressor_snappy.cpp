@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor_snappy.h"
+
+#include <snappy.h>
+
+#include "mongo/base/error_codes.h"
+
+namespace mongo {
+
+SnappyMessageCompressor::SnappyMessageCompressor()
+    : MessageCompressorBase(MessageCompressorId::kSnappy, "snappy") {}
+
+std::size_t SnappyMessageCompressor::getMaxCompressedSize(std::size_t inputSize) const {
+    return snappy::MaxCompressedLength(inputSize);
+}
+
+StatusWith<std::size_t> SnappyMessageCompressor::_compress(const char* input,
+                                                           std::size_t inputSize,
+                                                           char* output,
+                                                           std::size_t outputSize) {
+    if (outputSize < snappy::MaxCompressedLength(inputSize)) {
+        return {ErrorCodes::BadValue, "output buffer is too small for snappy compression"};
+    }
+    std::size_t written = 0;
+    snappy::RawCompress(input, inputSize, output, &written);
+    return written;
+}
+
+StatusWith<std::size_t> SnappyMessageCompressor::_decompress(const char* input,
+                                                             std::size_t inputSize,
+                                                             char* output,
+                                                             std::size_t outputSize) {
+    std::size_t expected = 0;
+    if (!snappy::GetUncompressedLength(input, inputSize, &expected) || expected != outputSize ||
+        !snappy::RawUncompress(input, inputSize, output)) {
+        return {ErrorCodes::BadValue, "invalid snappy compressed data"};
+    }
+    return expected;
+}
+
+}  // namespace mongo
@@ -0,0 +1,283 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor_manager.h"
+#include "mongo/util/net/message_compressor_registry.h"
+#include "mongo/util/net/message_compressor_snappy.h"
+#include "mongo/util/net/message_compressor_zlib.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MessageCompressorRegistry> makeRegistry(std::vector<std::string> enabled) {
+    auto registry = stdx::make_unique<MessageCompressorRegistry>();
+    registry->registerImplementation(stdx::make_unique<SnappyMessageCompressor>());
+    registry->registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+    ASSERT_OK(registry->setEnabledCompressors(std::move(enabled)));
+    return registry;
+}
+
+std::string makeCompressibleData() {
+    std::string data;
+    for (int i = 0; i < 1000; i++) {
+        data += "{ _id: " + std::to_string(i) + ", name: \"compressible\" } ";
+    }
+    return data;
+}
+
+std::string makeRandomData(size_t size) {
+    PseudoRandom random(1);
+    std::string data(size, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(random.nextInt32(256));
+    }
+    return data;
+}
+
+void assertRoundTrips(MessageCompressorBase* compressor, const std::string& input) {
+    std::vector<char> compressed(compressor->getMaxCompressedSize(input.size()));
+    auto compressedSize =
+        compressor->compressData(input.data(), input.size(), compressed.data(), compressed.size());
+    ASSERT_OK(compressedSize.getStatus());
+
+    std::string output(input.size(), '\0');
+    auto outputSize = compressor->decompressData(
+        compressed.data(), compressedSize.getValue(), &output[0], output.size());
+    ASSERT_OK(outputSize.getStatus());
+    ASSERT_EQUALS(input.size(), outputSize.getValue());
+    ASSERT_EQUALS(input, output);
+}
+
+/**
+ * Returns the isMaster reply a server using 'server' sends for a request from 'client'.
+ */
+BSONObj negotiate(MessageCompressorManager* client, MessageCompressorManager* server) {
+    BSONObjBuilder request;
+    request.append("isMaster", 1);
+    client->clientBegin(&request);
+
+    BSONObjBuilder reply;
+    server->serverNegotiate(request.obj(), &reply);
+    BSONObj replyObj = reply.obj();
+    client->clientFinish(replyObj);
+    return replyObj;
+}
+
+void makeMessage(const std::string& body, Message* msg) {
+    msg->setData(dbQuery, body.data(), body.size());
+    msg->header().setId(1234);
+    msg->header().setResponseTo(5678);
+}
+
+TEST(MessageCompressorTest, CompressorsRoundTrip) {
+    auto registry = makeRegistry({"snappy", "zlib"});
+    for (auto compressor : registry->getEnabledCompressors()) {
+        assertRoundTrips(compressor, "");
+        assertRoundTrips(compressor, "a");
+        assertRoundTrips(compressor, makeCompressibleData());
+        assertRoundTrips(compressor, makeRandomData(100 * 1024));
+    }
+}
+
+TEST(MessageCompressorTest, CompressorsCountBytesBothWays) {
+    auto registry = makeRegistry({"snappy", "zlib"});
+    const std::string input = makeCompressibleData();
+    for (auto compressor : registry->getEnabledCompressors()) {
+        assertRoundTrips(compressor, input);
+
+        BSONObjBuilder builder;
+        compressor->appendStats(&builder);
+        const BSONObj stats = builder.obj();
+        const long long compressedSize = stats["compressor"]["bytesOut"].numberLong();
+        ASSERT_EQUALS(static_cast<long long>(input.size()),
+                      stats["compressor"]["bytesIn"].numberLong());
+        ASSERT_LESS_THAN(compressedSize, static_cast<long long>(input.size()) / 4);
+        ASSERT_EQUALS(compressedSize, stats["decompressor"]["bytesIn"].numberLong());
+        ASSERT_EQUALS(static_cast<long long>(input.size()),
+                      stats["decompressor"]["bytesOut"].numberLong());
+    }
+}
+
+TEST(MessageCompressorTest, DecompressRejectsCorruptInput) {
+    auto registry = makeRegistry({"snappy", "zlib"});
+    const std::string garbage = makeRandomData(1024);
+    for (auto compressor : registry->getEnabledCompressors()) {
+        std::string output(4096, '\0');
+        auto decompressed =
+            compressor->decompressData(garbage.data(), garbage.size(), &output[0], output.size());
+        ASSERT_NOT_OK(decompressed.getStatus());
+    }
+}
+
+TEST(MessageCompressorRegistryTest, EnabledCompressors) {
+    auto registry = makeRegistry({"zlib"});
+    ASSERT(registry->getCompressor("zlib"));
+    ASSERT(registry->getCompressor(MessageCompressorId::kZlib));
+    ASSERT_FALSE(registry->getCompressor("snappy"));
+    ASSERT_FALSE(registry->getCompressor(MessageCompressorId::kSnappy));
+    ASSERT_FALSE(registry->getCompressor(MessageCompressorId::kNoop));
+
+    ASSERT_OK(registry->setEnabledCompressors({"disabled"}));
+    ASSERT(registry->getEnabledCompressors().empty());
+
+    ASSERT_NOT_OK(registry->setEnabledCompressors({"snappy", "lz4"}));
+    ASSERT_NOT_OK(registry->setEnabledCompressors({"snappy", "disabled"}));
+}
+
+TEST(MessageCompressorManagerTest, NegotiatesClientPreference) {
+    auto clientRegistry = makeRegistry({"zlib", "snappy"});
+    auto serverRegistry = makeRegistry({"snappy", "zlib"});
+    MessageCompressorManager client(clientRegistry.get());
+    MessageCompressorManager server(serverRegistry.get());
+
+    BSONObj reply = negotiate(&client, &server);
+    ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("zlib")), reply);
+    ASSERT_EQUALS("zlib", client.getNegotiatedCompressor()->getName());
+    ASSERT_EQUALS("zlib", server.getNegotiatedCompressor()->getName());
+}
+
+TEST(MessageCompressorManagerTest, NoCommonCompressor) {
+    auto clientRegistry = makeRegistry({"snappy"});
+    auto serverRegistry = makeRegistry({"zlib"});
+    MessageCompressorManager client(clientRegistry.get());
+    MessageCompressorManager server(serverRegistry.get());
+
+    ASSERT_EQUALS(BSONObj(), negotiate(&client, &server));
+    ASSERT_FALSE(client.getNegotiatedCompressor());
+    ASSERT_FALSE(server.getNegotiatedCompressor());
+}
+
+TEST(MessageCompressorManagerTest, DisabledClientDoesNotOffer) {
+    auto clientRegistry = makeRegistry({"disabled"});
+    auto serverRegistry = makeRegistry({"snappy", "zlib"});
+    MessageCompressorManager client(clientRegistry.get());
+    MessageCompressorManager server(serverRegistry.get());
+
+    BSONObjBuilder request;
+    client.clientBegin(&request);
+    ASSERT_EQUALS(BSONObj(), request.obj());
+
+    ASSERT_EQUALS(BSONObj(), negotiate(&client, &server));
+    ASSERT_FALSE(server.getNegotiatedCompressor());
+}
+
+TEST(MessageCompressorManagerTest, IsMasterWithoutCompressionKeepsChoice) {
+    auto registry = makeRegistry({"snappy"});
+    MessageCompressorManager client(registry.get());
+    MessageCompressorManager server(registry.get());
+    negotiate(&client, &server);
+    ASSERT(server.getNegotiatedCompressor());
+
+    BSONObjBuilder reply;
+    server.serverNegotiate(BSON("isMaster" << 1), &reply);
+    ASSERT_EQUALS(BSONObj(), reply.obj());
+    ASSERT(server.getNegotiatedCompressor());
+}
+
+TEST(MessageCompressorManagerTest, MessagesRoundTrip) {
+    auto registry = makeRegistry({"snappy", "zlib"});
+    for (auto name : {"snappy", "zlib"}) {
+        auto clientRegistry = makeRegistry({name});
+        MessageCompressorManager client(clientRegistry.get());
+        MessageCompressorManager server(registry.get());
+        negotiate(&client, &server);
+
+        const std::string body = makeCompressibleData();
+        Message msg;
+        makeMessage(body, &msg);
+
+        Message compressed;
+        ASSERT_OK(client.compressMessage(msg, &compressed));
+        ASSERT_EQUALS(dbCompressed, compressed.operation());
+        ASSERT_EQUALS(1234U, compressed.header().getId());
+        ASSERT_EQUALS(5678U, compressed.header().getResponseTo());
+        ASSERT_LESS_THAN(compressed.size(), msg.size());
+
+        Message decompressed;
+        ASSERT_OK(server.decompressMessage(compressed, &decompressed));
+        ASSERT_EQUALS(dbQuery, decompressed.operation());
+        ASSERT_EQUALS(1234U, decompressed.header().getId());
+        ASSERT_EQUALS(5678U, decompressed.header().getResponseTo());
+        ASSERT_EQUALS(msg.size(), decompressed.size());
+        ASSERT_EQUALS(body, std::string(decompressed.singleData().data(), body.size()));
+    }
+}
+
+TEST(MessageCompressorManagerTest, DecompressRejectsBadMessages) {
+    auto registry = makeRegistry({"snappy"});
+    MessageCompressorManager manager(registry.get());
+    negotiate(&manager, &manager);
+
+    Message msg;
+    makeMessage(makeCompressibleData(), &msg);
+
+    const auto assertRejected = [&](const stdx::function<void(char*)>& corrupt) {
+        Message compressed;
+        ASSERT_OK(manager.compressMessage(msg, &compressed));
+        corrupt(compressed.singleData().data());
+        Message decompressed;
+        ASSERT_NOT_OK(manager.decompressMessage(compressed, &decompressed));
+        ASSERT(decompressed.empty());
+    };
+
+    // The wrong uncompressed size.
+    assertRejected([](char* body) { DataView(body).write(tagLittleEndian<int32_t>(10), 4U); });
+    // A size larger than any message.
+    assertRejected([](char* body) {
+        DataView(body).write(tagLittleEndian<int32_t>(MaxMessageSizeBytes), 4U);
+    });
+    // A nested compressed message.
+    assertRejected([](char* body) {
+        DataView(body).write(tagLittleEndian<int32_t>(dbCompressed), 0U);
+    });
+    // A compressor which isn't enabled.
+    assertRejected([](char* body) { body[8] = static_cast<char>(MessageCompressorId::kZlib); });
+
+    // Too short to hold the compression header.
+    Message truncated;
+    truncated.setData(dbCompressed, "abc", 3);
+    Message decompressed;
+    ASSERT_NOT_OK(manager.decompressMessage(truncated, &decompressed));
+}
+
+}  // namespace
+}  // namespace mongo
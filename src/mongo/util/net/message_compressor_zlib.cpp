@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor_zlib.h"
+
+#include <cstring>
+#include <zlib.h>
+
+#include "mongo/base/error_codes.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+// The vendored zlib leaves out compress() and uncompress(), so these use the stream interface,
+// one call each way.
+
+ZlibMessageCompressor::ZlibMessageCompressor()
+    : MessageCompressorBase(MessageCompressorId::kZlib, "zlib") {}
+
+std::size_t ZlibMessageCompressor::getMaxCompressedSize(std::size_t inputSize) const {
+    // The bound zlib's compressBound() gives for the default window and memory level.
+    return inputSize + (inputSize >> 12) + (inputSize >> 14) + (inputSize >> 25) + 13;
+}
+
+StatusWith<std::size_t> ZlibMessageCompressor::_compress(const char* input,
+                                                         std::size_t inputSize,
+                                                         char* output,
+                                                         std::size_t outputSize) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // The fastest level, to keep the cost per message low.
+    int ret = deflateInit(&stream, 1);
+    if (ret != Z_OK) {
+        return {ErrorCodes::BadValue, str::stream() << "zlib deflateInit failed with " << ret};
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+    stream.avail_in = inputSize;
+    stream.next_out = reinterpret_cast<Bytef*>(output);
+    stream.avail_out = outputSize;
+
+    ret = deflate(&stream, Z_FINISH);
+    const std::size_t written = stream.total_out;
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+        return {ErrorCodes::BadValue, str::stream() << "zlib compression failed with " << ret};
+    }
+    return written;
+}
+
+StatusWith<std::size_t> ZlibMessageCompressor::_decompress(const char* input,
+                                                           std::size_t inputSize,
+                                                           char* output,
+                                                           std::size_t outputSize) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int ret = inflateInit(&stream);
+    if (ret != Z_OK) {
+        return {ErrorCodes::BadValue, str::stream() << "zlib inflateInit failed with " << ret};
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+    stream.avail_in = inputSize;
+    stream.next_out = reinterpret_cast<Bytef*>(output);
+    stream.avail_out = outputSize;
+
+    ret = inflate(&stream, Z_FINISH);
+    const std::size_t written = stream.total_out;
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END) {
+        return {ErrorCodes::BadValue, str::stream() << "zlib decompression failed with " << ret};
+    }
+    return written;
+}
+
+}  // namespace mongo
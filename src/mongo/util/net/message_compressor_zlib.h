@@ -0,0 +1,56 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/util/net/message_compressor_base.h"
+
+namespace mongo {
+
+/**
+ * Slower than snappy but compresses further, for links where bandwidth is scarce.
+ */
+class ZlibMessageCompressor final : public MessageCompressorBase {
+public:
+    ZlibMessageCompressor();
+
+    std::size_t getMaxCompressedSize(std::size_t inputSize) const override;
+
+private:
+    StatusWith<std::size_t> _compress(const char* input,
+                                      std::size_t inputSize,
+                                      char* output,
+                                      std::size_t outputSize) override;
+
+    StatusWith<std::size_t> _decompress(const char* input,
+                                        std::size_t inputSize,
+                                        char* output,
+                                        std::size_t outputSize) override;
+};
+
+}  // namespace mongo
@@ -129,6 +129,14 @@ MessagingPort::~MessagingPort() {
 }
 
 bool MessagingPort::recv(Message& m) {
+    return _recv(nullptr, m);
+}
+
+bool MessagingPort::recvWithHeader(const MSGHEADER::Value& header, Message& m) {
+    return _recv(&header, m);
+}
+
+bool MessagingPort::_recv(const MSGHEADER::Value* received, Message& m) {
     try {
 #ifdef MONGO_CONFIG_SSL
     again:
@@ -136,7 +144,12 @@ bool MessagingPort::recv(Message& m) {
         // mmm( log() << "*  recv() sock:" << this->sock << endl; )
         MSGHEADER::Value header;
         int headerLen = sizeof(MSGHEADER::Value);
-        psock->recv((char*)&header, headerLen);
+        if (received) {
+            memcpy(&header, received, headerLen);
+            received = nullptr;
+        } else {
+            psock->recv((char*)&header, headerLen);
+        }
         int len = header.constView().getMessageLength();
 
         if (len == 542393671) {
@@ -197,6 +210,18 @@ bool MessagingPort::recv(Message& m) {
 
         guard.Dismiss();
         m.setData(md.view2ptr(), true);
+
+        if (m.operation() == dbCompressed) {
+            Message decompressed;
+            Status status = compressorManager().decompressMessage(m, &decompressed);
+            m.reset();
+            if (!status.isOK()) {
+                LOG(0) << "recv(): failed to decompress message from " << remote() << ": "
+                       << status;
+                return false;
+            }
+            m = std::move(decompressed);
+        }
         return true;
 
     } catch (const SocketException& e) {
@@ -250,6 +275,15 @@ void MessagingPort::say(Message& toSend, int responseTo) {
     mmm(log() << "*  say()  thr:" << GetCurrentThreadId() << endl;)
         toSend.header().setId(nextMessageId());
     toSend.header().setResponseTo(responseTo);
+
+    if (compressorManager().getNegotiatedCompressor()) {
+        // Compress a copy so that callers may still read what they sent.
+        toSend.concat();
+        Message compressed;
+        uassertStatusOK(compressorManager().compressMessage(toSend, &compressed));
+        compressed.send(*this, "say");
+        return;
+    }
     toSend.send(*this, "say");
 }
 
@@ -61,6 +61,12 @@ public:
        also, the Message data will go out of scope on the subsequent recv call.
     */
     bool recv(Message& m);
+
+    /**
+     * As recv(), for a message whose header the caller has already read off the socket.
+     */
+    bool recvWithHeader(const MSGHEADER::Value& header, Message& m);
+
     void reply(Message& received, Message& response, MSGID responseTo);
     void reply(Message& received, Message& response);
     bool call(Message& toSend, Message& response);
@@ -122,6 +128,9 @@ private:
     // mutable because its initialized only on call to remote()
     mutable HostAndPort _remoteParsed;
 
+    // Receives a message, reading its header off the socket unless "received" supplies it.
+    bool _recv(const MSGHEADER::Value* received, Message& m);
+
 public:
     static void closeAllSockets(unsigned tagMask = 0xffffffff);
 };
@@ -34,12 +34,24 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/platform/basic.h"
 
 namespace mongo {
 
 class MessageHandler {
 public:
+    /**
+     * Per-connection state that a handler binds to the thread servicing a connection. When
+     * connections are multiplexed over a pool of worker threads, this state is parked between
+     * requests with suspend() and handed back to the next worker with resume().
+     */
+    class SessionState {
+    public:
+        virtual ~SessionState() {}
+    };
+
     virtual ~MessageHandler() {}
 
     /**
@@ -52,6 +64,22 @@ public:
      * handler is responsible for responding to client
      */
     virtual void process(Message& m, AbstractMessagingPort* p) = 0;
+
+    /**
+     * called on a service executor worker after a request has been processed, before the
+     * connection is parked until its next request. Returns whatever was bound to the current
+     * thread by connected(), or null if nothing was. Destroying the returned state ends the
+     * connection's session.
+     */
+    virtual std::unique_ptr<SessionState> suspend(AbstractMessagingPort* p) {
+        return nullptr;
+    }
+
+    /**
+     * called on a service executor worker before processing the next request of a parked
+     * connection, with the state previously returned by suspend().
+     */
+    virtual void resume(AbstractMessagingPort* p, std::unique_ptr<SessionState> state) {}
 };
 
 class MessageServer {
@@ -31,15 +31,19 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <memory>
 #include <system_error>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/config.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/synchronization.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -56,7 +60,11 @@
 #include "mongo/util/scopeguard.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
+#include <errno.h>
 #include <sys/resource.h>
+#include <sys/socket.h>
+
+#include "mongo/util/net/service_executor_epoll.h"
 #endif
 
 #if !defined(__has_feature)
@@ -90,6 +98,212 @@ private:
     MessageHandler* const _handler;
 };
 
+/**
+ * Shuts "port" down after its client closed the connection.
+ */
+void endConnection(MessagingPortWithHandler* port) {
+    if (!serverGlobalParams.quiet) {
+        int conns = Listener::globalTicketHolder.used() - 1;
+        const char* word = (conns == 1 ? " connection" : " connections");
+        log() << "end connection " << port->psock->remoteString() << " (" << conns << word
+              << " now open)" << endl;
+    }
+    port->shutdown();
+}
+
+/**
+ * Receives one request on "port" and hands it to the port's handler. If "header" is not null,
+ * the header of the request was already read off the socket. Returns false, after shutting the
+ * port down, if the client closed the connection.
+ */
+bool serviceOneRequest(MessagingPortWithHandler* port,
+                       const MSGHEADER::Value* header = nullptr) {
+    Message m;
+    port->psock->clearCounters();
+
+    if (!(header ? port->recvWithHeader(*header, m) : port->recv(m))) {
+        endConnection(port);
+        return false;
+    }
+
+    port->getHandler()->process(m, port);
+    const long long headerBytes = header ? sizeof(*header) : 0;
+    networkCounter.hit(port->psock->getBytesIn() + headerBytes, port->psock->getBytesOut());
+    return true;
+}
+
+/**
+ * Runs "work", which services requests on "port" and returns whether the connection should stay
+ * open. Errors thrown by "work" close the connection.
+ */
+template <typename Work>
+bool runClosingConnectionOnError(MessagingPortWithHandler* port, const Work& work) {
+    try {
+        return work();
+    } catch (AssertionException& e) {
+        log() << "AssertionException handling request, closing client connection: " << e << endl;
+        port->shutdown();
+    } catch (SocketException& e) {
+        log() << "SocketException handling request, closing client connection: " << e << endl;
+        port->shutdown();
+    } catch (const DBException& e) {  // must be right above std::exception to avoid catching
+                                      // subclasses
+        log() << "DBException handling request, closing client connection: " << e << endl;
+        port->shutdown();
+    } catch (std::exception& e) {
+        error() << "Uncaught std::exception: " << e.what() << ", terminating" << endl;
+        dbexit(EXIT_UNCAUGHT);
+    }
+    return false;
+}
+
+#ifdef __linux__
+/**
+ * A client connection serviced by a ServiceExecutorEpoll. Holds one of
+ * Listener::globalTicketHolder's tickets for as long as it lives.
+ */
+class EpollSession final : public ServiceExecutorEpoll::Session {
+    MONGO_DISALLOW_COPYING(EpollSession);
+
+public:
+    explicit EpollSession(std::unique_ptr<MessagingPortWithHandler> port)
+        : _port(std::move(port)) {}
+
+    ~EpollSession() {
+        _state.reset();
+        _port.reset();
+        Listener::globalTicketHolder.release();
+    }
+
+    int fd() const override {
+        return _port->psock->rawFD();
+    }
+
+    bool onReadable() override {
+        MessagingPortWithHandler* const port = _port.get();
+        MessageHandler* const handler = port->getHandler();
+
+        // Wait for the whole header before taking on the request, so that a client sending it a
+        // few bytes at a time does not hold a worker in a blocking read.
+        if (!_readHeader()) {
+            return false;
+        }
+        if (_headerBytes < sizeof(_header)) {
+            return true;
+        }
+        _headerBytes = 0;
+
+        const bool keep = runClosingConnectionOnError(port, [this] { return _serviceRequest(); });
+
+        // Park whatever the handler bound to this worker, even when the connection is ending, so
+        // that it is destroyed along with the session rather than left behind on the thread.
+        _state = handler->suspend(port);
+
+        // Occasionally we want to see if we're using too much memory.
+        if ((_requests++ & 0xf) == 0) {
+            markThreadIdle();
+        }
+        return keep;
+    }
+
+private:
+    /**
+     * Reads whatever has arrived of the next request's header, without blocking. Returns false,
+     * after shutting the port down, if the connection is closed or fails.
+     */
+    bool _readHeader() {
+        char* const buf = reinterpret_cast<char*>(&_header);
+        while (_headerBytes < sizeof(_header)) {
+            const ssize_t ret =
+                ::recv(fd(), buf + _headerBytes, sizeof(_header) - _headerBytes, MSG_DONTWAIT);
+            if (ret > 0) {
+                _headerBytes += ret;
+                continue;
+            }
+
+            const int err = errno;
+            if (ret < 0 && err == EINTR) {
+                continue;
+            }
+            if (ret < 0 && (err == EAGAIN || err == EWOULDBLOCK)) {
+                return true;
+            }
+            if (ret < 0) {
+                LOG(_port->psock->getLogLevel()) << "Socket recv() " << errnoWithDescription(err)
+                                                 << " " << _port->psock->remoteString();
+            }
+            endConnection(_port.get());
+            return false;
+        }
+        return true;
+    }
+
+    bool _serviceRequest() {
+        MessagingPortWithHandler* const port = _port.get();
+        MessageHandler* const handler = port->getHandler();
+
+        if (_connected) {
+            handler->resume(port, std::move(_state));
+        } else {
+            port->psock->setLogLevel(logger::LogSeverity::Debug(1));
+            handler->connected(port);
+            _connected = true;
+        }
+        return !inShutdown() && serviceOneRequest(port, &_header);
+    }
+
+    std::unique_ptr<MessagingPortWithHandler> _port;
+    std::unique_ptr<MessageHandler::SessionState> _state;
+
+    // The header of the next request, of which the first _headerBytes bytes have arrived.
+    MSGHEADER::Value _header;
+    size_t _headerBytes = 0;
+
+    bool _connected = false;
+    int64_t _requests = 0;
+};
+#endif  // __linux__
+
+/**
+ * Reports the state of the service executor under serverStatus().serviceExecutor.
+ */
+class ServiceExecutorServerStatusMetric : public ServerStatusMetric {
+public:
+    ServiceExecutorServerStatusMetric() : ServerStatusMetric(".serviceExecutor") {}
+
+#ifdef __linux__
+    void setExecutor(ServiceExecutorEpoll* executor) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _executor = executor;
+    }
+#endif
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        BSONObjBuilder sub(b.subobjStart(_leafName));
+#ifdef __linux__
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_executor) {
+            const ServiceExecutorEpoll::Stats stats = _executor->getStats();
+            sub.append("mode", "epoll");
+            sub.appendNumber("sessions", stats.sessions);
+            sub.appendNumber("queued", stats.queued);
+            sub.appendNumber("threads", stats.threads);
+            sub.appendNumber("idleThreads", stats.idleThreads);
+            sub.appendNumber("dispatched", stats.dispatched);
+            sub.appendNumber("dispatchLatencyMicros", stats.dispatchLatencyMicros);
+            return;
+        }
+#endif
+        sub.append("mode", "threadPerConnection");
+    }
+
+private:
+#ifdef __linux__
+    mutable stdx::mutex _mutex;
+    ServiceExecutorEpoll* _executor = nullptr;
+#endif
+} serviceExecutorServerStatusMetric;
+
 }  // namespace
 
 class PortMessageServer : public MessageServer, public Listener {
@@ -102,7 +316,38 @@ public:
      *     and should make sure that it lives longer than this server.
      */
     PortMessageServer(const MessageServer::Options& opts, MessageHandler* handler)
-        : Listener("", opts.ipList, opts.port), _handler(handler) {}
+        : Listener("", opts.ipList, opts.port), _handler(handler) {
+#ifdef __linux__
+        if (serverGlobalParams.serviceExecutor == "epoll") {
+#ifdef MONGO_CONFIG_SSL
+            const bool sslEnabled = getSSLManager();
+#else
+            const bool sslEnabled = false;
+#endif
+            if (sslEnabled) {
+                // OpenSSL may buffer a pipelined request that epoll cannot see, so SSL
+                // connections always get a thread of their own.
+                warning() << "the epoll service executor does not support SSL, using one thread "
+                             "per connection";
+            } else {
+                size_t numWorkers = serverGlobalParams.serviceExecutorThreads;
+                if (numWorkers == 0) {
+                    numWorkers = 2 * std::max(1U, stdx::thread::hardware_concurrency());
+                }
+                _executor = stdx::make_unique<ServiceExecutorEpoll>(numWorkers);
+            }
+        }
+#endif
+    }
+
+#ifdef __linux__
+    ~PortMessageServer() {
+        if (_executor) {
+            serviceExecutorServerStatusMetric.setExecutor(nullptr);
+            _executor->shutdown();
+        }
+    }
+#endif
 
     virtual void accepted(std::shared_ptr<Socket> psocket, long long connectionId) {
         ScopeGuard sleepAfterClosingPort = MakeGuard(sleepmillis, 2);
@@ -115,6 +360,21 @@ public:
             return;
         }
 
+#ifdef __linux__
+        if (_executor) {
+            // The session owns the ticket from here on, and gives it back if registration fails.
+            Status status =
+                _executor->addSession(stdx::make_unique<EpollSession>(std::move(portWithHandler)));
+            if (!status.isOK()) {
+                log() << "failed to register new connection with the service executor, closing "
+                         "connection: " << status;
+                return;
+            }
+            sleepAfterClosingPort.Dismiss();
+            return;
+        }
+#endif
+
         try {
 #ifndef __linux__  // TODO: consider making this ifdef _WIN32
             {
@@ -173,6 +433,12 @@ public:
     }
 
     void run() {
+#ifdef __linux__
+        if (_executor) {
+            fassert(28783, _executor->startup());
+            serviceExecutorServerStatusMetric.setExecutor(_executor.get());
+        }
+#endif
         initAndListen();
     }
 
@@ -183,6 +449,12 @@ public:
 private:
     MessageHandler* _handler;
 
+#ifdef __linux__
+    // Services connections when serverGlobalParams.serviceExecutor is "epoll", otherwise null
+    // and every connection gets a thread of its own.
+    std::unique_ptr<ServiceExecutorEpoll> _executor;
+#endif
+
     /**
      * Handles incoming messages from a given socket.
      *
@@ -206,50 +478,24 @@ private:
         setThreadName(std::string(str::stream() << "conn" << portWithHandler->connectionId()));
         portWithHandler->psock->setLogLevel(logger::LogSeverity::Debug(1));
 
-        Message m;
-        int64_t counter = 0;
-        try {
-            handler->connected(portWithHandler.get());
-
-            while (!inShutdown()) {
-                m.reset();
-                portWithHandler->psock->clearCounters();
-
-                if (!portWithHandler->recv(m)) {
-                    if (!serverGlobalParams.quiet) {
-                        int conns = Listener::globalTicketHolder.used() - 1;
-                        const char* word = (conns == 1 ? " connection" : " connections");
-                        log() << "end connection " << portWithHandler->psock->remoteString() << " ("
-                              << conns << word << " now open)" << endl;
-                    }
-                    portWithHandler->shutdown();
-                    break;
-                }
-
-                handler->process(m, portWithHandler.get());
-                networkCounter.hit(portWithHandler->psock->getBytesIn(),
-                                   portWithHandler->psock->getBytesOut());
-
-                // Occasionally we want to see if we're using too much memory.
-                if ((counter++ & 0xf) == 0) {
-                    markThreadIdle();
-                }
-            }
-        } catch (AssertionException& e) {
-            log() << "AssertionException handling request, closing client connection: " << e
-                  << endl;
-            portWithHandler->shutdown();
-        } catch (SocketException& e) {
-            log() << "SocketException handling request, closing client connection: " << e << endl;
-            portWithHandler->shutdown();
-        } catch (const DBException&
-                     e) {  // must be right above std::exception to avoid catching subclasses
-            log() << "DBException handling request, closing client connection: " << e << endl;
-            portWithHandler->shutdown();
-        } catch (std::exception& e) {
-            error() << "Uncaught std::exception: " << e.what() << ", terminating" << endl;
-            dbexit(EXIT_UNCAUGHT);
-        }
+        runClosingConnectionOnError(portWithHandler.get(),
+                                    [&] {
+                                        handler->connected(portWithHandler.get());
+
+                                        int64_t counter = 0;
+                                        while (!inShutdown()) {
+                                            if (!serviceOneRequest(portWithHandler.get())) {
+                                                break;
+                                            }
+
+                                            // Occasionally we want to see if we're using too
+                                            // much memory.
+                                            if ((counter++ & 0xf) == 0) {
+                                                markThreadIdle();
+                                            }
+                                        }
+                                        return false;
+                                    });
 
 // Normal disconnect path.
 #ifdef MONGO_CONFIG_SSL
@@ -0,0 +1,225 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/service_executor_epoll.h"
+
+#include <errno.h>
+#include <limits>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+// Maximum number of ready descriptors collected by a single call to epoll_wait.
+const int kMaxEventsPerWait = 128;
+
+// How often the poller wakes up to check for shutdown when no descriptor is readable.
+const int kPollTimeoutMillis = 100;
+
+ThreadPool::Options makeWorkerPoolOptions(size_t numWorkers) {
+    ThreadPool::Options options;
+    options.poolName = "ServiceExecutor";
+    options.threadNamePrefix = "serviceExecutor-";
+    options.minThreads = numWorkers;
+    // Bounded by the number of sessions, since each runs on at most one worker at a time.
+    options.maxThreads = std::numeric_limits<size_t>::max();
+    return options;
+}
+
+}  // namespace
+
+ServiceExecutorEpoll::ServiceExecutorEpoll(size_t numWorkers)
+    : _numWorkers(numWorkers), _workers(makeWorkerPoolOptions(numWorkers)) {}
+
+ServiceExecutorEpoll::~ServiceExecutorEpoll() {
+    shutdown();
+}
+
+Status ServiceExecutorEpoll::startup() {
+    invariant(_epollFd == -1);
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        const int err = errno;
+        return Status(ErrorCodes::InternalError,
+                      str::stream() << "epoll_create1 failed: " << errnoWithDescription(err));
+    }
+
+    _workers.startup();
+    _poller = stdx::thread([this] { _pollerLoop(); });
+    log() << "service executor started with " << _numWorkers << " worker threads, adding more "
+          << "while they are all busy";
+    return Status::OK();
+}
+
+void ServiceExecutorEpoll::shutdown() {
+    if (_inShutdown.swap(1)) {
+        return;
+    }
+
+    if (_poller.joinable()) {
+        _poller.join();
+    }
+
+    // Sessions that were already queued still run, but see _inShutdown and end themselves.
+    _workers.shutdown();
+    _workers.join();
+
+    stdx::list<std::unique_ptr<Session>> sessions;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        sessions.swap(_sessions);
+    }
+    sessions.clear();
+
+    if (_epollFd >= 0) {
+        close(_epollFd);
+        _epollFd = -1;
+    }
+}
+
+Status ServiceExecutorEpoll::addSession(std::unique_ptr<Session> session) {
+    if (_inShutdown.load()) {
+        return Status(ErrorCodes::ShutdownInProgress, "service executor is shutting down");
+    }
+
+    Session* const s = session.get();
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        s->_self = _sessions.insert(_sessions.end(), std::move(session));
+    }
+
+    Status status = _arm(s, EPOLL_CTL_ADD);
+    if (!status.isOK()) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _sessions.erase(s->_self);
+    }
+    return status;
+}
+
+ServiceExecutorEpoll::Stats ServiceExecutorEpoll::getStats() {
+    Stats stats;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        stats.sessions = _sessions.size();
+    }
+    stats.queued = _queued.load();
+    const ThreadPool::Stats workerStats = _workers.getStats();
+    stats.threads = workerStats.numThreads;
+    stats.idleThreads = workerStats.numIdleThreads;
+    stats.dispatched = _dispatched.load();
+    stats.dispatchLatencyMicros = _dispatchLatencyMicros.load();
+    return stats;
+}
+
+void ServiceExecutorEpoll::_pollerLoop() {
+    setThreadName("serviceExecutorPoller");
+
+    epoll_event events[kMaxEventsPerWait];
+    while (!_inShutdown.load()) {
+        const int numReady = epoll_wait(_epollFd, events, kMaxEventsPerWait, kPollTimeoutMillis);
+        if (numReady < 0) {
+            const int err = errno;
+            if (err == EINTR) {
+                continue;
+            }
+            severe() << "epoll_wait failed: " << errnoWithDescription(err);
+            fassertFailed(28782);
+        }
+
+        const unsigned long long now = curTimeMicros64();
+        for (int i = 0; i < numReady; ++i) {
+            Session* const session = static_cast<Session*>(events[i].data.ptr);
+            session->_readyTimeMicros = now;
+            _queued.addAndFetch(1);
+            Status status = _workers.schedule([this, session] { _runSession(session); });
+            if (!status.isOK()) {
+                // The pool only refuses work once shutdown has begun; the remaining sessions
+                // are destroyed by shutdown().
+                _queued.subtractAndFetch(1);
+                return;
+            }
+        }
+    }
+}
+
+void ServiceExecutorEpoll::_runSession(Session* session) {
+    _queued.subtractAndFetch(1);
+    _dispatched.addAndFetch(1);
+    _dispatchLatencyMicros.addAndFetch(curTimeMicros64() - session->_readyTimeMicros);
+
+    bool keep = !_inShutdown.load() && session->onReadable();
+    if (keep) {
+        Status status = _arm(session, EPOLL_CTL_MOD);
+        if (!status.isOK()) {
+            warning() << "ending session after failing to re-arm it: " << status;
+            keep = false;
+        }
+    }
+
+    if (!keep) {
+        _removeSession(session);
+    }
+}
+
+Status ServiceExecutorEpoll::_arm(Session* session, int op) {
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.ptr = session;
+    if (epoll_ctl(_epollFd, op, session->fd(), &event) != 0) {
+        const int err = errno;
+        return Status(ErrorCodes::InternalError,
+                      str::stream() << "epoll_ctl failed: " << errnoWithDescription(err));
+    }
+    return Status::OK();
+}
+
+void ServiceExecutorEpoll::_removeSession(Session* session) {
+    // The descriptor is still open here; it is closed when the session is destroyed below.
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, session->fd(), nullptr);
+
+    std::unique_ptr<Session> owned;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        owned = std::move(*session->_self);
+        _sessions.erase(session->_self);
+    }
+}
+
+}  // namespace mongo
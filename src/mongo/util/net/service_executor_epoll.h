@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/list.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+/**
+ * Multiplexes many mostly-idle connections over a pool of worker threads.
+ *
+ * Each registered Session wraps a file descriptor. A single poller thread waits in epoll_wait for
+ * descriptors to become readable and hands the corresponding session to the worker pool, which
+ * calls Session::onReadable(). Descriptors are armed with EPOLLONESHOT, so a session is never
+ * handled by two workers at once; it is re-armed only after onReadable() returns true. Returning
+ * false ends the session, which is then unregistered and destroyed.
+ *
+ * onReadable() may block, for instance while a request waits for write concern, and the request
+ * that would unblock it may arrive on another session. So when every worker is busy the pool
+ * starts another thread rather than queueing the session, and retires the extra threads once they
+ * have been idle for a while. Since a session runs on at most one worker at a time, the pool never
+ * has more threads than there are sessions.
+ *
+ * Linux only.
+ */
+class ServiceExecutorEpoll {
+    MONGO_DISALLOW_COPYING(ServiceExecutorEpoll);
+
+public:
+    /**
+     * A connection serviced by the executor. Destroying the session must close its descriptor.
+     */
+    class Session {
+    public:
+        virtual ~Session() = default;
+
+        /**
+         * The descriptor to poll for readability. Must not change over the session's lifetime.
+         */
+        virtual int fd() const = 0;
+
+        /**
+         * Called on a worker thread when fd() is readable. Returns true to keep the session
+         * registered, or false to end it.
+         */
+        virtual bool onReadable() = 0;
+
+    private:
+        friend class ServiceExecutorEpoll;
+
+        // Position of this session in ServiceExecutorEpoll::_sessions.
+        stdx::list<std::unique_ptr<Session>>::iterator _self;
+
+        // Time at which the poller queued this session for a worker, in microseconds.
+        unsigned long long _readyTimeMicros = 0;
+    };
+
+    /**
+     * Statistics about the executor, as returned by getStats().
+     */
+    struct Stats {
+        // Number of sessions currently registered.
+        long long sessions = 0;
+
+        // Number of readable sessions waiting for a worker.
+        long long queued = 0;
+
+        // Number of worker threads, and how many of them are waiting for a session.
+        long long threads = 0;
+        long long idleThreads = 0;
+
+        // Number of sessions that have been handed to a worker.
+        long long dispatched = 0;
+
+        // Cumulative time sessions spent between becoming readable and running on a worker.
+        long long dispatchLatencyMicros = 0;
+    };
+
+    /**
+     * Constructs an executor that keeps "numWorkers" threads to run sessions on, and more while
+     * they are all busy.
+     */
+    explicit ServiceExecutorEpoll(size_t numWorkers);
+
+    ~ServiceExecutorEpoll();
+
+    /**
+     * Creates the epoll instance and starts the poller and worker threads.
+     */
+    Status startup();
+
+    /**
+     * Stops the poller, waits for in-progress sessions to finish their current call to
+     * onReadable() and destroys all remaining sessions. Idempotent.
+     */
+    void shutdown();
+
+    /**
+     * Registers "session" and arms its descriptor. On failure the session is destroyed.
+     */
+    Status addSession(std::unique_ptr<Session> session);
+
+    Stats getStats();
+
+private:
+    void _pollerLoop();
+
+    void _runSession(Session* session);
+
+    // Re-arms the descriptor of "session" for one more readability notification.
+    Status _arm(Session* session, int op);
+
+    void _removeSession(Session* session);
+
+    const size_t _numWorkers;
+
+    int _epollFd = -1;
+
+    AtomicUInt32 _inShutdown;
+
+    ThreadPool _workers;
+
+    stdx::thread _poller;
+
+    // Guards _sessions.
+    mutable stdx::mutex _mutex;
+    stdx::list<std::unique_ptr<Session>> _sessions;
+
+    AtomicInt64 _queued;
+    AtomicInt64 _dispatched;
+    AtomicInt64 _dispatchLatencyMicros;
+};
+
+}  // namespace mongo
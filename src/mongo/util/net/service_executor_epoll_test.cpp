@@ -0,0 +1,219 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/service_executor_epoll.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+using namespace mongo;
+
+/**
+ * State shared between a test and the sessions it registers.
+ */
+struct SessionEvents {
+    void waitFor(const stdx::function<bool()>& pred) {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        ASSERT(cv.wait_for(lk, Seconds(10), pred));
+    }
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    int bytesRead = 0;
+    int destroyed = 0;
+    bool released = false;
+    int waited = 0;
+};
+
+// Bytes that make a TestSession block until another one is released, and release them.
+const char kWaitForRelease = 'w';
+const char kRelease = 'r';
+
+/**
+ * Reads one byte per wakeup and ends itself when it reads a zero byte or hits end of stream.
+ * Reading kWaitForRelease blocks the worker until some session reads kRelease.
+ */
+class TestSession : public ServiceExecutorEpoll::Session {
+public:
+    TestSession(int fd, SessionEvents* events) : _fd(fd), _events(events) {}
+
+    ~TestSession() {
+        close(_fd);
+        stdx::lock_guard<stdx::mutex> lk(_events->mutex);
+        ++_events->destroyed;
+        _events->cv.notify_all();
+    }
+
+    int fd() const override {
+        return _fd;
+    }
+
+    bool onReadable() override {
+        char c;
+        if (read(_fd, &c, 1) != 1) {
+            return false;
+        }
+        stdx::unique_lock<stdx::mutex> lk(_events->mutex);
+        ++_events->bytesRead;
+        if (c == kRelease) {
+            _events->released = true;
+        }
+        _events->cv.notify_all();
+
+        if (c == kWaitForRelease) {
+            if (!_events->cv.wait_for(lk, Seconds(10), [this] { return _events->released; })) {
+                return false;
+            }
+            ++_events->waited;
+            _events->cv.notify_all();
+        }
+        return c != 0;
+    }
+
+private:
+    const int _fd;
+    SessionEvents* const _events;
+};
+
+class ServiceExecutorEpollTest : public unittest::Test {
+protected:
+    /**
+     * Registers a new session with "executor" and returns the peer end of its socket.
+     */
+    int addSession(ServiceExecutorEpoll* executor) {
+        int fds[2];
+        ASSERT_EQUALS(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        ASSERT_OK(executor->addSession(stdx::make_unique<TestSession>(fds[0], &events)));
+        _peers.push_back(fds[1]);
+        return fds[1];
+    }
+
+    static void writeByte(int fd, char c) {
+        ASSERT_EQUALS(1, write(fd, &c, 1));
+    }
+
+    SessionEvents events;
+
+private:
+    void tearDown() override {
+        for (int fd : _peers) {
+            close(fd);
+        }
+    }
+
+    std::vector<int> _peers;
+};
+
+TEST_F(ServiceExecutorEpollTest, UnstartedExecutor) {
+    ServiceExecutorEpoll executor(2);
+}
+
+TEST_F(ServiceExecutorEpollTest, DispatchesReadableSessions) {
+    ServiceExecutorEpoll executor(2);
+    ASSERT_OK(executor.startup());
+
+    const int first = addSession(&executor);
+    const int second = addSession(&executor);
+    ASSERT_EQUALS(2, executor.getStats().sessions);
+
+    for (int i = 0; i < 10; ++i) {
+        writeByte(i % 2 ? first : second, 1);
+        events.waitFor([&] { return events.bytesRead == i + 1; });
+    }
+
+    ServiceExecutorEpoll::Stats stats = executor.getStats();
+    ASSERT_EQUALS(10, stats.dispatched);
+    ASSERT_EQUALS(0, stats.queued);
+    ASSERT_EQUALS(0, events.destroyed);
+}
+
+TEST_F(ServiceExecutorEpollTest, AddsWorkersWhileAllAreBusy) {
+    // With only its one worker, the waiting session would keep the releasing one from running.
+    ServiceExecutorEpoll executor(1);
+    ASSERT_OK(executor.startup());
+
+    const int waiting = addSession(&executor);
+    const int releasing = addSession(&executor);
+
+    writeByte(waiting, kWaitForRelease);
+    events.waitFor([&] { return events.bytesRead == 1; });
+    writeByte(releasing, kRelease);
+    events.waitFor([&] { return events.waited == 1; });
+
+    ASSERT_GREATER_THAN_OR_EQUALS(executor.getStats().threads, 2);
+    ASSERT_EQUALS(0, events.destroyed);
+}
+
+TEST_F(ServiceExecutorEpollTest, EndsSessionWhenOnReadableReturnsFalse) {
+    ServiceExecutorEpoll executor(1);
+    ASSERT_OK(executor.startup());
+
+    const int peer = addSession(&executor);
+    addSession(&executor);
+
+    writeByte(peer, 0);
+    events.waitFor([&] { return events.destroyed == 1; });
+    ASSERT_EQUALS(1, executor.getStats().sessions);
+}
+
+TEST_F(ServiceExecutorEpollTest, EndsSessionWhenPeerCloses) {
+    ServiceExecutorEpoll executor(1);
+    ASSERT_OK(executor.startup());
+
+    int fds[2];
+    ASSERT_EQUALS(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    ASSERT_OK(executor.addSession(stdx::make_unique<TestSession>(fds[0], &events)));
+    close(fds[1]);
+
+    events.waitFor([&] { return events.destroyed == 1; });
+    ASSERT_EQUALS(0, executor.getStats().sessions);
+}
+
+TEST_F(ServiceExecutorEpollTest, ShutdownDestroysIdleSessions) {
+    ServiceExecutorEpoll executor(2);
+    ASSERT_OK(executor.startup());
+
+    addSession(&executor);
+    addSession(&executor);
+    executor.shutdown();
+
+    ASSERT_EQUALS(2, events.destroyed);
+    ASSERT_EQUALS(0, executor.getStats().sessions);
+    ASSERT_NOT_OK(
+        executor.addSession(stdx::make_unique<TestSession>(dup(STDIN_FILENO), &events)));
+}
+
+}  // namespace
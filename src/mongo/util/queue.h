@@ -31,6 +31,7 @@
 
 #include <limits>
 #include <queue>
+#include <utility>
 
 #include "mongo/stdx/chrono.h"
 #include "mongo/stdx/condition_variable.h"
@@ -64,13 +65,13 @@ public:
     BlockingQueue(size_t size) : _maxSize(size), _currentSize(0), _getSize(&_getSizeDefault) {}
     BlockingQueue(size_t size, getSizeFunc f) : _maxSize(size), _currentSize(0), _getSize(f) {}
 
-    void push(T const& t) {
+    void push(T t) {
         stdx::unique_lock<stdx::mutex> l(_lock);
         size_t tSize = _getSize(t);
         while (_currentSize + tSize > _maxSize) {
             _cvNoLongerFull.wait(l);
         }
-        _queue.push(t);
+        _queue.push(std::move(t));
         _currentSize += tSize;
         _cvNoLongerEmpty.notify_one();
     }
@@ -115,7 +116,7 @@ public:
         if (_queue.empty())
             return false;
 
-        t = _queue.front();
+        t = std::move(_queue.front());
         _queue.pop();
         _currentSize -= _getSize(t);
         _cvNoLongerFull.notify_one();
@@ -128,7 +129,7 @@ public:
         while (_queue.empty())
             _cvNoLongerEmpty.wait(l);
 
-        T t = _queue.front();
+        T t = std::move(_queue.front());
         _queue.pop();
         _currentSize -= _getSize(t);
         _cvNoLongerFull.notify_one();
@@ -151,7 +152,7 @@ public:
                 return false;
         }
 
-        t = _queue.front();
+        t = std::move(_queue.front());
         _queue.pop();
         _currentSize -= _getSize(t);
         _cvNoLongerFull.notify_one();
@@ -173,6 +174,22 @@ public:
         return true;
     }
 
+    /**
+     * Blocks until the queue is not empty or maxSecondsToWait passes. Returns true if there is
+     * an item in the queue, without copying it out.
+     * Obviously, this should only be used when you have only one consumer.
+     */
+    bool waitForNonEmpty(int maxSecondsToWait) {
+        using namespace stdx::chrono;
+        const auto deadline = system_clock::now() + seconds(maxSecondsToWait);
+        stdx::unique_lock<stdx::mutex> l(_lock);
+        while (_queue.empty()) {
+            if (stdx::cv_status::timeout == _cvNoLongerEmpty.wait_until(l, deadline))
+                return false;
+        }
+        return true;
+    }
+
     // Obviously, this should only be used when you have
     // only one consumer
     bool peek(T& t) {